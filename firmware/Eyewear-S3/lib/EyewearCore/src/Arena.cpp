@@ -0,0 +1,41 @@
+#include "Arena.h"
+
+#include <stdlib.h>
+
+static size_t alignUp(size_t size) {
+  return (size + Arena::ALIGN - 1) & ~(Arena::ALIGN - 1);
+}
+
+void Arena::attach(void* buf, size_t capacity) {
+  // Start on an ALIGN boundary whatever the caller passed
+  uintptr_t addr = (uintptr_t)buf;
+  size_t skip = buf ? alignUp(addr) - addr : 0;
+  base = (uint8_t*)buf + skip;
+  cap = capacity > skip ? (capacity - skip) & ~(ALIGN - 1) : 0;
+  top = 0;
+  peak = 0;
+  overflowCount = 0;
+}
+
+void* Arena::allocate(size_t size) {
+  size_t need = alignUp(size ? size : 1);
+  if (need <= cap - top) {
+    void* p = base + top;
+    top += need;
+    if (top > peak) peak = top;
+    return p;
+  }
+  overflowCount++;
+  return malloc(size ? size : 1);
+}
+
+void Arena::deallocate(void* p, size_t size) {
+  if (!p) return;
+  if (!owns(p)) {
+    free(p);
+    return;
+  }
+  // Only the newest block can be given back before reset()
+  size_t offset = (uint8_t*)p - base;
+  if (offset + alignUp(size ? size : 1) == top) top = offset;
+}
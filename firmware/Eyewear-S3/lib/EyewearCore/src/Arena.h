@@ -0,0 +1,80 @@
+/*
+ * ============================================
+ * VisionAssist - Request Arena
+ * ============================================
+ *
+ * Bump allocator over one block reserved at boot (PSRAM on
+ * the eyewear). The OCR path takes its large, short-lived
+ * buffers (request JSON, response text) from here and drops
+ * them all with one reset(), so they never sit between
+ * long-lived allocations on the internal heap.
+ *
+ * Freeing the newest block rolls the top back, so a growing
+ * string does not leave its old buffers behind. When the
+ * arena is full, allocations fall back to malloc() and are
+ * counted: an undersized arena shows up in /metrics, not as
+ * a failed request.
+ *
+ * Not thread-safe; one task owns an arena.
+ * ============================================
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+class Arena {
+public:
+  static const size_t ALIGN = 8;
+
+  Arena() {}
+  Arena(void* buf, size_t capacity) { attach(buf, capacity); }
+
+  // Use `buf` as backing store (capacity 0 = every allocation overflows)
+  void attach(void* buf, size_t capacity);
+
+  void* allocate(size_t size);
+  void deallocate(void* p, size_t size);
+
+  // Release every block; nothing allocated before may be used after
+  void reset() { top = 0; }
+
+  bool owns(const void* p) const {
+    return (uintptr_t)p - (uintptr_t)base < cap;
+  }
+
+  size_t capacity() const { return cap; }
+  size_t used() const { return top; }
+  size_t highWater() const { return peak; }
+  uint32_t overflows() const { return overflowCount; }   // allocations sent to malloc()
+
+private:
+  uint8_t* base = nullptr;
+  size_t cap = 0;
+  size_t top = 0;
+  size_t peak = 0;
+  uint32_t overflowCount = 0;
+};
+
+// std allocator over an Arena, for containers and strings
+template <typename T>
+class ArenaAllocator {
+public:
+  typedef T value_type;
+
+  explicit ArenaAllocator(Arena& arena) : arena(&arena) {}
+  template <typename U>
+  ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) {}
+
+  T* allocate(size_t n) { return (T*)arena->allocate(n * sizeof(T)); }
+  void deallocate(T* p, size_t n) { arena->deallocate(p, n * sizeof(T)); }
+
+  bool operator==(const ArenaAllocator& other) const { return arena == other.arena; }
+  bool operator!=(const ArenaAllocator& other) const { return arena != other.arena; }
+
+  Arena* arena;
+};
+
+typedef std::basic_string<char, std::char_traits<char>, ArenaAllocator<char> > ArenaString;
@@ -0,0 +1,62 @@
+#include "DistanceHistory.h"
+#include "ZoneClassifier.h"
+
+static int16_t clamp16(int v) {
+  return v > 32767 ? 32767 : (v < -32768 ? -32768 : (int16_t)v);
+}
+
+static uint8_t worse(uint8_t a, int b) {
+  return ZoneClassifier::severity(b) > ZoneClassifier::severity(a) ? (uint8_t)b : a;
+}
+
+void DistanceHistory::pushRaw() {
+  raws[rawCount % RAW_SLOTS] = rawAcc;
+  rawCount++;
+}
+
+void DistanceHistory::pushSummary() {
+  if (samples) summaryAcc.mean = clamp16(sum / samples);
+  summaries[summaryCount % SUMMARY_SLOTS] = summaryAcc;
+  summaryCount++;
+}
+
+void DistanceHistory::add(uint32_t now, int distance, int pattern) {
+  uint32_t rawAt = now / RAW_PERIOD;
+  uint32_t summaryAt = now / SUMMARY_PERIOD;
+  int16_t d = clamp16(distance);
+
+  if (started && rawAt != rawPeriod) {
+    // Close the period, repeat it over any the caller skipped
+    uint32_t periods = rawAt - rawPeriod;
+    if (periods > RAW_SLOTS) periods = RAW_SLOTS;
+    while (periods--) pushRaw();
+  }
+  if (!started || rawAt != rawPeriod) {
+    rawPeriod = rawAt;
+    rawAcc.distance = d;
+    rawAcc.pattern = (uint8_t)pattern;
+  } else {
+    if (d < rawAcc.distance) rawAcc.distance = d;
+    rawAcc.pattern = worse(rawAcc.pattern, pattern);
+  }
+
+  if (started && summaryAt != summaryPeriod) {
+    uint32_t periods = summaryAt - summaryPeriod;
+    if (periods > SUMMARY_SLOTS) periods = SUMMARY_SLOTS;
+    while (periods--) pushSummary();
+  }
+  if (!started || summaryAt != summaryPeriod) {
+    summaryPeriod = summaryAt;
+    summaryAcc.min = summaryAcc.max = summaryAcc.mean = d;
+    summaryAcc.pattern = (uint8_t)pattern;
+    sum = d;
+    samples = 1;
+  } else {
+    if (d < summaryAcc.min) summaryAcc.min = d;
+    if (d > summaryAcc.max) summaryAcc.max = d;
+    summaryAcc.pattern = worse(summaryAcc.pattern, pattern);
+    sum += d;
+    samples++;
+  }
+  started = true;
+}
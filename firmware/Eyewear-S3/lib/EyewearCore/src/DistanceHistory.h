@@ -0,0 +1,79 @@
+/*
+ * ============================================
+ * VisionAssist - Distance History
+ * ============================================
+ *
+ * The last minutes of distance and zone at two
+ * resolutions, in fixed rings, for the web UI's
+ * sparklines (/history):
+ *   raw      RAW_PERIOD ms, RAW_SLOTS deep (10 s): nearest
+ *            distance and worst zone of each period
+ *   summary  SUMMARY_PERIOD ms, SUMMARY_SLOTS deep (10 min):
+ *            min / max / mean distance and worst zone
+ *
+ * Every entry has a sequence number (entries pushed since
+ * boot), so a client asks only for what it has not seen.
+ * Periods nothing was added in repeat the last entry,
+ * keeping the time axis regular.
+ *
+ * Not thread-safe: the safety task adds, the web handler
+ * copies the object under the caller's lock and reads the
+ * copy.
+ * ============================================
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+class DistanceHistory {
+public:
+  static const uint32_t RAW_PERIOD = 50;
+  static const uint16_t RAW_SLOTS = 200;
+  static const uint32_t SUMMARY_PERIOD = 1000;
+  static const uint16_t SUMMARY_SLOTS = 600;
+
+  struct Raw {
+    int16_t distance;
+    uint8_t pattern;
+  };
+
+  struct Summary {
+    int16_t min;
+    int16_t max;
+    int16_t mean;
+    uint8_t pattern;
+  };
+
+  // One sample, every safety tick
+  void add(uint32_t now, int distance, int pattern);
+
+  // Sequence number the next entry will get
+  uint32_t rawNext() const { return rawCount; }
+  uint32_t summaryNext() const { return summaryCount; }
+
+  // Oldest entry still held
+  uint32_t rawFirst() const { return rawCount > RAW_SLOTS ? rawCount - RAW_SLOTS : 0; }
+  uint32_t summaryFirst() const { return summaryCount > SUMMARY_SLOTS ? summaryCount - SUMMARY_SLOTS : 0; }
+
+  const Raw& raw(uint32_t seq) const { return raws[seq % RAW_SLOTS]; }
+  const Summary& summary(uint32_t seq) const { return summaries[seq % SUMMARY_SLOTS]; }
+
+private:
+  void pushRaw();
+  void pushSummary();
+
+  Raw raws[RAW_SLOTS];
+  Summary summaries[SUMMARY_SLOTS];
+  uint32_t rawCount = 0;
+  uint32_t summaryCount = 0;
+
+  // Periods being accumulated
+  bool started = false;
+  uint32_t rawPeriod = 0;
+  uint32_t summaryPeriod = 0;
+  Raw rawAcc = {};
+  int32_t sum = 0;
+  uint16_t samples = 0;
+  Summary summaryAcc = {};
+};
@@ -0,0 +1,47 @@
+#include "DistanceTracker.h"
+
+void DistanceTracker::reset(uint32_t now) {
+  lastGoodReading = now;
+}
+
+int DistanceTracker::poll(uint32_t now, hal::Tof& tof) {
+  if (now - lastRead < POLL_INTERVAL || !tof.dataReady()) return -1;
+
+  int raw = tof.distance();
+  tof.clearInterrupt();
+  lastRead = now;
+  addSample(now, raw);
+  return raw;
+}
+
+bool DistanceTracker::addSample(uint32_t now, int raw) {
+  if (raw <= 0 || raw >= MAX_RANGE) {
+    rejected++;
+    return false;
+  }
+
+  accepted++;
+  lastGoodReading = now;
+  readings[index] = raw;
+  index = (index + 1) % 3;
+
+  int previous = smoothed;
+  smoothed = (readings[0] + readings[1] + readings[2]) / 3;
+
+  // Closing speed for handband dead reckoning (EMA of the range derivative)
+  if (lastSpeedSample > 0 && previous < MAX_RANGE && now > lastSpeedSample) {
+    float instant = (previous - smoothed) * 1000.0f / (now - lastSpeedSample);
+    speed += 0.3f * (instant - speed);
+  }
+  lastSpeedSample = now;
+  return true;
+}
+
+void DistanceTracker::update(uint32_t now) {
+  if (now - lastGoodReading > STALE_TIMEOUT) {
+    smoothed = NO_OBSTACLE;
+    speed = 0;
+    lastSpeedSample = 0;
+    lastGoodReading = now;
+  }
+}
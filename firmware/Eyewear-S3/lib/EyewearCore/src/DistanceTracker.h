@@ -0,0 +1,54 @@
+/*
+ * ============================================
+ * VisionAssist - TOF Distance Tracker
+ * ============================================
+ *
+ * Polls the TOF sensor, averages the last three good
+ * readings and estimates closing speed for the handband's
+ * dead reckoning. Falls back to NO_OBSTACLE when the
+ * sensor stops returning good readings.
+ * ============================================
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <Hal.h>
+
+class DistanceTracker {
+public:
+  static const int NO_OBSTACLE = 5000;   // reported when nothing is in range
+  static const int MAX_RANGE = 4000;     // readings at or beyond this are dropped
+  static const uint32_t POLL_INTERVAL = 20;
+  static const uint32_t STALE_TIMEOUT = 1000;
+
+  // Start the stale timer from `now` (call once sensing starts)
+  void reset(uint32_t now);
+
+  // Read the sensor if a sample is due; returns the raw reading or -1
+  int poll(uint32_t now, hal::Tof& tof);
+
+  // Feed one raw reading; returns false if it was out of range
+  bool addSample(uint32_t now, int raw);
+
+  // Drop to NO_OBSTACLE after STALE_TIMEOUT without a good reading
+  void update(uint32_t now);
+
+  int distance() const { return smoothed; }
+  float closingSpeed() const { return speed; }   // mm/s, positive = approaching
+
+  // Readings since boot, for /metrics
+  uint32_t acceptedSamples() const { return accepted; }
+  uint32_t rejectedSamples() const { return rejected; }
+
+private:
+  int readings[3] = { NO_OBSTACLE, NO_OBSTACLE, NO_OBSTACLE };
+  int index = 0;
+  int smoothed = NO_OBSTACLE;
+  float speed = 0;
+  uint32_t lastRead = 0;
+  uint32_t lastGoodReading = 0;
+  uint32_t lastSpeedSample = 0;
+  uint32_t accepted = 0;
+  uint32_t rejected = 0;
+};
@@ -0,0 +1,78 @@
+#include "ExposureController.h"
+
+#include <math.h>
+
+// The sensor's output is gamma encoded: exposure scales level^GAMMA
+static const float GAMMA = 2.2f;
+static const float MAX_RATIO = 4.0f;
+
+void ExposureController::reset() {
+  good = split(800);   // indoor light
+  current = good;
+  stepCount = 0;
+  lastLevel = 0;
+}
+
+void ExposureController::begin() {
+  current = good;
+  stepCount = 0;
+}
+
+Exposure ExposureController::split(uint32_t t) {
+  Exposure e;
+  if (t <= LINES_STILL) {
+    e.gain = 0;
+    e.lines = t < LINES_MIN ? LINES_MIN : (uint16_t)t;
+  } else if (t <= (uint32_t)LINES_STILL * (GAIN_MAX + 1)) {
+    e.gain = (uint8_t)((t + LINES_STILL - 1) / LINES_STILL - 1);
+    e.lines = (uint16_t)(t / (e.gain + 1u));
+  } else {
+    e.gain = GAIN_MAX;
+    uint32_t lines = t / (GAIN_MAX + 1u);
+    e.lines = lines > LINES_MAX ? LINES_MAX : (uint16_t)lines;
+  }
+  return e;
+}
+
+ExposureController::Result ExposureController::update(const LumaStats& stats) {
+  stepCount++;
+  lastLevel = stats.percentile(TARGET_PCT);
+
+  if (lastLevel + TOLERANCE >= TARGET && lastLevel <= TARGET + TOLERANCE && lastLevel < CLIPPED) {
+    good = current;
+    return EXPOSURE_CONVERGED;
+  }
+
+  // Clipped frames say how much too bright only roughly: halve, or
+  // quarter if most of the window is white
+  float ratio;
+  if (lastLevel >= CLIPPED) {
+    ratio = stats.permilleAbove(CLIPPED) > 500 ? 1.0f / MAX_RATIO : 0.5f;
+  } else if (lastLevel < 2) {
+    ratio = MAX_RATIO;
+  } else {
+    ratio = powf((float)TARGET / lastLevel, GAMMA);
+    if (ratio > MAX_RATIO) ratio = MAX_RATIO;
+    if (ratio < 1.0f / MAX_RATIO) ratio = 1.0f / MAX_RATIO;
+  }
+
+  uint32_t now = total(current);
+  Exposure next = split((uint32_t)(now * ratio + 0.5f));
+  if (total(next) == now) {
+    good = current;
+    return EXPOSURE_LIMIT;
+  }
+  if (stepCount >= MAX_STEPS) return EXPOSURE_UNSETTLED;
+
+  current = next;
+  return EXPOSURE_ADJUST;
+}
+
+const char* exposureResultName(ExposureController::Result result) {
+  switch (result) {
+    case ExposureController::EXPOSURE_ADJUST: return "adjust";
+    case ExposureController::EXPOSURE_CONVERGED: return "converged";
+    case ExposureController::EXPOSURE_LIMIT: return "limit";
+    default: return "unsettled";
+  }
+}
@@ -0,0 +1,82 @@
+/*
+ * ============================================
+ * VisionAssist - OCR Exposure Controller
+ * ============================================
+ *
+ * The OV2640's own AEC meters the whole frame, so a sign
+ * against a bright sky comes out dark and a page under a
+ * lamp comes out blown. For the OCR shot the eyewear
+ * takes over exposure and gain: it puts the bright end
+ * (97th percentile) of the centre of the frame at TARGET,
+ * just below clipping, which is where the paper or sign
+ * background of dark text sits and where light text on a
+ * dark sign sits.
+ *
+ * Each step measures one frame (JpegLuma block levels) and
+ * corrects the total exposure in one go, undoing the
+ * sensor's gamma. Long exposure is preferred over gain up
+ * to LINES_STILL, beyond which head movement blurs text.
+ * A run starts from the last good exposure, so repeated
+ * reads in the same light usually converge on the first
+ * frame, and stops after MAX_STEPS frames.
+ * ============================================
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include "JpegLuma.h"
+
+struct Exposure {
+  uint16_t lines;   // OV2640 AEC value, exposure in sensor rows
+  uint8_t gain;     // AGC step, about (gain + 1)x
+};
+
+class ExposureController {
+public:
+  static const uint16_t LINES_MIN = 4;
+  static const uint16_t LINES_STILL = 800;
+  static const uint16_t LINES_MAX = 1200;
+  static const uint8_t GAIN_MAX = 30;
+
+  static const uint8_t TARGET = 200;
+  static const uint8_t TARGET_PCT = 97;
+  static const uint8_t TOLERANCE = 24;   // levels either side of TARGET
+  static const uint8_t CLIPPED = 250;
+  static const uint8_t MAX_STEPS = 5;
+
+  enum Result {
+    EXPOSURE_ADJUST,      // apply exposure() and measure another frame
+    EXPOSURE_CONVERGED,   // this frame is good
+    EXPOSURE_LIMIT,       // best the sensor can do (too dark / too bright)
+    EXPOSURE_UNSETTLED,   // out of steps
+    EXPOSURE_RESULTS
+  };
+
+  ExposureController() { reset(); }
+
+  // Forget the last good exposure
+  void reset();
+
+  // Start a run from the last good exposure
+  void begin();
+
+  // Feed the statistics of a frame taken at exposure()
+  Result update(const LumaStats& stats);
+
+  const Exposure& exposure() const { return current; }
+  uint8_t steps() const { return stepCount; }
+  uint8_t level() const { return lastLevel; }   // measured percentile, last frame
+
+  // lines x gain factor, and back (long exposure first)
+  static uint32_t total(const Exposure& e) { return (uint32_t)e.lines * (e.gain + 1u); }
+  static Exposure split(uint32_t total);
+
+private:
+  Exposure current;
+  Exposure good;
+  uint8_t stepCount = 0;
+  uint8_t lastLevel = 0;
+};
+
+const char* exposureResultName(ExposureController::Result result);
@@ -0,0 +1,183 @@
+#include "FlightRecorder.h"
+#include "DistanceTracker.h"
+
+#include <string.h>
+
+#ifdef ARDUINO
+#include <freertos/FreeRTOS.h>
+static portMUX_TYPE flightMux = portMUX_INITIALIZER_UNLOCKED;
+#define FLIGHT_LOCK() portENTER_CRITICAL(&flightMux)
+#define FLIGHT_UNLOCK() portEXIT_CRITICAL(&flightMux)
+#else
+#define FLIGHT_LOCK()
+#define FLIGHT_UNLOCK()
+#endif
+
+static_assert(sizeof(FlightRecord) == 4, "flight records are 4 bytes on the wire");
+static_assert(sizeof(FlightHeader) == 16, "flight header is 16 bytes on the wire");
+
+// ===========================================
+// Recorder
+// ===========================================
+void FlightRecorder::begin(hal::Clock& c, void* buf, size_t bytes) {
+  FLIGHT_LOCK();
+  clock = &c;
+  ring = (FlightRecord*)buf;
+  size_t n = buf ? bytes / (sizeof(FlightRecord) * BLOCK_RECORDS) : 0;
+  blocks = n > 0xFFFF ? 0xFFFF : (uint16_t)n;
+  head = 0;
+  lastMs = 0;
+  FLIGHT_UNLOCK();
+}
+
+void FlightRecorder::put(uint8_t tag, uint8_t dt, uint16_t value) {
+  FlightRecord& r = ring[head % capacity()];
+  r.tag = tag;
+  r.dt = dt;
+  r.value = value;
+  head++;
+}
+
+void FlightRecorder::record(FlightKind kind, uint8_t arg, int32_t value) {
+  if (!enabled()) return;
+  if (value > 32767) value = 32767;
+  if (value < -32768) value = -32768;
+
+  FLIGHT_LOCK();
+  uint32_t now = clock->millis();
+  uint32_t gap = now - lastMs;
+  lastMs = now;
+
+  // Absolute time after a long gap and at every block start, so
+  // decoding can begin at any block. The pair must not straddle a
+  // block: a GAP 0 filler moves it into the next one.
+  bool sync = gap > 0xFFFF;
+  uint8_t dt = 0;
+  if (!sync && gap > 0xFF) put(FR_GAP, 0, (uint16_t)gap);
+  else if (!sync) dt = (uint8_t)gap;
+  while (sync || head % BLOCK_RECORDS == 0) {
+    if (head % BLOCK_RECORDS == BLOCK_RECORDS - 1) put(FR_GAP, 0, 0);
+    put(FR_SYNC_LO, 0, (uint16_t)now);
+    put(FR_SYNC_HI, 0, (uint16_t)(now >> 16));
+    sync = false;
+    dt = 0;
+  }
+  put((uint8_t)(kind | (arg << 4)), dt, (uint16_t)(int16_t)value);
+  FLIGHT_UNLOCK();
+}
+
+// First record still held: the ring drops whole blocks
+uint32_t FlightRecorder::oldest() const {
+  uint32_t top = (head + BLOCK_RECORDS - 1) / BLOCK_RECORDS * BLOCK_RECORDS;
+  return top > capacity() ? top - capacity() : 0;
+}
+
+void FlightRecorder::header(FlightHeader& h, uint8_t tofZones, uint32_t& cursor, uint32_t& end) {
+  memset(&h, 0, sizeof(h));
+  memcpy(h.magic, FLIGHT_MAGIC, 4);
+  h.version = FLIGHT_VERSION;
+  h.recordBytes = sizeof(FlightRecord);
+  h.tofZones = tofZones;
+  FLIGHT_LOCK();
+  h.dumpMs = clock ? clock->millis() : 0;
+  cursor = enabled() ? oldest() : 0;
+  end = head;
+  h.overwritten = cursor;
+  FLIGHT_UNLOCK();
+}
+
+size_t FlightRecorder::read(uint32_t& cursor, uint32_t end, FlightRecord* out, size_t max) {
+  if (!enabled()) return 0;
+  FLIGHT_LOCK();
+  uint32_t first = oldest();
+  if ((int32_t)(cursor - first) < 0) cursor = first;
+  size_t n = (int32_t)(end - cursor) > 0 ? end - cursor : 0;
+  if (n > max) n = max;
+  for (size_t i = 0; i < n; i++) out[i] = ring[(cursor + i) % capacity()];
+  cursor += n;
+  FLIGHT_UNLOCK();
+  return n;
+}
+
+// ===========================================
+// Reader
+// ===========================================
+bool FlightReader::open(const uint8_t* data, size_t len) {
+  if (len < sizeof(FlightHeader)) return false;
+  memcpy(&hdr, data, sizeof(hdr));
+  if (memcmp(hdr.magic, FLIGHT_MAGIC, 4) != 0 || hdr.version != FLIGHT_VERSION ||
+      hdr.recordBytes != sizeof(FlightRecord)) {
+    return false;
+  }
+  rec = (const FlightRecord*)(data + sizeof(FlightHeader));
+  count = (len - sizeof(FlightHeader)) / sizeof(FlightRecord);
+  pos = 0;
+  ms = 0;
+  synced = false;
+  memset(zoneMm, 0, sizeof(zoneMm));
+  return true;
+}
+
+bool FlightReader::next(FlightEvent& e) {
+  while (pos < count) {
+    FlightRecord r;
+    memcpy(&r, rec + pos++, sizeof(r));
+    FlightKind kind = (FlightKind)(r.tag & 0x0F);
+    switch (kind) {
+      case FR_SYNC_LO:
+        syncLo = r.value;
+        synced = false;
+        continue;
+      case FR_SYNC_HI:
+        ms = (uint32_t)r.value << 16 | syncLo;
+        synced = true;
+        continue;
+      case FR_GAP:
+        ms += r.dt + r.value;
+        continue;
+      default:
+        break;
+    }
+    ms += r.dt;
+    if (!synced || kind >= FR_KINDS) continue;   // before the first block start
+    e.ms = ms;
+    e.kind = kind;
+    e.arg = r.tag >> 4;
+    e.value = (int16_t)r.value;
+    return true;
+  }
+  return false;
+}
+
+bool FlightReader::nextTof(uint32_t& at, int& mm) {
+  FlightEvent e;
+  while (next(e)) {
+    if (e.kind != FR_TOF) continue;
+    zoneMm[e.arg] = e.value > 0 && e.value < DistanceTracker::MAX_RANGE ? e.value : -1;
+    at = e.ms;
+    mm = e.value;
+    if (hdr.tofZones <= 1) return true;
+
+    // A bad reading in one zone must not hide the others
+    int near = -1;
+    for (uint8_t z = 0; z < hdr.tofZones && z < 16; z++) {
+      if (zoneMm[z] > 0 && (near < 0 || zoneMm[z] < near)) near = zoneMm[z];
+    }
+    if (near > 0) mm = near;
+    return true;
+  }
+  return false;
+}
+
+const char* flightKindName(FlightKind kind) {
+  switch (kind) {
+    case FR_TOF: return "tof";
+    case FR_DISTANCE: return "distance";
+    case FR_ZONE: return "zone";
+    case FR_SEND: return "send";
+    case FR_ACK: return "ack";
+    case FR_PAUSE: return "pause";
+    case FR_RESUME: return "resume";
+    default: return "?";
+  }
+}
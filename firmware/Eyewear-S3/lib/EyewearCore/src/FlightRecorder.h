@@ -0,0 +1,155 @@
+/*
+ * ============================================
+ * VisionAssist - Flight Recorder
+ * ============================================
+ *
+ * Keeps the last minutes of the alert path in a RAM ring
+ * (PSRAM on the eyewear) so "it didn't vibrate" can be
+ * looked at afterwards: every raw TOF sample, the smoothed
+ * distance, zone changes, state frames queued per band,
+ * delivery results, and reading-mode pause / resume.
+ *
+ * Records are 4 bytes: kind, argument, milliseconds since
+ * the previous record, 16-bit value. Longer gaps add a GAP
+ * record. The ring is made of BLOCK_RECORDS blocks that
+ * each open with two SYNC records (absolute time), so when
+ * the oldest block is overwritten the rest still decodes.
+ * About 150 records/s with two bands: 256 KB holds ~7 min.
+ *
+ * Dump (GET /flight): FlightHeader, then the records oldest
+ * first, little endian. FlightReader decodes it on the host
+ * (Host-Tools flight_decode, system_sim --trace).
+ * ============================================
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <Hal.h>
+
+enum FlightKind : uint8_t {
+  FR_SYNC_LO,     // value = ms bits 0-15, at block starts
+  FR_SYNC_HI,     // value = ms bits 16-31
+  FR_GAP,         // value = extra ms (unsigned) before the next record
+  FR_TOF,         // arg = zone, value = raw mm (<= 0 = error)
+  FR_DISTANCE,    // value = smoothed mm
+  FR_ZONE,        // arg = stable pattern, value = smoothed mm
+  FR_SEND,        // arg = band slot, value = queued << 8 | pattern
+  FR_ACK,         // arg = band slot, value = delivered
+  FR_PAUSE,       // reading mode on
+  FR_RESUME,      // arg = resume reason
+  FR_KINDS
+};
+
+static const uint8_t FLIGHT_NO_SLOT = 0x0F;       // band not in the peer table
+static const uint8_t FLIGHT_OTHER_FRAME = 0xFF;   // FR_SEND pattern of table / pause frames
+
+struct __attribute__((packed)) FlightRecord {
+  uint8_t tag;      // kind | arg << 4
+  uint8_t dt;       // ms since the previous record
+  uint16_t value;
+};
+
+#define FLIGHT_MAGIC "VAFR"
+#define FLIGHT_VERSION 1
+
+struct __attribute__((packed)) FlightHeader {
+  char magic[4];        // FLIGHT_MAGIC
+  uint8_t version;
+  uint8_t recordBytes;  // sizeof(FlightRecord)
+  uint8_t tofZones;
+  uint8_t reserved;
+  uint32_t dumpMs;      // device millis() at the start of the dump
+  uint32_t overwritten; // records lost to the ring before the first one sent
+};
+
+class FlightRecorder {
+public:
+  static const uint16_t BLOCK_RECORDS = 256;   // 1 KB
+
+  // Record into `buf` (rounded down to whole blocks); no buffer = off
+  void begin(hal::Clock& clock, void* buf, size_t bytes);
+  bool enabled() const { return blocks > 0; }
+
+  // Safe from any task and the ESP-NOW callbacks; `value` is
+  // clamped to 16 bits
+  void record(FlightKind kind, uint8_t arg, int32_t value);
+
+  // Records written since boot, and how many the ring holds
+  uint32_t written() const { return head; }
+  uint32_t capacity() const { return (uint32_t)blocks * BLOCK_RECORDS; }
+
+  // Dump: header() fixes the end, then read() until it returns 0
+  void header(FlightHeader& h, uint8_t tofZones, uint32_t& cursor, uint32_t& end);
+  // Copies records [cursor, end) oldest first; a cursor the ring has
+  // overtaken moves on to the oldest block still held
+  size_t read(uint32_t& cursor, uint32_t end, FlightRecord* out, size_t max);
+
+private:
+  uint32_t oldest() const;
+  void put(uint8_t tag, uint8_t dt, uint16_t value);
+
+  hal::Clock* clock = nullptr;
+  FlightRecord* ring = nullptr;
+  uint16_t blocks = 0;
+  uint32_t head = 0;      // records written, index of the next one
+  uint32_t lastMs = 0;
+};
+
+// Passes a sensor through, recording every reading (wraps the
+// sensor itself, so each zone's sample is kept, not just the nearest)
+class FlightTof : public hal::Tof {
+public:
+  FlightTof(hal::Tof& sensor, FlightRecorder& recorder) : sensor(sensor), recorder(recorder) {}
+
+  bool dataReady() override { return sensor.dataReady(); }
+  int distance() override {
+    int mm = sensor.distance();
+    recorder.record(FR_TOF, sensor.zone(), mm);
+    return mm;
+  }
+  void clearInterrupt() override { sensor.clearInterrupt(); }
+  uint8_t zoneCount() const override { return sensor.zoneCount(); }
+  uint8_t zone() const override { return sensor.zone(); }
+
+private:
+  hal::Tof& sensor;
+  FlightRecorder& recorder;
+};
+
+// ===========================================
+// Host side
+// ===========================================
+struct FlightEvent {
+  uint32_t ms;
+  FlightKind kind;
+  uint8_t arg;
+  int32_t value;     // signed for TOF / distances, as recorded
+};
+
+class FlightReader {
+public:
+  // `data` stays owned by the caller; false if it is not a dump
+  bool open(const uint8_t* data, size_t len);
+  const FlightHeader& header() const { return hdr; }
+
+  // Next event in time order (SYNC and GAP records are consumed)
+  bool next(FlightEvent& e);
+
+  // Next TOF sample as the navigation path saw it: the nearest good
+  // zone, as ZoneMap reports it ("ms,mm" replay input)
+  bool nextTof(uint32_t& ms, int& mm);
+
+private:
+  FlightHeader hdr = {};
+  const FlightRecord* rec = nullptr;
+  size_t count = 0;
+  size_t pos = 0;
+  uint32_t ms = 0;
+  uint16_t syncLo = 0;
+  bool synced = false;
+  int zoneMm[16] = {};
+};
+
+const char* flightKindName(FlightKind kind);
@@ -0,0 +1,396 @@
+#include "JpegLuma.h"
+
+#include <string.h>
+
+// ===========================================
+// LumaStats
+// ===========================================
+void LumaStats::clear() {
+  memset(hist, 0, sizeof(hist));
+  count = 0;
+}
+
+uint8_t LumaStats::percentile(uint8_t pct) const {
+  if (count == 0) return 0;
+  uint32_t want = (uint64_t)count * pct / 100;
+  uint32_t seen = 0;
+  for (int level = 0; level < 256; level++) {
+    seen += hist[level];
+    if (seen > want || seen == count) return (uint8_t)level;
+  }
+  return 255;
+}
+
+uint8_t LumaStats::mean() const {
+  if (count == 0) return 0;
+  uint64_t sum = 0;
+  for (int level = 0; level < 256; level++) sum += (uint64_t)hist[level] * level;
+  return (uint8_t)(sum / count);
+}
+
+uint16_t LumaStats::permilleAbove(uint8_t level) const {
+  if (count == 0) return 0;
+  uint32_t above = 0;
+  for (int l = level; l < 256; l++) above += hist[l];
+  return (uint16_t)((uint64_t)above * 1000 / count);
+}
+
+// ===========================================
+// Huffman Decoding
+// ===========================================
+namespace {
+
+const int LOOKAHEAD = 8;
+
+struct HuffTable {
+  bool defined = false;
+  uint8_t lookLen[1 << LOOKAHEAD];   // length of the code starting here, 0 = longer
+  uint8_t lookVal[1 << LOOKAHEAD];
+  int32_t maxCode[18];               // largest code of each length, -1 = none
+  int32_t valOffset[17];
+  uint8_t values[256];
+
+  bool build(const uint8_t* counts, const uint8_t* vals, int total) {
+    if (total > 256) return false;
+    memcpy(values, vals, total);
+    memset(lookLen, 0, sizeof(lookLen));
+    int32_t code = 0;
+    int k = 0;
+    for (int len = 1; len <= 16; len++) {
+      valOffset[len] = k - code;
+      for (int i = 0; i < counts[len - 1]; i++, code++, k++) {
+        if (len <= LOOKAHEAD) {
+          int shift = LOOKAHEAD - len;
+          for (int fill = 0; fill < (1 << shift); fill++) {
+            lookLen[(code << shift) | fill] = len;
+            lookVal[(code << shift) | fill] = values[k];
+          }
+        }
+      }
+      maxCode[len] = counts[len - 1] ? code - 1 : -1;
+      code <<= 1;
+    }
+    maxCode[17] = 0x7FFFFFFF;
+    defined = true;
+    return true;
+  }
+};
+
+// MSB-first bit reader over entropy-coded data. Undoes 0xFF00
+// stuffing and reads zeros from the first marker on.
+class BitReader {
+public:
+  BitReader(const uint8_t* p, const uint8_t* end) : p(p), end(end) {}
+
+  uint32_t peek(int n) {
+    fill();
+    return acc >> (32 - n);
+  }
+  void skip(int n) {
+    acc <<= n;
+    bits -= n;
+  }
+  int get(int n) {
+    if (n == 0) return 0;
+    uint32_t v = peek(n);
+    skip(n);
+    return (int)v;
+  }
+
+  int decode(const HuffTable& table) {
+    uint32_t look = peek(LOOKAHEAD);
+    int len = table.lookLen[look];
+    if (len) {
+      skip(len);
+      return table.lookVal[look];
+    }
+    for (len = LOOKAHEAD + 1; len <= 16; len++) {
+      int32_t code = (int32_t)peek(len);
+      if (code <= table.maxCode[len]) {
+        skip(len);
+        return table.values[code + table.valOffset[len]];
+      }
+    }
+    return -1;
+  }
+
+  // Drop the rest of this interval and step over its RSTn marker
+  void restart() {
+    acc = 0;
+    bits = 0;
+    marker = false;
+    while (p + 1 < end && !(p[0] == 0xFF && p[1] >= 0xD0 && p[1] <= 0xD7)) p++;
+    if (p + 1 < end) p += 2;
+  }
+
+private:
+  void fill() {
+    while (bits <= 24) {
+      uint32_t byte = 0;
+      if (!marker && p < end) {
+        byte = *p;
+        if (byte == 0xFF) {
+          if (p + 1 < end && p[1] == 0x00) {
+            p += 2;
+          } else {
+            marker = true;   // leave p on the marker for restart()
+            byte = 0;
+          }
+        } else {
+          p++;
+        }
+      }
+      acc |= byte << (24 - bits);
+      bits += 8;
+    }
+  }
+
+  const uint8_t* p;
+  const uint8_t* end;
+  uint32_t acc = 0;
+  int bits = 0;
+  bool marker = false;
+};
+
+int extend(int v, int s) {
+  return v < (1 << (s - 1)) ? v - (1 << s) + 1 : v;
+}
+
+struct Component {
+  uint8_t id;
+  uint8_t h, v;
+  uint8_t quant;
+  uint8_t dcTable, acTable;   // from the scan header
+};
+
+uint16_t be16(const uint8_t* p) {
+  return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+// Direction of each AC coefficient, in zigzag order: 0 = first row
+// (horizontal detail), 1 = first column (vertical), 2 = both
+const uint8_t DETAIL_DIR[64] = {
+  0, 0, 1, 1, 2, 0, 0, 2, 2, 1, 1, 2, 2, 2, 0, 0,
+  2, 2, 2, 2, 1, 1, 2, 2, 2, 2, 2, 0, 0, 2, 2, 2,
+  2, 2, 2, 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+  2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2 };
+
+class StatsSink : public LumaBlockSink {
+public:
+  explicit StatsSink(LumaStats& stats) : stats(stats) {}
+  void begin(uint16_t, uint16_t) override {}
+  void block(const LumaBlock& b) override { stats.add(b.level); }
+
+private:
+  LumaStats& stats;
+};
+
+}  // namespace
+
+// ===========================================
+// Parser
+// ===========================================
+bool jpegLumaStats(const uint8_t* jpeg, size_t len, LumaStats& stats, uint8_t windowPct) {
+  stats.clear();
+  StatsSink sink(stats);
+  return jpegLumaBlocks(jpeg, len, sink, windowPct);
+}
+
+bool jpegLumaBlocks(const uint8_t* jpeg, size_t len, LumaBlockSink& sink, uint8_t windowPct) {
+  if (len < 4 || jpeg[0] != 0xFF || jpeg[1] != 0xD8) return false;
+  if (windowPct == 0 || windowPct > 100) windowPct = 100;
+
+  // 7.5 KB: static to keep it off the task stack, so one caller at a time
+  static HuffTable dcTables[4], acTables[4];
+  static uint16_t quant[4][64];   // zigzag order, as stored
+  for (int i = 0; i < 4; i++) dcTables[i].defined = acTables[i].defined = false;
+  memset(quant, 0, sizeof(quant));
+  Component comps[4];
+  int compCount = 0;
+  uint16_t width = 0, height = 0;
+  uint16_t restartInterval = 0;
+
+  size_t i = 2;
+  while (i + 4 <= len) {
+    if (jpeg[i] != 0xFF) return false;
+    uint8_t marker = jpeg[i + 1];
+    if (marker == 0xFF) { i++; continue; }   // fill byte
+    if (marker == 0x01 || (marker >= 0xD0 && marker <= 0xD7)) { i += 2; continue; }
+    if (marker == 0xD9) return false;        // EOI before any scan
+
+    size_t segLen = be16(jpeg + i + 2);
+    const uint8_t* seg = jpeg + i + 4;
+    size_t segEnd = i + 2 + segLen;
+    if (segLen < 2 || segEnd > len) return false;
+    const uint8_t* end = jpeg + segEnd;
+
+    switch (marker) {
+      case 0xC0:
+      case 0xC1: {
+        if (segLen < 8) return false;
+        height = be16(seg + 1);
+        width = be16(seg + 3);
+        compCount = seg[5];
+        if (compCount < 1 || compCount > 4 || segLen < 8 + 3u * compCount) return false;
+        for (int c = 0; c < compCount; c++) {
+          comps[c].id = seg[6 + 3 * c];
+          comps[c].h = seg[7 + 3 * c] >> 4;
+          comps[c].v = seg[7 + 3 * c] & 0x0F;
+          comps[c].quant = seg[8 + 3 * c] & 0x03;
+          if (comps[c].h < 1 || comps[c].v < 1 || comps[c].h > 4 || comps[c].v > 4) return false;
+        }
+        break;
+      }
+
+      case 0xC2: case 0xC3: case 0xC5: case 0xC6: case 0xC7:
+      case 0xC9: case 0xCA: case 0xCB: case 0xCD: case 0xCE: case 0xCF:
+        return false;   // progressive, lossless or arithmetic coded
+
+      case 0xC4:
+        while (seg + 17 <= end) {
+          uint8_t cls = seg[0] >> 4, id = seg[0] & 0x03;
+          int total = 0;
+          for (int n = 0; n < 16; n++) total += seg[1 + n];
+          if (seg + 17 + total > end) return false;
+          HuffTable& table = cls ? acTables[id] : dcTables[id];
+          if (!table.build(seg + 1, seg + 17, total)) return false;
+          seg += 17 + total;
+        }
+        break;
+
+      case 0xDB:
+        while (seg + 65 <= end) {
+          bool wide = seg[0] >> 4;
+          uint8_t id = seg[0] & 0x03;
+          if (wide && seg + 129 > end) return false;
+          for (int k = 0; k < 64; k++) quant[id][k] = wide ? be16(seg + 1 + 2 * k) : seg[1 + k];
+          seg += wide ? 129 : 65;
+        }
+        break;
+
+      case 0xDD:
+        if (segLen >= 4) restartInterval = be16(seg);
+        break;
+
+      case 0xDA: {
+        if (compCount == 0 || width == 0 || height == 0) return false;
+        int scanCount = seg[0];
+        if (scanCount < 1 || scanCount > compCount || segLen < 6 + 2u * scanCount) return false;
+
+        int scan[4];
+        for (int s = 0; s < scanCount; s++) {
+          scan[s] = -1;
+          for (int c = 0; c < compCount; c++) {
+            if (comps[c].id == seg[1 + 2 * s]) scan[s] = c;
+          }
+          if (scan[s] < 0) return false;
+          comps[scan[s]].dcTable = seg[2 + 2 * s] >> 4;
+          comps[scan[s]].acTable = seg[2 + 2 * s] & 0x03;
+          if (!dcTables[comps[scan[s]].dcTable].defined || !acTables[comps[scan[s]].acTable].defined) {
+            return false;
+          }
+        }
+        // Luma is the first frame component; a scan without it has no brightness
+        if (scan[0] != 0) return false;
+
+        int hMax = 1, vMax = 1;
+        for (int c = 0; c < compCount; c++) {
+          if (comps[c].h > hMax) hMax = comps[c].h;
+          if (comps[c].v > vMax) vMax = comps[c].v;
+        }
+        const Component& luma = comps[0];
+        int lumaW = (width * luma.h + hMax - 1) / hMax;
+        int lumaH = (height * luma.v + vMax - 1) / vMax;
+        int blocksW = (lumaW + 7) / 8;
+        int blocksH = (lumaH + 7) / 8;
+        int marginX = lumaW * (100 - windowPct) / 200;
+        int marginY = lumaH * (100 - windowPct) / 200;
+        // Window: blocks whose centre is inside the margins
+        int col0 = 0, col1 = blocksW, row0 = 0, row1 = blocksH;
+        while (col0 < blocksW && col0 * 8 + 4 < marginX) col0++;
+        while (col1 > col0 && (col1 - 1) * 8 + 4 >= lumaW - marginX) col1--;
+        while (row0 < blocksH && row0 * 8 + 4 < marginY) row0++;
+        while (row1 > row0 && (row1 - 1) * 8 + 4 >= lumaH - marginY) row1--;
+        sink.begin((uint16_t)(col1 - col0), (uint16_t)(row1 - row0));
+        const uint16_t* q = quant[luma.quant];
+        int q0 = q[0] ? q[0] : 1;
+        uint32_t visited = 0;
+
+        // Interleaved: MCUs of h x v blocks per component. One component:
+        // single blocks over that component's own block grid
+        int mcusX, mcusY;
+        if (scanCount == 1) {
+          mcusX = blocksW;
+          mcusY = blocksH;
+        } else {
+          mcusX = (width + 8 * hMax - 1) / (8 * hMax);
+          mcusY = (height + 8 * vMax - 1) / (8 * vMax);
+        }
+
+        BitReader bits(jpeg + segEnd, jpeg + len);
+        int pred[4] = { 0, 0, 0, 0 };
+        uint32_t mcus = (uint32_t)mcusX * mcusY;
+        for (uint32_t m = 0; m < mcus; m++) {
+          if (restartInterval && m > 0 && m % restartInterval == 0) {
+            bits.restart();
+            pred[0] = pred[1] = pred[2] = pred[3] = 0;
+          }
+          int mx = m % mcusX, my = m / mcusX;
+
+          for (int s = 0; s < scanCount; s++) {
+            const Component& comp = comps[scan[s]];
+            int bh = scanCount == 1 ? 1 : comp.h;
+            int bv = scanCount == 1 ? 1 : comp.v;
+            const HuffTable& dc = dcTables[comp.dcTable];
+            const HuffTable& ac = acTables[comp.acTable];
+
+            for (int v = 0; v < bv; v++) {
+              for (int h = 0; h < bh; h++) {
+                int size = bits.decode(dc);
+                if (size < 0 || size > 11) return visited > 0;
+                if (size) pred[s] += extend(bits.get(size), size);
+
+                uint32_t detail[3] = { 0, 0, 0 };
+                for (int k = 1; k < 64;) {
+                  int rs = bits.decode(ac);
+                  if (rs < 0) return visited > 0;
+                  int run = rs >> 4, acSize = rs & 0x0F;
+                  if (acSize == 0) {
+                    if (run != 15) break;   // end of block
+                    k += 16;
+                  } else {
+                    k += run;
+                    int value = extend(bits.get(acSize), acSize);
+                    if (s == 0 && k < 64) detail[DETAIL_DIR[k]] += (uint32_t)(value < 0 ? -value : value) * q[k];
+                    k++;
+                  }
+                }
+
+                if (s != 0) continue;
+                int bx = mx * bh + h, by = my * bv + v;
+                if (bx < col0 || bx >= col1 || by < row0 || by >= row1) continue;
+
+                LumaBlock b;
+                b.col = (uint16_t)(bx - col0);
+                b.row = (uint16_t)(by - row0);
+                int level = 128 + pred[0] * q0 / 8;
+                b.level = (uint8_t)(level < 0 ? 0 : (level > 255 ? 255 : level));
+                b.horizontal = (uint16_t)(detail[0] / 8 > 0xFFFF ? 0xFFFF : detail[0] / 8);
+                b.vertical = (uint16_t)(detail[1] / 8 > 0xFFFF ? 0xFFFF : detail[1] / 8);
+                b.mixed = (uint16_t)(detail[2] / 8 > 0xFFFF ? 0xFFFF : detail[2] / 8);
+                sink.block(b);
+                visited++;
+              }
+            }
+          }
+        }
+        return visited > 0;
+      }
+
+      default:
+        break;   // APPn, COM, ...
+    }
+    i = segEnd;
+  }
+  return false;
+}
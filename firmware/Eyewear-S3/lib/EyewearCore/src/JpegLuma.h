@@ -0,0 +1,68 @@
+/*
+ * ============================================
+ * VisionAssist - JPEG Luminance Statistics
+ * ============================================
+ *
+ * Brightness histogram of a camera JPEG without decoding
+ * it. Only the Huffman codes are walked: the luma DC
+ * coefficient of each 8x8 block, once dequantised, is that
+ * block's mean level and goes into the histogram; nothing
+ * is inverse transformed and no pixel buffer is needed.
+ *
+ * jpegLumaBlocks() hands each block to a sink instead,
+ * with the size of its AC coefficients (detail) split by
+ * direction - what TextPresence looks for strokes in.
+ *
+ * Baseline (SOF0/SOF1) Huffman JPEGs only, any sampling
+ * factors, with or without restart markers - what the
+ * OV2640 produces.
+ * ============================================
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Histogram of 8x8 block means (0-255) over a centred window
+struct LumaStats {
+  uint32_t hist[256];
+  uint32_t count;
+
+  void clear();
+  void add(uint8_t level) { hist[level]++; count++; }
+
+  // Level at or below which `pct` percent of the blocks lie
+  uint8_t percentile(uint8_t pct) const;
+  uint8_t mean() const;
+  // Share of blocks at or above `level`, in 1/1000
+  uint16_t permilleAbove(uint8_t level) const;
+};
+
+// One 8x8 luma block. Detail is the sum of the dequantised AC
+// coefficients' magnitudes, in levels (/8): horizontal = first row
+// (vertical edges), vertical = first column (horizontal edges), mixed
+// = the rest (corners, curves, strokes both ways, texture).
+struct LumaBlock {
+  uint16_t col, row;   // in blocks, from the window's top left
+  uint8_t level;       // mean
+  uint16_t horizontal;
+  uint16_t vertical;
+  uint16_t mixed;
+};
+
+class LumaBlockSink {
+public:
+  virtual ~LumaBlockSink() {}
+  // Window size in blocks, before the first block
+  virtual void begin(uint16_t cols, uint16_t rows) = 0;
+  // In stream order: raster order for 4:4:4 and 4:2:2, MCU by MCU otherwise
+  virtual void block(const LumaBlock& b) = 0;
+};
+
+// Blocks whose centre lies in the middle `windowPct` percent of the
+// width and height (the text being read is usually straight ahead).
+// Returns false for a JPEG this parser does not handle.
+// Not reentrant (the Huffman tables are static).
+bool jpegLumaStats(const uint8_t* jpeg, size_t len, LumaStats& stats, uint8_t windowPct = 60);
+bool jpegLumaBlocks(const uint8_t* jpeg, size_t len, LumaBlockSink& sink, uint8_t windowPct = 60);
@@ -0,0 +1,75 @@
+#include "Metrics.h"
+
+#include <stdio.h>
+
+Histogram::Histogram(const uint32_t* bounds, uint8_t count)
+  : bounds(bounds), boundCount(count > MAX_BUCKETS ? MAX_BUCKETS : count) {}
+
+void Histogram::observe(uint32_t value) {
+  uint8_t i = 0;
+  while (i < boundCount && value > bounds[i]) i++;
+  buckets[i] = buckets[i] + 1;
+  valueSum = valueSum + value;
+  total = total + 1;
+}
+
+static void appendLabels(std::string& out, const char* labels, const char* le) {
+  bool any = labels && *labels;
+  if (!any && !le) return;
+  out += '{';
+  if (any) out += labels;
+  if (le) {
+    if (any) out += ',';
+    out += "le=\"";
+    out += le;
+    out += '"';
+  }
+  out += '}';
+}
+
+void Histogram::write(std::string& out, const char* name, const char* labels) const {
+  char num[24];
+  uint32_t cumulative = 0;
+
+  for (uint8_t i = 0; i <= boundCount; i++) {
+    cumulative += buckets[i];
+    if (i < boundCount) snprintf(num, sizeof(num), "%u", (unsigned)bounds[i]);
+    out += name;
+    out += "_bucket";
+    appendLabels(out, labels, i < boundCount ? num : "+Inf");
+    snprintf(num, sizeof(num), " %u\n", (unsigned)cumulative);
+    out += num;
+  }
+
+  out += name;
+  out += "_sum";
+  appendLabels(out, labels, nullptr);
+  snprintf(num, sizeof(num), " %llu\n", (unsigned long long)valueSum);
+  out += num;
+
+  out += name;
+  out += "_count";
+  appendLabels(out, labels, nullptr);
+  snprintf(num, sizeof(num), " %u\n", (unsigned)cumulative);
+  out += num;
+}
+
+void promHeader(std::string& out, const char* name, const char* type, const char* help) {
+  out += "# HELP ";
+  out += name;
+  out += ' ';
+  out += help;
+  out += "\n# TYPE ";
+  out += name;
+  out += ' ';
+  out += type;
+  out += '\n';
+}
+
+void promSample(std::string& out, const char* name, const char* labels, uint64_t value) {
+  char num[24];
+  out += name;
+  appendLabels(out, labels, nullptr);
+  snprintf(num, sizeof(num), " %llu\n", (unsigned long long)value);
+  out += num;
+}
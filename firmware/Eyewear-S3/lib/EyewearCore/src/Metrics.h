@@ -0,0 +1,59 @@
+/*
+ * ============================================
+ * VisionAssist - Metrics (Prometheus text)
+ * ============================================
+ *
+ * Counters and fixed-bucket histograms cheap enough to leave
+ * on in production: an update is a relaxed atomic add or a
+ * short bucket scan, nothing allocates. Rendering to the
+ * Prometheus text format happens only when /metrics is read.
+ *
+ * Each histogram has one writer (the task that times the
+ * work); readers may see a sum and count a sample apart.
+ * ============================================
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <string>
+
+class Counter {
+public:
+  void inc(uint32_t n = 1) { v.fetch_add(n, std::memory_order_relaxed); }
+  uint32_t value() const { return v.load(std::memory_order_relaxed); }
+
+private:
+  std::atomic<uint32_t> v{0};
+};
+
+class Histogram {
+public:
+  static const uint8_t MAX_BUCKETS = 12;
+
+  // `bounds` are ascending upper bounds (static storage); +Inf is implied
+  Histogram(const uint32_t* bounds, uint8_t count);
+
+  void observe(uint32_t value);
+
+  uint32_t count() const { return total; }
+  uint64_t sum() const { return valueSum; }
+
+  // <name>_bucket / _sum / _count lines; `labels` like route="/ocr" or null
+  void write(std::string& out, const char* name, const char* labels = nullptr) const;
+
+private:
+  const uint32_t* bounds;
+  uint8_t boundCount;
+  volatile uint32_t buckets[MAX_BUCKETS + 1] = {};   // last = above every bound
+  volatile uint32_t total = 0;
+  volatile uint64_t valueSum = 0;
+};
+
+// # HELP / # TYPE lines for one metric family
+void promHeader(std::string& out, const char* name, const char* type, const char* help);
+
+// One sample line; `labels` like result="ok" or null
+void promSample(std::string& out, const char* name, const char* labels, uint64_t value);
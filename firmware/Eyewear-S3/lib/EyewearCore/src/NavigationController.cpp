@@ -0,0 +1,21 @@
+#include "NavigationController.h"
+#include "StateFrames.h"
+
+bool NavigationController::step(uint32_t now, hal::Tof* tof, bool paused, uint8_t tableVersion,
+                                StateFrame& frame) {
+  if (tof) tracker.poll(now, *tof);
+  tracker.update(now);
+
+  bool sendNow = classifier.update(tracker.distance());
+  if (!sendNow && sentOnce && now - lastSend < SEND_INTERVAL) return false;
+
+  if (paused) {
+    frame = makePauseFrame(tableVersion);
+  } else {
+    frame = makeStateFrame(tableVersion, classifier.stablePattern(),
+                           tracker.distance(), tracker.closingSpeed());
+  }
+  lastSend = now;
+  sentOnce = true;
+  return true;
+}
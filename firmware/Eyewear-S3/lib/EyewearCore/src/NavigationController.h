@@ -0,0 +1,44 @@
+/*
+ * ============================================
+ * VisionAssist - Eyewear Navigation Path
+ * ============================================
+ *
+ * The obstacle part of the eyewear loop(): poll the TOF,
+ * classify the zone and decide when a state frame goes
+ * out (zone change or every SEND_INTERVAL). Sending is
+ * left to the caller so the firmware and the host
+ * simulators share this logic.
+ * ============================================
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <Hal.h>
+#include <VisionAssistProtocol.h>
+#include "DistanceTracker.h"
+#include "ZoneClassifier.h"
+
+class NavigationController {
+public:
+  static const uint32_t SEND_INTERVAL = 50;
+
+  void reset(uint32_t now) { tracker.reset(now); }
+
+  // One loop() pass. `tof` may be null while the sensor is down.
+  // Returns true and fills `frame` when a frame is due; a pause
+  // frame replaces the state frame while `paused`.
+  bool step(uint32_t now, hal::Tof* tof, bool paused, uint8_t tableVersion, StateFrame& frame);
+
+  int distance() const { return tracker.distance(); }
+  float closingSpeed() const { return tracker.closingSpeed(); }
+  int stablePattern() const { return classifier.stablePattern(); }
+  const ZoneClassifier& zones() const { return classifier; }
+  const DistanceTracker& distanceTracker() const { return tracker; }
+
+private:
+  DistanceTracker tracker;
+  ZoneClassifier classifier;
+  uint32_t lastSend = 0;
+  bool sentOnce = false;
+};
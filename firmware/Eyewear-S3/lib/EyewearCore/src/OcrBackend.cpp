@@ -0,0 +1,131 @@
+#include "OcrBackend.h"
+
+#include <stdio.h>
+#include <string.h>
+
+// Reports the end of the body once the request is cancelled. Checked
+// every CHECK_EVERY bytes: cancelled() reads the clock.
+class CancellableStream : public hal::ByteStream {
+public:
+  static const uint32_t CHECK_EVERY = 256;
+
+  CancellableStream(hal::ByteStream& inner, OcrCancel* cancel) : inner(inner), cancel(cancel) {}
+
+  int available() override {
+    if (stopped) return 0;
+    if (cancel && ++calls % CHECK_EVERY == 0 && cancel->cancelled()) {
+      stopped = true;
+      return 0;
+    }
+    return inner.available();
+  }
+  int read() override { return stopped ? -1 : inner.read(); }
+  bool wasStopped() const { return stopped; }
+
+private:
+  hal::ByteStream& inner;
+  OcrCancel* cancel;
+  uint32_t calls = 0;
+  bool stopped = false;
+};
+
+// Times and counts the body read by `parse`, then releases the connection:
+// dropped rather than kept alive if the read was cut short
+template <typename Parse>
+static void readBody(hal::Clock& clock, hal::Http& http, OcrCancel* cancel, OcrTiming& timing,
+                     Parse parse) {
+  uint32_t started = clock.millis();
+  CancellableStream stream(*http.responseStream(), cancel);
+  hal::CountingStream body(stream);
+  parse(body);
+  timing.downloadMs = clock.millis() - started;
+  timing.responseBytes = body.bytes();
+  if (stream.wasStopped()) http.abort();
+  else http.end();
+}
+
+// ===========================================
+// VisionBackend
+// ===========================================
+const char VisionBackend::DEFAULT_ENDPOINT[] = "https://vision.googleapis.com/v1/images:annotate";
+
+VisionBackend::VisionBackend(hal::Clock& clock, hal::Http& http, const char* apiKey, const char* endpoint)
+  : OcrBackend(clock, http), keyLength(strlen(apiKey)) {
+  url = endpoint;
+  url += "?key=";
+  url += apiKey;
+  url += "&fields=";
+  url += VISION_FIELD_MASK;
+}
+
+int VisionBackend::recognize(const hal::Frame& frame, OcrFeature feature, ArenaString& text,
+                             OcrTextSink* sink, OcrCancel* cancel, OcrTiming& timing) {
+  uint32_t started = clock.millis();
+  ArenaString json(text.get_allocator());
+  buildVisionRequest(frame.buf, frame.len, json, feature);
+  timing.encodeMs = clock.millis() - started;
+  timing.requestBytes = json.length();
+
+  started = clock.millis();
+  int code = http.post(url.c_str(), "application/json", (const uint8_t*)json.data(), json.length());
+  timing.httpMs = clock.millis() - started;
+
+  if (code != 200) {
+    http.end();
+    return code;
+  }
+  readBody(clock, http, cancel, timing, [&](hal::ByteStream& body) {
+    extractTextFromResponse(body, text, sink);
+  });
+  return code;
+}
+
+int VisionBackend::recognizeBatch(const ArenaString& request, uint8_t count, ArenaString* texts,
+                                  OcrCancel* cancel, OcrTiming& timing) {
+  timing.requestBytes = request.length();
+  uint32_t started = clock.millis();
+  int code = http.post(url.c_str(), "application/json", (const uint8_t*)request.data(), request.length());
+  timing.httpMs = clock.millis() - started;
+
+  if (code != 200) {
+    http.end();
+    return code;
+  }
+  readBody(clock, http, cancel, timing, [&](hal::ByteStream& body) {
+    extractBatchTexts(body, texts, count);
+  });
+  return code;
+}
+
+// ===========================================
+// GatewayBackend
+// ===========================================
+GatewayBackend::GatewayBackend(hal::Clock& clock, hal::Http& http, const char* baseUrl)
+  : OcrBackend(clock, http) {
+  url[0] = '\0';
+  if (strncmp(baseUrl, "http://", 7) == 0 && strlen(baseUrl) < MAX_URL) {
+    strcpy(url, baseUrl);
+  }
+}
+
+int GatewayBackend::recognize(const hal::Frame& frame, OcrFeature feature, ArenaString& text,
+                              OcrTextSink* sink, OcrCancel* cancel, OcrTiming& timing) {
+  char request[MAX_URL + 20];   // + "?feature=document"
+  snprintf(request, sizeof(request), "%s%cfeature=%s", url, strchr(url, '?') ? '&' : '?',
+           feature == FEATURE_TEXT ? "text" : "document");
+  timing.requestBytes = frame.len;
+
+  uint32_t started = clock.millis();
+  int code = http.post(request, "image/jpeg", frame.buf, frame.len);
+  timing.httpMs = clock.millis() - started;
+
+  if (code != 200) {
+    http.end();
+    return code;
+  }
+  int length = http.responseSize();
+  readBody(clock, http, cancel, timing, [&](hal::ByteStream& body) {
+    readPlainText(body, length, text, sink);
+  });
+  return code;
+}
@@ -0,0 +1,114 @@
+/*
+ * ============================================
+ * VisionAssist - OCR Backends
+ * ============================================
+ *
+ * One JPEG in, text out, behind a common interface:
+ *   vision   - Google Cloud Vision straight from the eyewear:
+ *              base64 JSON over TLS, a new connection per
+ *              request, JSON reply parsed as it streams
+ *   gateway  - the raw JPEG POSTed to a gateway on the LAN
+ *              over plain HTTP with keep-alive; the gateway
+ *              runs the cloud or local OCR and replies with
+ *              text/plain (Host-Tools/ocr_gateway)
+ *
+ * The gateway skips the base64 step (a third less upload),
+ * the TLS handshake and the JSON parse on the ESP32.
+ *
+ * Vision also takes a burst: several frames in one request
+ * over one connection, a text back for each (see
+ * OcrConsensus.h for picking one).
+ * ============================================
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <Hal.h>
+#include "Arena.h"
+#include "OcrText.h"
+
+// Filled in by recognize() for /metrics and the trace
+struct OcrTiming {
+  uint32_t encodeMs = 0;     // request body built
+  uint32_t httpMs = 0;       // request sent, response headers in
+  uint32_t downloadMs = 0;   // response body read
+  size_t requestBytes = 0;
+  size_t responseBytes = 0;
+};
+
+// Polled while a response downloads; true stops reading it
+class OcrCancel {
+public:
+  virtual ~OcrCancel() {}
+  virtual bool cancelled() = 0;
+};
+
+class OcrBackend {
+public:
+  OcrBackend(hal::Clock& clock, hal::Http& http) : clock(clock), http(http) {}
+  virtual ~OcrBackend() {}
+  virtual const char* name() const = 0;
+
+  // Per-request HTTP timeout, e.g. what is left of a deadline
+  void setTimeout(uint32_t ms) { http.setTimeout(ms); }
+
+  // Text of one frame appended to `text` (empty = nothing found);
+  // `sink` (optional) gets it sentence by sentence as it arrives.
+  // `cancel` (optional) cuts the download short; the text is then partial.
+  // Returns the HTTP status (200 = ok) or a negative transport error.
+  virtual int recognize(const hal::Frame& frame, OcrFeature feature, ArenaString& text,
+                        OcrTextSink* sink, OcrCancel* cancel, OcrTiming& timing) = 0;
+
+protected:
+  hal::Clock& clock;
+  hal::Http& http;
+};
+
+class VisionBackend : public OcrBackend {
+public:
+  static const char DEFAULT_ENDPOINT[];
+
+  // `endpoint`: images:annotate URL without the query (a stand-in
+  // server for host benchmarks)
+  VisionBackend(hal::Clock& clock, hal::Http& http, const char* apiKey,
+                const char* endpoint = DEFAULT_ENDPOINT);
+
+  const char* name() const override { return "vision"; }
+  int recognize(const hal::Frame& frame, OcrFeature feature, ArenaString& text,
+                OcrTextSink* sink, OcrCancel* cancel, OcrTiming& timing) override;
+
+  // A burst body built with beginVisionBatch() etc. (OcrText.h) holding
+  // `count` frames; texts[i] gets frame i's text, read in one pass
+  int recognizeBatch(const ArenaString& request, uint8_t count, ArenaString* texts,
+                     OcrCancel* cancel, OcrTiming& timing);
+
+  // A real key is longer than this
+  bool configured() const { return keyLength >= 10; }
+
+private:
+  std::string url;
+  size_t keyLength;
+};
+
+// Request: POST <url>?feature=text|document, Content-Type image/jpeg
+// Reply:   200, text/plain; charset=utf-8, Content-Length set
+class GatewayBackend : public OcrBackend {
+public:
+  static const size_t MAX_URL = 96;
+
+  GatewayBackend(hal::Clock& clock, hal::Http& http, const char* url);
+
+  const char* name() const override { return "gateway"; }
+  int recognize(const hal::Frame& frame, OcrFeature feature, ArenaString& text,
+                OcrTextSink* sink, OcrCancel* cancel, OcrTiming& timing) override;
+
+  // An http:// URL that fits MAX_URL
+  bool configured() const { return url[0] != '\0'; }
+  const char* baseUrl() const { return url; }
+
+private:
+  char url[MAX_URL];
+};
@@ -0,0 +1,106 @@
+#include "OcrChunks.h"
+#include "WebJson.h"
+
+#include <stdio.h>
+
+static bool isSpace(char ch) {
+  return ch == ' ' || ch == '\n' || ch == '\t';
+}
+
+static bool isWordChar(char ch) {
+  return (ch >= '0' && ch <= '9') || (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') ||
+         (uint8_t)ch >= 0x80;   // UTF-8 letters
+}
+
+// ===========================================
+// SentenceChunker
+// ===========================================
+void SentenceChunker::reset() {
+  count = 0;
+  lastSpace = 0;
+  stop = false;
+  hasText = false;
+}
+
+size_t SentenceChunker::push(char ch) {
+  count++;
+  bool space = isSpace(ch);
+  size_t cut = 0;
+
+  if (hasText && (ch == '\n' || (stop && space))) {
+    cut = count;
+  } else if (count >= MAX_CHUNK && (lastSpace > 0 || (uint8_t)ch < 0x80)) {
+    // Long run without a sentence end: break between words if we can,
+    // never inside a UTF-8 sequence
+    cut = lastSpace > 0 ? lastSpace : count;
+  }
+
+  // Closing quotes / brackets keep a sentence end pending: `"Exit." `
+  if (ch == '.' || ch == '!' || ch == '?') stop = true;
+  else if (!(stop && (ch == '"' || ch == '\'' || ch == ')'))) stop = false;
+  if (space) lastSpace = count;
+  if (isWordChar(ch)) hasText = true;
+
+  if (cut) {
+    count -= cut;
+    lastSpace = lastSpace > cut ? lastSpace - cut : 0;
+    hasText = count > 0;   // the rest of a word split at MAX_CHUNK
+  }
+  return cut;
+}
+
+// ===========================================
+// OcrChunkLog
+// ===========================================
+void OcrChunkLog::begin(uint32_t run) {
+  all.clear();
+  chunkCount = 0;
+  runId = run;
+  finished = false;
+}
+
+void OcrChunkLog::add(const char* text, size_t len) {
+  if (finished) return;
+  size_t start = chunkCount ? ends[chunkCount - 1] : 0;
+  all.append(text, len);
+
+  // Keep the last slot for whatever is left at finish()
+  if (chunkCount >= MAX_CHUNKS - 1 || all.size() > UINT16_MAX) return;
+  for (size_t i = start; i < all.size(); i++) {
+    if (isWordChar(all[i])) {
+      ends[chunkCount++] = (uint16_t)all.size();
+      return;
+    }
+  }
+}
+
+void OcrChunkLog::finish() {
+  if (finished) return;
+  finished = true;
+  size_t end = all.size() > UINT16_MAX ? UINT16_MAX : all.size();
+  size_t start = chunkCount ? ends[chunkCount - 1] : 0;
+  if (end <= start) return;
+
+  bool hasText = false;
+  for (size_t i = start; i < end && !hasText; i++) hasText = isWordChar(all[i]);
+
+  if (hasText && chunkCount < MAX_CHUNKS) ends[chunkCount++] = (uint16_t)end;
+  else if (chunkCount > 0 && !hasText) ends[chunkCount - 1] = (uint16_t)end;
+}
+
+void OcrChunkLog::appendJson(std::string& out, uint8_t since) const {
+  char num[48];
+  snprintf(num, sizeof(num), "\"run\":%u,\"done\":%s,\"next\":%u,\"chunks\":[",
+           (unsigned)runId, finished ? "true" : "false", (unsigned)chunkCount);
+  out += num;
+
+  for (uint8_t i = since; i < chunkCount; i++) {
+    size_t start = i ? ends[i - 1] : 0;
+    if (i > since) out += ',';
+    snprintf(num, sizeof(num), "{\"seq\":%u,\"text\":\"", (unsigned)i);
+    out += num;
+    out += escapeJson(all.substr(start, ends[i] - start));
+    out += "\"}";
+  }
+  out += ']';
+}
@@ -0,0 +1,73 @@
+/*
+ * ============================================
+ * VisionAssist - Progressive OCR Text
+ * ============================================
+ *
+ * Splits OCR text into speakable chunks while the Vision
+ * response is still streaming in, so the phone can start
+ * speaking the first sentence before the last one arrives.
+ *
+ * A chunk ends at a line break (signs and labels are line
+ * based), after . ! ? followed by whitespace, or at the
+ * last space before MAX_CHUNK characters.
+ *
+ * OcrChunkLog keeps one run's text with its chunk
+ * boundaries; /ocr_status hands out chunks by sequence
+ * number so the UI can queue them as they arrive.
+ * ============================================
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+class SentenceChunker {
+public:
+  static const size_t MAX_CHUNK = 160;
+
+  void reset();
+
+  // Feed the next character; returns how many pending characters
+  // now form a complete chunk (0 = not yet)
+  size_t push(char ch);
+
+  size_t pending() const { return count; }
+
+private:
+  size_t count = 0;       // characters since the last cut
+  size_t lastSpace = 0;   // pending length just after the last space, 0 = none
+  bool stop = false;      // previous character ended a sentence
+  bool hasText = false;   // pending characters include a letter or digit
+};
+
+class OcrChunkLog {
+public:
+  static const uint8_t MAX_CHUNKS = 48;
+
+  // Start a new run; drops the previous run's text
+  void begin(uint32_t run);
+
+  // Append streamed text; whitespace-only pieces join the next chunk
+  void add(const char* text, size_t len);
+
+  // No more text this run
+  void finish();
+
+  uint32_t run() const { return runId; }
+  uint8_t count() const { return chunkCount; }
+  bool done() const { return finished; }
+  const std::string& text() const { return all; }
+
+  // "run":R,"done":b,"next":N,"chunks":[{"seq":S,"text":"..."},...]
+  // with the chunks from `since` on (no braces, for /ocr_status)
+  void appendJson(std::string& out, uint8_t since) const;
+
+private:
+  std::string all;
+  uint16_t ends[MAX_CHUNKS];
+  uint8_t chunkCount = 0;
+  uint32_t runId = 0;
+  bool finished = true;
+};
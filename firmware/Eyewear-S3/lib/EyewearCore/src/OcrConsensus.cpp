@@ -0,0 +1,69 @@
+#include "OcrConsensus.h"
+#include "OcrText.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+// Hashes of the text's words, lower-cased, sorted
+static void wordHashes(const OcrCandidate& c, std::vector<uint32_t>& out) {
+  out.clear();
+  uint32_t h = 2166136261u;
+  size_t n = 0;
+  for (size_t i = 0; i <= c.len; i++) {
+    char ch = i < c.len ? c.text[i] : ' ';
+    bool word = (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') || (ch >= '0' && ch <= '9') ||
+                (uint8_t)ch >= 0x80;
+    if (word) {
+      if (ch >= 'A' && ch <= 'Z') ch += 'a' - 'A';
+      h = (h ^ (uint8_t)ch) * 16777619u;
+      n++;
+      continue;
+    }
+    if (n >= CONSENSUS_MIN_WORD) out.push_back(h);
+    h = 2166136261u;
+    n = 0;
+  }
+  std::sort(out.begin(), out.end());
+}
+
+// Words in both (each word of `b` matched once)
+static uint16_t shared(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b) {
+  uint16_t n = 0;
+  size_t i = 0, j = 0;
+  while (i < a.size() && j < b.size()) {
+    if (a[i] < b[j]) i++;
+    else if (b[j] < a[i]) j++;
+    else {
+      n++;
+      i++;
+      j++;
+    }
+  }
+  return n;
+}
+
+uint8_t pickConsensusText(const OcrCandidate* texts, uint8_t count, uint16_t* agreement) {
+  std::vector<std::vector<uint32_t> > words(count);
+  std::vector<bool> useful(count);
+  for (uint8_t i = 0; i < count; i++) {
+    useful[i] = isUsefulOcrText(std::string(texts[i].text, texts[i].len));
+    if (useful[i]) wordHashes(texts[i], words[i]);
+  }
+
+  uint8_t best = count;
+  uint32_t bestScore = 0;
+  for (uint8_t i = 0; i < count; i++) {
+    if (!useful[i]) continue;
+    uint32_t score = 0;
+    for (uint8_t j = 0; j < count; j++) {
+      if (j != i && useful[j]) score += shared(words[i], words[j]);
+    }
+    if (best == count || score > bestScore || (score == bestScore && texts[i].len > texts[best].len)) {
+      best = i;
+      bestScore = score;
+    }
+  }
+  if (agreement) *agreement = best < count ? (uint16_t)std::min<uint32_t>(bestScore, 0xFFFF) : 0;
+  return best;
+}
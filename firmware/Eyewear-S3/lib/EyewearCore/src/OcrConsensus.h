@@ -0,0 +1,34 @@
+/*
+ * ============================================
+ * VisionAssist - Burst Text Consensus
+ * ============================================
+ *
+ * Picks one text out of a burst: the OCR of two or three
+ * frames of the same scene, taken back to back. Motion
+ * blur or a glare spot usually spoils one frame, not all
+ * of them, and what the good frames read mostly agrees.
+ *
+ * Each useful text (isUsefulOcrText) scores the words it
+ * shares with the others; the best-supported one wins, the
+ * longer one on a tie. With two frames that is simply the
+ * longer text, with three an outlier loses to the pair
+ * that agrees.
+ * ============================================
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Words of at least this many letters / digits count
+#define CONSENSUS_MIN_WORD 2
+
+struct OcrCandidate {
+  const char* text;
+  size_t len;
+};
+
+// Index of the chosen text; `count` if none is useful.
+// `agreement` (optional): words it shares with the other frames.
+uint8_t pickConsensusText(const OcrCandidate* texts, uint8_t count, uint16_t* agreement = nullptr);
@@ -0,0 +1,130 @@
+#include "OcrHistory.h"
+
+#include <string.h>
+
+static const uint8_t SAVE_VERSION = 1;
+static const size_t PREFIX = 2;   // uint16_t text length
+
+uint32_t ocrImageHash(const uint8_t* data, size_t len) {
+  uint32_t h = 2166136261u;
+  for (size_t i = 0; i < len; i++) {
+    h ^= data[i];
+    h *= 16777619u;
+  }
+  return h;
+}
+
+void OcrHistory::attach(void* buf, size_t bytes) {
+  uint32_t n = buf ? bytes / BYTES_PER_SLOT : 0;
+  index = (Entry*)buf;
+  log = (uint8_t*)buf + n * sizeof(Entry);
+  slots = n;
+  logSize = n ? bytes - n * sizeof(Entry) : 0;
+  writePos = 0;
+  first = next = 1;
+}
+
+uint16_t OcrHistory::lengthAt(uint32_t offset) const {
+  uint16_t len;
+  memcpy(&len, log + offset, sizeof(len));
+  return len;
+}
+
+void OcrHistory::dropOldest() {
+  first++;
+  if (first == next) writePos = 0;   // empty: start the log over
+}
+
+uint32_t OcrHistory::add(uint32_t now, uint32_t imageHash, const char* text, size_t len) {
+  if (!enabled() || len == 0) return 0;
+  size_t max = logSize - PREFIX < 0xFFFF ? logSize - PREFIX : 0xFFFF;
+  if (len > max) len = max;
+  uint32_t need = PREFIX + len;
+
+  if (count() == slots) dropOldest();
+
+  // Entries lie in the log oldest first from the write position on
+  // (wrapping), so dropping from the oldest frees the bytes about to be
+  // written. Wrapping early drops the entries left past the old position.
+  if (writePos + need > logSize) {
+    while (first != next && index[first % slots].offset >= writePos) dropOldest();
+    writePos = 0;
+  }
+  while (first != next) {
+    const Entry& old = index[first % slots];
+    uint32_t end = old.offset + PREFIX + lengthAt(old.offset);
+    if (old.offset >= writePos + need || end <= writePos) break;
+    dropOldest();
+  }
+
+  uint16_t n = (uint16_t)len;
+  memcpy(log + writePos, &n, sizeof(n));
+  memcpy(log + writePos + PREFIX, text, len);
+
+  Entry& e = index[next % slots];
+  e.id = next;
+  e.ms = now;
+  e.imageHash = imageHash;
+  e.offset = writePos;
+  writePos += need;
+  return next++;
+}
+
+bool OcrHistory::get(uint32_t id, Entry& e, const char*& text, uint16_t& len) const {
+  if (!enabled() || id < first || id >= next) return false;
+  e = index[id % slots];
+  len = lengthAt(e.offset);
+  text = (const char*)log + e.offset + PREFIX;
+  return true;
+}
+
+// Blob: version, count, then per entry (oldest first) hash, length, text
+size_t OcrHistory::save(uint8_t* out, size_t cap) const {
+  if (cap < 2) return 0;
+  size_t used = 2;
+  uint32_t from = next;
+  while (from > first && next - from < 255) {
+    const Entry& e = index[(from - 1) % slots];
+    size_t bytes = sizeof(e.imageHash) + PREFIX + lengthAt(e.offset);
+    if (used + bytes > cap) break;
+    used += bytes;
+    from--;
+  }
+
+  uint8_t* p = out;
+  *p++ = SAVE_VERSION;
+  *p++ = (uint8_t)(next - from);
+  for (uint32_t id = from; id < next; id++) {
+    const Entry& e = index[id % slots];
+    uint16_t len = lengthAt(e.offset);
+    memcpy(p, &e.imageHash, sizeof(e.imageHash));
+    p += sizeof(e.imageHash);
+    memcpy(p, log + e.offset, PREFIX + len);
+    p += PREFIX + len;
+  }
+  return used;
+}
+
+bool OcrHistory::load(const uint8_t* in, size_t len) {
+  if (len < 2 || in[0] != SAVE_VERSION) return false;
+  const uint8_t* end = in + len;
+
+  // Walk the blob once to check it, then again to add: a cut or
+  // corrupt blob restores nothing rather than its first entries
+  for (int pass = 0; pass < 2; pass++) {
+    const uint8_t* p = in + 2;
+    for (uint8_t i = 0; i < in[1]; i++) {
+      uint32_t hash;
+      uint16_t n;
+      if (end - p < (ptrdiff_t)(sizeof(hash) + PREFIX)) return false;
+      memcpy(&hash, p, sizeof(hash));
+      memcpy(&n, p + sizeof(hash), PREFIX);
+      p += sizeof(hash) + PREFIX;
+      if (end - p < n) return false;
+      if (pass) add(0, hash, (const char*)p, n);
+      p += n;
+    }
+    if (p != end) return false;
+  }
+  return true;
+}
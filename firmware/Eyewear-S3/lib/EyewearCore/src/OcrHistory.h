@@ -0,0 +1,76 @@
+/*
+ * ============================================
+ * VisionAssist - OCR History
+ * ============================================
+ *
+ * The last OCR results, so a reading can be repeated
+ * without another capture and cloud call.
+ *
+ * One buffer (PSRAM on the eyewear) holds a fixed index
+ * of slots followed by a byte log. Each text is appended
+ * to the log length-prefixed; the log wraps to its start
+ * when the next text doesn't fit before the end, and the
+ * oldest entries whose bytes it covers are dropped. Ids
+ * count up from 1 and an id's slot is id % slots, so
+ * looking one up costs the same however much is held.
+ *
+ * save() / load() copy the newest entries that fit in a
+ * small blob (NVS), so they survive a reboot; restored
+ * entries have no time.
+ * ============================================
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// FNV-1a over the JPEG, to tell repeated shots of the same scene apart
+uint32_t ocrImageHash(const uint8_t* data, size_t len);
+
+class OcrHistory {
+public:
+  static const size_t BYTES_PER_SLOT = 256;   // index slot per this much buffer
+
+  struct Entry {
+    uint32_t id;
+    uint32_t ms;          // millis() when read; 0 = before this boot
+    uint32_t imageHash;
+    uint32_t offset;      // of the length prefix in the log
+  };
+
+  // Keep the history in `buf`; no buffer = off
+  void attach(void* buf, size_t bytes);
+  bool enabled() const { return slots > 0; }
+
+  // Returns the new entry's id (0 = off, or empty text). Texts
+  // longer than the log are cut.
+  uint32_t add(uint32_t now, uint32_t imageHash, const char* text, size_t len);
+
+  // Ids held are [firstId(), nextId())
+  uint32_t firstId() const { return first; }
+  uint32_t nextId() const { return next; }
+  uint32_t count() const { return next - first; }
+  size_t logBytes() const { return logSize; }
+
+  // Entry `id` and its text (not terminated) if still held
+  bool get(uint32_t id, Entry& e, const char*& text, uint16_t& len) const;
+
+  // Newest entries that fit in `cap` bytes; returns bytes used
+  size_t save(uint8_t* out, size_t cap) const;
+  // Adds the entries of a save() blob after any live ones; a cut or
+  // corrupt blob adds nothing and returns false
+  bool load(const uint8_t* in, size_t len);
+
+private:
+  uint16_t lengthAt(uint32_t offset) const;
+  void dropOldest();
+
+  Entry* index = nullptr;
+  uint8_t* log = nullptr;
+  uint32_t slots = 0;
+  uint32_t logSize = 0;
+  uint32_t writePos = 0;
+  uint32_t first = 1;
+  uint32_t next = 1;
+};
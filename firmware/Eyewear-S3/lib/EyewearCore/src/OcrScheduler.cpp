@@ -0,0 +1,83 @@
+#include "OcrScheduler.h"
+
+// ===========================================
+// Requests
+// ===========================================
+OcrRequest OcrScheduler::submit(uint8_t source, uint32_t budgetMs) {
+  OcrRequest req;
+  req.id = ++nextId;
+  req.source = source;
+  req.deadline = clock.millis() + budgetMs;
+  latest = req.id;
+  return req;
+}
+
+void OcrScheduler::begin(const OcrRequest& req) {
+  // Ids skipped since the last run were overwritten in the queue
+  if (lastTaken && req.id > lastTaken + 1) outcomeCount[OCR_CANCELLED].inc(req.id - lastTaken - 1);
+  lastTaken = req.id;
+  runningDeadline = req.deadline;
+  runningId = req.id;
+}
+
+void OcrScheduler::finish(OcrOutcome outcome) {
+  runningId = 0;
+  outcomeCount[outcome].inc();
+}
+
+uint32_t OcrScheduler::remaining(const OcrRequest& req) const {
+  int32_t left = (int32_t)(req.deadline - clock.millis());
+  return left > 0 ? (uint32_t)left : 0;
+}
+
+bool OcrScheduler::abandon(uint32_t id) {
+  return latest.compare_exchange_strong(id, 0);
+}
+
+bool OcrScheduler::abandonRunning() {
+  uint32_t id = runningId;
+  return id && abandon(id);
+}
+
+bool OcrScheduler::abandonLate() {
+  uint32_t id = runningId;
+  if (!id || !isCurrent(id)) return false;
+  if ((int32_t)(clock.millis() - runningDeadline.load()) < 0) return false;
+  return abandon(id);
+}
+
+// ===========================================
+// Retries
+// ===========================================
+bool OcrScheduler::transient(int code) {
+  // Negative = connect / send / read failure in the HTTP client
+  return code < 0 || code == 408 || code == 429 || (code >= 500 && code <= 599);
+}
+
+bool OcrScheduler::retryAfter(const OcrRequest& req, int code, uint8_t attempt, uint32_t& waitMs) {
+  if (attempt + 1 >= OCR_MAX_ATTEMPTS || !transient(code)) return false;
+
+  uint32_t base = (uint32_t)OCR_BACKOFF_MS << attempt;
+  jitter ^= jitter << 13;
+  jitter ^= jitter >> 17;
+  jitter ^= jitter << 5;
+  waitMs = base - base / 4 + jitter % (base / 2 + 1);
+
+  if (!isCurrent(req.id) || remaining(req) < waitMs + OCR_MIN_ATTEMPT_MS) return false;
+  retryCount.inc();
+  return true;
+}
+
+// ===========================================
+// OcrTicket
+// ===========================================
+bool OcrTicket::wait(hal::Clock& clock, uint32_t ms) {
+  const uint32_t STEP = 20;
+  uint32_t start = clock.millis();
+  while (clock.millis() - start < ms) {
+    if (cancelled()) return false;
+    uint32_t left = ms - (clock.millis() - start);
+    clock.delay(left < STEP ? left : STEP);
+  }
+  return !cancelled();
+}
@@ -0,0 +1,115 @@
+/*
+ * ============================================
+ * VisionAssist - OCR Scheduler
+ * ============================================
+ *
+ * Every OCR request gets an id and a deadline. The newest
+ * request wins: submitting one cancels whatever is queued
+ * or running, and a run that misses its deadline is
+ * abandoned. The OCR task checks its OcrTicket between
+ * stages and while the response downloads, and gives up as
+ * soon as it is cancelled.
+ *
+ * Transient failures (transport errors, 408 / 429 / 5xx)
+ * are retried with jittered exponential backoff, but only
+ * while enough of the deadline is left for another try.
+ *
+ * Ids and state are atomics: requests come from loop() and
+ * the web task, the OCR task runs them.
+ * ============================================
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <Hal.h>
+#include "Metrics.h"
+#include "OcrBackend.h"
+
+#define OCR_MAX_ATTEMPTS 3
+#define OCR_BACKOFF_MS 300         // first retry; doubles per attempt, +-25% jitter
+#define OCR_MIN_ATTEMPT_MS 2000    // no retry with less of the deadline left
+
+struct OcrRequest {
+  uint32_t id = 0;
+  uint8_t source = 0;      // caller's tag (touch / web)
+  uint32_t deadline = 0;   // millis()
+};
+
+enum OcrOutcome : uint8_t {
+  OCR_COMPLETED,         // text, or "No text detected"
+  OCR_FAILED,            // capture failed, or errors after every retry
+  OCR_CANCELLED,         // superseded by a newer request
+  OCR_DEADLINE_MISSED,   // abandoned at its deadline
+  OCR_OUTCOMES
+};
+
+class OcrScheduler {
+public:
+  explicit OcrScheduler(hal::Clock& clock) : clock(clock) {}
+
+  // Any task: a new request `budgetMs` from now; cancels the previous one
+  OcrRequest submit(uint8_t source, uint32_t budgetMs);
+
+  // OCR task, around each run. begin() counts the requests that were
+  // replaced while still queued; finish() records the outcome.
+  void begin(const OcrRequest& req);
+  void finish(OcrOutcome outcome);
+
+  // The OCR task is working on a request
+  bool busy() const { return runningId.load() != 0; }
+
+  // The newest request, not cancelled; false also once abandoned
+  bool isCurrent(uint32_t id) const { return latest.load() == id; }
+  bool expired(const OcrRequest& req) const { return (int32_t)(clock.millis() - req.deadline) >= 0; }
+  uint32_t remaining(const OcrRequest& req) const;
+
+  // Cancel `id` if it is still current; true for the one caller that did.
+  // abandonRunning() does it for the running request (user stop),
+  // abandonLate() only once that request is past its deadline.
+  bool abandon(uint32_t id);
+  bool abandonRunning();
+  bool abandonLate();
+
+  // Why a run stopped early: its deadline passed, or a newer request came in
+  OcrOutcome abandonedOutcome(const OcrRequest& req) const {
+    return expired(req) ? OCR_DEADLINE_MISSED : OCR_CANCELLED;
+  }
+
+  // After attempt `attempt` (0-based) ended with HTTP `code`: true and the
+  // wait before the next try if the failure is transient and time is left
+  bool retryAfter(const OcrRequest& req, int code, uint8_t attempt, uint32_t& waitMs);
+  static bool transient(int code);
+
+  uint32_t outcomes(OcrOutcome outcome) const { return outcomeCount[outcome].value(); }
+  uint32_t retries() const { return retryCount.value(); }
+
+private:
+  hal::Clock& clock;
+  std::atomic<uint32_t> nextId{0};
+  std::atomic<uint32_t> latest{0};      // 0 = none current
+  std::atomic<uint32_t> runningId{0};   // OCR task's request, 0 = idle
+  std::atomic<uint32_t> runningDeadline{0};
+  uint32_t lastTaken = 0;               // OCR task only
+  uint32_t jitter = 0x9E3779B9;         // OCR task only
+  Counter outcomeCount[OCR_OUTCOMES];
+  Counter retryCount;
+};
+
+// One run's view of its request: cancelled once it is no longer current
+// or past its deadline. Polled by the backends while the body downloads.
+class OcrTicket : public OcrCancel {
+public:
+  OcrTicket(OcrScheduler& scheduler, const OcrRequest& req) : scheduler(scheduler), req(req) {}
+
+  bool cancelled() override { return !scheduler.isCurrent(req.id) || scheduler.expired(req); }
+
+  // Sleep up to `ms`, waking early on cancellation; false if cancelled
+  bool wait(hal::Clock& clock, uint32_t ms);
+
+private:
+  OcrScheduler& scheduler;
+  OcrRequest req;
+};
@@ -0,0 +1,356 @@
+#include "OcrText.h"
+#include "OcrChunks.h"
+
+#include <string.h>
+
+static const char B64_ALPHABET[] =
+  "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// Shared by the std::string and ArenaString entry points
+template <typename Str>
+static void appendBase64(const uint8_t* data, size_t len, Str& out) {
+  out.reserve(out.size() + (len + 2) / 3 * 4);
+
+  size_t i = 0;
+  for (; i + 2 < len; i += 3) {
+    uint32_t v = (data[i] << 16) | (data[i + 1] << 8) | data[i + 2];
+    out += B64_ALPHABET[(v >> 18) & 0x3F];
+    out += B64_ALPHABET[(v >> 12) & 0x3F];
+    out += B64_ALPHABET[(v >> 6) & 0x3F];
+    out += B64_ALPHABET[v & 0x3F];
+  }
+
+  if (i < len) {
+    uint32_t v = data[i] << 16;
+    if (i + 1 < len) v |= data[i + 1] << 8;
+    out += B64_ALPHABET[(v >> 18) & 0x3F];
+    out += B64_ALPHABET[(v >> 12) & 0x3F];
+    out += (i + 1 < len) ? B64_ALPHABET[(v >> 6) & 0x3F] : '=';
+    out += '=';
+  }
+}
+
+void base64Encode(const uint8_t* data, size_t len, std::string& out) {
+  appendBase64(data, len, out);
+}
+
+const char VISION_FIELD_MASK[] = "responses(fullTextAnnotation/text,error/message)";
+
+OcrFeature chooseOcrFeature(OcrMode mode, size_t jpegLen, uint16_t width, uint16_t height,
+                            size_t lastTextLen) {
+  if (mode == OCR_MODE_SIGN) return FEATURE_TEXT;
+  if (mode == OCR_MODE_PAGE) return FEATURE_DOCUMENT;
+
+  if (lastTextLen >= OCR_PAGE_TEXT_CHARS) return FEATURE_DOCUMENT;
+  uint32_t kpx = (uint32_t)width * height / 1000;
+  if (kpx == 0) return FEATURE_DOCUMENT;
+  return jpegLen / kpx >= OCR_PAGE_BYTES_PER_KPX ? FEATURE_DOCUMENT : FEATURE_TEXT;
+}
+
+const char* ocrFeatureName(OcrFeature feature) {
+  return feature == FEATURE_TEXT ? "TEXT_DETECTION" : "DOCUMENT_TEXT_DETECTION";
+}
+
+const char* ocrModeName(OcrMode mode) {
+  switch (mode) {
+    case OCR_MODE_SIGN: return "sign";
+    case OCR_MODE_PAGE: return "page";
+    default: return "auto";
+  }
+}
+
+bool parseOcrMode(const char* name, OcrMode& mode) {
+  for (uint8_t m = OCR_MODE_AUTO; m <= OCR_MODE_PAGE; m++) {
+    if (strcmp(name, ocrModeName((OcrMode)m)) == 0) {
+      mode = (OcrMode)m;
+      return true;
+    }
+  }
+  return false;
+}
+
+static const char REQUEST_HEAD[] = "{\"requests\":[";
+static const char REQUEST_TAIL[] = "]}";
+static const char IMAGE_HEAD[] = "{\"image\":{\"content\":\"";
+static const char IMAGE_FEATURE[] = "\"},\"features\":[{\"type\":\"";
+static const char IMAGE_TAIL[] = "\",\"maxResults\":1}]}";
+
+// One entry of the "requests" array, without the ',' before it
+static size_t visionImageBytes(size_t jpegLen, OcrFeature feature) {
+  return strlen(IMAGE_HEAD) + (jpegLen + 2) / 3 * 4 + strlen(IMAGE_FEATURE) + strlen(ocrFeatureName(feature)) +
+         strlen(IMAGE_TAIL);
+}
+
+size_t visionBatchBytes(size_t jpegLen, uint8_t frames, OcrFeature feature) {
+  size_t bytes = strlen(REQUEST_HEAD) + strlen(REQUEST_TAIL);
+  if (frames == 0) return bytes;
+  return bytes + visionImageBytes(jpegLen, feature) * frames + (frames - 1);   // ',' between entries
+}
+
+// One entry of the "requests" array, comma-separated from the previous one
+template <typename Str>
+static void appendVisionImage(const uint8_t* jpeg, size_t len, OcrFeature feature, Str& json) {
+  if (json.size() > 0 && json[json.size() - 1] == '}') json += ',';
+  json += IMAGE_HEAD;
+  appendBase64(jpeg, len, json);
+  json += IMAGE_FEATURE;
+  json += ocrFeatureName(feature);
+  json += IMAGE_TAIL;
+}
+
+template <typename Str>
+static void appendVisionRequest(const uint8_t* jpeg, size_t len, OcrFeature feature, Str& json) {
+  json.reserve(json.size() + visionBatchBytes(len, 1, feature));
+  json += REQUEST_HEAD;
+  appendVisionImage(jpeg, len, feature, json);
+  json += REQUEST_TAIL;
+}
+
+std::string buildVisionRequest(const uint8_t* jpeg, size_t len, OcrFeature feature) {
+  std::string json;
+  appendVisionRequest(jpeg, len, feature, json);
+  return json;
+}
+
+void buildVisionRequest(const uint8_t* jpeg, size_t len, ArenaString& out, OcrFeature feature) {
+  appendVisionRequest(jpeg, len, feature, out);
+}
+
+void beginVisionBatch(ArenaString& out, size_t reserve) {
+  out.reserve(out.size() + reserve);
+  out += REQUEST_HEAD;
+}
+
+void addVisionBatchImage(const uint8_t* jpeg, size_t len, OcrFeature feature, ArenaString& out) {
+  appendVisionImage(jpeg, len, feature, out);
+}
+
+void endVisionBatch(ArenaString& out) {
+  out += REQUEST_TAIL;
+}
+
+// Appends decoded text and hands complete sentences to the sink
+template <typename Str>
+class ChunkedText {
+public:
+  ChunkedText(Str& out, OcrTextSink* sink) : out(out), sink(sink), emitted(out.size()) {}
+
+  void put(char ch) {
+    out += ch;
+    if (!sink) return;
+    size_t cut = chunker.push(ch);
+    if (cut) {
+      sink->onChunk(out.data() + emitted, cut);
+      emitted += cut;
+    }
+  }
+
+  // Whatever is left after the last sentence end
+  void flush() {
+    if (sink && out.size() > emitted) {
+      sink->onChunk(out.data() + emitted, out.size() - emitted);
+      emitted = out.size();
+    }
+  }
+
+private:
+  Str& out;
+  OcrTextSink* sink;
+  SentenceChunker chunker;
+  size_t emitted;
+};
+
+void sendTextChunks(const char* text, size_t len, OcrTextSink* sink) {
+  std::string out;
+  out.reserve(len);
+  ChunkedText<std::string> chunks(out, sink);
+  for (size_t i = 0; i < len; i++) chunks.put(text[i]);
+  chunks.flush();
+}
+
+template <typename Str>
+static void appendResponseText(hal::ByteStream& stream, Str& result, OcrTextSink* sink) {
+  // textAnnotations[0].description, or fullTextAnnotation.text when the
+  // field mask has dropped textAnnotations
+  static const char* const KEYS[] = { "\"description\"", "\"text\"" };
+  const int keyCount = sizeof(KEYS) / sizeof(KEYS[0]);
+
+  enum { FIND_KEY, FIND_COLON, FIND_QUOTE, IN_STRING } state = FIND_KEY;
+  size_t matched[keyCount] = {};
+  bool escaped = false;
+  bool closed = false;
+
+  ChunkedText<Str> text(result, sink);
+
+  while (!closed && stream.available()) {
+    int c = stream.read();
+    if (c < 0) break;
+    char ch = (char)c;
+
+    switch (state) {
+      case FIND_KEY:
+        for (int k = 0; k < keyCount; k++) {
+          const char* key = KEYS[k];
+          if (ch == key[matched[k]]) {
+            if (key[++matched[k]] == '\0') state = FIND_COLON;
+          } else {
+            matched[k] = (ch == key[0]) ? 1 : 0;
+          }
+        }
+        break;
+
+      case FIND_COLON:
+        if (ch == ':') state = FIND_QUOTE;
+        break;
+
+      case FIND_QUOTE:
+        if (ch == '"') state = IN_STRING;
+        break;
+
+      case IN_STRING:
+        if (escaped) {
+          if (ch == 'n') text.put('\n');
+          else if (ch == 't') text.put(' ');
+          else if (ch == 'r') { }
+          else text.put(ch);
+          escaped = false;
+        } else if (ch == '\\') {
+          escaped = true;
+        } else if (ch == '"') {
+          closed = true;
+        } else {
+          text.put(ch);
+        }
+        break;
+    }
+  }
+
+  text.flush();
+}
+
+std::string extractTextFromResponse(hal::ByteStream& stream) {
+  std::string result;
+  appendResponseText(stream, result, nullptr);
+  return result;
+}
+
+void extractTextFromResponse(hal::ByteStream& stream, ArenaString& out, OcrTextSink* sink) {
+  appendResponseText(stream, out, sink);
+}
+
+// {"responses":[{...},{...}]}: each response is an object at depth 2.
+// Strings are tracked so braces inside text or error messages do not
+// count; the first "text" / "description" value in a response is its text.
+template <typename Str>
+static uint8_t appendBatchTexts(hal::ByteStream& stream, Str* texts, uint8_t count) {
+  static const size_t KEY_MAX = 12;
+  char key[KEY_MAX];
+  size_t keyLen = 0;
+  int depth = 0;
+  int index = -1;
+  bool inString = false, escaped = false;
+  bool isValue = false;      // the string being read is a value
+  bool textKey = false;      // the last key closed was "text" / "description"
+  bool taking = false;       // copying this string into texts[index]
+  bool taken = false;        // texts[index] already has its value
+
+  while (stream.available()) {
+    int c = stream.read();
+    if (c < 0) break;
+    char ch = (char)c;
+
+    if (inString) {
+      if (escaped) {
+        escaped = false;
+        if (taking) {
+          if (ch == 'n') texts[index] += '\n';
+          else if (ch == 't') texts[index] += ' ';
+          else if (ch != 'r') texts[index] += ch;
+        }
+      } else if (ch == '\\') {
+        escaped = true;
+      } else if (ch == '"') {
+        inString = false;
+        if (taking) {
+          taking = false;
+          taken = true;
+        } else if (!isValue) {
+          key[keyLen < KEY_MAX ? keyLen : KEY_MAX - 1] = '\0';
+          textKey = keyLen < KEY_MAX && (strcmp(key, "text") == 0 || strcmp(key, "description") == 0);
+        }
+      } else if (taking) {
+        texts[index] += ch;
+      } else if (!isValue && keyLen < KEY_MAX) {
+        key[keyLen++] = ch;
+      }
+      continue;
+    }
+
+    switch (ch) {
+      case '"':
+        inString = true;
+        taking = isValue && textKey && !taken && index >= 0 && index < count;
+        keyLen = 0;
+        break;
+      case ':':
+        isValue = true;
+        continue;
+      case '{':
+        if (++depth == 2) {
+          index++;
+          taken = false;
+        }
+        break;
+      case '}':
+        depth--;
+        break;
+      default:
+        break;
+    }
+    if (ch != '"' && ch != ' ' && ch != '\n' && ch != '\r' && ch != '\t') {
+      isValue = false;
+      textKey = false;
+    }
+  }
+  return (uint8_t)(index + 1 < count ? index + 1 : count);
+}
+
+uint8_t extractBatchTexts(hal::ByteStream& stream, ArenaString* texts, uint8_t count) {
+  return appendBatchTexts(stream, texts, count);
+}
+
+uint8_t extractBatchTexts(hal::ByteStream& stream, std::string* texts, uint8_t count) {
+  return appendBatchTexts(stream, texts, count);
+}
+
+template <typename Str>
+static void appendPlainText(hal::ByteStream& stream, int length, Str& result, OcrTextSink* sink) {
+  ChunkedText<Str> text(result, sink);
+  // Stop at Content-Length: on a kept-alive connection the stream
+  // never reports its end
+  for (int n = 0; length < 0 || n < length; n++) {
+    if (!stream.available()) break;
+    int c = stream.read();
+    if (c < 0) break;
+    if (c != '\r') text.put((char)c);
+  }
+  text.flush();
+}
+
+std::string readPlainText(hal::ByteStream& stream, int length) {
+  std::string result;
+  appendPlainText(stream, length, result, nullptr);
+  return result;
+}
+
+void readPlainText(hal::ByteStream& stream, int length, ArenaString& out, OcrTextSink* sink) {
+  appendPlainText(stream, length, out, sink);
+}
+
+bool isUsefulOcrText(const std::string& text) {
+  if (text.length() < 3) return false;
+  if (text == "No text detected") return false;
+  if (text.compare(0, 5, "Error") == 0) return false;
+  if (text.compare(0, 9, "API Error") == 0) return false;
+  return true;
+}
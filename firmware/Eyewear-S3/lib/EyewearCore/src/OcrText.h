@@ -0,0 +1,95 @@
+/*
+ * ============================================
+ * VisionAssist - OCR Request / Response Handling
+ * ============================================
+ *
+ * Builds the Cloud Vision request body and pulls the first
+ * "description" (or, with the field mask, "text") string out
+ * of the response as it streams in, without buffering the
+ * whole document. The text can be handed on sentence by
+ * sentence as it is decoded (see OcrChunks.h). An OCR
+ * gateway replies with plain text instead (see OcrBackend.h).
+ *
+ * A burst puts several frames of the same scene in one
+ * images:annotate request; each frame's text comes back
+ * in its own response, all read in one pass.
+ *
+ * TEXT_DETECTION is quicker for signs and labels,
+ * DOCUMENT_TEXT_DETECTION reads dense pages better;
+ * chooseOcrFeature() picks one per frame.
+ * ============================================
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <Hal.h>
+#include "Arena.h"
+
+// Standard base64 (with padding) appended to `out`
+void base64Encode(const uint8_t* data, size_t len, std::string& out);
+
+enum OcrFeature : uint8_t { FEATURE_TEXT, FEATURE_DOCUMENT };
+enum OcrMode : uint8_t { OCR_MODE_AUTO, OCR_MODE_SIGN, OCR_MODE_PAGE };
+
+// `fields` URL parameter: only the full text (and any error) comes
+// back instead of every block / word / symbol with its geometry
+extern const char VISION_FIELD_MASK[];
+
+// JPEG bytes per 1000 pixels from which AUTO treats a frame as a page:
+// dense print compresses worse than a sign on a plain background
+#define OCR_PAGE_BYTES_PER_KPX 150
+// A previous result this long keeps AUTO on document detection
+#define OCR_PAGE_TEXT_CHARS 200
+
+// Sign -> TEXT_DETECTION, page -> DOCUMENT_TEXT_DETECTION; AUTO decides
+// from JPEG density (size unknown = 0) and the previous result's length
+OcrFeature chooseOcrFeature(OcrMode mode, size_t jpegLen, uint16_t width, uint16_t height,
+                            size_t lastTextLen);
+const char* ocrFeatureName(OcrFeature feature);   // Vision API type
+const char* ocrModeName(OcrMode mode);            // "auto" / "sign" / "page"
+bool parseOcrMode(const char* name, OcrMode& mode);
+
+// images:annotate JSON body for one JPEG
+std::string buildVisionRequest(const uint8_t* jpeg, size_t len, OcrFeature feature = FEATURE_DOCUMENT);
+void buildVisionRequest(const uint8_t* jpeg, size_t len, ArenaString& out,
+                        OcrFeature feature = FEATURE_DOCUMENT);
+
+// Burst request, built as the frames come in so none has to be held:
+// begin, add each JPEG, end. `reserve` avoids regrowing the body
+// (and leaving the old copies in the arena).
+void beginVisionBatch(ArenaString& out, size_t reserve);
+void addVisionBatchImage(const uint8_t* jpeg, size_t len, OcrFeature feature, ArenaString& out);
+void endVisionBatch(ArenaString& out);
+// Exact body size for `frames` JPEGs of `jpegLen` bytes each
+size_t visionBatchBytes(size_t jpegLen, uint8_t frames, OcrFeature feature);
+
+// Receives OCR text in sentence / line chunks as it is decoded
+class OcrTextSink {
+public:
+  virtual ~OcrTextSink() {}
+  virtual void onChunk(const char* text, size_t len) = 0;
+};
+
+// A whole text to `sink` in the chunks it would have streamed in as
+void sendTextChunks(const char* text, size_t len, OcrTextSink* sink);
+
+// First "description" or "text" value in a Vision response, unescaped;
+// `sink` (optional) sees it chunk by chunk while it streams in
+std::string extractTextFromResponse(hal::ByteStream& stream);
+void extractTextFromResponse(hal::ByteStream& stream, ArenaString& out, OcrTextSink* sink = nullptr);
+
+// Text of each response in a burst reply into texts[0..count), one pass;
+// empty for no text or an error. Returns the responses seen.
+uint8_t extractBatchTexts(hal::ByteStream& stream, ArenaString* texts, uint8_t count);
+uint8_t extractBatchTexts(hal::ByteStream& stream, std::string* texts, uint8_t count);
+
+// text/plain body (an OCR gateway's reply) of `length` bytes, or up to
+// the end of the stream when the length is unknown (< 0); CR dropped
+std::string readPlainText(hal::ByteStream& stream, int length);
+void readPlainText(hal::ByteStream& stream, int length, ArenaString& out, OcrTextSink* sink = nullptr);
+
+// False for errors, "No text detected" and fragments too short to speak
+bool isUsefulOcrText(const std::string& text);
@@ -0,0 +1,148 @@
+#include "PeerTable.h"
+
+#include <stdio.h>
+#include <string.h>
+
+void PeerTable::load(const PeerRecord* records, uint8_t count) {
+  for (uint8_t i = 0; i < MAX_PEERS; i++) peers[i] = Peer();
+  for (uint8_t i = 0; i < count && i < MAX_PEERS; i++) {
+    peers[i].used = true;
+    memcpy(peers[i].mac, records[i].mac, 6);
+    peers[i].role = records[i].role < ROLE_COUNT ? records[i].role : ROLE_ALL;
+  }
+}
+
+uint8_t PeerTable::save(PeerRecord* records) const {
+  uint8_t n = 0;
+  for (uint8_t i = 0; i < MAX_PEERS; i++) {
+    if (!peers[i].used) continue;
+    memcpy(records[n].mac, peers[i].mac, 6);
+    records[n].role = peers[i].role;
+    n++;
+  }
+  return n;
+}
+
+void PeerTable::openPairing(uint32_t now, uint32_t ms) {
+  pairUntil = now + ms;
+  if (pairUntil == 0) pairUntil = 1;
+}
+
+int PeerTable::find(const uint8_t* mac) const {
+  for (uint8_t i = 0; i < MAX_PEERS; i++) {
+    if (peers[i].used && memcmp(peers[i].mac, mac, 6) == 0) return i;
+  }
+  return -1;
+}
+
+int PeerTable::pair(uint32_t now, const uint8_t* mac, uint8_t role, bool& added) {
+  added = false;
+  int slot = find(mac);
+  if (slot >= 0) return slot;
+  if (!pairingOpen(now)) return -1;
+
+  for (uint8_t i = 0; i < MAX_PEERS; i++) {
+    if (peers[i].used) continue;
+    peers[i] = Peer();
+    peers[i].used = true;
+    memcpy(peers[i].mac, mac, 6);
+    peers[i].role = role < ROLE_COUNT ? role : ROLE_ALL;
+    added = true;
+    return i;
+  }
+  return -1;
+}
+
+bool PeerTable::setRole(uint8_t slot, uint8_t role) {
+  if (!used(slot) || role >= ROLE_COUNT) return false;
+  peers[slot].role = role;
+  return true;
+}
+
+bool PeerTable::remove(uint8_t slot) {
+  if (!used(slot)) return false;
+  peers[slot] = Peer();
+  return true;
+}
+
+uint8_t PeerTable::count() const {
+  uint8_t n = 0;
+  for (uint8_t i = 0; i < MAX_PEERS; i++) n += peers[i].used;
+  return n;
+}
+
+bool PeerTable::directional() const {
+  for (uint8_t i = 0; i < MAX_PEERS; i++) {
+    if (peers[i].used && peers[i].role != ROLE_ALL) return true;
+  }
+  return false;
+}
+
+bool PeerTable::awaitingAck() const {
+  for (uint8_t i = 0; i < MAX_PEERS; i++) {
+    if (peers[i].used && peers[i].stats.lastAck == 0 && reachable(i)) return true;
+  }
+  return false;
+}
+
+uint8_t PeerTable::plan(uint32_t now, const StateFrame& nearest, const ZoneMap& map,
+                        const ZoneClassifier& zones, Send* out) {
+  uint8_t n = 0;
+  for (uint8_t i = 0; i < MAX_PEERS; i++) {
+    Peer& peer = peers[i];
+    if (!peer.used) continue;
+    if (!reachable(i) && now - peer.lastPlanned < UNREACHABLE_INTERVAL) continue;
+
+    peer.lastPlanned = now;
+    memcpy(out[n].mac, peer.mac, 6);
+    out[n].frame = map.roleFrame(nearest, peer.role, zones);
+    n++;
+  }
+  return n;
+}
+
+void PeerTable::onQueued(const uint8_t* mac, bool ok) {
+  int slot = find(mac);
+  if (slot < 0) return;
+  if (ok) peers[slot].stats.sent++;
+  else peers[slot].stats.refused++;
+}
+
+int PeerTable::onDelivery(uint32_t now, const uint8_t* mac, bool ok) {
+  int slot = find(mac);
+  if (slot < 0) return -1;
+  PeerStats& stats = peers[slot].stats;
+  if (ok) {
+    stats.delivered++;
+    stats.lastAck = now ? now : 1;
+    stats.failStreak = 0;
+  } else {
+    stats.failed++;
+    if (stats.failStreak < UINT16_MAX) stats.failStreak++;
+  }
+  return slot;
+}
+
+const char* peerRoleName(uint8_t role) {
+  switch (role) {
+    case ROLE_LEFT: return "left";
+    case ROLE_RIGHT: return "right";
+    case ROLE_CENTER: return "center";
+    default: return "all";
+  }
+}
+
+bool parsePeerRole(const char* name, uint8_t& role) {
+  for (uint8_t r = 0; r < ROLE_COUNT; r++) {
+    if (strcmp(name, peerRoleName(r)) == 0) {
+      role = r;
+      return true;
+    }
+  }
+  return false;
+}
+
+void formatMac(const uint8_t* mac, char* out) {
+  snprintf(out, 18, "%02x:%02x:%02x:%02x:%02x:%02x",
+           mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+}
@@ -0,0 +1,111 @@
+/*
+ * ============================================
+ * VisionAssist - Handband Peer Table
+ * ============================================
+ *
+ * The bands the eyewear drives, each with a role (all,
+ * left, right, centre) and its own delivery statistics.
+ *
+ * Pairing: a band sends MSG_PAIR_REQUEST until it is
+ * acknowledged. Known bands are always acknowledged, new
+ * ones only while the pairing window is open (after boot
+ * and on request from the web UI).
+ *
+ * plan() computes every band's frame for a tick in one
+ * pass under the caller's lock; the caller then sends them
+ * back to back. Bands that stopped acknowledging are only
+ * sent a frame every UNREACHABLE_INTERVAL so their retries
+ * do not hold up the bands that are listening.
+ *
+ * Not thread safe: the firmware guards it with a spinlock
+ * shared by the safety task, the web task and the ESP-NOW
+ * callbacks.
+ * ============================================
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <VisionAssistProtocol.h>
+#include "ZoneClassifier.h"
+#include "ZoneMap.h"
+
+// NVS layout of one band
+struct PeerRecord {
+  uint8_t mac[6];
+  uint8_t role;
+};
+
+struct PeerStats {
+  uint32_t sent = 0;        // frames esp_now_send() accepted
+  uint32_t refused = 0;     // frames esp_now_send() refused
+  uint32_t delivered = 0;   // acknowledged by the band
+  uint32_t failed = 0;      // not acknowledged
+  uint32_t lastAck = 0;     // ms, 0 = never
+  uint16_t failStreak = 0;  // failures since the last ack
+};
+
+class PeerTable {
+public:
+  static const uint8_t MAX_PEERS = 4;
+  static const uint16_t UNREACHABLE_AFTER = 20;       // failed frames in a row
+  static const uint32_t UNREACHABLE_INTERVAL = 1000;  // ms between frames then
+  static const uint32_t PAIR_WINDOW = 60000;
+
+  struct Send {
+    uint8_t mac[6];
+    StateFrame frame;
+  };
+
+  void load(const PeerRecord* records, uint8_t count);
+  uint8_t save(PeerRecord* records) const;   // returns the count
+
+  void openPairing(uint32_t now, uint32_t ms = PAIR_WINDOW);
+  void closePairing() { pairUntil = 0; }
+  bool pairingOpen(uint32_t now) const { return pairUntil && (int32_t)(pairUntil - now) > 0; }
+
+  // Pair request from `mac`; returns its slot or -1 (window closed
+  // or table full). `added` is set for a band seen the first time.
+  int pair(uint32_t now, const uint8_t* mac, uint8_t role, bool& added);
+  int find(const uint8_t* mac) const;
+  bool setRole(uint8_t slot, uint8_t role);
+  bool remove(uint8_t slot);
+
+  uint8_t count() const;
+  // A left, right or centre band is paired (the TOF sweeps zones for it)
+  bool directional() const;
+  // A band has not acknowledged a frame yet and is still sent every one
+  bool awaitingAck() const;
+  bool used(uint8_t slot) const { return slot < MAX_PEERS && peers[slot].used; }
+  const uint8_t* mac(uint8_t slot) const { return peers[slot].mac; }
+  uint8_t role(uint8_t slot) const { return peers[slot].role; }
+  const PeerStats& stats(uint8_t slot) const { return peers[slot].stats; }
+  bool reachable(uint8_t slot) const { return peers[slot].stats.failStreak < UNREACHABLE_AFTER; }
+
+  // This tick's frames, one per band that is due one; returns how many
+  uint8_t plan(uint32_t now, const StateFrame& nearest, const ZoneMap& map,
+               const ZoneClassifier& zones, Send* out);
+
+  // Result of esp_now_send() and of the send callback
+  void onQueued(const uint8_t* mac, bool ok);
+  // Returns the slot, -1 for frames to unknown addresses (beacons)
+  int onDelivery(uint32_t now, const uint8_t* mac, bool ok);
+
+private:
+  struct Peer {
+    bool used = false;
+    uint8_t mac[6] = {};
+    uint8_t role = ROLE_ALL;
+    uint32_t lastPlanned = 0;
+    PeerStats stats;
+  };
+
+  Peer peers[MAX_PEERS];
+  uint32_t pairUntil = 0;
+};
+
+const char* peerRoleName(uint8_t role);
+bool parsePeerRole(const char* name, uint8_t& role);
+
+// "88:56:a6:64:21:6c", `out` holds at least 18 bytes
+void formatMac(const uint8_t* mac, char* out);
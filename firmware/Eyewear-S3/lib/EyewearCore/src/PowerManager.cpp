@@ -0,0 +1,100 @@
+#include "PowerManager.h"
+
+void PowerManager::begin(uint32_t now, const Config& config) {
+  cfg = config;
+  for (uint8_t s = 0; s < POWER_SUBSYSTEMS; s++) {
+    state[s] = State();
+    state[s].since = now;
+  }
+  cameraUsers = 0;
+  cameraUsed = radioUsed = now;
+  bootMs = windowAt = now;
+  windowFull = false;
+}
+
+void PowerManager::set(PowerSubsystem s, bool on, uint32_t now) {
+  State& st = state[s];
+  if (st.on == on) return;
+  if (st.on) st.onTotal += now - st.since;
+  else st.wakes++;
+  st.on = on;
+  st.since = now;
+}
+
+bool PowerManager::acquireCamera(uint32_t now) {
+  cameraUsers++;
+  cameraUsed = now;
+  bool wake = !state[POWER_CAMERA].on;
+  set(POWER_CAMERA, true, now);
+  return wake;
+}
+
+void PowerManager::releaseCamera(uint32_t now) {
+  if (cameraUsers > 0) cameraUsers--;
+  cameraUsed = now;
+}
+
+bool PowerManager::webActivity(uint32_t now) {
+  radioUsed = now;
+  bool wake = !state[POWER_RADIO].on;
+  set(POWER_RADIO, true, now);
+  return wake;
+}
+
+bool PowerManager::holdRadio(uint32_t now) {
+  return webActivity(now);
+}
+
+uint8_t PowerManager::update(uint32_t now) {
+  uint8_t actions = 0;
+  if (state[POWER_CAMERA].on && cameraUsers == 0 && now - cameraUsed >= cfg.cameraIdleMs) {
+    set(POWER_CAMERA, false, now);
+    actions |= CAMERA_STANDBY;
+  }
+  if (state[POWER_RADIO].on && now - radioUsed >= cfg.radioIdleMs) {
+    set(POWER_RADIO, false, now);
+    actions |= RADIO_SLEEP;
+  }
+
+  if (now - windowAt >= WINDOW_MS) {
+    for (uint8_t s = 0; s < POWER_SUBSYSTEMS; s++) {
+      uint64_t total = onMs((PowerSubsystem)s, now);
+      state[s].windowOn = total - state[s].windowStart;
+      state[s].windowStart = total;
+    }
+    windowAt = now;
+    windowFull = true;
+  }
+  return actions;
+}
+
+uint64_t PowerManager::onMs(PowerSubsystem s, uint32_t now) const {
+  const State& st = state[s];
+  return st.onTotal + (st.on ? now - st.since : 0);
+}
+
+uint16_t PowerManager::dutyPermille(PowerSubsystem s, uint32_t now) const {
+  if (windowFull) return (uint16_t)(state[s].windowOn * 1000 / WINDOW_MS);
+  uint32_t elapsed = now - bootMs;
+  return elapsed ? (uint16_t)(onMs(s, now) * 1000 / elapsed) : 1000;
+}
+
+uint32_t PowerManager::estimatedMa(uint32_t now) const {
+  uint32_t ma1000 = (uint32_t)cfg.baseMa * 1000;
+  for (uint8_t s = 0; s < POWER_SUBSYSTEMS; s++) {
+    uint32_t duty = dutyPermille((PowerSubsystem)s, now);
+    ma1000 += duty * cfg.onMa[s] + (1000 - duty) * cfg.offMa[s];
+  }
+  return (ma1000 + 500) / 1000;
+}
+
+int32_t awaitFreshFrame(hal::Camera& camera, hal::Clock& clock, uint32_t wokeAt, int maxFrames) {
+  for (int i = 0; i < maxFrames; i++) {
+    hal::Frame frame;
+    if (!camera.capture(frame)) break;
+    bool fresh = (int32_t)(frame.ms - wokeAt) > 0;
+    camera.release(frame);
+    if (fresh) return (int32_t)(clock.millis() - wokeAt);
+  }
+  return -1;
+}
@@ -0,0 +1,110 @@
+/*
+ * ============================================
+ * VisionAssist - Eyewear Power Manager
+ * ============================================
+ *
+ * Decides when the camera and the WiFi radio may idle.
+ * The OV2640 streams frames into PSRAM nonstop once
+ * started, yet is only used for OCR and /capture: it goes
+ * to standby (registers kept, wakes in a frame or two)
+ * once no one has used it for cameraIdleMs. The radio
+ * stays fully awake while the web UI is in use and drops
+ * to modem sleep radioIdleMs after the last request; the
+ * driver still wakes it for every ESP-NOW send, but frames
+ * the bands send unasked may be missed while it sleeps, so
+ * holdRadio() keeps it awake while one is expected.
+ *
+ * update() returns the transitions due and the caller
+ * carries them out; acquireCamera() / webActivity() say
+ * when something must be woken. Not locked: main.cpp
+ * holds powerMutex around each call and the action.
+ *
+ * Per subsystem it keeps the time on and the wakes, and
+ * from the last full minute's duty estimates the current
+ * drawn, from typical figures in Config.
+ * ============================================
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <Hal.h>
+
+enum PowerSubsystem : uint8_t {
+  POWER_CAMERA,    // on = streaming, off = standby
+  POWER_RADIO,     // on = awake, off = modem sleep
+  POWER_SUBSYSTEMS
+};
+
+class PowerManager {
+public:
+  enum Action : uint8_t {
+    CAMERA_STANDBY = 0x01,
+    RADIO_SLEEP = 0x02
+  };
+
+  static const uint32_t WINDOW_MS = 60000;
+
+  struct Config {
+    uint32_t cameraIdleMs = 5000;
+    uint32_t radioIdleMs = 3000;
+    // mA at the battery, typical: measure the unit for real numbers
+    uint16_t onMa[POWER_SUBSYSTEMS] = { 45, 80 };
+    uint16_t offMa[POWER_SUBSYSTEMS] = { 2, 15 };
+    uint16_t baseMa = 85;   // CPU, PSRAM, TOF ranging
+  };
+
+  // Both subsystems start on
+  void begin(uint32_t now, const Config& config);
+  const Config& config() const { return cfg; }
+
+  // A camera user starts / ends (OCR run, /capture). True if the
+  // caller must wake the camera first.
+  bool acquireCamera(uint32_t now);
+  void releaseCamera(uint32_t now);
+
+  // A web request; true if the caller must wake the radio
+  bool webActivity(uint32_t now);
+  // A band may send unasked (pairing open, band not heard yet): keeps
+  // the radio awake for another radioIdleMs; true if the caller must
+  // wake it
+  bool holdRadio(uint32_t now);
+
+  // Action bits due now (the state already reflects them)
+  uint8_t update(uint32_t now);
+
+  bool on(PowerSubsystem s) const { return state[s].on; }
+  uint64_t onMs(PowerSubsystem s, uint32_t now) const;
+  uint32_t wakes(PowerSubsystem s) const { return state[s].wakes; }
+
+  // Share on over the last full window (since boot before the first)
+  uint16_t dutyPermille(PowerSubsystem s, uint32_t now) const;
+  uint32_t estimatedMa(uint32_t now) const;
+
+private:
+  struct State {
+    bool on = true;
+    uint32_t since = 0;        // last switch
+    uint64_t onTotal = 0;      // ms, up to `since`
+    uint64_t windowStart = 0;  // onTotal at the window start
+    uint64_t windowOn = 0;     // ms on in the last full window
+    uint32_t wakes = 0;
+  };
+
+  void set(PowerSubsystem s, bool on, uint32_t now);
+
+  Config cfg;
+  State state[POWER_SUBSYSTEMS];
+  uint8_t cameraUsers = 0;
+  uint32_t cameraUsed = 0;
+  uint32_t radioUsed = 0;   // last web request or hold
+  uint32_t bootMs = 0;
+  uint32_t windowAt = 0;
+  bool windowFull = false;
+};
+
+// After the camera wakes: drops the frames that ended before `wokeAt`
+// (the driver keeps its last one from before standby), at most
+// `maxFrames`. Returns the ms from `wokeAt` to the first fresh frame,
+// -1 if none came.
+int32_t awaitFreshFrame(hal::Camera& camera, hal::Clock& clock, uint32_t wokeAt, int maxFrames);
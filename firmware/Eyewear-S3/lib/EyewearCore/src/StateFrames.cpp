@@ -0,0 +1,50 @@
+#include "StateFrames.h"
+
+#include <string.h>
+
+static int clampInt(int v, int lo, int hi) {
+  return v < lo ? lo : (v > hi ? hi : v);
+}
+
+uint8_t computeIntensity(int distance) {
+  int d = clampInt(distance, 0, CAUTION_DISTANCE);
+  return (uint8_t)(255 - d * (255 - 128) / CAUTION_DISTANCE);
+}
+
+StateFrame makeStateFrame(uint8_t tableVersion, uint8_t pattern, int distance, float closingSpeed) {
+  StateFrame frame;
+  frame.type = MSG_STATE;
+  frame.tableVersion = tableVersion;
+  frame.pattern = pattern;
+  frame.intensity = computeIntensity(distance);
+  frame.flags = 0;
+  frame.distance = (int16_t)clampInt(distance, -32768, 32767);
+  frame.closingSpeed = (int16_t)clampInt((int)closingSpeed, -5000, 5000);
+  return frame;
+}
+
+StateFrame makePauseFrame(uint8_t tableVersion) {
+  StateFrame frame;
+  frame.type = MSG_STATE;
+  frame.tableVersion = tableVersion;
+  frame.pattern = PATTERN_CLEAR;
+  frame.intensity = 0;
+  frame.flags = FLAG_PAUSE;
+  frame.distance = 0;
+  frame.closingSpeed = 0;
+  return frame;
+}
+
+PatternTableFrame makePatternTableFrame(uint8_t tableVersion, const PatternDesc* patterns, uint8_t count) {
+  PatternTableFrame frame;
+  memset(&frame, 0, sizeof(frame));
+  if (count > MAX_PATTERNS) count = MAX_PATTERNS;
+  frame.type = MSG_PATTERN_TABLE;
+  frame.tableVersion = tableVersion;
+  frame.count = count;
+  memcpy(frame.patterns, patterns, count * sizeof(PatternDesc));
+  frame.thresholds[0] = CRITICAL_DISTANCE;
+  frame.thresholds[1] = WARNING_DISTANCE;
+  frame.thresholds[2] = CAUTION_DISTANCE;
+  return frame;
+}
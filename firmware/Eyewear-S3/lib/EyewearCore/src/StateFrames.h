@@ -0,0 +1,17 @@
+/*
+ * ============================================
+ * VisionAssist - ESP-NOW Frame Builders
+ * ============================================
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <VisionAssistProtocol.h>
+
+// Stronger vibration the closer the obstacle (128 at the caution edge, 255 at contact)
+uint8_t computeIntensity(int distance);
+
+StateFrame makeStateFrame(uint8_t tableVersion, uint8_t pattern, int distance, float closingSpeed);
+StateFrame makePauseFrame(uint8_t tableVersion);
+PatternTableFrame makePatternTableFrame(uint8_t tableVersion, const PatternDesc* patterns, uint8_t count);
@@ -0,0 +1,59 @@
+#include "TextPresence.h"
+
+#include <string.h>
+
+bool TextPresenceDetector::detect(const uint8_t* jpeg, size_t len, TextPresence& result) {
+  result = TextPresence();
+  cols = rows = 0;
+  if (!jpegLumaBlocks(jpeg, len, *this, cfg.windowPct)) return false;
+  scan(result);
+  return true;
+}
+
+void TextPresenceDetector::begin(uint16_t c, uint16_t r) {
+  // A larger frame is judged on its top left MAX_COLS x MAX_ROWS blocks
+  cols = c < MAX_COLS ? c : MAX_COLS;
+  rows = r < MAX_ROWS ? r : MAX_ROWS;
+  blocks = strokes = 0;
+  memset(map, 0, sizeof(map));
+}
+
+void TextPresenceDetector::block(const LumaBlock& b) {
+  if (b.col >= cols || b.row >= rows) return;
+  blocks++;
+  uint32_t both = b.horizontal < b.vertical ? b.horizontal : b.vertical;
+  if (both + b.mixed < cfg.strokeDetail) return;
+  uint32_t i = (uint32_t)b.row * cols + b.col;
+  map[i / 32] |= 1u << (i % 32);
+  strokes++;
+}
+
+// Line runs, row by row: stroke blocks with at most one empty block
+// between neighbours
+void TextPresenceDetector::scan(TextPresence& result) const {
+  result.blocks = blocks;
+  result.strokeBlocks = strokes;
+  for (uint16_t r = 0; r < rows; r++) {
+    uint32_t run = 0;
+    uint8_t gap = 0;
+    bool rowHasRun = false;
+    for (uint16_t c = 0; c <= cols; c++) {
+      uint32_t i = (uint32_t)r * cols + c;
+      bool stroke = c < cols && (map[i / 32] >> (i % 32)) & 1;
+      if (stroke) {
+        run++;
+        gap = 0;
+        continue;
+      }
+      if (run == 0 || (++gap <= 1 && c < cols)) continue;
+      if (run >= cfg.minRun) {
+        result.lineBlocks += run;
+        rowHasRun = true;
+      }
+      run = 0;
+      gap = 0;
+    }
+    if (rowHasRun) result.lineRows++;
+  }
+  result.noText = result.lineBlocks < cfg.minLineBlocks;
+}
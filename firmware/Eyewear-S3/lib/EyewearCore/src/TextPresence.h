@@ -0,0 +1,79 @@
+/*
+ * ============================================
+ * VisionAssist - Text Presence Detector
+ * ============================================
+ *
+ * Decides from the OCR shot's JPEG, without decoding it,
+ * whether there can be text in the frame, so a touch on a
+ * bare wall or an empty street answers "No text detected"
+ * at once instead of after a Vision round trip.
+ *
+ * Text is strokes going both ways, side by side along a
+ * line. Per 8x8 luma block (JpegLuma) the detail is split
+ * by direction: a stroke block has some both ways, where
+ * a straight edge (door frame, table, horizon) has it one
+ * way only and smooth surfaces have none. Stroke blocks
+ * next to each other in a block row - one gap allowed,
+ * between letters - make line runs. Too few blocks in
+ * runs: no text.
+ *
+ * It only ever says "no text" when it is sure: textured
+ * scenes (foliage, gravel, carpet) have runs everywhere
+ * and still go to the OCR backend. The defaults were set
+ * on Host-Tools text_gate_sim, keeping every text scene.
+ * ============================================
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "JpegLuma.h"
+
+struct TextPresenceConfig {
+  // A block with strokes: min(horizontal, vertical) + mixed detail
+  uint16_t strokeDetail = 40;
+  // Stroke blocks side by side (gaps of one included) for a line run
+  uint8_t minRun = 3;
+  // Fewer blocks in line runs than this: no text
+  uint16_t minLineBlocks = 12;
+  uint8_t windowPct = 100;   // Vision reads the whole frame
+};
+
+struct TextPresence {
+  uint32_t blocks = 0;        // in the window
+  uint32_t strokeBlocks = 0;
+  uint32_t lineBlocks = 0;    // stroke blocks in line runs
+  uint16_t lineRows = 0;      // block rows with a line run
+  bool noText = false;        // false as well when the JPEG was not parsed
+};
+
+class TextPresenceDetector : public LumaBlockSink {
+public:
+  // Frames up to UXGA (1600x1200)
+  static const uint16_t MAX_COLS = 200;
+  static const uint16_t MAX_ROWS = 150;
+
+  explicit TextPresenceDetector(const TextPresenceConfig& config = TextPresenceConfig()) : cfg(config) {}
+
+  // False for a JPEG the parser does not handle (result.noText false).
+  // Not reentrant: keep one detector per task, off the stack (4 KB).
+  bool detect(const uint8_t* jpeg, size_t len, TextPresence& result);
+
+  const TextPresenceConfig& config() const { return cfg; }
+  void setConfig(const TextPresenceConfig& config) { cfg = config; }
+
+  // LumaBlockSink
+  void begin(uint16_t cols, uint16_t rows) override;
+  void block(const LumaBlock& b) override;
+
+private:
+  void scan(TextPresence& result) const;
+
+  TextPresenceConfig cfg;
+  uint16_t cols = 0, rows = 0;
+  uint32_t blocks = 0;
+  uint32_t strokes = 0;
+  uint32_t map[(MAX_COLS * MAX_ROWS + 31) / 32];   // one bit per stroke block
+};
@@ -0,0 +1,177 @@
+#include "WebJson.h"
+
+#include <VisionAssistProtocol.h>
+#include "DistanceHistory.h"
+#include "OcrChunks.h"
+#include "OcrHistory.h"
+#include "PeerTable.h"
+
+#include <stdio.h>
+
+std::string escapeJson(const std::string& text) {
+  std::string out;
+  out.reserve(text.size() + text.size() / 8 + 2);
+
+  for (char ch : text) {
+    switch (ch) {
+      case '\\': out += "\\\\"; break;
+      case '"':  out += "\\\""; break;
+      case '\n': out += "\\n"; break;
+      case '\r': out += "\\r"; break;
+      case '\t': out += "\\t"; break;
+      default:   out += ch; break;
+    }
+  }
+  return out;
+}
+
+static const char* zoneName(int pattern) {
+  switch (pattern) {
+    case PATTERN_CRITICAL: return "CRITICAL";
+    case PATTERN_WARNING: return "WARNING";
+    case PATTERN_CAUTION: return "CAUTION";
+    default: return "CLEAR";
+  }
+}
+
+std::string distanceJson(int distance, int pattern, bool paused) {
+  std::string json;
+  json.reserve(96);
+  json += "{\"distance\":";
+  json += std::to_string(distance);
+  json += ",\"pattern\":";
+  json += std::to_string(pattern);
+  json += ",\"paused\":";
+  json += paused ? "true" : "false";
+  json += ",\"status\":\"";
+  json += paused ? "READING 📖" : zoneName(pattern);
+  json += "\"}";
+  return json;
+}
+
+std::string ocrStatusJson(bool newText, bool reading, const std::string& text) {
+  std::string json;
+  json.reserve(text.size() + 48);
+  json += "{\"newText\":";
+  json += newText ? "true" : "false";
+  json += ",\"reading\":";
+  json += reading ? "true" : "false";
+  json += ",\"text\":\"";
+  json += escapeJson(text);
+  json += "\"}";
+  return json;
+}
+
+std::string ocrStatusJson(bool newText, bool reading, const std::string& text,
+                          const OcrChunkLog& chunks, uint8_t since) {
+  std::string json = ocrStatusJson(newText, reading, text);
+  json.pop_back();
+  json += ',';
+  chunks.appendJson(json, since);
+  json += '}';
+  return json;
+}
+
+std::string peersJson(const PeerTable& peers, uint32_t now) {
+  std::string json;
+  json.reserve(32 + PeerTable::MAX_PEERS * 144);
+  json += "{\"pairing\":";
+  json += peers.pairingOpen(now) ? "true" : "false";
+  json += ",\"peers\":[";
+
+  bool first = true;
+  for (uint8_t i = 0; i < PeerTable::MAX_PEERS; i++) {
+    if (!peers.used(i)) continue;
+    const PeerStats& st = peers.stats(i);
+    char mac[18];
+    char row[160];
+    formatMac(peers.mac(i), mac);
+    snprintf(row, sizeof(row),
+             "%s{\"slot\":%u,\"mac\":\"%s\",\"role\":\"%s\",\"reachable\":%s,"
+             "\"sent\":%u,\"delivered\":%u,\"failed\":%u,\"ackAgeMs\":%ld}",
+             first ? "" : ",", (unsigned)i, mac, peerRoleName(peers.role(i)),
+             peers.reachable(i) ? "true" : "false", (unsigned)st.sent, (unsigned)st.delivered,
+             (unsigned)st.failed, st.lastAck ? (long)(now - st.lastAck) : -1L);
+    json += row;
+    first = false;
+  }
+  json += "]}";
+  return json;
+}
+
+static uint32_t clampSince(uint32_t since, uint32_t first, uint32_t next) {
+  if (since < first || since > next) return first;   // too old, or from before a reboot
+  return since;
+}
+
+template <typename Get>
+static void appendColumn(std::string& json, const char* name, uint32_t from, uint32_t to, Get get) {
+  json += ",\"";
+  json += name;
+  json += "\":[";
+  char num[8];
+  for (uint32_t seq = from; seq < to; seq++) {
+    snprintf(num, sizeof(num), "%s%d", seq != from ? "," : "", (int)get(seq));
+    json += num;
+  }
+  json += ']';
+}
+
+std::string historyJson(const DistanceHistory& h, uint32_t rawSince, uint32_t summarySince) {
+  uint32_t rawFrom = clampSince(rawSince, h.rawFirst(), h.rawNext());
+  uint32_t summaryFrom = clampSince(summarySince, h.summaryFirst(), h.summaryNext());
+
+  std::string json;
+  json.reserve(128 + (h.rawNext() - rawFrom) * 7 + (h.summaryNext() - summaryFrom) * 17);
+  json += "{\"raw\":{\"period\":";
+  json += std::to_string(DistanceHistory::RAW_PERIOD);
+  json += ",\"from\":";
+  json += std::to_string(rawFrom);
+  json += ",\"next\":";
+  json += std::to_string(h.rawNext());
+  appendColumn(json, "d", rawFrom, h.rawNext(), [&](uint32_t s) { return h.raw(s).distance; });
+  appendColumn(json, "p", rawFrom, h.rawNext(), [&](uint32_t s) { return h.raw(s).pattern; });
+
+  json += "},\"summary\":{\"period\":";
+  json += std::to_string(DistanceHistory::SUMMARY_PERIOD);
+  json += ",\"from\":";
+  json += std::to_string(summaryFrom);
+  json += ",\"next\":";
+  json += std::to_string(h.summaryNext());
+  appendColumn(json, "min", summaryFrom, h.summaryNext(), [&](uint32_t s) { return h.summary(s).min; });
+  appendColumn(json, "max", summaryFrom, h.summaryNext(), [&](uint32_t s) { return h.summary(s).max; });
+  appendColumn(json, "mean", summaryFrom, h.summaryNext(), [&](uint32_t s) { return h.summary(s).mean; });
+  appendColumn(json, "p", summaryFrom, h.summaryNext(), [&](uint32_t s) { return h.summary(s).pattern; });
+  json += "}}";
+  return json;
+}
+
+std::string ocrHistoryJson(const OcrHistory& h, uint32_t before, uint8_t limit, uint32_t now) {
+  if (before == 0 || before > h.nextId()) before = h.nextId();
+
+  std::string json;
+  json.reserve(64 + limit * 96);
+  json += "{\"first\":";
+  json += std::to_string(h.firstId());
+  json += ",\"next\":";
+  json += std::to_string(h.nextId());
+  json += ",\"entries\":[";
+
+  uint32_t id = before;
+  for (uint8_t n = 0; n < limit && id > h.firstId(); n++) {
+    OcrHistory::Entry e;
+    const char* text;
+    uint16_t len;
+    if (!h.get(--id, e, text, len)) break;
+    char head[96];
+    snprintf(head, sizeof(head), "%s{\"id\":%u,\"ageMs\":%ld,\"hash\":\"%08x\",\"text\":\"",
+             n ? "," : "", (unsigned)e.id, e.ms ? (long)(now - e.ms) : -1L, (unsigned)e.imageHash);
+    json += head;
+    json += escapeJson(std::string(text, len));
+    json += "\"}";
+  }
+  json += "],\"more\":";
+  json += id > h.firstId() ? "true" : "false";
+  json += '}';
+  return json;
+}
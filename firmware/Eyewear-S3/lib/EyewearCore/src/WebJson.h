@@ -0,0 +1,39 @@
+/*
+ * ============================================
+ * VisionAssist - Web API JSON
+ * ============================================
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+
+class DistanceHistory;
+class OcrChunkLog;
+class OcrHistory;
+class PeerTable;
+
+// Escape \ " and control characters for a JSON string value
+std::string escapeJson(const std::string& text);
+
+// /distance payload
+std::string distanceJson(int distance, int pattern, bool paused);
+
+// /ocr_status payload
+std::string ocrStatusJson(bool newText, bool reading, const std::string& text);
+
+// /ocr_status with the current run's chunks from `since` on
+std::string ocrStatusJson(bool newText, bool reading, const std::string& text,
+                          const OcrChunkLog& chunks, uint8_t since);
+
+// /peers payload: pairing window state and every band with its stats
+std::string peersJson(const PeerTable& peers, uint32_t now);
+
+// /history payload: entries from `rawSince` / `summarySince` on
+// (sequence numbers from the previous reply's "next"), as columns
+std::string historyJson(const DistanceHistory& history, uint32_t rawSince, uint32_t summarySince);
+
+// /ocr/history payload: up to `limit` entries older than `before`
+// (0 = newest first), newest first; "more" if older ones are held
+std::string ocrHistoryJson(const OcrHistory& history, uint32_t before, uint8_t limit, uint32_t now);
@@ -0,0 +1,49 @@
+#include "ZoneClassifier.h"
+
+ZoneClassifier::ZoneClassifier(int critical, int warning, int caution) {
+  thresholds[0] = critical;
+  thresholds[1] = warning;
+  thresholds[2] = caution;
+}
+
+int ZoneClassifier::classify(int distance) const {
+  if (distance < thresholds[0]) return PATTERN_CRITICAL;
+  if (distance < thresholds[1]) return PATTERN_WARNING;
+  if (distance < thresholds[2]) return PATTERN_CAUTION;
+  return PATTERN_CLEAR;
+}
+
+int ZoneClassifier::severity(int pattern) {
+  switch (pattern) {
+    case PATTERN_CRITICAL: return 3;
+    case PATTERN_WARNING: return 2;
+    case PATTERN_CAUTION: return 1;
+    default: return 0;
+  }
+}
+
+bool ZoneClassifier::update(int distance) {
+  int newPattern = classify(distance);
+
+  if (newPattern == PATTERN_CRITICAL && currentStablePattern != PATTERN_CRITICAL) {
+    currentStablePattern = PATTERN_CRITICAL;
+    return true;
+  }
+
+  if (newPattern != lastPattern) {
+    lastPattern = newPattern;
+    stableCount = 0;
+    if (newPattern == PATTERN_CLEAR) {
+      currentStablePattern = PATTERN_CLEAR;
+      return true;
+    }
+    return false;
+  }
+
+  stableCount++;
+  if (stableCount >= 1 && currentStablePattern != newPattern) {
+    currentStablePattern = newPattern;
+    return true;
+  }
+  return false;
+}
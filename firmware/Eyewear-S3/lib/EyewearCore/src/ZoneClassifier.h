@@ -0,0 +1,39 @@
+/*
+ * ============================================
+ * VisionAssist - Obstacle Zone Classifier
+ * ============================================
+ *
+ * Maps the smoothed distance to a pattern id and debounces
+ * zone changes. CRITICAL and CLEAR take effect at once,
+ * the other zones need a second agreeing reading.
+ * ============================================
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <VisionAssistProtocol.h>
+
+class ZoneClassifier {
+public:
+  ZoneClassifier(int critical = CRITICAL_DISTANCE, int warning = WARNING_DISTANCE,
+                 int caution = CAUTION_DISTANCE);
+
+  // Raw zone for a distance
+  int classify(int distance) const;
+
+  // Orders pattern ids by urgency: CLEAR 0 .. CRITICAL 3
+  static int severity(int pattern);
+
+  // Feed the latest distance; returns true if the stable pattern changed
+  // and should be sent immediately
+  bool update(int distance);
+
+  int stablePattern() const { return currentStablePattern; }
+
+private:
+  int thresholds[3];
+  int lastPattern = -1;
+  int stableCount = 0;
+  int currentStablePattern = PATTERN_CLEAR;
+};
@@ -0,0 +1,100 @@
+#include "ZoneMap.h"
+#include "DistanceTracker.h"
+#include "StateFrames.h"
+
+uint8_t ZoneMap::zoneCount() const {
+  uint8_t count = sensor.zoneCount();
+  return count > MAX_ZONES ? MAX_ZONES : count;
+}
+
+int ZoneMap::distance() {
+  int raw = sensor.distance();
+  uint8_t z = sensor.zone();
+  if (z < MAX_ZONES) track(z, raw);
+  if (zoneCount() == 1) return raw;
+
+  // A bad reading in one zone must not hide the others
+  int near = nearest(SIDE_ALL);
+  return near > 0 ? near : raw;
+}
+
+void ZoneMap::track(uint8_t z, int raw) {
+  if (raw <= 0 || raw >= DistanceTracker::MAX_RANGE) {
+    readings[z] = -1;
+    speeds[z] = 0;
+    readAt[z] = 0;
+    return;
+  }
+
+  // Same EMA of the range derivative as DistanceTracker, per zone
+  uint32_t now = clock.millis();
+  if (readAt[z] && readings[z] > 0 && now > readAt[z]) {
+    float instant = (readings[z] - raw) * 1000.0f / (now - readAt[z]);
+    speeds[z] += 0.3f * (instant - speeds[z]);
+  }
+  readings[z] = raw;
+  readAt[z] = now ? now : 1;
+}
+
+int ZoneMap::nearestZone(uint8_t sides) const {
+  int best = -1;
+  for (uint8_t z = 0; z < zoneCount(); z++) {
+    if (!(sidesOf(z) & sides) || readings[z] <= 0) continue;
+    if (best < 0 || readings[z] < readings[best]) best = z;
+  }
+  return best;
+}
+
+int ZoneMap::nearest(uint8_t sides) const {
+  int z = nearestZone(sides);
+  return z < 0 ? -1 : readings[z];
+}
+
+uint8_t ZoneMap::sidesOf(uint8_t zone) const {
+  if (zoneCount() == 1) return SIDE_CENTER;
+  switch (zone) {
+    case 0: return SIDE_LEFT;
+    case 1: return SIDE_CENTER;
+    default: return SIDE_RIGHT;
+  }
+}
+
+void ZoneMap::clear() {
+  for (uint8_t z = 0; z < MAX_ZONES; z++) {
+    readings[z] = -1;
+    speeds[z] = 0;
+    readAt[z] = 0;
+  }
+}
+
+uint8_t ZoneMap::roleSides(uint8_t role) {
+  switch (role) {
+    case ROLE_LEFT: return SIDE_LEFT | SIDE_CENTER;
+    case ROLE_RIGHT: return SIDE_RIGHT | SIDE_CENTER;
+    case ROLE_CENTER: return SIDE_CENTER;
+    default: return SIDE_ALL;
+  }
+}
+
+StateFrame ZoneMap::roleFrame(const StateFrame& nearestFrame, uint8_t role,
+                              const ZoneClassifier& zones) const {
+  if (role == ROLE_ALL || (nearestFrame.flags & FLAG_PAUSE) || zoneCount() == 1) {
+    return nearestFrame;
+  }
+
+  int overall = nearest(SIDE_ALL);
+  int sideZone = nearestZone(roleSides(role));
+  if (sideZone < 0) {
+    return makeStateFrame(nearestFrame.tableVersion, PATTERN_CLEAR, DistanceTracker::NO_OBSTACLE, 0);
+  }
+  int side = readings[sideZone];
+  if (side <= overall + SAME_OBSTACLE_MM) return nearestFrame;
+
+  // Another side is closer: this side's own zone, undebounced, so it
+  // may lag but never lead the nearest obstacle's pattern
+  int pattern = zones.classify(side);
+  if (ZoneClassifier::severity(pattern) > ZoneClassifier::severity(nearestFrame.pattern)) {
+    pattern = nearestFrame.pattern;
+  }
+  return makeStateFrame(nearestFrame.tableVersion, pattern, side, speeds[sideZone]);
+}
@@ -0,0 +1,80 @@
+/*
+ * ============================================
+ * VisionAssist - Multi-Zone Obstacle Map
+ * ============================================
+ *
+ * Sits between the TOF sensor and NavigationController.
+ * Keeps the latest reading of every zone the sensor sweeps
+ * and reports the nearest one as its own distance, so the
+ * tracker and classifier keep working on "the closest
+ * obstacle" whatever the zone count.
+ *
+ * roleFrame() turns the nearest-obstacle state frame into
+ * the cue for one band: a band that sees the nearest
+ * obstacle on its side gets the frame unchanged, the other
+ * bands get their own side's zone (never more urgent than
+ * the debounced nearest zone) with that zone's own
+ * closing speed, so the band's dead reckoning can still
+ * extrapolate. With a single-zone sensor every band gets
+ * the nearest frame.
+ * ============================================
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <Hal.h>
+#include <VisionAssistProtocol.h>
+#include "ZoneClassifier.h"
+
+class ZoneMap : public hal::Tof {
+public:
+  static const uint8_t MAX_ZONES = 3;
+
+  // Sides of the field of view, as a bit mask
+  static const uint8_t SIDE_LEFT = 0x01;
+  static const uint8_t SIDE_CENTER = 0x02;
+  static const uint8_t SIDE_RIGHT = 0x04;
+  static const uint8_t SIDE_ALL = 0x07;
+
+  // Readings this much further than the nearest zone still
+  // count as the same obstacle (e.g. a wall across two zones)
+  static const int SAME_OBSTACLE_MM = 150;
+
+  ZoneMap(hal::Tof& sensor, hal::Clock& clock) : sensor(sensor), clock(clock) {}
+
+  // hal::Tof: forwards to the sensor, distance() is the nearest zone
+  bool dataReady() override { return sensor.dataReady(); }
+  int distance() override;
+  void clearInterrupt() override { sensor.clearInterrupt(); }
+  uint8_t zoneCount() const override;
+  uint8_t zone() const override { return sensor.zone(); }
+
+  // Latest good reading of the zones on `sides`, -1 if none
+  int nearest(uint8_t sides) const;
+  int zoneDistance(uint8_t zone) const { return zone < MAX_ZONES ? readings[zone] : -1; }
+  // mm/s, positive = approaching, 0 until the zone has two good readings
+  float zoneSpeed(uint8_t zone) const { return zone < MAX_ZONES ? speeds[zone] : 0; }
+  uint8_t sidesOf(uint8_t zone) const;
+  // Forget every zone's reading, after the sensor's zone count changed
+  void clear();
+
+  // The sides a band with `role` reports
+  static uint8_t roleSides(uint8_t role);
+
+  // Cue for one band from the nearest-obstacle frame
+  StateFrame roleFrame(const StateFrame& nearestFrame, uint8_t role,
+                       const ZoneClassifier& zones) const;
+
+private:
+  // Store a zone's reading and update its closing speed
+  void track(uint8_t zone, int raw);
+  // Zone holding the nearest good reading on `sides`, -1 if none
+  int nearestZone(uint8_t sides) const;
+
+  hal::Tof& sensor;
+  hal::Clock& clock;
+  int readings[MAX_ZONES] = { -1, -1, -1 };
+  float speeds[MAX_ZONES] = { 0, 0, 0 };
+  uint32_t readAt[MAX_ZONES] = { 0, 0, 0 };   // ms of the last good reading, 0 = none
+};
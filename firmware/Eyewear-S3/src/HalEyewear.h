@@ -0,0 +1,185 @@
+/*
+ * ============================================
+ * VisionAssist - Eyewear HAL bindings
+ * ============================================
+ *
+ * VL53L1X, OV2640 and HTTPClient behind the interfaces
+ * in Hal.h.
+ * ============================================
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <HTTPClient.h>
+#include <Adafruit_VL53L1X.h>
+#include "esp_camera.h"
+#include <Hal.h>
+
+namespace hal {
+
+// With 3 zones the 16x16 SPAD array is read as three 5x16
+// strips, one per ranging. The next strip is selected before
+// the interrupt is cleared so the following ranging uses it.
+class Vl53Tof : public Tof {
+public:
+  explicit Vl53Tof(Adafruit_VL53L1X& sensor) : vl53(sensor) {}
+
+  // After startRanging(); 1 = full field of view, 3 = left / centre / right
+  void setZones(uint8_t count) {
+    zones = count == 3 ? 3 : 1;
+    current = 0;
+    if (zones == 1) {
+      vl53.VL53L1X_SetROI(16, 16);
+      vl53.VL53L1X_SetROICenter(ROI_CENTRE);
+    } else {
+      vl53.VL53L1X_SetROI(5, 16);
+      vl53.VL53L1X_SetROICenter(stripCentre(0));
+    }
+  }
+
+  bool dataReady() override { return vl53.dataReady(); }
+  int distance() override { return vl53.distance(); }
+  void clearInterrupt() override {
+    if (zones > 1) {
+      current = (current + 1) % zones;
+      vl53.VL53L1X_SetROICenter(stripCentre(current));
+    }
+    vl53.clearInterrupt();
+  }
+  uint8_t zoneCount() const override { return zones; }
+  uint8_t zone() const override { return current; }
+
+private:
+  // SPAD numbers of the ROI centres (row 7; columns 13, 8, 2).
+  // The receiver lens mirrors the scene, so the strip on the
+  // array's right looks left. Swap the outer two if the sensor
+  // is mounted upside down.
+  static const uint8_t ROI_CENTRE = 199;
+  static uint8_t stripCentre(uint8_t zone) {
+    static const uint8_t CENTRES[3] = { 239, 199, 151 };
+    return CENTRES[zone];
+  }
+
+  Adafruit_VL53L1X& vl53;
+  uint8_t zones = 1;
+  uint8_t current = 0;
+};
+
+class Esp32Camera : public Camera {
+public:
+  bool capture(Frame& frame) override {
+    camera_fb_t* fb = esp_camera_fb_get();
+    if (!fb) return false;
+    frame.buf = fb->buf;
+    frame.len = fb->len;
+    frame.width = fb->width;
+    frame.height = fb->height;
+    frame.ms = fb->timestamp.tv_sec * 1000 + fb->timestamp.tv_usec / 1000;   // esp_timer based
+    frame.handle = fb;
+    return true;
+  }
+
+  void release(Frame& frame) override {
+    if (frame.handle) esp_camera_fb_return((camera_fb_t*)frame.handle);
+    frame = Frame();
+  }
+
+  // Takes effect a frame or two later (register latch + queued buffer)
+  bool setExposure(uint16_t lines, uint8_t gain) override {
+    sensor_t* s = esp_camera_sensor_get();
+    if (!s || !s->set_aec_value || !s->set_agc_gain) return false;
+    s->set_exposure_ctrl(s, 0);
+    s->set_aec2(s, 0);
+    s->set_aec_value(s, lines);
+    s->set_gain_ctrl(s, 0);
+    s->set_agc_gain(s, gain);
+    return true;
+  }
+
+  void autoExposure() override {
+    sensor_t* s = esp_camera_sensor_get();
+    if (!s) return;
+    s->set_exposure_ctrl(s, 1);
+    s->set_gain_ctrl(s, 1);
+  }
+
+  // OV2640 COM2 (sensor bank 0x09) bit 4: array and ADC off, ~1 mA.
+  // The driver keeps its last frame, so the first one after waking is stale.
+  bool setStandby(bool standby) override {
+    sensor_t* s = esp_camera_sensor_get();
+    if (!s || !s->set_reg || s->id.PID != OV2640_PID) return false;
+    return s->set_reg(s, 0x100 | 0x09, 0x10, standby ? 0x10 : 0) == 0;
+  }
+};
+
+// available() waits for the next TCP segment while the server is
+// still sending, so a slow download is not mistaken for its end
+class WiFiClientStream : public ByteStream {
+public:
+  static const uint32_t IDLE_TIMEOUT = 5000;
+
+  void attach(WiFiClient* client) { stream = client; }
+
+  int available() override {
+    if (!stream) return 0;
+    uint32_t start = millis();
+    int n;
+    while ((n = stream->available()) == 0 && stream->connected() && millis() - start < IDLE_TIMEOUT) {
+      delay(1);
+    }
+    return n;
+  }
+
+  int read() override { return stream ? stream->read() : -1; }
+
+private:
+  WiFiClient* stream = nullptr;
+};
+
+class ArduinoHttp : public Http {
+public:
+  static const uint32_t CONNECT_TIMEOUT = 5000;
+
+  // keepAlive: HTTP/1.1 and the connection is reused between posts to
+  // the same host (plain HTTP OCR gateway); the response must then be
+  // read to Content-Length, since the server will not close it
+  explicit ArduinoHttp(uint32_t timeoutMs = 30000, bool keepAlive = false)
+    : timeout(timeoutMs), keepAlive(keepAlive) {}
+
+  int post(const char* url, const char* contentType, const uint8_t* body, size_t len) override {
+    http.begin(url);
+    http.setReuse(keepAlive);
+    // Otherwise a plain body (no chunked encoding) and the server closes
+    // when done: the response is read straight off the socket
+    http.useHTTP10(!keepAlive);
+    http.addHeader("Content-Type", contentType);
+    http.setTimeout(timeout > 65535 ? 65535 : timeout);
+    http.setConnectTimeout(timeout > CONNECT_TIMEOUT ? CONNECT_TIMEOUT : timeout);
+    int code = http.POST((uint8_t*)body, len);
+    if (code > 0) stream.attach(http.getStreamPtr());
+    return code;
+  }
+
+  ByteStream* responseStream() override { return &stream; }
+  int responseSize() override { return http.getSize(); }
+  void setTimeout(uint32_t ms) override { timeout = ms; }
+
+  void end() override {
+    stream.attach(nullptr);
+    http.end();
+  }
+
+  void abort() override {
+    http.setReuse(false);
+    end();
+  }
+
+private:
+  HTTPClient http;
+  WiFiClientStream stream;
+  uint32_t timeout;
+  bool keepAlive;
+};
+
+}  // namespace hal
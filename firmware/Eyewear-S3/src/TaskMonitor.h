@@ -0,0 +1,87 @@
+/*
+ * ============================================
+ * VisionAssist - Task Monitor (Eyewear)
+ * ============================================
+ *
+ * Per-task busy time and stack high-water marks. Each task
+ * brackets its work with begin()/end(); busy time is the
+ * time between those calls, so it includes blocking I/O
+ * done inside the work (e.g. the OCR HTTP request).
+ * Stack figures are bytes (ESP-IDF FreeRTOS convention).
+ * ============================================
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <esp_timer.h>
+
+class TaskMonitor {
+public:
+    static const int MAX_TASKS = 8;
+
+    // Register a task under a fixed slot (0..MAX_TASKS-1)
+    void add(int slot, const char* name, TaskHandle_t handle, uint32_t stackBytes, int core, int priority) {
+        if (slot < 0 || slot >= MAX_TASKS) return;
+        Entry& e = tasks[slot];
+        e.name = name;
+        e.handle = handle;
+        e.stackBytes = stackBytes;
+        e.core = core;
+        e.priority = priority;
+        if (slot >= count) count = slot + 1;
+        if (windowStart == 0) windowStart = esp_timer_get_time();
+    }
+
+    void begin(int slot) {
+        if (slot >= 0) tasks[slot].started = esp_timer_get_time();
+    }
+
+    void end(int slot) {
+        if (slot < 0) return;
+        Entry& e = tasks[slot];
+        uint32_t us = (uint32_t)(esp_timer_get_time() - e.started);
+        e.busyUs += us;
+        e.runs++;
+        if (us > e.worstUs) e.worstUs = us;
+    }
+
+    // Busy %, worst single run and free stack since the last reset
+    void report(Print& out, bool reset) {
+        int64_t now = esp_timer_get_time();
+        float window = (now - windowStart) / 1e6f;
+        out.printf("── Tasks (%.1f s) ──\n", window);
+        for (int i = 0; i < count; i++) {
+            Entry& e = tasks[i];
+            if (!e.handle) continue;
+            uint32_t freeStack = uxTaskGetStackHighWaterMark(e.handle);
+            float busy = window > 0 ? e.busyUs / (window * 1e4f) : 0;
+            out.printf("%-8s core%d p%d  busy %5.1f%%  runs %6u  worst %7u us  stack free %5u/%u\n",
+                       e.name, e.core, e.priority, busy, e.runs, e.worstUs,
+                       freeStack, e.stackBytes);
+            if (reset) {
+                e.busyUs = 0;
+                e.runs = 0;
+                e.worstUs = 0;
+            }
+        }
+        if (reset) windowStart = now;
+    }
+
+private:
+    struct Entry {
+        const char* name = "";
+        TaskHandle_t handle = NULL;
+        uint32_t stackBytes = 0;
+        int core = 0;
+        int priority = 0;
+        int64_t started = 0;
+        uint64_t busyUs = 0;
+        uint32_t runs = 0;
+        uint32_t worstUs = 0;
+    };
+
+    Entry tasks[MAX_TASKS];
+    int count = 0;
+    int64_t windowStart = 0;
+};
@@ -0,0 +1,50 @@
+/*
+ * ============================================
+ * VisionAssist - Eyewear host runner
+ * ============================================
+ *
+ * Runs the navigation path (TOF polling, smoothing, zone
+ * classification, state frames) on a PC against a TOF
+ * trace, using the HAL fakes and a virtual clock.
+ *
+ * Input  (stdin):  one "ms,mm" TOF sample per line
+ * Output (stdout): "ms,pattern,intensity,distance,closingSpeed,flags"
+ *                  for every state frame sent - the handband
+ *                  runner reads this format.
+ * ============================================
+ */
+
+#include <stdio.h>
+
+#include <HalHost.h>
+#include <NavigationController.h>
+
+static const uint32_t LOOP_INTERVAL = 5;     // ms per loop() iteration
+
+int main() {
+  hal::VirtualClock clock;
+  hal::ScriptedTof tof;
+  NavigationController nav;
+
+  unsigned long sampleMs = 0;
+  int sampleMm = 0;
+  bool haveSample = scanf("%lu,%d", &sampleMs, &sampleMm) == 2;
+  nav.reset(0);
+
+  while (haveSample) {
+    uint32_t now = clock.millis();
+
+    while (haveSample && sampleMs <= now) {
+      tof.push(sampleMm);
+      haveSample = scanf("%lu,%d", &sampleMs, &sampleMm) == 2;
+    }
+
+    StateFrame f;
+    if (nav.step(now, &tof, false, 1, f)) {
+      printf("%u,%u,%u,%d,%d,%u\n", now, f.pattern, f.intensity, f.distance, f.closingSpeed, f.flags);
+    }
+
+    clock.delay(LOOP_INTERVAL);
+  }
+  return 0;
+}
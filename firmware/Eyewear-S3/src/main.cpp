@@ -8,22 +8,56 @@
  *   - OV2640 Camera for OCR
  *   - VL53L1X TOF Sensor for distance
  *   - Touch sensor for triggering OCR
- *   - ESP-NOW for communication with handband
- *   - Web interface with TTS
+ *   - ESP-NOW to one or more paired handbands, each with its own
+ *     directional cue (left / right / centre from a 3-zone TOF sweep)
+ *   - Web interface with TTS (OCR text spoken sentence by sentence as it arrives)
+ *   - OCR via Google Cloud Vision or a LAN gateway (Host-Tools/ocr_gateway),
+ *     with deadlines, retries and latest-request-wins cancellation
+ *   - FreeRTOS tasks: safety path on core 1, OCR / web on core 0
+ *   - Deferred binary trace (decode with Host-Tools/trace_decode)
+ *   - Prometheus-style /metrics (timing, heap, radio, OCR, HTTP)
  * 
  * License: MIT
  * ============================================
  */
 
 #include <Arduino.h>
+#include <atomic>
+#include <vector>
 #include "esp_camera.h"
 #include <WiFi.h>
 #include <WebServer.h>
 #include <HTTPClient.h>
-#include <mbedtls/base64.h>
 #include <Wire.h>
 #include <Adafruit_VL53L1X.h>
 #include <esp_now.h>
+#include <Preferences.h>
+#include <esp_wifi.h>
+#include <esp_heap_caps.h>
+#include <StreamString.h>
+#include <VisionAssistProtocol.h>
+#include <HalArduino.h>
+#include "HalEyewear.h"
+#include "TaskMonitor.h"
+#include <Trace.h>
+#include <Metrics.h>
+#include <NavigationController.h>
+#include <StateFrames.h>
+#include <ZoneMap.h>
+#include <PeerTable.h>
+#include <OcrText.h>
+#include <OcrChunks.h>
+#include <OcrBackend.h>
+#include <OcrScheduler.h>
+#include <ExposureController.h>
+#include <TextPresence.h>
+#include <FlightRecorder.h>
+#include <DistanceHistory.h>
+#include <OcrHistory.h>
+#include <OcrConsensus.h>
+#include <PowerManager.h>
+#include <Arena.h>
+#include <WebJson.h>
 
 // ===========================================
 // WiFi Credentials - CHANGE THESE!
@@ -36,6 +70,13 @@ const char* password = "YOUR_WIFI_PASSWORD";
 // ===========================================
 const char* apiKey = "YOUR_GOOGLE_CLOUD_VISION_API_KEY";
 
+// ===========================================
+// OCR Gateway (optional) - CHANGE THIS!
+// ===========================================
+// PC on the same network running Host-Tools/ocr_gateway; pick the
+// "gateway" backend in the web UI to use it. Plain http:// only.
+const char* gatewayUrl = "http://192.168.1.100:8088/ocr";
+
 // ===========================================
 // Touch Sensor Pin
 // ===========================================
@@ -47,13 +88,6 @@ const char* apiKey = "YOUR_GOOGLE_CLOUD_VISION_API_KEY";
 #define I2C_SDA 5
 #define I2C_SCL 6
 
-// ===========================================
-// Distance Thresholds (mm)
-// ===========================================
-#define CRITICAL_DISTANCE 1300
-#define WARNING_DISTANCE 1600
-#define CAUTION_DISTANCE 2000
-
 // ===========================================
 // Camera Pins
 // ===========================================
@@ -75,19 +109,44 @@ const char* apiKey = "YOUR_GOOGLE_CLOUD_VISION_API_KEY";
 #define PCLK_GPIO_NUM     13
 
 // ===========================================
-// ESP-NOW Setup - CHANGE MAC ADDRESS!
+// ESP-NOW Peers (handbands)
 // ===========================================
-// Replace with your ESP32-C3's MAC address or Broadcast address
-uint8_t broadcastAddress[] = {0x88, 0x56, 0xA6, 0x64, 0x21, 0x6C};
+// Bands pair themselves while the pairing window is open: for
+// PeerTable::PAIR_WINDOW ms after boot and after "Pair" in the web UI.
+// Paired bands are kept in NVS.
+PeerTable peers;
+portMUX_TYPE peerMux = portMUX_INITIALIZER_UNLOCKED;  // safety / web task and ESP-NOW callbacks
+std::atomic<bool> peersDirty(false);                   // save to NVS from loop()
+
+// Pair requests queued by the receive callback and answered by the
+// safety task: adding a peer and sending from the WiFi task stalls it.
+// Full = dropped, the band keeps asking until it is acknowledged.
+struct PairRequest {
+    uint8_t mac[6];
+    uint8_t role;
+};
+PairRequest pairRequests[PeerTable::MAX_PEERS];  // guarded by peerMux
+uint8_t pairRequestCount = 0;
+
+// Zones swept while a left / right / centre band is paired; otherwise
+// the sensor reads its full field of view, every band gets the nearest
+// obstacle. With 3, left and right bands only buzz for their side, but
+// each strip is read every third ranging: an obstacle in one strip
+// takes up to 150 ms instead of 50 ms to show up, and a 5x16 strip
+// sees less than the full array. 1 = never sweep.
+#define TOF_ZONES 3
 
-typedef struct {
-  char command[32];
-  int distance;
-  int pattern;
-} Message;
+uint8_t beaconAddress[] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+#define BEACON_INTERVAL 250
 
-Message outgoingData;
-esp_now_peer_info_t peerInfo;
+// ===========================================
+// Haptic Pattern Table (tunable from web UI)
+// ===========================================
+PatternDesc patternTable[MAX_PATTERNS];
+uint8_t patternTableVersion = 1;
+portMUX_TYPE tableMux = portMUX_INITIALIZER_UNLOCKED;  // web task writes, safety task sends
+std::atomic<bool> patternTableRequested(false);       // send from the safety task
+Preferences prefs;
 
 // ===========================================
 // Globals
@@ -95,40 +154,276 @@ esp_now_peer_info_t peerInfo;
 WebServer server(80);
 Adafruit_VL53L1X vl53 = Adafruit_VL53L1X();
 
+hal::ArduinoClock sysClock;
+hal::ArduinoGpio gpio;
+hal::EspNowRadio radio;
+hal::Vl53Tof tof(vl53);
+FlightRecorder flight;            // last minutes of the alert path, /flight
+FlightTof flightTof(tof, flight);
+ZoneMap zoneMap(flightTof, sysClock);
+hal::Esp32Camera camera;
+
 uint32_t imageCount = 0;
-String lastOcrText = "No text detected yet";
+String lastOcrText = "No text detected yet";  // guarded by ocrTextMutex
+SemaphoreHandle_t ocrTextMutex;
+OcrHistory ocrHistory;                        // guarded by ocrTextMutex, /ocr/history
+std::atomic<uint8_t> ocrHistoryPending(0);    // entries not in NVS yet, saved from loop()
+unsigned long lastOcrHistorySave = 0;
 bool sensorReady = false;
 
+// Set by the startup tasks once camera / WiFi come up
+volatile bool cameraReady = false;
+volatile bool wifiReady = false;
+uint8_t savedWiFiChannel = 0;
+
 // ESP-NOW status
 unsigned long lastSendSuccess = 0;
 unsigned long lastSendFail = 0;
 int sendSuccessCount = 0;
 int sendFailCount = 0;
 
-// TOF smoothing
-int goodReadings[5] = {5000, 5000, 5000, 5000, 5000};
-int readIndex = 0;
-int smoothedDistance = 5000;
-unsigned long lastGoodReading = 0;
-int lastPattern = -1;
-int stableCount = 0;
-int currentStablePattern = 0;
+// TOF smoothing + zone classification (safety task only)
+NavigationController nav;
 unsigned long lastPrint = 0;
 
+// Published by the safety task for loop() and the web handlers
+std::atomic<int> navDistance(DistanceTracker::NO_OBSTACLE);
+std::atomic<int> navPattern(PATTERN_CLEAR);
+
+// Last 10 s / 10 min of distance and zone for /history (safety task adds)
+DistanceHistory history;
+portMUX_TYPE historyMux = portMUX_INITIALIZER_UNLOCKED;
+
 // ===========================================
 // Touch Sensor & TTS State
 // ===========================================
-bool touchTriggered = false;
-bool ocrInProgress = false;
-bool newOcrAvailable = false;
-bool ttsSpeaking = false;
-bool distancePaused = false;
+std::atomic<bool> readingMode(false);     // vibration paused while text is read / spoken
+std::atomic<bool> newOcrAvailable(false);
+std::atomic<uint32_t> readingSince(0);
+std::atomic<uint32_t> autoResumeAt(0);    // 0 = wait for /tts_done
 unsigned long lastTouchTime = 0;
-unsigned long ttsStartTime = 0;
+
+// Touch runs publish their text chunk by chunk (guarded by ocrTextMutex)
+OcrChunkLog ocrChunks;
+std::atomic<uint32_t> ocrRun(0);
+std::atomic<uint32_t> ocrRunStarted(0);
+std::atomic<bool> firstWordPending(false);   // waiting for the UI's /tts_started
+
+// Sign / page / auto, set from the web UI (saved in NVS)
+std::atomic<uint8_t> ocrMode(OCR_MODE_AUTO);
+size_t lastUsefulTextLen = 0;   // OCR task only
+
+// Frames per read: 1 = one shot, 2-3 = a burst in one Vision request,
+// the text they agree on wins (set from the web UI, saved in NVS;
+// the gateway always gets one frame)
+#define OCR_BURST_MAX 3
+std::atomic<uint8_t> ocrBurst(1);
+
+// ===========================================
+// OCR Backends
+// ===========================================
+// Used by the OCR task only; the gateway connection is kept open
+// between runs
+hal::ArduinoHttp visionHttp(30000);
+hal::ArduinoHttp gatewayHttp(15000, true);
+VisionBackend visionBackend(sysClock, visionHttp, apiKey);
+GatewayBackend gatewayBackend(sysClock, gatewayHttp, gatewayUrl);
+
+enum OcrBackendId : uint8_t { BACKEND_VISION, BACKEND_GATEWAY, OCR_BACKENDS };
+OcrBackend* const ocrBackends[OCR_BACKENDS] = { &visionBackend, &gatewayBackend };
+std::atomic<uint8_t> ocrBackend(BACKEND_VISION);   // set from the web UI (saved in NVS)
 #define TOUCH_DEBOUNCE 1000
+#define OCR_TOUCH_DEADLINE 15000   // touch to text, retries included
+#define OCR_WEB_DEADLINE 20000
 #define TTS_TIMEOUT 60000
-unsigned long autoResumeTime = 0;
 #define NO_TEXT_RESUME_DELAY 2500
+#define NO_TEXT_LOCAL_RESUME_DELAY 1000   // text gate skip: time to say "No text detected"
+
+// The OCR shot is exposed for the text, not the whole scene: exposure
+// and gain are set from the JPEG's block levels (ExposureController)
+// over a few frames, then the sensor's AEC takes over again
+#define OCR_EXPOSURE_CONTROL 1
+#define EXPOSURE_SETTLE_FRAMES 2   // dropped after each change
+ExposureController exposureCtl;   // OCR task only
+
+// A shot with no text in it (no strokes along lines, TextPresence) is
+// answered "No text detected" at once, without the OCR backend
+#define OCR_TEXT_GATE 1
+TextPresenceDetector textGate;    // OCR task only
+
+// ===========================================
+// Power Management
+// ===========================================
+// Camera standby and WiFi modem sleep while idle (PowerManager).
+// A touch wakes the camera first thing in the OCR run.
+#define POWER_SAVE 1
+#define CAMERA_IDLE_MS 5000       // standby after the last OCR run / capture
+#define RADIO_IDLE_MS 3000        // modem sleep after the last web request
+#define CAMERA_WAKE_FRAMES 4      // frames dropped at most until a fresh one
+PowerManager power;               // guarded by powerMutex
+SemaphoreHandle_t powerMutex;
+
+// ===========================================
+// Tasks
+// ===========================================
+// Core 1: safety (TOF -> zones -> ESP-NOW) above loop() housekeeping
+// Core 0: OCR worker and web server, next to the WiFi stack
+#define SAFETY_PERIOD_MS 5
+#define SAFETY_PRIORITY 5
+#define SAFETY_STACK 4096
+#define OCR_PRIORITY 2
+#define OCR_STACK 12288
+#define WEB_PRIORITY 1
+#define WEB_STACK 8192
+#define WEB_POLL_MS 5
+#define OCR_REPLY_MARGIN 2000     // /ocr waits this long past the deadline
+#define TRACE_PRIORITY 1
+#define TRACE_STACK 3072
+#define TRACE_DRAIN_MS 20
+#define TASK_REPORT_INTERVAL 30000
+
+enum TaskSlot { SLOT_SAFETY, SLOT_LOOP, SLOT_OCR, SLOT_WEB, SLOT_TRACE };
+enum OcrSource : uint8_t { OCR_TOUCH, OCR_WEB };
+
+// A newer request overwrites a queued one and cancels a running one
+struct OcrReply {
+    uint32_t id;
+    OcrOutcome outcome;
+    bool captured;
+};
+
+TaskMonitor monitor;
+OcrScheduler scheduler(sysClock);
+QueueHandle_t ocrRequests;   // OcrRequest, newest only
+QueueHandle_t ocrReplies;    // OcrReply, answers OCR_WEB
+
+// ===========================================
+// OCR Arena (PSRAM)
+// ===========================================
+// Request JSON and response text for one OCR run; reset after each
+// run so these never fragment the internal heap. A JPEG of N bytes
+// needs ~1.34 N here.
+#define OCR_ARENA_BYTES (256 * 1024)
+Arena ocrArena;   // OCR task only
+
+// Flight recorder ring, ~7 minutes with two bands (off without PSRAM)
+#define FLIGHT_RECORDER_BYTES (256 * 1024)
+#define FLIGHT_CHUNK_RECORDS 128   // per sendContent() of /flight
+
+// Past OCR results for /ocr/history and "Repeat" (64 KB holds ~250
+// readings; 8 KB from the heap without PSRAM). The newest that fit in
+// OCR_HISTORY_SAVE_BYTES are kept in NVS; 0 = RAM only. Each save
+// rewrites the whole blob (flash wear, cache off while it erases), so
+// new entries are saved once OCR_HISTORY_SAVE_ENTRIES are pending or
+// OCR_HISTORY_SAVE_INTERVAL after the last save: a power cut loses
+// at most that much.
+#define OCR_HISTORY_BYTES (64 * 1024)
+#define OCR_HISTORY_HEAP_BYTES (8 * 1024)
+#define OCR_HISTORY_SAVE_BYTES 2048
+#define OCR_HISTORY_SAVE_ENTRIES 5
+#define OCR_HISTORY_SAVE_INTERVAL (5 * 60 * 1000UL)
+#define OCR_HISTORY_PAGE_MAX 20
+
+// ===========================================
+// Metrics (/metrics)
+// ===========================================
+// Always on: an update is an atomic add or a short bucket scan
+#define COUNT_OF(a) (sizeof(a) / sizeof((a)[0]))
+#define MAX_ROUTES 24
+
+const uint32_t LOOP_BUCKETS_US[] = { 50, 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000 };
+const uint32_t OCR_BUCKETS_MS[] = { 50, 100, 250, 500, 1000, 2000, 3000, 5000, 10000, 20000, 30000 };
+const uint32_t HTTP_BUCKETS_MS[] = { 1, 5, 10, 25, 50, 100, 250, 1000, 5000, 30000 };
+
+Histogram safetyLoopUs(LOOP_BUCKETS_US, COUNT_OF(LOOP_BUCKETS_US));   // work per safety tick
+Histogram safetyLateUs(LOOP_BUCKETS_US, COUNT_OF(LOOP_BUCKETS_US));   // wake-up past the 5 ms period
+Histogram mainLoopUs(LOOP_BUCKETS_US, COUNT_OF(LOOP_BUCKETS_US));
+Counter espNowSendErrors;   // esp_now_send() refused the frame
+Counter stateFramesSent;
+
+// download = reading + parsing the response body after the headers
+enum OcrStage { STAGE_CAPTURE, STAGE_ENCODE, STAGE_HTTP, STAGE_DOWNLOAD, STAGE_FIRST_CHUNK, STAGE_TOTAL, OCR_STAGES };
+const char* const OCR_STAGE_LABELS[OCR_STAGES] = {
+    "stage=\"capture\"", "stage=\"encode\"", "stage=\"http\"", "stage=\"download\"", "stage=\"first_chunk\"",
+    "stage=\"total\""
+};
+Histogram ocrStageMs[OCR_STAGES] = {
+    Histogram(OCR_BUCKETS_MS, COUNT_OF(OCR_BUCKETS_MS)),
+    Histogram(OCR_BUCKETS_MS, COUNT_OF(OCR_BUCKETS_MS)),
+    Histogram(OCR_BUCKETS_MS, COUNT_OF(OCR_BUCKETS_MS)),
+    Histogram(OCR_BUCKETS_MS, COUNT_OF(OCR_BUCKETS_MS)),
+    Histogram(OCR_BUCKETS_MS, COUNT_OF(OCR_BUCKETS_MS)),
+    Histogram(OCR_BUCKETS_MS, COUNT_OF(OCR_BUCKETS_MS)),
+};
+
+const char* const OCR_OUTCOME_LABELS[OCR_OUTCOMES] = {
+    "outcome=\"completed\"", "outcome=\"failed\"", "outcome=\"cancelled\"", "outcome=\"deadline_missed\""
+};
+
+enum OcrResult {
+    RESULT_TEXT, RESULT_NO_TEXT, RESULT_API_ERROR, RESULT_NO_KEY, RESULT_CAPTURE_FAILED, RESULT_NO_TEXT_LOCAL,
+    OCR_RESULTS
+};
+const char* const OCR_RESULT_LABELS[OCR_RESULTS] = {
+    "result=\"text\"", "result=\"no_text\"", "result=\"api_error\"", "result=\"no_key\"",
+    "result=\"capture_failed\"", "result=\"no_text_local\""
+};
+Counter ocrResults[OCR_RESULTS];
+Histogram firstWordMs(OCR_BUCKETS_MS, COUNT_OF(OCR_BUCKETS_MS));   // touch to first spoken word
+
+const uint32_t RESPONSE_BUCKETS[] = { 512, 1024, 2048, 4096, 8192, 16384, 32768, 65536, 131072, 262144, 524288 };
+Histogram ocrResponseBytes(RESPONSE_BUCKETS, COUNT_OF(RESPONSE_BUCKETS));
+const char* const OCR_FEATURE_LABELS[] = { "feature=\"text\"", "feature=\"document\"" };
+Counter ocrFeatures[2];   // by OcrFeature
+
+// Per burst size: reads, reads with useful text, and touch-to-text time
+const char* const BURST_LABELS[OCR_BURST_MAX] = { "frames=\"1\"", "frames=\"2\"", "frames=\"3\"" };
+Counter ocrReads[OCR_BURST_MAX];
+Counter ocrReadsUseful[OCR_BURST_MAX];
+Histogram ocrReadMs[OCR_BURST_MAX] = {
+    Histogram(OCR_BUCKETS_MS, COUNT_OF(OCR_BUCKETS_MS)),
+    Histogram(OCR_BUCKETS_MS, COUNT_OF(OCR_BUCKETS_MS)),
+    Histogram(OCR_BUCKETS_MS, COUNT_OF(OCR_BUCKETS_MS)),
+};
+
+// OCR shot exposure: time spent, how it ended, and how often each
+// ending still gave useful text
+const char* const EXPOSURE_RESULT_LABELS[ExposureController::EXPOSURE_RESULTS] = {
+    "result=\"adjust\"", "result=\"converged\"", "result=\"limit\"", "result=\"unsettled\""
+};
+Histogram exposureMs(OCR_BUCKETS_MS, COUNT_OF(OCR_BUCKETS_MS));
+
+// Text presence check on the OCR shot
+const uint32_t TEXT_GATE_BUCKETS_MS[] = { 5, 10, 20, 30, 50, 75, 100, 200 };
+Histogram textGateMs(TEXT_GATE_BUCKETS_MS, COUNT_OF(TEXT_GATE_BUCKETS_MS));
+Counter exposureResults[ExposureController::EXPOSURE_RESULTS];
+Counter exposureUseful[ExposureController::EXPOSURE_RESULTS];
+
+// Power: standby to first fresh frame, and duty per subsystem
+const uint32_t WAKE_BUCKETS_MS[] = { 20, 50, 100, 150, 200, 300, 500, 1000, 2000 };
+Histogram cameraWakeMs(WAKE_BUCKETS_MS, COUNT_OF(WAKE_BUCKETS_MS));
+const char* const POWER_LABELS[POWER_SUBSYSTEMS] = { "subsystem=\"camera\"", "subsystem=\"radio\"" };
+
+// End-to-end by backend, to compare Vision with the gateway
+const char* const OCR_BACKEND_LABELS[OCR_BACKENDS] = { "backend=\"vision\"", "backend=\"gateway\"" };
+Histogram ocrBackendMs[OCR_BACKENDS] = {
+    Histogram(OCR_BUCKETS_MS, COUNT_OF(OCR_BUCKETS_MS)),
+    Histogram(OCR_BUCKETS_MS, COUNT_OF(OCR_BUCKETS_MS)),
+};
+Histogram ocrRequestBytes[OCR_BACKENDS] = {
+    Histogram(RESPONSE_BUCKETS, COUNT_OF(RESPONSE_BUCKETS)),
+    Histogram(RESPONSE_BUCKETS, COUNT_OF(RESPONSE_BUCKETS)),
+};
+
+// Filled by route() during setup, read-only afterwards
+struct RouteStats {
+    const char* path = "";
+    WebServer::THandlerFunction handler;
+    Counter requests;
+    Histogram latencyMs{ HTTP_BUCKETS_MS, COUNT_OF(HTTP_BUCKETS_MS) };
+};
+RouteStats routeStats[MAX_ROUTES];
+int routeCount = 0;
 
 // ===========================================
 // HTML Interface with TTS + Touch Support
@@ -181,6 +476,9 @@ const char index_html[] PROGMEM = R"rawliteral(
          <span id="distance">---</span> mm
         <br>
         <span id="alert" style="font-size: 16px;">---</span>
+        <br>
+        <canvas id="history" width="560" height="80" style="width: 100%; margin-top: 10px; cursor: pointer;" onclick="toggleHistory()"></canvas>
+        <div style="font-size: 12px; color: #888;" id="historyLabel">last 10 s (tap for 10 min)</div>
     </div>
     
     <img id="camera" src="/capture" onclick="enableTTS()" />
@@ -188,17 +486,60 @@ const char index_html[] PROGMEM = R"rawliteral(
     <div class="controls">
         <button class="btn" onclick="runOCR()"> Read Text</button>
         <button class="btn btn-speak" onclick="speakText()"> Speak</button>
+        <button class="btn btn-speak" onclick="repeatPrevious()"> Previous</button>
         <button class="btn btn-stop" onclick="stopSpeech()"> Stop</button>
+        <div>
+            Text type
+            <select id="ocrMode" onchange="setOcrMode(this.value)">
+                <option value="auto">Auto</option>
+                <option value="sign">Sign / label</option>
+                <option value="page">Page / document</option>
+            </select>
+            &nbsp; Frames
+            <select id="ocrBurst" onchange="setOcrMode(null, this.value)">
+                <option value="1">1</option>
+                <option value="2">2 (burst)</option>
+                <option value="3">3 (burst)</option>
+            </select>
+            &nbsp; OCR
+            <select id="ocrBackend" onchange="setOcrBackend(this.value)">
+                <option value="vision">Cloud Vision</option>
+                <option value="gateway">LAN gateway</option>
+            </select>
+        </div>
     </div>
     
     <h3 style="margin-bottom: 10px;">Detected Text:</h3>
     <div class="ocr-box" id="ocrText">Touch sensor or tap "Read Text" to scan...</div>
     
+    <div class="controls" id="patterns">
+        <h3 style="margin-top: 0;">Vibration Patterns (ON / OFF ms)</h3>
+        <div>Critical <input id="p1on" size="4"> <input id="p1off" size="4"> <button class="btn" onclick="savePattern(1)">Set</button></div>
+        <div>Warning <input id="p2on" size="4"> <input id="p2off" size="4"> <button class="btn" onclick="savePattern(2)">Set</button></div>
+        <div>Caution <input id="p3on" size="4"> <input id="p3off" size="4"> <button class="btn" onclick="savePattern(3)">Set</button></div>
+        <div>Link lost <input id="p4on" size="4"> <input id="p4off" size="4"> <button class="btn" onclick="savePattern(4)">Set</button></div>
+    </div>
+    
+    <div class="controls" id="bands">
+        <h3 style="margin-top: 0;">Bands</h3>
+        <div id="peerList">---</div>
+        <button class="btn" onclick="loadPeers('?pair=1')">Pair new band</button>
+        <span id="pairing"></span>
+    </div>
+    
     <script>
         let ttsEnabled = false;
         let lastSpokenText = "";
         let speaking = false;
         let pollCount = 0;
+        let ocrActive = false;     // poll faster while a read is in progress
+        
+        // Touch reads arrive sentence by sentence: chunks of run chunkRun from nextSeq on
+        let chunkRun = -1;         // -1 until the first poll
+        let nextSeq = 0;
+        let streaming = false;     // more chunks may follow
+        let chunksQueued = 0;      // utterances not yet finished
+        let chunkSpoken = false;
         
         const synth = window.speechSynthesis;
         const ttsSupported = 'speechSynthesis' in window;
@@ -222,11 +563,7 @@ const char index_html[] PROGMEM = R"rawliteral(
             }
         }
         
-        function speak(text) {
-            if (!ttsEnabled || !text || text.length < 2) return;
-            
-            synth.cancel();
-            
+        function makeUtterance(text) {
             const utterance = new SpeechSynthesisUtterance(text);
             utterance.rate = 0.9;
             utterance.pitch = 1.0;
@@ -239,6 +576,15 @@ const char index_html[] PROGMEM = R"rawliteral(
                     break;
                 }
             }
+            return utterance;
+        }
+        
+        function speak(text) {
+            if (!ttsEnabled || !text || text.length < 2) return;
+            
+            synth.cancel();
+            
+            const utterance = makeUtterance(text);
             
             utterance.onstart = () => { 
                 speaking = true;
@@ -260,6 +606,52 @@ const char index_html[] PROGMEM = R"rawliteral(
             synth.speak(utterance);
         }
         
+        // Queued behind the previous chunk, no cancel()
+        function speakChunk(text, seq) {
+            const box = document.getElementById("ocrText");
+            box.innerText = seq === 0 ? text : box.innerText + text;
+            box.classList.remove("processing");
+            
+            if (!ttsEnabled || !text.trim()) return;
+            const run = chunkRun;
+            const utterance = makeUtterance(text);
+            utterance.onstart = () => {
+                speaking = true;
+                updateModeIndicator(true);
+                if (seq === 0) fetch("/tts_started?run=" + run).catch(() => {});
+            };
+            const finished = () => {
+                if (run !== chunkRun) return;
+                chunksQueued--;
+                finishChunks();
+            };
+            utterance.onend = finished;
+            utterance.onerror = finished;
+            chunksQueued++;
+            chunkSpoken = true;
+            synth.speak(utterance);
+        }
+        
+        // Resume navigation once the last chunk has been spoken
+        function finishChunks() {
+            if (streaming || chunksQueued > 0 || !chunkSpoken) return;
+            chunkSpoken = false;
+            speaking = false;
+            updateModeIndicator(false);
+            fetch("/tts_done").catch(() => {});
+        }
+        
+        // A newer read replaces the one being spoken
+        function startChunkRun(run) {
+            enableTTS();
+            synth.cancel();
+            chunkRun = run;
+            nextSeq = 0;
+            streaming = true;
+            chunksQueued = 0;
+            chunkSpoken = false;
+        }
+        
         function updateModeIndicator(reading) {
             const indicator = document.getElementById("modeIndicator");
             const distStatus = document.getElementById("distanceStatus");
@@ -287,7 +679,28 @@ const char index_html[] PROGMEM = R"rawliteral(
             }
         }
         
+        // Each press steps one reading further back (no new capture)
+        let historyBefore = 0;
+        function repeatPrevious() {
+            enableTTS();
+            fetch("/ocr/history?limit=1&before=" + historyBefore)
+                .then(r => r.json())
+                .then(data => {
+                    if (data.entries.length === 0) {
+                        historyBefore = 0;
+                        speak("No earlier text");
+                        return;
+                    }
+                    const entry = data.entries[0];
+                    historyBefore = entry.id;
+                    document.getElementById("ocrText").innerText = entry.text;
+                    speak(entry.text);
+                })
+                .catch(() => {});
+        }
+        
         function stopSpeech() {
+            fetch("/ocr_cancel").catch(() => {});
             synth.cancel();
             speaking = false;
             updateModeIndicator(false);
@@ -348,15 +761,35 @@ const char index_html[] PROGMEM = R"rawliteral(
         }
         
         function checkForNewOcr() {
-            fetch("/ocr_status")
+            return fetch("/ocr_status?run=" + chunkRun + "&since=" + nextSeq)
                 .then(r => {
                     if (!r.ok) throw new Error("HTTP " + r.status);
                     return r.json();
                 })
                 .then(data => {
                     pollCount++;
+                    ocrActive = data.reading;
+                    
+                    let chunks = data.chunks;
+                    if (chunkRun < 0) {
+                        // Page just loaded: don't replay an earlier read
+                        chunkRun = data.run;
+                        nextSeq = data.next;
+                        chunks = [];
+                    } else if (data.run !== chunkRun) {
+                        startChunkRun(data.run);
+                    }
+                    for (const c of chunks) {
+                        if (c.seq !== nextSeq) continue;
+                        speakChunk(c.text, c.seq);
+                        nextSeq++;
+                    }
+                    if (data.done && streaming) {
+                        streaming = false;
+                        finishChunks();
+                    }
                     
-                    if (data.reading && !data.newText) {
+                    if (data.reading && !data.newText && !data.done && data.next === 0) {
                         const ocrBox = document.getElementById("ocrText");
                         if (!ocrBox.innerText.includes("Processing") && !ocrBox.innerText.includes("Analyzing")) {
                             ocrBox.innerText = " Processing... (touch detected)";
@@ -372,10 +805,13 @@ const char index_html[] PROGMEM = R"rawliteral(
                         const ocrBox = document.getElementById("ocrText");
                         ocrBox.innerText = data.text;
                         ocrBox.classList.remove("processing");
+                        historyBefore = 0;
                         
                         refresh();
                         
-                        if (data.text !== lastSpokenText) {
+                        if (data.run === chunkRun && nextSeq > 0) {
+                            lastSpokenText = data.text;   // already spoken chunk by chunk
+                        } else if (data.text !== lastSpokenText) {
                             if (!data.text.startsWith("Error") && data.text !== "No text detected") {
                                 setTimeout(() => {
                                     speak(data.text);
@@ -397,6 +833,113 @@ const char index_html[] PROGMEM = R"rawliteral(
                 });
         }
         
+        function showPatterns(data) {
+            for (let i = 1; i < data.patterns.length; i++) {
+                document.getElementById("p" + i + "on").value = data.patterns[i][0];
+                document.getElementById("p" + i + "off").value = data.patterns[i][1];
+            }
+        }
+        
+        function loadPatterns() {
+            fetch("/patterns").then(r => r.json()).then(showPatterns).catch(() => {});
+        }
+        
+        function savePattern(id) {
+            const on = document.getElementById("p" + id + "on").value;
+            const off = document.getElementById("p" + id + "off").value;
+            fetch("/patterns_set?id=" + id + "&on=" + on + "&off=" + off)
+                .then(r => r.json())
+                .then(showPatterns)
+                .catch(() => {});
+        }
+        
+        // One row per paired band: role, link state, acknowledged / sent
+        function showPeers(data) {
+            let html = "";
+            data.peers.forEach(p => {
+                html += "<div>" + p.mac + " <select onchange=\"loadPeers('?slot=" + p.slot + "&role=' + this.value)\">";
+                ["all", "left", "right", "center"].forEach(r => {
+                    html += "<option" + (r === p.role ? " selected" : "") + ">" + r + "</option>";
+                });
+                html += "</select> " + (p.reachable ? "✓ " : "✗ ") + p.delivered + "/" + p.sent +
+                        " <button class=\"btn btn-stop\" onclick=\"loadPeers('?slot=" + p.slot + "&remove=1')\">Remove</button></div>";
+            });
+            document.getElementById("peerList").innerHTML = html || "No bands paired";
+            document.getElementById("pairing").innerText = data.pairing ? "Pairing open..." : "";
+            if (data.pairing) setTimeout(loadPeers, 3000);
+        }
+        
+        function loadPeers(query) {
+            fetch("/peers" + (query || "")).then(r => r.json()).then(showPeers).catch(() => {});
+        }
+        
+        function setOcrMode(mode, burst) {
+            fetch("/ocr_mode" + (mode ? "?mode=" + mode : burst ? "?burst=" + burst : ""))
+                .then(r => r.json())
+                .then(data => {
+                    document.getElementById("ocrMode").value = data.mode;
+                    document.getElementById("ocrBurst").value = data.burst;
+                })
+                .catch(() => {});
+        }
+        
+        function setOcrBackend(name) {
+            fetch("/ocr_backend" + (name ? "?name=" + name : ""))
+                .then(r => r.json())
+                .then(data => { document.getElementById("ocrBackend").value = data.name; })
+                .catch(() => {});
+        }
+        
+        // Distance sparkline: one full /history fetch, then only new entries
+        const ZONE_COLORS = ["#00d4ff", "#ff0000", "#ff8800", "#ffff00", "#888888"];
+        const hist = { raw: null, summary: null, long: false };
+        
+        function mergeHistory(old, fresh, cols, slots) {
+            if (!old || fresh.from !== old.next) return fresh;   // first fetch, or entries missed
+            cols.forEach(c => { old[c] = old[c].concat(fresh[c]).slice(-slots); });
+            old.next = fresh.next;
+            return old;
+        }
+        
+        function drawHistory() {
+            const c = document.getElementById("history");
+            const g = c.getContext("2d");
+            g.clearRect(0, 0, c.width, c.height);
+            const s = hist.long ? hist.summary : hist.raw;
+            if (!s) return;
+            const lo = hist.long ? s.min : s.d, hi = hist.long ? s.max : s.d;
+            const slots = hist.long ? 600 : 200, w = c.width / slots;
+            const y = mm => (c.height - 2) * (1 - Math.min(Math.max(mm, 0), 4000) / 4000);
+            for (let i = 0; i < lo.length; i++) {
+                g.fillStyle = ZONE_COLORS[s.p[i]] || ZONE_COLORS[0];
+                g.fillRect((slots - lo.length + i) * w, y(hi[i]), Math.max(w, 1), Math.max(y(lo[i]) - y(hi[i]), 2));
+            }
+        }
+        
+        function toggleHistory() {
+            hist.long = !hist.long;
+            document.getElementById("historyLabel").innerText =
+                hist.long ? "last 10 min, min-max per second (tap for 10 s)" : "last 10 s (tap for 10 min)";
+            drawHistory();
+        }
+        
+        function pollHistory() {
+            const q = hist.raw ? "?raw=" + hist.raw.next + "&summary=" + hist.summary.next : "";
+            fetch("/history" + q)
+                .then(r => r.json())
+                .then(data => {
+                    hist.raw = mergeHistory(hist.raw, data.raw, ["d", "p"], 200);
+                    hist.summary = mergeHistory(hist.summary, data.summary, ["min", "max", "mean", "p"], 600);
+                    drawHistory();
+                })
+                .catch(() => {});
+        }
+        
+        loadPatterns();
+        loadPeers();
+        setOcrMode();
+        setOcrBackend();
+        
         setInterval(() => {
             fetch("/distance")
                 .then(r => r.json())
@@ -420,7 +963,13 @@ const char index_html[] PROGMEM = R"rawliteral(
                 .catch(() => {});
         }, 300);
         
-        setInterval(checkForNewOcr, 400);
+        pollHistory();
+        setInterval(pollHistory, 1000);
+        
+        function pollOcr() {
+            checkForNewOcr().finally(() => setTimeout(pollOcr, ocrActive ? 100 : 400));
+        }
+        pollOcr();
         
         if (ttsSupported) {
             synth.getVoices();
@@ -436,6 +985,13 @@ const char index_html[] PROGMEM = R"rawliteral(
 </html>
 )rawliteral";
 
+// ===========================================
+// Boot Phase Log
+// ===========================================
+void bootLog(const char* phase) {
+    Serial.printf("[boot +%5lu ms] %s\n", millis(), phase);
+}
+
 // ===========================================
 // Camera Init
 // ===========================================
@@ -493,6 +1049,22 @@ bool initCamera() {
 // ===========================================
 // TOF Sensor Init
 // ===========================================
+// TOF_ZONES only while a band needs a side of its own
+uint8_t tofZonesWanted() {
+    portENTER_CRITICAL(&peerMux);
+    bool directional = peers.directional();
+    portEXIT_CRITICAL(&peerMux);
+    return directional ? TOF_ZONES : 1;
+}
+
+// Called from the safety task, the only one ranging after setup
+void updateTofZones() {
+    uint8_t zones = tofZonesWanted();
+    if (!sensorReady || zones == tof.zoneCount()) return;
+    tof.setZones(zones);
+    zoneMap.clear();
+}
+
 bool initTOF() {
     Wire.begin(I2C_SDA, I2C_SCL);
     Wire.setClock(400000);
@@ -502,8 +1074,9 @@ bool initTOF() {
         Serial.println("✓ TOF Sensor Found");
         if (vl53.startRanging()) {
             vl53.setTimingBudget(50);
+            tof.setZones(tofZonesWanted());
             sensorReady = true;
-            Serial.println("✓ Ranging Active (50ms fast mode)");
+            Serial.printf("✓ Ranging Active (50ms fast mode, %u zones)\n", tof.zoneCount());
             return true;
         }
     }
@@ -512,175 +1085,635 @@ bool initTOF() {
 }
 
 // ===========================================
-// Extract Text from Response
+// Haptic Pattern Table
 // ===========================================
-String extractTextFromResponse(WiFiClient* stream) {
-    String result = "";
-    String buffer = "";
-    bool foundDescription = false;
-    
-    while (stream->available()) {
-        char c = stream->read();
-        buffer += c;
+void loadPatternTable() {
+    memset(patternTable, 0, sizeof(patternTable));
+    memcpy(patternTable, DEFAULT_PATTERNS, sizeof(DEFAULT_PATTERNS));
+    
+    prefs.begin("haptics", true);
+    if (prefs.getBytesLength("table") == sizeof(patternTable)) {
+        prefs.getBytes("table", patternTable, sizeof(patternTable));
+        patternTableVersion = prefs.getUChar("ver", 1);
+    }
+    savedWiFiChannel = prefs.getUChar("wifiChan", 0);
+    ocrMode = prefs.getUChar("ocrMode", OCR_MODE_AUTO);
+    uint8_t backend = prefs.getUChar("ocrBackend", BACKEND_VISION);
+    ocrBackend = backend < OCR_BACKENDS ? backend : BACKEND_VISION;
+    uint8_t burst = prefs.getUChar("ocrBurst", 1);
+    ocrBurst = burst >= 1 && burst <= OCR_BURST_MAX ? burst : 1;
+    prefs.end();
+    Serial.printf("✓ Pattern table v%u\n", patternTableVersion);
+}
+
+void savePatternTable() {
+    prefs.begin("haptics", false);
+    prefs.putBytes("table", patternTable, sizeof(patternTable));
+    prefs.putUChar("ver", patternTableVersion);
+    prefs.end();
+}
+
+// ===========================================
+// Peer Table Storage / Sending
+// ===========================================
+void loadPeers() {
+    PeerRecord records[PeerTable::MAX_PEERS];
+    prefs.begin("haptics", true);
+    size_t len = prefs.getBytesLength("peers");
+    uint8_t count = 0;
+    if (len > 0 && len <= sizeof(records) && len % sizeof(PeerRecord) == 0) {
+        prefs.getBytes("peers", records, len);
+        count = len / sizeof(PeerRecord);
+    }
+    prefs.end();
+    peers.load(records, count);
+    Serial.printf("✓ %u paired band(s)\n", count);
+}
+
+void savePeers() {
+    PeerRecord records[PeerTable::MAX_PEERS];
+    portENTER_CRITICAL(&peerMux);
+    uint8_t count = peers.save(records);
+    portEXIT_CRITICAL(&peerMux);
+    
+    // Own handle: loop() saves while the web task may hold `prefs`
+    Preferences store;
+    store.begin("haptics", false);
+    if (count > 0) store.putBytes("peers", records, count * sizeof(PeerRecord));
+    else store.remove("peers");
+    store.end();
+}
+
+void loadOcrHistory() {
+#if OCR_HISTORY_SAVE_BYTES > 0
+    static uint8_t blob[OCR_HISTORY_SAVE_BYTES];
+    prefs.begin("haptics", true);
+    size_t len = prefs.getBytesLength("ocrHistory");
+    if (len > 0 && len <= sizeof(blob)) prefs.getBytes("ocrHistory", blob, len);
+    else len = 0;
+    prefs.end();
+    if (len > 0 && ocrHistory.load(blob, len)) {
+        Serial.printf("✓ %u OCR results restored\n", (unsigned)ocrHistory.count());
+    }
+#endif
+}
+
+void saveOcrHistory() {
+#if OCR_HISTORY_SAVE_BYTES > 0
+    static uint8_t blob[OCR_HISTORY_SAVE_BYTES];   // loop() only
+    xSemaphoreTake(ocrTextMutex, portMAX_DELAY);
+    size_t len = ocrHistory.save(blob, sizeof(blob));
+    xSemaphoreGive(ocrTextMutex);
+    
+    Preferences store;
+    store.begin("haptics", false);
+    store.putBytes("ocrHistory", blob, len);
+    store.end();
+#endif
+}
+
+bool addEspNowPeer(const uint8_t* mac) {
+    if (esp_now_is_peer_exist(mac)) return true;
+    esp_now_peer_info_t peer = {};
+    memcpy(peer.peer_addr, mac, 6);
+    peer.channel = 0;  // follow the current channel
+    peer.encrypt = false;
+    peer.ifidx = WIFI_IF_STA;
+    return esp_now_add_peer(&peer) == ESP_OK;
+}
+
+// Queues the frames back to back, then books them in one go
+void sendBatch(const PeerTable::Send* batch, uint8_t count) {
+    bool queued[PeerTable::MAX_PEERS];
+    int slots[PeerTable::MAX_PEERS];
+    for (uint8_t i = 0; i < count; i++) {
+        queued[i] = radio.send(batch[i].mac, (const uint8_t*)&batch[i].frame, sizeof(StateFrame));
+        if (queued[i]) stateFramesSent.inc();
+        else espNowSendErrors.inc();
+    }
+    portENTER_CRITICAL(&peerMux);
+    for (uint8_t i = 0; i < count; i++) {
+        peers.onQueued(batch[i].mac, queued[i]);
+        slots[i] = peers.find(batch[i].mac);
+    }
+    portEXIT_CRITICAL(&peerMux);
+    for (uint8_t i = 0; i < count; i++) {
+        const StateFrame& f = batch[i].frame;
+        uint8_t pattern = f.flags & FLAG_PAUSE ? FLIGHT_OTHER_FRAME : f.pattern;
+        flight.record(FR_SEND, slots[i] < 0 ? FLIGHT_NO_SLOT : slots[i], queued[i] << 8 | pattern);
+    }
+}
+
+// Same frame to every paired band
+void sendToPeers(const uint8_t* data, size_t len) {
+    PeerRecord targets[PeerTable::MAX_PEERS];
+    portENTER_CRITICAL(&peerMux);
+    uint8_t count = peers.save(targets);
+    portEXIT_CRITICAL(&peerMux);
+    
+    for (uint8_t i = 0; i < count; i++) {
+        bool ok = radio.send(targets[i].mac, data, len);
+        if (!ok) espNowSendErrors.inc();
+        portENTER_CRITICAL(&peerMux);
+        peers.onQueued(targets[i].mac, ok);
+        int slot = peers.find(targets[i].mac);
+        portEXIT_CRITICAL(&peerMux);
+        flight.record(FR_SEND, slot < 0 ? FLIGHT_NO_SLOT : slot, ok << 8 | FLIGHT_OTHER_FRAME);
+    }
+}
+
+void sendPatternTable() {
+    portENTER_CRITICAL(&tableMux);
+    PatternTableFrame frame = makePatternTableFrame(patternTableVersion, patternTable, PATTERN_COUNT);
+    portEXIT_CRITICAL(&tableMux);
+    sendToPeers((uint8_t*)&frame, sizeof(frame));
+    TRACE(TR_EYE_TABLE_SENT, frame.tableVersion, 0);
+}
+
+void sendPause() {
+    StateFrame frame = makePauseFrame(patternTableVersion);
+    sendToPeers((uint8_t*)&frame, sizeof(frame));
+}
+
+// ===========================================
+// Reading Mode
+// ===========================================
+void enterReadingMode() {
+    readingSince = millis();
+    autoResumeAt = 0;
+    readingMode = true;
+    flight.record(FR_PAUSE, 0, 0);
+    sendPause();  // don't wait for the next safety tick
+}
+
+enum ResumeReason { RESUME_TTS_DONE, RESUME_AUTO, RESUME_TIMEOUT, RESUME_CAPTURE_FAILED, RESUME_ABANDONED };
+
+void exitReadingMode(ResumeReason reason) {
+    readingMode = false;
+    autoResumeAt = 0;
+    flight.record(FR_RESUME, reason, 0);
+    TRACE(TR_EYE_READING_OFF, reason, 0);
+}
+
+void setOcrText(const String& text) {
+    xSemaphoreTake(ocrTextMutex, portMAX_DELAY);
+    lastOcrText = text;
+    xSemaphoreGive(ocrTextMutex);
+}
+
+String getOcrText() {
+    xSemaphoreTake(ocrTextMutex, portMAX_DELAY);
+    String text = lastOcrText;
+    xSemaphoreGive(ocrTextMutex);
+    return text;
+}
+
+// ===========================================
+// Progressive OCR Text
+// ===========================================
+void beginOcrChunks(uint32_t now) {
+    xSemaphoreTake(ocrTextMutex, portMAX_DELAY);
+    ocrChunks.begin(++ocrRun);
+    xSemaphoreGive(ocrTextMutex);
+    ocrRunStarted = now;
+    firstWordPending = true;
+}
+
+void finishOcrChunks() {
+    xSemaphoreTake(ocrTextMutex, portMAX_DELAY);
+    ocrChunks.finish();
+    xSemaphoreGive(ocrTextMutex);
+}
+
+// Hands each sentence to /ocr_status while the response is still downloading
+class ChunkPublisher : public OcrTextSink {
+public:
+    void onChunk(const char* text, size_t len) override {
+        xSemaphoreTake(ocrTextMutex, portMAX_DELAY);
+        bool first = ocrChunks.count() == 0;
+        ocrChunks.add(text, len);
+        bool published = ocrChunks.count() > 0;
+        xSemaphoreGive(ocrTextMutex);
         
-        if (buffer.length() > 1000) {
-            int descIndex = buffer.indexOf("\"description\"");
-            
-            if (descIndex >= 0 && !foundDescription) {
-                int colonIndex = buffer.indexOf(":", descIndex);
-                if (colonIndex >= 0) {
-                    int quoteStart = buffer.indexOf("\"", colonIndex);
-                    if (quoteStart >= 0) {
-                        quoteStart++;
-                        
-                        bool escaped = false;
-                        for (int i = quoteStart; i < buffer.length(); i++) {
-                            char ch = buffer[i];
-                            
-                            if (escaped) {
-                                if (ch == 'n') result += '\n';
-                                else if (ch == 't') result += ' ';
-                                else if (ch == 'r') { }
-                                else if (ch == '\\') result += '\\';
-                                else if (ch == '"') result += '"';
-                                else result += ch;
-                                escaped = false;
-                            } else {
-                                if (ch == '\\') {
-                                    escaped = true;
-                                } else if (ch == '"') {
-                                    foundDescription = true;
-                                    return result;
-                                } else {
-                                    result += ch;
-                                }
-                            }
-                        }
-                        
-                        buffer = buffer.substring(quoteStart);
-                        continue;
-                    }
-                }
-            }
-            
-            if (!foundDescription && result.length() == 0) {
-                buffer = buffer.substring(buffer.length() - 200);
-            }
+        if (first && published) {
+            uint32_t ms = millis() - ocrRunStarted;
+            ocrStageMs[STAGE_FIRST_CHUNK].observe(ms);
+            TRACE(TR_EYE_OCR_CHUNK, ocrRun, ms);
         }
     }
-    
-    return result;
-}
+};
+
+ChunkPublisher chunkPublisher;
 
 // ===========================================
 // OCR Function
 // ===========================================
-String performOCR(camera_fb_t* fb) {
-    if (!fb) return "Error: No image";
-    
-    Serial.println("\n=== OCR START ===");
-    Serial.printf("Image: %u bytes\n", fb->len);
-    
-    if (strlen(apiKey) < 10) {
+// One attempt. `sink` (optional) receives the text sentence by sentence;
+// `cancel` stops the download early. `code` is the HTTP status (0 = not sent),
+// `kind` what came of it (counted once per request, by runOCR()).
+String performOCR(const hal::Frame& frame, uint8_t backendId, OcrTextSink* sink, OcrCancel* cancel,
+                  int& code, OcrResult& kind) {
+    code = 0;
+    kind = RESULT_API_ERROR;
+    if (!frame.buf) return "Error: No image";
+    
+    if (backendId == BACKEND_VISION && !visionBackend.configured()) {
+        kind = RESULT_NO_KEY;
         return "Error: Add Google Cloud Vision API key";
     }
+    if (backendId == BACKEND_GATEWAY && !gatewayBackend.configured()) {
+        kind = RESULT_NO_KEY;
+        return "Error: Set the OCR gateway URL";
+    }
     
-    size_t outLen;
-    mbedtls_base64_encode(NULL, 0, &outLen, fb->buf, fb->len);
-    unsigned char* b64Buffer = (unsigned char*)malloc(outLen);
-    mbedtls_base64_encode(b64Buffer, outLen, &outLen, fb->buf, fb->len);
-    String b64String = String((char*)b64Buffer);
-    free(b64Buffer);
-    b64String.trim();
-    
-    Serial.printf("Base64: %d chars\n", b64String.length());
-    
-    String json = "{\"requests\":[{\"image\":{\"content\":\"";
-    json += b64String;
-    json += "\"},\"features\":[{\"type\":\"DOCUMENT_TEXT_DETECTION\",\"maxResults\":1}]}]}";
-    
-    HTTPClient http;
-    String url = "https://vision.googleapis.com/v1/images:annotate?key=";
-    url += apiKey;
+    OcrFeature feature = chooseOcrFeature((OcrMode)ocrMode.load(), frame.len, frame.width, frame.height,
+                                          lastUsefulTextLen);
+    ocrFeatures[feature].inc();
+    TRACE(TR_EYE_OCR_FEATURE, feature, ocrMode.load());
     
-    http.begin(url);
-    http.addHeader("Content-Type", "application/json");
-    http.setTimeout(30000);
+    OcrTiming timing;
+    ArenaString text{ ArenaAllocator<char>(ocrArena) };
+    code = ocrBackends[backendId]->recognize(frame, feature, text, sink, cancel, timing);
     
-    Serial.println("Sending to Google...");
-    int code = http.POST(json);
+    if (backendId == BACKEND_VISION) ocrStageMs[STAGE_ENCODE].observe(timing.encodeMs);
+    ocrRequestBytes[backendId].observe(timing.requestBytes);
+    TRACE(TR_EYE_OCR_IMAGE, frame.len, timing.requestBytes);
+    ocrStageMs[STAGE_HTTP].observe(timing.httpMs);
+    TRACE(TR_EYE_OCR_HTTP, code, timing.httpMs);
     
     String result = "";
     
     if (code == 200) {
-        WiFiClient* stream = http.getStreamPtr();
-        result = extractTextFromResponse(stream);
+        result = text.c_str();
+        ocrStageMs[STAGE_DOWNLOAD].observe(timing.downloadMs);
+        ocrResponseBytes.observe(timing.responseBytes);
+        TRACE(TR_EYE_OCR_RESPONSE, timing.responseBytes, timing.downloadMs);
         
         if (result.length() > 0) {
-            Serial.println("✓ Text extracted");
+            kind = RESULT_TEXT;
             Serial.println("===TTS_START===");
             Serial.println(result);
             Serial.println("===TTS_END===");
         } else {
+            kind = RESULT_NO_TEXT;
             result = "No text detected";
         }
     } else {
-        Serial.printf("HTTP Error: %d\n", code);
         result = "API Error: " + String(code);
     }
     
-    http.end();
-    Serial.println("=== OCR END ===\n");
     return result;
 }
 
-// ===========================================
-// Touch-Triggered OCR
-// ===========================================
-void triggerOCR() {
-    Serial.println("\n>>> TOUCH TRIGGERED OCR <<<");
-    
-    ocrInProgress = true;
-    distancePaused = true;
-    ttsSpeaking = true;
-    ttsStartTime = millis();
-    autoResumeTime = 0;
+// Burst read: `frames` shots of the scene in one Vision request (one
+// connection, one TLS handshake), each shot's text read in one pass,
+// then the text they agree on. `frame`, the exposed OCR shot, is the
+// first; each shot is encoded and released as soon as it is taken, so
+// two frame buffers suffice. Retries resend the same body. Text and
+// request stay in the arena until the caller resets it.
+String performBurstOCR(hal::Frame& frame, uint8_t frames, const OcrRequest& req, OcrTicket& ticket,
+                       OcrTextSink* sink, int& code, OcrResult& kind) {
+    code = 0;
+    kind = RESULT_API_ERROR;
+    if (!visionBackend.configured()) {
+        kind = RESULT_NO_KEY;
+        return "Error: Add Google Cloud Vision API key";
+    }
     
-    strcpy(outgoingData.command, "PAUSE");
-    outgoingData.distance = 0;
-    outgoingData.pattern = 0;
-    esp_now_send(broadcastAddress, (uint8_t*)&outgoingData, sizeof(outgoingData));
+    OcrFeature feature = chooseOcrFeature((OcrMode)ocrMode.load(), frame.len, frame.width, frame.height,
+                                          lastUsefulTextLen);
+    ocrFeatures[feature].inc();
+    TRACE(TR_EYE_OCR_FEATURE, feature, ocrMode.load());
+    
+    // Later shots (back on AEC) may compress worse than the first
+    uint32_t started = millis();
+    ArenaAllocator<char> alloc(ocrArena);
+    ArenaString json(alloc);
+    beginVisionBatch(json, visionBatchBytes(frame.len + frame.len / 2, frames, feature));
+    uint8_t taken = 0;
+    size_t imageBytes = 0;
+    while (frame.buf) {
+        addVisionBatchImage(frame.buf, frame.len, feature, json);
+        imageBytes += frame.len;
+        taken++;
+        camera.release(frame);
+        if (taken == frames || ticket.cancelled() || !camera.capture(frame)) break;
+    }
+    endVisionBatch(json);
+    ocrStageMs[STAGE_ENCODE].observe(millis() - started);   // the extra shots included
+    ocrRequestBytes[BACKEND_VISION].observe(json.length());
+    TRACE(TR_EYE_OCR_IMAGE, imageBytes, json.length());
+    
+    std::vector<ArenaString> texts(taken, ArenaString(alloc));
+    OcrTiming timing;
+    for (uint8_t attempt = 0;; attempt++) {
+        for (ArenaString& t : texts) t.clear();
+        visionBackend.setTimeout(scheduler.remaining(req));
+        code = visionBackend.recognizeBatch(json, taken, texts.data(), &ticket, timing);
+        
+        uint32_t waitMs;
+        if (ticket.cancelled() || !scheduler.retryAfter(req, code, attempt, waitMs)) break;
+        TRACE(TR_EYE_OCR_RETRY, code, waitMs);
+        if (!ticket.wait(sysClock, waitMs)) break;
+    }
+    ocrStageMs[STAGE_HTTP].observe(timing.httpMs);
+    TRACE(TR_EYE_OCR_HTTP, code, timing.httpMs);
     
-    Serial.println("Reading Mode - Vibration PAUSED");
+    if (code != 200) {
+        return "API Error: " + String(code);
+    }
+    ocrStageMs[STAGE_DOWNLOAD].observe(timing.downloadMs);
+    ocrResponseBytes.observe(timing.responseBytes);
+    TRACE(TR_EYE_OCR_RESPONSE, timing.responseBytes, timing.downloadMs);
+    
+    // Nothing useful anywhere: the longest fragment, as one shot would give
+    OcrCandidate candidates[OCR_BURST_MAX];
+    for (uint8_t i = 0; i < taken; i++) candidates[i] = { texts[i].data(), texts[i].length() };
+    uint8_t pick = pickConsensusText(candidates, taken);
+    TRACE(TR_EYE_OCR_BURST, taken, pick);
+    if (pick == taken) {
+        pick = 0;
+        for (uint8_t i = 1; i < taken; i++) {
+            if (texts[i].length() > texts[pick].length()) pick = i;
+        }
+    }
     
-    camera_fb_t* fb = esp_camera_fb_get();
-    if (fb) {
-        lastOcrText = performOCR(fb);
-        esp_camera_fb_return(fb);
-        newOcrAvailable = true;
-        Serial.println("OCR complete");
-        Serial.print("Text: ");
-        Serial.println(lastOcrText);
+    if (texts[pick].empty()) {
+        kind = RESULT_NO_TEXT;
+        return "No text detected";
+    }
+    kind = RESULT_TEXT;
+    if (sink) sendTextChunks(texts[pick].data(), texts[pick].length(), sink);
+    String result = texts[pick].c_str();
+    Serial.println("===TTS_START===");
+    Serial.println(result);
+    Serial.println("===TTS_END===");
+    return result;
+}
+
+// ===========================================
+// Camera Power
+// ===========================================
+// Every camera user brackets its captures with these. Waking drops
+// the frame the driver held from before standby (and any taken
+// while the sensor restarts) and times it to the first fresh one.
+void acquireCamera() {
+    xSemaphoreTake(powerMutex, portMAX_DELAY);
+    uint32_t wokeAt = millis();
+    bool wake = power.acquireCamera(wokeAt) && camera.setStandby(false);
+    xSemaphoreGive(powerMutex);
+    if (!wake) return;
+    
+    int32_t ms = awaitFreshFrame(camera, sysClock, wokeAt, CAMERA_WAKE_FRAMES);
+    if (ms >= 0) {
+        cameraWakeMs.observe(ms);
+        TRACE(TR_EYE_CAMERA_POWER, 0, ms);
+    }
+}
+
+void releaseCamera() {
+    xSemaphoreTake(powerMutex, portMAX_DELAY);
+    power.releaseCamera(millis());
+    xSemaphoreGive(powerMutex);
+}
+
+// Full radio for the web UI; called for every request
+void webActivity() {
+    xSemaphoreTake(powerMutex, portMAX_DELAY);
+    if (power.webActivity(millis())) {
+#if POWER_SAVE
+        WiFi.setSleep(false);
+#endif
+        TRACE(TR_EYE_RADIO_POWER, 0, 0);
+    }
+    xSemaphoreGive(powerMutex);
+}
+
+// Idle transitions, from loop(). In modem sleep the radio only
+// listens at DTIM beacons, so pair and table requests the bands send
+// unasked can be missed: it stays awake while the pairing window is
+// open or a band has not acknowledged a frame yet. After that, bands
+// resend both requests every second until they are answered.
+void updatePower(uint32_t now) {
+    portENTER_CRITICAL(&peerMux);
+    bool listen = peers.pairingOpen(now) || peers.awaitingAck();
+    portEXIT_CRITICAL(&peerMux);
+    
+    if (xSemaphoreTake(powerMutex, 0) != pdTRUE) return;
+    bool wake = listen && power.holdRadio(now);
+    uint8_t actions = power.update(now);
+#if POWER_SAVE
+    if (wake) WiFi.setSleep(false);
+    if (actions & PowerManager::CAMERA_STANDBY) {
+        camera.setStandby(true);
+        TRACE(TR_EYE_CAMERA_POWER, 1, 0);
+    }
+    if (actions & PowerManager::RADIO_SLEEP) {
+        WiFi.setSleep(true);     // wakes for ESP-NOW sends and DTIM beacons
+        TRACE(TR_EYE_RADIO_POWER, 1, 0);
+    }
+#endif
+    if (wake) TRACE(TR_EYE_RADIO_POWER, 0, 0);
+    xSemaphoreGive(powerMutex);
+}
+
+// ===========================================
+// OCR Task (core 0)
+// ===========================================
+// Capture the OCR shot, exposed for the text. Each frame's JPEG is
+// measured as it comes (no decode); after a change the next
+// EXPOSURE_SETTLE_FRAMES frames still carry the old exposure and are
+// dropped. A sensor without manual exposure, or a JPEG the parser
+// does not handle, gets the plain AEC frame. Sets `result`
+// (EXPOSURE_RESULTS when not controlled).
+bool captureForOcr(hal::Frame& frame, OcrTicket& ticket, uint8_t& result) {
+    result = ExposureController::EXPOSURE_RESULTS;
+#if OCR_EXPOSURE_CONTROL
+    static LumaStats stats;   // 1 KB, off the task stack
+    uint32_t started = millis();
+    exposureCtl.begin();
+    const Exposure* e = &exposureCtl.exposure();
+    if (camera.setExposure(e->lines, e->gain)) {
+        ExposureController::Result r = ExposureController::EXPOSURE_ADJUST;
+        bool ok = true;
+        while (r == ExposureController::EXPOSURE_ADJUST && !ticket.cancelled()) {
+            for (int i = 0; ok && i < EXPOSURE_SETTLE_FRAMES; i++) {
+                ok = camera.capture(frame);
+                if (ok) camera.release(frame);
+            }
+            if (!ok || !camera.capture(frame)) {
+                ok = false;
+                break;
+            }
+            if (!jpegLumaStats(frame.buf, frame.len, stats)) break;   // keep this frame as it is
+            r = exposureCtl.update(stats);
+            if (r == ExposureController::EXPOSURE_ADJUST) {
+                camera.release(frame);
+                e = &exposureCtl.exposure();
+                camera.setExposure(e->lines, e->gain);
+            }
+        }
+        camera.autoExposure();
+        if (ok && !frame.buf) ok = camera.capture(frame);   // cancelled between frames
         
-        if (lastOcrText == "No text detected" || 
-            lastOcrText.startsWith("Error") || 
-            lastOcrText.startsWith("API Error") ||
-            lastOcrText.length() < 3) {
-            
-            autoResumeTime = millis() + NO_TEXT_RESUME_DELAY;
-            Serial.println("No useful text - Auto-resume in 2.5s");
-        } else {
-            Serial.println("Text found - Waiting for TTS...");
+        uint32_t ms = millis() - started;
+        if (r != ExposureController::EXPOSURE_ADJUST) {
+            result = r;
+            exposureResults[r].inc();
+            exposureMs.observe(ms);
+            TRACE(TR_EYE_EXPOSURE, r, exposureCtl.steps());
         }
-    } else {
-        lastOcrText = "Error: Camera capture failed";
+        return ok;
+    }
+#endif
+    return camera.capture(frame);
+}
+
+// True if the shot surely has no text. A JPEG the parser does not
+// handle goes to the backend.
+bool shotHasNoText(const hal::Frame& frame) {
+    uint32_t started = millis();
+    TextPresence presence;
+    textGate.detect(frame.buf, frame.len, presence);
+    uint32_t ms = millis() - started;
+    textGateMs.observe(ms);
+    TRACE(TR_EYE_TEXT_GATE, presence.lineBlocks, ms);
+    return presence.noText;
+}
+
+OcrOutcome runOCR(const OcrRequest& req, bool& captured) {
+    OcrSource source = (OcrSource)req.source;
+    captured = false;
+    OcrTicket ticket(scheduler, req);
+    enterReadingMode();
+    TRACE(TR_EYE_READING_ON, source, 0);
+    
+    uint32_t started = millis();
+    // Web requests get their text in the /ocr reply instead
+    if (source == OCR_TOUCH) beginOcrChunks(started);
+    
+    hal::Frame frame;
+    uint8_t exposure;
+    if (cameraReady) acquireCamera();
+    if (!cameraReady || !captureForOcr(frame, ticket, exposure)) {
+        if (cameraReady) releaseCamera();
+        ocrResults[RESULT_CAPTURE_FAILED].inc();
+        TRACE(TR_EYE_CAPTURE_FAIL, cameraReady, 0);
+        if (source == OCR_WEB) {
+            exitReadingMode(RESUME_CAPTURE_FAILED);
+            return OCR_FAILED;
+        }
+        setOcrText("Error: Camera capture failed");
+        finishOcrChunks();
         newOcrAvailable = true;
-        Serial.println("✗ Camera capture failed!");
-        autoResumeTime = millis() + 1000;
-        Serial.println("Error - Auto-resume in 1s");
+        autoResumeAt = millis() + 1000;
+        return OCR_FAILED;
     }
     
-    ocrInProgress = false;
+    ocrStageMs[STAGE_CAPTURE].observe(millis() - started);
+    captured = true;
+    uint32_t imageHash = ocrImageHash(frame.buf, frame.len);
+    
+    // Retry transient failures while the deadline allows
+    uint8_t backend = ocrBackend;
+    uint8_t burst = backend == BACKEND_VISION ? ocrBurst.load() : 1;
+    OcrTextSink* sink = source == OCR_TOUCH ? &chunkPublisher : nullptr;
+    String text;
+    int code = 0;
+    OcrResult kind = RESULT_NO_TEXT_LOCAL;   // set by the backend call when there is one
+    bool skipped = false;
+#if OCR_TEXT_GATE
+    skipped = shotHasNoText(frame);
+#endif
+    if (skipped) {
+        text = "No text detected";
+    } else if (burst > 1) {
+        text = performBurstOCR(frame, burst, req, ticket, sink, code, kind);
+        ocrArena.reset();
+    } else {
+        for (uint8_t attempt = 0;; attempt++) {
+            ocrBackends[backend]->setTimeout(scheduler.remaining(req));
+            text = performOCR(frame, backend, sink, &ticket, code, kind);
+            ocrArena.reset();
+            
+            uint32_t waitMs;
+            if (ticket.cancelled() || !scheduler.retryAfter(req, code, attempt, waitMs)) break;
+            TRACE(TR_EYE_OCR_RETRY, code, waitMs);
+            if (!ticket.wait(sysClock, waitMs)) break;
+        }
+    }
+    camera.release(frame);
+    releaseCamera();
+    
+    // Superseded or out of time: nothing is published. Navigation resumes
+    // here unless loop() already did, or a newer request holds reading mode.
+    if (ticket.cancelled()) {
+        OcrOutcome outcome = scheduler.abandonedOutcome(req);
+        if (source == OCR_TOUCH) finishOcrChunks();
+        if (scheduler.abandon(req.id)) exitReadingMode(RESUME_ABANDONED);
+        if (outcome == OCR_DEADLINE_MISSED && source == OCR_TOUCH) {
+            setOcrText("Error: Text reading timed out");
+            newOcrAvailable = true;
+        }
+        TRACE(TR_EYE_OCR_ABANDON, req.id, outcome);
+        return outcome;
+    }
+    
+    // One result per request: retries are in scheduler.retries()
+    ocrResults[kind].inc();
+    setOcrText(text);
+    if (source == OCR_TOUCH) finishOcrChunks();   // before newOcrAvailable: /ocr_status then has every chunk
+    uint32_t totalMs = millis() - started;
+    ocrStageMs[STAGE_TOTAL].observe(totalMs);
+    
+    bool useful = isUsefulOcrText(text.c_str());
+    lastUsefulTextLen = useful ? text.length() : 0;
+    if (!skipped) {
+        ocrBackendMs[backend].observe(totalMs);
+        TRACE(TR_EYE_OCR_BACKEND, backend, totalMs);
+        ocrReads[burst - 1].inc();
+        if (useful) ocrReadsUseful[burst - 1].inc();
+        ocrReadMs[burst - 1].observe(totalMs);
+    }
+    if (useful) {
+        xSemaphoreTake(ocrTextMutex, portMAX_DELAY);
+        ocrHistory.add(millis(), imageHash, text.c_str(), text.length());
+        xSemaphoreGive(ocrTextMutex);
+        ocrHistoryPending++;
+    }
+    if (useful && exposure < ExposureController::EXPOSURE_RESULTS) exposureUseful[exposure].inc();
+    TRACE(TR_EYE_OCR_DONE, text.length(), useful);
+    
+    // Nothing to speak: resume navigation without waiting for /tts_done
+    if (source == OCR_TOUCH) {
+        newOcrAvailable = true;
+        if (!useful) autoResumeAt = millis() + (skipped ? NO_TEXT_LOCAL_RESUME_DELAY : NO_TEXT_RESUME_DELAY);
+    }
+    return code == 200 || skipped ? OCR_COMPLETED : OCR_FAILED;
+}
+
+// Queue an OCR run; the newest request wins over a queued or running one
+OcrRequest requestOCR(OcrSource source) {
+    OcrRequest req = scheduler.submit(source, source == OCR_TOUCH ? OCR_TOUCH_DEADLINE : OCR_WEB_DEADLINE);
+    xQueueOverwrite(ocrRequests, &req);
+    return req;
+}
+
+void ocrTask(void* param) {
+    OcrRequest req;
+    for (;;) {
+        if (xQueueReceive(ocrRequests, &req, portMAX_DELAY) != pdTRUE) continue;
+        monitor.begin(SLOT_OCR);
+        scheduler.begin(req);
+        bool captured;
+        OcrOutcome outcome = runOCR(req, captured);
+        scheduler.finish(outcome);
+        monitor.end(SLOT_OCR);
+        if (req.source == OCR_WEB) {
+            OcrReply reply = { req.id, outcome, captured };
+            xQueueOverwrite(ocrReplies, &reply);
+        }
+    }
 }
 
 // ===========================================
@@ -691,65 +1724,96 @@ void handleRoot() {
 }
 
 void handleCapture() {
-    camera_fb_t* fb = esp_camera_fb_get();
-    if (!fb) {
+    if (!cameraReady) {
+        server.send(503, "text/plain", "Camera starting");
+        return;
+    }
+    hal::Frame frame;
+    acquireCamera();
+    if (!camera.capture(frame)) {
+        releaseCamera();
         server.send(500, "text/plain", "Capture failed");
         return;
     }
     imageCount++;
     server.sendHeader("Content-Type", "image/jpeg");
-    server.send_P(200, "image/jpeg", (const char*)fb->buf, fb->len);
-    esp_camera_fb_return(fb);
+    server.send_P(200, "image/jpeg", (const char*)frame.buf, frame.len);
+    camera.release(frame);
+    releaseCamera();
 }
 
 void handleOCR() {
-    Serial.println("\n>>> MANUAL OCR REQUEST <<<");
-    
-    distancePaused = true;
-    ttsSpeaking = true;
-    ttsStartTime = millis();
-    
-    strcpy(outgoingData.command, "PAUSE");
-    outgoingData.distance = 0;
-    outgoingData.pattern = 0;
-    esp_now_send(broadcastAddress, (uint8_t*)&outgoingData, sizeof(outgoingData));
-    
-    camera_fb_t* fb = esp_camera_fb_get();
-    if (!fb) {
-        server.send(500, "text/plain", "Capture failed");
-        distancePaused = false;
-        ttsSpeaking = false;
-        return;
+    xQueueReset(ocrReplies);
+    OcrRequest req = requestOCR(OCR_WEB);
+    
+    // Runs on the OCR task; this web request waits for its reply, or
+    // answers at once when a touch replaces it or it is abandoned
+    OcrReply reply = { req.id, OCR_DEADLINE_MISSED, false };
+    uint32_t waitUntil = req.deadline + OCR_REPLY_MARGIN;
+    for (;;) {
+        OcrReply received;
+        if (xQueueReceive(ocrReplies, &received, pdMS_TO_TICKS(50)) == pdTRUE) {
+            if (received.id != req.id) continue;
+            reply = received;
+            break;
+        }
+        if (!scheduler.isCurrent(req.id)) {
+            reply.outcome = scheduler.abandonedOutcome(req);
+            break;
+        }
+        if ((int32_t)(millis() - waitUntil) >= 0) break;
     }
     
-    String result = performOCR(fb);
-    lastOcrText = result;
-    
-    esp_camera_fb_return(fb);
-    server.send(200, "text/plain", result);
+    switch (reply.outcome) {
+        case OCR_COMPLETED:
+        case OCR_FAILED:
+            if (reply.captured) server.send(200, "text/plain", getOcrText());
+            else server.send(500, "text/plain", "Capture failed");
+            break;
+        case OCR_CANCELLED:
+            server.send(409, "text/plain", "OCR cancelled by a newer request");
+            break;
+        default:
+            server.send(504, "text/plain", "OCR timeout");
+            break;
+    }
+}
+
+// Stop button: drop the request in flight and resume navigation now
+void handleOcrCancel() {
+    if (scheduler.abandonRunning()) exitReadingMode(RESUME_ABANDONED);
+    server.send(200, "text/plain", "OK");
 }
 
 void handleGetOcrText() {
-    String text = lastOcrText;
+    String text = getOcrText();
     text.replace("\\", "\\\\");
     text.replace("\"", "\\\"");
     server.send(200, "text/plain", text);
 }
 
+// ?run=R&since=S: chunks of run R from S on (every chunk if R is not the current run)
 void handleOcrStatus() {
-    String escapedText = lastOcrText;
-    escapedText.replace("\\", "\\\\");
-    escapedText.replace("\"", "\\\"");
-    escapedText.replace("\n", "\\n");
-    escapedText.replace("\r", "\\r");
-    escapedText.replace("\t", "\\t");
-    
-    String json = "{";
-    json += "\"newText\":" + String(newOcrAvailable ? "true" : "false") + ",";
-    json += "\"reading\":" + String(distancePaused ? "true" : "false") + ",";
-    json += "\"text\":\"" + escapedText + "\"";
-    json += "}";
-    server.send(200, "application/json", json);
+    uint32_t run = server.arg("run").toInt();
+    int since = server.arg("since").toInt();
+    bool newText = newOcrAvailable;
+    String text = getOcrText();
+    
+    xSemaphoreTake(ocrTextMutex, portMAX_DELAY);
+    if (run != ocrChunks.run()) since = 0;
+    std::string json = ocrStatusJson(newText, readingMode, text.c_str(), ocrChunks, constrain(since, 0, 255));
+    xSemaphoreGive(ocrTextMutex);
+    server.send(200, "application/json", json.c_str());
+}
+
+// ?before=ID&limit=N: past results newest first; page on with the lowest id
+void handleOcrHistory() {
+    uint32_t before = strtoul(server.arg("before").c_str(), nullptr, 10);
+    int limit = server.hasArg("limit") ? server.arg("limit").toInt() : 10;
+    xSemaphoreTake(ocrTextMutex, portMAX_DELAY);
+    std::string json = ocrHistoryJson(ocrHistory, before, constrain(limit, 1, OCR_HISTORY_PAGE_MAX), millis());
+    xSemaphoreGive(ocrTextMutex);
+    server.send(200, "application/json", json.c_str());
 }
 
 void handleOcrAck() {
@@ -757,71 +1821,633 @@ void handleOcrAck() {
     server.send(200, "text/plain", "OK");
 }
 
+// UI started speaking the first chunk of a run: time to first spoken word
+void handleTtsStarted() {
+    uint32_t run = server.arg("run").toInt();
+    bool expected = true;
+    if (run == ocrRun && firstWordPending.compare_exchange_strong(expected, false)) {
+        uint32_t ms = millis() - ocrRunStarted;
+        firstWordMs.observe(ms);
+        TRACE(TR_EYE_TTS_START, run, ms);
+    }
+    server.send(200, "text/plain", "OK");
+}
+
+// ?mode=auto|sign|page sets the OCR feature choice, ?burst=1..3 the frames
+// per read; replies with the current settings
+void handleOcrMode() {
+    OcrMode mode;
+    if (server.hasArg("mode")) {
+        if (!parseOcrMode(server.arg("mode").c_str(), mode)) {
+            server.send(400, "text/plain", "Bad mode");
+            return;
+        }
+        ocrMode = mode;
+        prefs.begin("haptics", false);
+        prefs.putUChar("ocrMode", mode);
+        prefs.end();
+    }
+    if (server.hasArg("burst")) {
+        long burst = server.arg("burst").toInt();
+        if (burst < 1 || burst > OCR_BURST_MAX) {
+            server.send(400, "text/plain", "Bad burst");
+            return;
+        }
+        ocrBurst = (uint8_t)burst;
+        prefs.begin("haptics", false);
+        prefs.putUChar("ocrBurst", (uint8_t)burst);
+        prefs.end();
+    }
+    String json = "{\"mode\":\"";
+    json += ocrModeName((OcrMode)ocrMode.load());
+    json += "\",\"burst\":";
+    json += ocrBurst.load();
+    json += "}";
+    server.send(200, "application/json", json);
+}
+
+// ?name=vision|gateway picks the OCR backend; replies with the current one
+void handleOcrBackend() {
+    if (server.hasArg("name")) {
+        String name = server.arg("name");
+        uint8_t backend = OCR_BACKENDS;
+        for (uint8_t i = 0; i < OCR_BACKENDS; i++) {
+            if (name == ocrBackends[i]->name()) backend = i;
+        }
+        if (backend == OCR_BACKENDS) {
+            server.send(400, "text/plain", "Bad backend");
+            return;
+        }
+        ocrBackend = backend;   // from the next run on
+        prefs.begin("haptics", false);
+        prefs.putUChar("ocrBackend", backend);
+        prefs.end();
+    }
+    String json = "{\"name\":\"";
+    json += ocrBackends[ocrBackend]->name();
+    json += "\",\"gateway\":\"";
+    json += gatewayBackend.baseUrl();
+    json += "\"}";
+    server.send(200, "application/json", json);
+}
+
 void handleTtsDone() {
-    Serial.println("TTS Done - Resuming Navigation Mode");
-    ttsSpeaking = false;
-    distancePaused = false;
+    // Speech interrupted by a new run: that run owns reading mode until it
+    // ends (bounded by its deadline); /ocr_cancel stops it
+    if (!scheduler.busy()) exitReadingMode(RESUME_TTS_DONE);
     newOcrAvailable = false;
-    ocrInProgress = false;
-    autoResumeTime = 0;
     server.send(200, "text/plain", "OK");
 }
 
+// Lists the bands; ?pair=1 opens the pairing window,
+// ?slot=N&role=all|left|right|center changes a role, ?slot=N&remove=1 unpairs
+void handlePeers() {
+    uint32_t now = millis();
+    if (server.hasArg("pair")) {
+        portENTER_CRITICAL(&peerMux);
+        peers.openPairing(now);
+        portEXIT_CRITICAL(&peerMux);
+    }
+    
+    if (server.hasArg("slot")) {
+        uint8_t slot = constrain(server.arg("slot").toInt(), 0, 255);
+        uint8_t role;
+        uint8_t mac[6];
+        bool ok = false;
+        if (server.hasArg("remove")) {
+            portENTER_CRITICAL(&peerMux);
+            if (peers.used(slot)) memcpy(mac, peers.mac(slot), 6);
+            ok = peers.remove(slot);
+            portEXIT_CRITICAL(&peerMux);
+            if (ok) esp_now_del_peer(mac);
+        } else if (parsePeerRole(server.arg("role").c_str(), role)) {
+            portENTER_CRITICAL(&peerMux);
+            ok = peers.setRole(slot, role);
+            portEXIT_CRITICAL(&peerMux);
+        }
+        if (!ok) {
+            server.send(400, "text/plain", "Bad band or role");
+            return;
+        }
+        peersDirty = true;
+    }
+    
+    PeerTable snapshot;
+    portENTER_CRITICAL(&peerMux);
+    snapshot = peers;
+    portEXIT_CRITICAL(&peerMux);
+    std::string json = peersJson(snapshot, now);
+    server.send(200, "application/json", json.c_str());
+}
+
 void handleDistance() {
-    String json = "{";
-    json += "\"distance\":" + String(smoothedDistance) + ",";
-    json += "\"pattern\":" + String(currentStablePattern) + ",";
-    json += "\"paused\":" + String(distancePaused ? "true" : "false") + ",";
-    json += "\"status\":\"";
-    
-    if (distancePaused) {
-        json += "READING 📖";
-    } else {
-        switch(currentStablePattern) {
-            case 1: json += "CRITICAL"; break;
-            case 2: json += "WARNING"; break;
-            case 3: json += "CAUTION"; break;
-            default: json += "CLEAR"; break;
+    std::string json = distanceJson(navDistance, navPattern, readingMode);
+    server.send(200, "application/json", json.c_str());
+}
+
+// Sparkline data. ?raw=N&summary=M (the "next" values of the previous
+// reply) return only the entries added since.
+void handleHistory() {
+    uint32_t rawSince = server.hasArg("raw") ? strtoul(server.arg("raw").c_str(), nullptr, 10) : 0;
+    uint32_t summarySince = server.hasArg("summary") ? strtoul(server.arg("summary").c_str(), nullptr, 10) : 0;
+    static DistanceHistory snapshot;   // 5 KB, web task only
+    portENTER_CRITICAL(&historyMux);
+    snapshot = history;
+    portEXIT_CRITICAL(&historyMux);
+    std::string json = historyJson(snapshot, rawSince, summarySince);
+    server.send(200, "application/json", json.c_str());
+}
+
+void handleTasks() {
+    StreamString report;
+    monitor.report(report, false);
+    server.send(200, "text/plain", report);
+}
+
+void writeHeap(std::string& out, const char* name, const char* help, size_t (*fn)(uint32_t)) {
+    promHeader(out, name, "gauge", help);
+    promSample(out, name, "pool=\"internal\"", fn(MALLOC_CAP_INTERNAL));
+    promSample(out, name, "pool=\"psram\"", fn(MALLOC_CAP_SPIRAM));
+}
+
+// Per band: frames by status and time since its last ack
+void writePeerMetrics(std::string& out, const PeerTable& table) {
+    static const char* const STATUS[] = { "sent", "refused", "delivered", "failed" };
+    char mac[18];
+    char labels[96];
+    
+    promHeader(out, "visionassist_espnow_peer_frames_total", "counter", "Frames per paired band by status");
+    for (uint8_t i = 0; i < PeerTable::MAX_PEERS; i++) {
+        if (!table.used(i)) continue;
+        const PeerStats& st = table.stats(i);
+        const uint32_t counts[] = { st.sent, st.refused, st.delivered, st.failed };
+        formatMac(table.mac(i), mac);
+        for (uint8_t s = 0; s < 4; s++) {
+            snprintf(labels, sizeof(labels), "peer=\"%s\",role=\"%s\",status=\"%s\"",
+                     mac, peerRoleName(table.role(i)), STATUS[s]);
+            promSample(out, "visionassist_espnow_peer_frames_total", labels, counts[s]);
         }
     }
     
-    json += "\"}";
+    promHeader(out, "visionassist_espnow_peer_last_ack_age_ms", "gauge", "Time since each band last acknowledged a frame");
+    for (uint8_t i = 0; i < PeerTable::MAX_PEERS; i++) {
+        if (!table.used(i) || table.stats(i).lastAck == 0) continue;
+        formatMac(table.mac(i), mac);
+        snprintf(labels, sizeof(labels), "peer=\"%s\"", mac);
+        promSample(out, "visionassist_espnow_peer_last_ack_age_ms", labels, millis() - table.stats(i).lastAck);
+    }
+}
+
+// Snapshot under powerMutex; a scrape itself keeps the radio awake
+void writePower(std::string& out) {
+    uint64_t onMs[POWER_SUBSYSTEMS];
+    uint32_t wakes[POWER_SUBSYSTEMS];
+    uint16_t duty[POWER_SUBSYSTEMS];
+    xSemaphoreTake(powerMutex, portMAX_DELAY);
+    uint32_t now = millis();
+    for (uint8_t s = 0; s < POWER_SUBSYSTEMS; s++) {
+        onMs[s] = power.onMs((PowerSubsystem)s, now);
+        wakes[s] = power.wakes((PowerSubsystem)s);
+        duty[s] = power.dutyPermille((PowerSubsystem)s, now);
+    }
+    uint32_t ma = power.estimatedMa(now);
+    xSemaphoreGive(powerMutex);
+    
+    promHeader(out, "visionassist_power_on_ms_total", "counter", "Time each subsystem was on (camera streaming, radio out of modem sleep)");
+    for (uint8_t s = 0; s < POWER_SUBSYSTEMS; s++) promSample(out, "visionassist_power_on_ms_total", POWER_LABELS[s], onMs[s]);
+    promHeader(out, "visionassist_power_wakes_total", "counter", "Wake-ups from standby / modem sleep");
+    for (uint8_t s = 0; s < POWER_SUBSYSTEMS; s++) promSample(out, "visionassist_power_wakes_total", POWER_LABELS[s], wakes[s]);
+    promHeader(out, "visionassist_power_duty_permille", "gauge", "Share of the last minute each subsystem was on");
+    for (uint8_t s = 0; s < POWER_SUBSYSTEMS; s++) promSample(out, "visionassist_power_duty_permille", POWER_LABELS[s], duty[s]);
+    promHeader(out, "visionassist_power_estimated_ma", "gauge", "Battery current estimated from the duty cycles");
+    promSample(out, "visionassist_power_estimated_ma", nullptr, ma);
+    promHeader(out, "visionassist_camera_wake_ms", "histogram", "Camera standby to first fresh frame");
+    cameraWakeMs.write(out, "visionassist_camera_wake_ms");
+}
+
+void handleMetrics() {
+    std::string out;
+    out.reserve(8192);
+    
+    promHeader(out, "visionassist_uptime_seconds", "gauge", "Seconds since boot");
+    promSample(out, "visionassist_uptime_seconds", nullptr, millis() / 1000);
+    
+    promHeader(out, "visionassist_safety_loop_us", "histogram", "Safety task work per tick");
+    safetyLoopUs.write(out, "visionassist_safety_loop_us");
+    promHeader(out, "visionassist_safety_wake_late_us", "histogram", "Safety task wake-up past its period");
+    safetyLateUs.write(out, "visionassist_safety_wake_late_us");
+    promHeader(out, "visionassist_main_loop_us", "histogram", "loop() work per iteration");
+    mainLoopUs.write(out, "visionassist_main_loop_us");
+    
+    // TOF reads are paced by the sensor; rate() of these gives samples/s
+    const DistanceTracker& tracker = nav.distanceTracker();
+    promHeader(out, "visionassist_tof_samples_total", "counter", "TOF readings (rejected = no target or error)");
+    promSample(out, "visionassist_tof_samples_total", "result=\"accepted\"", tracker.acceptedSamples());
+    promSample(out, "visionassist_tof_samples_total", "result=\"rejected\"", tracker.rejectedSamples());
+    promHeader(out, "visionassist_tof_ready", "gauge", "TOF sensor initialised");
+    promSample(out, "visionassist_tof_ready", nullptr, sensorReady);
+    
+    promHeader(out, "visionassist_espnow_sent_total", "counter", "ESP-NOW send callbacks by status");
+    promSample(out, "visionassist_espnow_sent_total", "status=\"success\"", (uint32_t)sendSuccessCount);
+    promSample(out, "visionassist_espnow_sent_total", "status=\"fail\"", (uint32_t)sendFailCount);
+    promHeader(out, "visionassist_espnow_send_errors_total", "counter", "Frames esp_now_send() refused");
+    promSample(out, "visionassist_espnow_send_errors_total", nullptr, espNowSendErrors.value());
+    promHeader(out, "visionassist_espnow_last_success_age_ms", "gauge", "Time since the last acknowledged frame");
+    promSample(out, "visionassist_espnow_last_success_age_ms", nullptr, millis() - lastSendSuccess);
+    
+    PeerTable peerStats;
+    portENTER_CRITICAL(&peerMux);
+    peerStats = peers;
+    portEXIT_CRITICAL(&peerMux);
+    writePeerMetrics(out, peerStats);
+    promHeader(out, "visionassist_state_frames_total", "counter", "State frames queued for the handband");
+    promSample(out, "visionassist_state_frames_total", nullptr, stateFramesSent.value());
+    
+    promHeader(out, "visionassist_ocr_scheduled_total", "counter", "OCR requests by outcome (cancelled = replaced by a newer one)");
+    for (int i = 0; i < OCR_OUTCOMES; i++) {
+        promSample(out, "visionassist_ocr_scheduled_total", OCR_OUTCOME_LABELS[i], scheduler.outcomes((OcrOutcome)i));
+    }
+    promHeader(out, "visionassist_ocr_retries_total", "counter", "OCR attempts retried after a transient failure");
+    promSample(out, "visionassist_ocr_retries_total", nullptr, scheduler.retries());
+    promHeader(out, "visionassist_ocr_requests_total", "counter", "OCR requests by result, retries counted once");
+    for (int i = 0; i < OCR_RESULTS; i++) {
+        promSample(out, "visionassist_ocr_requests_total", OCR_RESULT_LABELS[i], ocrResults[i].value());
+    }
+    promHeader(out, "visionassist_ocr_stage_ms", "histogram", "OCR latency by stage");
+    for (int i = 0; i < OCR_STAGES; i++) {
+        ocrStageMs[i].write(out, "visionassist_ocr_stage_ms", OCR_STAGE_LABELS[i]);
+    }
+    promHeader(out, "visionassist_ocr_feature_total", "counter", "Vision requests by detection feature");
+    for (int i = 0; i < 2; i++) {
+        promSample(out, "visionassist_ocr_feature_total", OCR_FEATURE_LABELS[i], ocrFeatures[i].value());
+    }
+    promHeader(out, "visionassist_ocr_backend_ms", "histogram", "OCR run (capture to text) by backend");
+    for (int i = 0; i < OCR_BACKENDS; i++) {
+        ocrBackendMs[i].write(out, "visionassist_ocr_backend_ms", OCR_BACKEND_LABELS[i]);
+    }
+    promHeader(out, "visionassist_ocr_request_bytes", "histogram", "OCR request body bytes by backend");
+    for (int i = 0; i < OCR_BACKENDS; i++) {
+        ocrRequestBytes[i].write(out, "visionassist_ocr_request_bytes", OCR_BACKEND_LABELS[i]);
+    }
+    promHeader(out, "visionassist_ocr_exposure_ms", "histogram", "Exposure control before the OCR shot");
+    exposureMs.write(out, "visionassist_ocr_exposure_ms");
+    promHeader(out, "visionassist_ocr_exposure_total", "counter", "OCR shots by exposure result");
+    promHeader(out, "visionassist_ocr_exposure_useful_total", "counter", "OCR shots that gave useful text, by exposure result");
+    for (int i = ExposureController::EXPOSURE_CONVERGED; i < ExposureController::EXPOSURE_RESULTS; i++) {
+        promSample(out, "visionassist_ocr_exposure_total", EXPOSURE_RESULT_LABELS[i], exposureResults[i].value());
+        promSample(out, "visionassist_ocr_exposure_useful_total", EXPOSURE_RESULT_LABELS[i], exposureUseful[i].value());
+    }
+    promHeader(out, "visionassist_ocr_text_gate_ms", "histogram", "Text presence check on the OCR shot");
+    textGateMs.write(out, "visionassist_ocr_text_gate_ms");
+    promHeader(out, "visionassist_ocr_reads_total", "counter", "OCR reads by frames per read (burst size)");
+    promHeader(out, "visionassist_ocr_reads_useful_total", "counter", "OCR reads that gave useful text, by frames per read");
+    for (uint8_t i = 0; i < OCR_BURST_MAX; i++) {
+        promSample(out, "visionassist_ocr_reads_total", BURST_LABELS[i], ocrReads[i].value());
+        promSample(out, "visionassist_ocr_reads_useful_total", BURST_LABELS[i], ocrReadsUseful[i].value());
+    }
+    promHeader(out, "visionassist_ocr_read_ms", "histogram", "OCR run (capture to text) by frames per read");
+    for (uint8_t i = 0; i < OCR_BURST_MAX; i++) ocrReadMs[i].write(out, "visionassist_ocr_read_ms", BURST_LABELS[i]);
+    promHeader(out, "visionassist_ocr_response_bytes", "histogram", "OCR response body bytes read");
+    ocrResponseBytes.write(out, "visionassist_ocr_response_bytes");
+    promHeader(out, "visionassist_ocr_first_word_ms", "histogram", "Touch to first spoken word (reported by the UI)");
+    firstWordMs.write(out, "visionassist_ocr_first_word_ms");
+    promHeader(out, "visionassist_ocr_arena_high_water_bytes", "gauge", "Peak OCR arena use since boot");
+    promSample(out, "visionassist_ocr_arena_high_water_bytes", nullptr, ocrArena.highWater());
+    promHeader(out, "visionassist_ocr_arena_overflows_total", "counter", "OCR allocations that did not fit the arena");
+    promSample(out, "visionassist_ocr_arena_overflows_total", nullptr, ocrArena.overflows());
+    promHeader(out, "visionassist_flight_records_total", "counter", "Flight recorder records written");
+    promSample(out, "visionassist_flight_records_total", nullptr, flight.written());
+    promHeader(out, "visionassist_flight_capacity_records", "gauge", "Flight recorder ring size (0 = off)");
+    promSample(out, "visionassist_flight_capacity_records", nullptr, flight.capacity());
+    promHeader(out, "visionassist_images_captured_total", "counter", "Frames served by /capture");
+    promSample(out, "visionassist_images_captured_total", nullptr, imageCount);
+    writePower(out);
+    
+    writeHeap(out, "visionassist_heap_free_bytes", "Free heap", heap_caps_get_free_size);
+    writeHeap(out, "visionassist_heap_largest_free_bytes", "Largest free block", heap_caps_get_largest_free_block);
+    writeHeap(out, "visionassist_heap_min_free_bytes", "Lowest free heap since boot", heap_caps_get_minimum_free_size);
+    
+    char labels[64];
+    promHeader(out, "visionassist_http_requests_total", "counter", "HTTP requests by route");
+    for (int i = 0; i < routeCount; i++) {
+        snprintf(labels, sizeof(labels), "route=\"%s\"", routeStats[i].path);
+        promSample(out, "visionassist_http_requests_total", labels, routeStats[i].requests.value());
+    }
+    promHeader(out, "visionassist_http_request_ms", "histogram", "HTTP handler latency by route");
+    for (int i = 0; i < routeCount; i++) {
+        snprintf(labels, sizeof(labels), "route=\"%s\"", routeStats[i].path);
+        routeStats[i].latencyMs.write(out, "visionassist_http_request_ms", labels);
+    }
+    
+    server.send(200, "text/plain; version=0.0.4", out.c_str());
+}
+
+// Flight recorder dump: FlightHeader, then the records oldest first
+// (Host-Tools flight_decode). Recording goes on while it streams.
+void handleFlight() {
+    if (!flight.enabled()) {
+        server.send(503, "text/plain", "Flight recorder off (no PSRAM)");
+        return;
+    }
+    FlightHeader header;
+    uint32_t cursor, end;
+    flight.header(header, tof.zoneCount(), cursor, end);
+    
+    server.sendHeader("Content-Disposition", "attachment; filename=\"flight.bin\"");
+    server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+    server.send(200, "application/octet-stream", "");
+    server.sendContent((const char*)&header, sizeof(header));
+    FlightRecord chunk[FLIGHT_CHUNK_RECORDS];
+    size_t n;
+    while ((n = flight.read(cursor, end, chunk, FLIGHT_CHUNK_RECORDS)) > 0) {
+        server.sendContent((const char*)chunk, n * sizeof(FlightRecord));
+    }
+    server.sendContent("");
+}
+
+// Register a handler with a request counter and latency histogram
+void route(const char* path, WebServer::THandlerFunction handler) {
+    if (routeCount >= MAX_ROUTES) {
+        server.on(path, handler);
+        return;
+    }
+    RouteStats* stats = &routeStats[routeCount++];
+    stats->path = path;
+    stats->handler = handler;
+    server.on(path, [stats]() {
+        uint32_t started = millis();
+        webActivity();
+        stats->handler();
+        stats->requests.inc();
+        stats->latencyMs.observe(millis() - started);
+    });
+}
+
+void handlePatterns() {
+    PatternDesc table[PATTERN_COUNT];
+    portENTER_CRITICAL(&tableMux);
+    memcpy(table, patternTable, sizeof(table));
+    uint8_t version = patternTableVersion;
+    portEXIT_CRITICAL(&tableMux);
+    
+    String json = "{\"version\":" + String(version) + ",\"patterns\":[";
+    for (int i = 0; i < PATTERN_COUNT; i++) {
+        if (i > 0) json += ",";
+        json += "[" + String(table[i].onMs) + "," + String(table[i].offMs) + "]";
+    }
+    json += "]}";
     server.send(200, "application/json", json);
 }
 
+void handleSetPattern() {
+    int id = server.arg("id").toInt();
+    if (id < 1 || id >= PATTERN_COUNT || !server.hasArg("on") || !server.hasArg("off")) {
+        server.send(400, "text/plain", "Bad pattern");
+        return;
+    }
+    
+    uint16_t onMs = constrain(server.arg("on").toInt(), 0, 5000);
+    uint16_t offMs = constrain(server.arg("off").toInt(), 0, 5000);
+    
+    portENTER_CRITICAL(&tableMux);
+    patternTable[id].onMs = onMs;
+    patternTable[id].offMs = offMs;
+    // Version 0 is reserved for the handband's built-in table
+    if (++patternTableVersion == 0) patternTableVersion = 1;
+    portEXIT_CRITICAL(&tableMux);
+    
+    savePatternTable();
+    patternTableRequested = true;
+    
+    TRACE(TR_EYE_TABLE_SET, id, patternTableVersion);
+    handlePatterns();
+}
+
 // ===========================================
 // ESP-NOW Callback
 // ===========================================
 void OnDataSent(const uint8_t *mac, esp_now_send_status_t status) {
-    if (status == ESP_NOW_SEND_SUCCESS) {
+    bool ok = status == ESP_NOW_SEND_SUCCESS;
+    if (ok) {
         lastSendSuccess = millis();
         sendSuccessCount++;
     } else {
         lastSendFail = millis();
         sendFailCount++;
+        TRACE(TR_EYE_SEND_FAIL, sendFailCount, sendSuccessCount);
+    }
+    
+    portENTER_CRITICAL(&peerMux);
+    int slot = peers.onDelivery(millis(), mac, ok);
+    bool lost = slot >= 0 && !ok && peers.stats(slot).failStreak == PeerTable::UNREACHABLE_AFTER;
+    portEXIT_CRITICAL(&peerMux);
+    if (slot >= 0) flight.record(FR_ACK, slot, ok);   // not the beacons
+    if (lost) TRACE(TR_EYE_PEER_LOST, slot, PeerTable::UNREACHABLE_AFTER);
+}
+
+// Called from the receive callback: only queues the request
+void queuePairRequest(const uint8_t *mac, uint8_t wantedRole) {
+    portENTER_CRITICAL(&peerMux);
+    uint8_t i = 0;
+    while (i < pairRequestCount && memcmp(pairRequests[i].mac, mac, 6) != 0) i++;
+    if (i < PeerTable::MAX_PEERS) {
+        memcpy(pairRequests[i].mac, mac, 6);
+        pairRequests[i].role = wantedRole;
+        if (i == pairRequestCount) pairRequestCount++;
+    }
+    portEXIT_CRITICAL(&peerMux);
+}
+
+// Known bands are acknowledged any time, new ones while pairing is open
+void answerPairRequest(const uint8_t *mac, uint8_t wantedRole) {
+    bool added;
+    portENTER_CRITICAL(&peerMux);
+    int slot = peers.pair(millis(), mac, wantedRole, added);
+    uint8_t role = slot >= 0 ? peers.role(slot) : ROLE_ALL;
+    portEXIT_CRITICAL(&peerMux);
+    if (slot < 0) return;
+    
+    if (added) {
+        peersDirty = true;
+        patternTableRequested = true;
+        TRACE(TR_EYE_PEER_PAIRED, slot, role);
+    }
+    if (!addEspNowPeer(mac)) return;
+    
+    PairAckFrame ack;
+    ack.type = MSG_PAIR_ACK;
+    ack.role = role;
+    ack.slot = slot;
+    bool ok = radio.send(mac, (uint8_t*)&ack, sizeof(ack));
+    if (!ok) espNowSendErrors.inc();
+}
+
+// Safety task: answers the requests queued since the last tick
+void answerPairRequests() {
+    PairRequest pending[PeerTable::MAX_PEERS];
+    portENTER_CRITICAL(&peerMux);
+    uint8_t count = pairRequestCount;
+    memcpy(pending, pairRequests, count * sizeof(PairRequest));
+    pairRequestCount = 0;
+    portEXIT_CRITICAL(&peerMux);
+    for (uint8_t i = 0; i < count; i++) answerPairRequest(pending[i].mac, pending[i].role);
+}
+
+void OnDataRecv(const uint8_t *mac, const uint8_t *data, int len) {
+    if (len >= (int)sizeof(TableRequestFrame) && data[0] == MSG_TABLE_REQUEST) {
+        patternTableRequested = true;
+    }
+    if (len >= (int)sizeof(PairRequestFrame) && data[0] == MSG_PAIR_REQUEST) {
+        queuePairRequest(mac, ((const PairRequestFrame*)data)->role);
     }
 }
 
 // ===========================================
-// WiFi Init
+// Startup / Web Tasks (core 0)
 // ===========================================
-void initWiFi() {
+void cameraInitTask(void* param) {
+    if (initCamera()) {
+        cameraReady = true;
+        bootLog("Camera ready");
+    } else {
+        bootLog("Camera FAILED - OCR unavailable");
+    }
+    vTaskDelete(NULL);
+}
+
+// Joins the AP, then stays on as the web server
+void webTask(void* param) {
     Serial.printf("Connecting to: %s\n", ssid);
-    WiFi.mode(WIFI_STA);
-    WiFi.begin(ssid, password);
     
-    int attempts = 0;
-    while (WiFi.status() != WL_CONNECTED && attempts++ < 30) {
-        delay(500);
-        Serial.print(".");
+    // Retry forever - obstacle detection does not depend on WiFi
+    while (WiFi.status() != WL_CONNECTED) {
+        WiFi.begin(ssid, password, savedWiFiChannel);
+        for (int attempts = 0; attempts < 30 && WiFi.status() != WL_CONNECTED; attempts++) {
+            delay(500);
+        }
+        if (WiFi.status() != WL_CONNECTED) {
+            bootLog("WiFi not connected - retrying");
+            WiFi.disconnect();
+            savedWiFiChannel = 0;  // AP may have moved - full scan next time
+        }
+    }
+    bootLog("WiFi connected");
+    
+    // Remember the AP channel so ESP-NOW starts on it next boot
+    uint8_t channel = WiFi.channel();
+    if (channel != savedWiFiChannel) {
+        prefs.begin("haptics", false);
+        prefs.putUChar("wifiChan", channel);
+        prefs.end();
     }
     
-    if (WiFi.status() == WL_CONNECTED) {
-        Serial.println("\n✓ WiFi Connected");
-        Serial.print("IP: ");
-        Serial.println(WiFi.localIP());
-    } else {
-        Serial.println("\n✗ WiFi FAILED");
+    server.begin();
+    wifiReady = true;
+    bootLog("Web server ready");
+    
+    Serial.println("\n========================================");
+    Serial.println("  SYSTEM READY!");
+    Serial.print("  Phone browser: http://");
+    Serial.println(WiFi.localIP());
+    Serial.printf("  WiFi channel: %d\n", channel);
+    Serial.println("========================================\n");
+    
+    for (;;) {
+        monitor.begin(SLOT_WEB);
+        server.handleClient();
+        monitor.end(SLOT_WEB);
+        vTaskDelay(pdMS_TO_TICKS(WEB_POLL_MS));
+    }
+}
+
+// ===========================================
+// Trace Drain Task (core 0, lowest priority)
+// ===========================================
+// Only this task writes trace records to serial, so a full TX
+// buffer stalls it instead of the code that traced
+void traceTask(void* param) {
+    static uint8_t frame[5 + TRACE_FRAME_MAX_RECORDS * sizeof(TraceRecord)];
+    for (;;) {
+        monitor.begin(SLOT_TRACE);
+        size_t len;
+        while ((len = traceDrain(frame, sizeof(frame))) > 0) {
+            Serial.write(frame, len);
+        }
+        // Reported once the ring has room again
+        uint32_t lost = traceTakeDropped();
+        if (lost) TRACE(TR_DROPPED, lost, 0);
+        
+        monitor.end(SLOT_TRACE);
+        vTaskDelay(pdMS_TO_TICKS(TRACE_DRAIN_MS));
+    }
+}
+
+// ===========================================
+// Safety Task (core 1, highest app priority)
+// ===========================================
+void safetyTask(void* param) {
+    TickType_t wake = xTaskGetTickCount();
+    bool firstFrameLogged = false;
+    unsigned long lastBeacon = 0;
+    uint32_t lastStartUs = 0;
+    int recordedDistance = -1;
+    int recordedPattern = -1;
+    
+    for (;;) {
+        monitor.begin(SLOT_SAFETY);
+        uint32_t startUs = micros();
+        if (lastStartUs != 0) {
+            uint32_t periodUs = startUs - lastStartUs;
+            safetyLateUs.observe(periodUs > SAFETY_PERIOD_MS * 1000 ? periodUs - SAFETY_PERIOD_MS * 1000 : 0);
+        }
+        lastStartUs = startUs;
+        unsigned long now = sysClock.millis();
+        
+        answerPairRequests();
+        if (patternTableRequested.exchange(false)) {
+            sendPatternTable();
+        }
+        updateTofZones();
+        
+        if (now - lastBeacon >= BEACON_INTERVAL) {
+            BeaconFrame beacon;
+            beacon.type = MSG_BEACON;
+            beacon.channel = WiFi.channel();
+            if (!radio.send(beaconAddress, (uint8_t*)&beacon, sizeof(beacon))) espNowSendErrors.inc();
+            lastBeacon = now;
+        }
+        
+        StateFrame frame;
+        if (nav.step(now, sensorReady ? &zoneMap : nullptr, readingMode, patternTableVersion, frame)) {
+            // Every band's cue first, then the sends in one pass
+            PeerTable::Send batch[PeerTable::MAX_PEERS];
+            portENTER_CRITICAL(&peerMux);
+            uint8_t count = peers.plan(now, frame, zoneMap, nav.zones(), batch);
+            portEXIT_CRITICAL(&peerMux);
+            sendBatch(batch, count);
+            
+            if (!firstFrameLogged && count > 0) {
+                firstFrameLogged = true;
+                bootLog("First state frame sent");
+            }
+        }
+        navDistance = nav.distance();
+        navPattern = nav.stablePattern();
+        portENTER_CRITICAL(&historyMux);
+        history.add(now, nav.distance(), nav.stablePattern());
+        portEXIT_CRITICAL(&historyMux);
+        if (nav.distance() != recordedDistance) {
+            recordedDistance = nav.distance();
+            flight.record(FR_DISTANCE, 0, recordedDistance);
+        }
+        if (nav.stablePattern() != recordedPattern) {
+            recordedPattern = nav.stablePattern();
+            flight.record(FR_ZONE, recordedPattern, recordedDistance);
+        }
+        
+        safetyLoopUs.observe(micros() - startUs);
+        monitor.end(SLOT_SAFETY);
+        vTaskDelayUntil(&wake, pdMS_TO_TICKS(SAFETY_PERIOD_MS));
     }
 }
 
@@ -829,8 +2455,13 @@ void initWiFi() {
 // ESP-NOW Init
 // ===========================================
 void initESPNow() {
-    int32_t channel = WiFi.channel();
-    Serial.printf("WiFi Channel: %d\n", channel);
+    // Start on the last AP channel so joining the AP later does not move us
+    WiFi.mode(WIFI_STA);
+    WiFi.setSleep(false);   // PowerManager starts with the radio on
+    if (savedWiFiChannel > 0) {
+        esp_wifi_set_channel(savedWiFiChannel, WIFI_SECOND_CHAN_NONE);
+    }
+    Serial.printf("ESP-NOW Channel: %d\n", WiFi.channel());
     
     if (esp_now_init() != ESP_OK) {
         Serial.println("✗ ESP-NOW FAILED");
@@ -838,16 +2469,18 @@ void initESPNow() {
     }
     Serial.println("✓ ESP-NOW OK");
     
-    esp_now_register_send_cb(OnDataSent);
-    
-    memcpy(peerInfo.peer_addr, broadcastAddress, 6);
-    peerInfo.channel = channel;
-    peerInfo.encrypt = false;
-    peerInfo.ifidx = WIFI_IF_STA;
-    
-    if (esp_now_add_peer(&peerInfo) == ESP_OK) {
-        Serial.println("✓ Peer Added");
+    loadPeers();
+    for (uint8_t i = 0; i < PeerTable::MAX_PEERS; i++) {
+        if (peers.used(i) && !addEspNowPeer(peers.mac(i))) {
+            Serial.printf("✗ Band %u not added\n", i);
+        }
     }
+    addEspNowPeer(beaconAddress);
+    peers.openPairing(millis());
+    
+    esp_now_register_send_cb(OnDataSent);
+    esp_now_register_recv_cb(OnDataRecv);
+    sendPatternTable();
 }
 
 // ===========================================
@@ -855,178 +2488,160 @@ void initESPNow() {
 // ===========================================
 void setup() {
     Serial.begin(115200);
-    delay(2000);
     
     Serial.println("\n========================================");
     Serial.println("  VISIONASSIST - EYEWEAR UNIT");
     Serial.println("  Touch + Camera + TOF + Voice");
     Serial.println("========================================\n");
+    bootLog("Serial up");
+    
+    traceBegin(sysClock, 'E');
+    uint32_t traceCost = traceMeasureCostNs(2000);
+    TRACE(TR_COST, traceCost, 2000);
+    Serial.printf("✓ Trace level %d, %u ns/event\n", TRACE_LEVEL, traceCost);
+    
+    ocrTextMutex = xSemaphoreCreateMutex();
+    powerMutex = xSemaphoreCreateMutex();
+    PowerManager::Config powerCfg;
+    powerCfg.cameraIdleMs = CAMERA_IDLE_MS;
+    powerCfg.radioIdleMs = RADIO_IDLE_MS;
+    power.begin(millis(), powerCfg);
+    ocrRequests = xQueueCreate(1, sizeof(OcrRequest));
+    ocrReplies = xQueueCreate(1, sizeof(OcrReply));
+    
+    void* arenaMem = heap_caps_malloc(OCR_ARENA_BYTES, MALLOC_CAP_SPIRAM);
+    if (arenaMem) {
+        ocrArena.attach(arenaMem, OCR_ARENA_BYTES);
+        Serial.printf("✓ OCR arena %u KB in PSRAM\n", OCR_ARENA_BYTES / 1024);
+    } else {
+        Serial.println("⚠️ No PSRAM, OCR buffers use the heap");
+    }
+    void* flightMem = heap_caps_malloc(FLIGHT_RECORDER_BYTES, MALLOC_CAP_SPIRAM);
+    flight.begin(sysClock, flightMem, flightMem ? FLIGHT_RECORDER_BYTES : 0);
+    if (flightMem) {
+        Serial.printf("✓ Flight recorder %u KB in PSRAM\n", FLIGHT_RECORDER_BYTES / 1024);
+    } else {
+        Serial.println("⚠️ No PSRAM, flight recorder off");
+    }
+    void* historyMem = heap_caps_malloc(OCR_HISTORY_BYTES, MALLOC_CAP_SPIRAM);
+    size_t historyBytes = OCR_HISTORY_BYTES;
+    if (!historyMem) {
+        historyBytes = OCR_HISTORY_HEAP_BYTES;
+        historyMem = malloc(historyBytes);
+    }
+    ocrHistory.attach(historyMem, historyMem ? historyBytes : 0);
+    loadOcrHistory();
     
     pinMode(TOUCH_PIN, INPUT);
     Serial.println("✓ Touch Sensor on GPIO7");
     
-    if (!initCamera()) {
-        Serial.println("FATAL: Camera failed!");
-        while(1) delay(1000);
-    }
-    
-    initWiFi();
-    
-    if (WiFi.status() != WL_CONNECTED) {
-        Serial.println("FATAL: WiFi required!");
-        delay(3000);
-        ESP.restart();
-    }
-    
+    // Safety path first: radio + TOF, no dependency on the AP
+    loadPatternTable();
     initESPNow();
-    initTOF();
-    
-    server.on("/", handleRoot);
-    server.on("/capture", handleCapture);
-    server.on("/ocr", handleOCR);
-    server.on("/getOcrText", handleGetOcrText);
-    server.on("/ocr_status", handleOcrStatus);
-    server.on("/ocr_ack", handleOcrAck);
-    server.on("/tts_done", handleTtsDone);
-    server.on("/distance", handleDistance);
-    
-    server.begin();
+    bootLog("ESP-NOW ready");
     
-    lastGoodReading = millis();
-    
-    Serial.println("\n========================================");
-    Serial.println("  SYSTEM READY!");
-    Serial.print("  Phone browser: http://");
-    Serial.println(WiFi.localIP());
-    Serial.println("  Touch sensor: GPIO7");
-    Serial.println("========================================\n");
+    initTOF();
+    nav.reset(millis());
+    
+    TaskHandle_t handle;
+    xTaskCreatePinnedToCore(safetyTask, "safety", SAFETY_STACK, NULL, SAFETY_PRIORITY, &handle, 1);
+    monitor.add(SLOT_SAFETY, "safety", handle, SAFETY_STACK, 1, SAFETY_PRIORITY);
+    monitor.add(SLOT_LOOP, "loop", xTaskGetCurrentTaskHandle(), getArduinoLoopTaskStackSize(),
+                xPortGetCoreID(), uxTaskPriorityGet(NULL));
+    bootLog(sensorReady ? "Obstacle detection active" : "Obstacle detection unavailable (no TOF)");
+    
+    route("/", handleRoot);
+    route("/capture", handleCapture);
+    route("/ocr", handleOCR);
+    route("/getOcrText", handleGetOcrText);
+    route("/ocr_status", handleOcrStatus);
+    route("/ocr_ack", handleOcrAck);
+    route("/tts_started", handleTtsStarted);
+    route("/ocr_mode", handleOcrMode);
+    route("/ocr_backend", handleOcrBackend);
+    route("/tts_done", handleTtsDone);
+    route("/ocr_cancel", handleOcrCancel);
+    route("/ocr/history", handleOcrHistory);
+    route("/distance", handleDistance);
+    route("/history", handleHistory);
+    route("/peers", handlePeers);
+    route("/patterns", handlePatterns);
+    route("/patterns_set", handleSetPattern);
+    route("/tasks", handleTasks);
+    route("/metrics", handleMetrics);
+    route("/flight", handleFlight);
+    
+    // Camera and WiFi come up in the background on core 0 (loop() runs on core 1)
+    xTaskCreatePinnedToCore(cameraInitTask, "cameraInit", 8192, NULL, 1, NULL, 0);
+    xTaskCreatePinnedToCore(ocrTask, "ocr", OCR_STACK, NULL, OCR_PRIORITY, &handle, 0);
+    monitor.add(SLOT_OCR, "ocr", handle, OCR_STACK, 0, OCR_PRIORITY);
+    xTaskCreatePinnedToCore(webTask, "web", WEB_STACK, NULL, WEB_PRIORITY, &handle, 0);
+    monitor.add(SLOT_WEB, "web", handle, WEB_STACK, 0, WEB_PRIORITY);
+    xTaskCreatePinnedToCore(traceTask, "trace", TRACE_STACK, NULL, TRACE_PRIORITY, &handle, 0);
+    monitor.add(SLOT_TRACE, "trace", handle, TRACE_STACK, 0, TRACE_PRIORITY);
 }
 
 // ===========================================
-// Loop
+// Loop (core 1, below the safety task)
 // ===========================================
+// Touch, reading-mode timers and serial status
 void loop() {
-    unsigned long now = millis();
-    
-    static unsigned long lastWebHandle = 0;
-    if (now - lastWebHandle >= 100) {
-        server.handleClient();
-        lastWebHandle = now;
+    monitor.begin(SLOT_LOOP);
+    uint32_t startUs = micros();
+    unsigned long now = sysClock.millis();
+    
+    // A new touch replaces whatever is being read (latest wins)
+    static int lastTouchState = LOW;
+    int touchState = gpio.digitalRead(TOUCH_PIN);
+    if (touchState == HIGH && lastTouchState == LOW && (now - lastTouchTime > TOUCH_DEBOUNCE)) {
+        lastTouchTime = now;
+        TRACE(TR_EYE_TOUCH, 0, 0);
+        requestOCR(OCR_TOUCH);
     }
+    lastTouchState = touchState;
     
-    if (!ocrInProgress && !ttsSpeaking) {
-        int touchState = digitalRead(TOUCH_PIN);
-        if (touchState == HIGH && (now - lastTouchTime > TOUCH_DEBOUNCE)) {
-            lastTouchTime = now;
-            Serial.println("\n👆 TOUCH DETECTED!");
-            triggerOCR();
-        }
+    if (peersDirty.exchange(false)) {
+        savePeers();
     }
-    
-    if (autoResumeTime > 0 && now >= autoResumeTime) {
-        Serial.println(" Auto-resume");
-        ttsSpeaking = false;
-        distancePaused = false;
-        autoResumeTime = 0;
+    uint8_t historyPending = ocrHistoryPending.load();
+    if (historyPending > 0 && (historyPending >= OCR_HISTORY_SAVE_ENTRIES ||
+                               now - lastOcrHistorySave >= OCR_HISTORY_SAVE_INTERVAL)) {
+        ocrHistoryPending -= historyPending;
+        lastOcrHistorySave = now;
+        saveOcrHistory();
     }
+    updatePower(now);
     
-    if (distancePaused && (now - ttsStartTime > TTS_TIMEOUT)) {
-        Serial.println("⚠️ TTS Timeout");
-        ttsSpeaking = false;
-        distancePaused = false;
-        autoResumeTime = 0;
-    }
-    
-    static unsigned long lastTofRead = 0;
-    int rawDistance = -1;
-    
-    if (sensorReady && (now - lastTofRead >= 20)) {
-        if (vl53.dataReady()) {
-            rawDistance = vl53.distance();
-            vl53.clearInterrupt();
-            lastTofRead = now;
-            
-            if (rawDistance > 0 && rawDistance < 4000) {
-                lastGoodReading = now;
-                
-                static int fastReadings[3] = {5000, 5000, 5000};
-                static int fastIndex = 0;
-                
-                fastReadings[fastIndex] = rawDistance;
-                fastIndex = (fastIndex + 1) % 3;
-                
-                smoothedDistance = (fastReadings[0] + fastReadings[1] + fastReadings[2]) / 3;
-            }
-        }
+    // Past its deadline: resume navigation now, the OCR task unwinds later
+    if (scheduler.abandonLate()) {
+        exitReadingMode(RESUME_ABANDONED);
     }
     
-    if (now - lastGoodReading > 1000) {
-        smoothedDistance = 5000;
-        lastGoodReading = now;
+    uint32_t resumeAt = autoResumeAt;
+    if (resumeAt > 0 && now >= resumeAt) {
+        exitReadingMode(RESUME_AUTO);
     }
     
-    int newPattern;
-    if (smoothedDistance < CRITICAL_DISTANCE) {
-        newPattern = 1;
-    } else if (smoothedDistance < WARNING_DISTANCE) {
-        newPattern = 2;
-    } else if (smoothedDistance < CAUTION_DISTANCE) {
-        newPattern = 3;
-    } else {
-        newPattern = 0;
-    }
-    
-    bool sendNow = false;
-    if (newPattern == 1 && currentStablePattern != 1) {
-        currentStablePattern = 1;
-        sendNow = true;
-    } else if (newPattern != lastPattern) {
-        lastPattern = newPattern;
-        stableCount = 0;
-        if (newPattern == 0) {
-            currentStablePattern = 0;
-            sendNow = true;
-        }
-    } else {
-        stableCount++;
-        if (stableCount >= 1 && currentStablePattern != newPattern) {
-            currentStablePattern = newPattern;
-            sendNow = true;
-        }
+    if (readingMode && (now - readingSince > TTS_TIMEOUT)) {
+        exitReadingMode(RESUME_TIMEOUT);
     }
     
-    static unsigned long lastEspNowSend = 0;
-    
-    if (sendNow || (now - lastEspNowSend >= 50)) {
-        if (distancePaused) {
-            strcpy(outgoingData.command, "PAUSE");
-            outgoingData.distance = 0;
-            outgoingData.pattern = 0;
+    if (now - lastPrint >= 500) {
+        if (readingMode) {
+            TRACE(TR_EYE_STATUS_READ, navDistance, navPattern);
         } else {
-            switch(currentStablePattern) {
-                case 1: strcpy(outgoingData.command, "CRITICAL"); break;
-                case 2: strcpy(outgoingData.command, "WARNING"); break;
-                case 3: strcpy(outgoingData.command, "CAUTION"); break;
-                default: strcpy(outgoingData.command, "CLEAR"); break;
-            }
-            outgoingData.distance = smoothedDistance;
-            outgoingData.pattern = currentStablePattern;
+            TRACE(TR_EYE_STATUS, navDistance, navPattern);
         }
-        
-        esp_now_send(broadcastAddress, (uint8_t*)&outgoingData, sizeof(outgoingData));
-        lastEspNowSend = now;
+        lastPrint = now;
     }
     
-    if (now - lastPrint >= 500) {
-        if (distancePaused) {
-            Serial.print(" READ | ");
-        }
-        Serial.print("D:");
-        Serial.print(smoothedDistance);
-        Serial.print("mm P:");
-        Serial.println(currentStablePattern);
-        lastPrint = now;
+    static unsigned long lastReport = 0;
+    if (now - lastReport >= TASK_REPORT_INTERVAL) {
+        monitor.report(Serial, true);
+        lastReport = now;
     }
     
-    yield();
-}
\ No newline at end of file
+    mainLoopUs.observe(micros() - startUs);
+    monitor.end(SLOT_LOOP);
+    vTaskDelay(pdMS_TO_TICKS(10));
+}
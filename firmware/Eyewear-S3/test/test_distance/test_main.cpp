@@ -0,0 +1,130 @@
+/*
+ * ============================================
+ * VisionAssist - DistanceTracker / ZoneClassifier tests
+ * ============================================
+ *
+ *   pio test -e native
+ * ============================================
+ */
+
+#include <unity.h>
+#include <DistanceTracker.h>
+#include <ZoneClassifier.h>
+
+void setUp() {}
+void tearDown() {}
+
+// ===========================================
+// DistanceTracker
+// ===========================================
+void test_tracker_averages_last_three() {
+  DistanceTracker t;
+  t.reset(0);
+  t.addSample(100, 1000);
+  t.addSample(120, 1100);
+  t.addSample(140, 1200);
+  TEST_ASSERT_EQUAL_INT(1100, t.distance());
+  t.addSample(160, 1500);   // replaces the oldest (1000)
+  TEST_ASSERT_EQUAL_INT((1100 + 1200 + 1500) / 3, t.distance());
+}
+
+void test_tracker_rejects_out_of_range() {
+  DistanceTracker t;
+  t.reset(0);
+  for (int i = 0; i < 3; i++) t.addSample(100 + i * 20, 1500);
+  TEST_ASSERT_FALSE(t.addSample(200, 0));
+  TEST_ASSERT_FALSE(t.addSample(220, -5));
+  TEST_ASSERT_FALSE(t.addSample(240, DistanceTracker::MAX_RANGE));
+  TEST_ASSERT_EQUAL_INT(1500, t.distance());
+  TEST_ASSERT_EQUAL_UINT32(3, t.acceptedSamples());
+  TEST_ASSERT_EQUAL_UINT32(3, t.rejectedSamples());
+}
+
+void test_tracker_closing_speed() {
+  DistanceTracker t;
+  t.reset(0);
+  // 10 mm closer every 100 ms: 100 mm/s once the start-up transient decays
+  for (int i = 1; i <= 40; i++) t.addSample(i * 100, 2000 - i * 10);
+  TEST_ASSERT_FLOAT_WITHIN(5.0f, 100.0f, t.closingSpeed());
+
+  // Receding: speed goes negative
+  for (int i = 41; i <= 80; i++) t.addSample(i * 100, 1600 + (i - 40) * 10);
+  TEST_ASSERT_FLOAT_WITHIN(5.0f, -100.0f, t.closingSpeed());
+}
+
+void test_tracker_goes_stale() {
+  DistanceTracker t;
+  t.reset(0);
+  for (int i = 0; i < 3; i++) t.addSample(1000, 1200);
+  t.update(1000 + DistanceTracker::STALE_TIMEOUT);
+  TEST_ASSERT_EQUAL_INT(1200, t.distance());
+  t.update(1001 + DistanceTracker::STALE_TIMEOUT);
+  TEST_ASSERT_EQUAL_INT(DistanceTracker::NO_OBSTACLE, t.distance());
+  TEST_ASSERT_FLOAT_WITHIN(0.001f, 0.0f, t.closingSpeed());
+}
+
+// ===========================================
+// ZoneClassifier
+// ===========================================
+void test_zone_thresholds() {
+  ZoneClassifier z;
+  TEST_ASSERT_EQUAL_INT(PATTERN_CRITICAL, z.classify(0));
+  TEST_ASSERT_EQUAL_INT(PATTERN_CRITICAL, z.classify(CRITICAL_DISTANCE - 1));
+  TEST_ASSERT_EQUAL_INT(PATTERN_WARNING, z.classify(CRITICAL_DISTANCE));
+  TEST_ASSERT_EQUAL_INT(PATTERN_WARNING, z.classify(WARNING_DISTANCE - 1));
+  TEST_ASSERT_EQUAL_INT(PATTERN_CAUTION, z.classify(WARNING_DISTANCE));
+  TEST_ASSERT_EQUAL_INT(PATTERN_CAUTION, z.classify(CAUTION_DISTANCE - 1));
+  TEST_ASSERT_EQUAL_INT(PATTERN_CLEAR, z.classify(CAUTION_DISTANCE));
+  TEST_ASSERT_EQUAL_INT(PATTERN_CLEAR, z.classify(DistanceTracker::NO_OBSTACLE));
+}
+
+void test_zone_custom_thresholds() {
+  ZoneClassifier z(500, 800, 1000);
+  TEST_ASSERT_EQUAL_INT(PATTERN_CRITICAL, z.classify(499));
+  TEST_ASSERT_EQUAL_INT(PATTERN_WARNING, z.classify(500));
+  TEST_ASSERT_EQUAL_INT(PATTERN_CAUTION, z.classify(999));
+  TEST_ASSERT_EQUAL_INT(PATTERN_CLEAR, z.classify(1000));
+}
+
+void test_zone_critical_and_clear_are_immediate() {
+  ZoneClassifier z;
+  TEST_ASSERT_TRUE(z.update(CRITICAL_DISTANCE - 100));
+  TEST_ASSERT_EQUAL_INT(PATTERN_CRITICAL, z.stablePattern());
+  TEST_ASSERT_TRUE(z.update(CAUTION_DISTANCE + 500));
+  TEST_ASSERT_EQUAL_INT(PATTERN_CLEAR, z.stablePattern());
+}
+
+void test_zone_others_need_two_readings() {
+  ZoneClassifier z;
+  TEST_ASSERT_FALSE(z.update(WARNING_DISTANCE - 100));
+  TEST_ASSERT_EQUAL_INT(PATTERN_CLEAR, z.stablePattern());
+  TEST_ASSERT_TRUE(z.update(WARNING_DISTANCE - 50));
+  TEST_ASSERT_EQUAL_INT(PATTERN_WARNING, z.stablePattern());
+  TEST_ASSERT_FALSE(z.update(WARNING_DISTANCE - 50));   // no change, nothing to send
+
+  TEST_ASSERT_FALSE(z.update(CAUTION_DISTANCE - 100));
+  TEST_ASSERT_EQUAL_INT(PATTERN_WARNING, z.stablePattern());
+  TEST_ASSERT_TRUE(z.update(CAUTION_DISTANCE - 100));
+  TEST_ASSERT_EQUAL_INT(PATTERN_CAUTION, z.stablePattern());
+}
+
+void test_zone_severity_order() {
+  TEST_ASSERT_EQUAL_INT(0, ZoneClassifier::severity(PATTERN_CLEAR));
+  TEST_ASSERT_EQUAL_INT(1, ZoneClassifier::severity(PATTERN_CAUTION));
+  TEST_ASSERT_EQUAL_INT(2, ZoneClassifier::severity(PATTERN_WARNING));
+  TEST_ASSERT_EQUAL_INT(3, ZoneClassifier::severity(PATTERN_CRITICAL));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_tracker_averages_last_three);
+  RUN_TEST(test_tracker_rejects_out_of_range);
+  RUN_TEST(test_tracker_closing_speed);
+  RUN_TEST(test_tracker_goes_stale);
+  RUN_TEST(test_zone_thresholds);
+  RUN_TEST(test_zone_custom_thresholds);
+  RUN_TEST(test_zone_critical_and_clear_are_immediate);
+  RUN_TEST(test_zone_others_need_two_readings);
+  RUN_TEST(test_zone_severity_order);
+  return UNITY_END();
+}
@@ -0,0 +1,252 @@
+/*
+ * ============================================
+ * VisionAssist - OcrHistory / OcrChunks tests
+ * ============================================
+ *
+ *   pio test -e native
+ * ============================================
+ */
+
+#include <unity.h>
+#include <string.h>
+#include <string>
+#include <OcrChunks.h>
+#include <OcrHistory.h>
+#include <WebJson.h>
+
+void setUp() {}
+void tearDown() {}
+
+// 4 index slots and a 960-byte log
+static uint8_t mem[4 * OcrHistory::BYTES_PER_SLOT];
+
+static uint32_t addText(OcrHistory& h, uint32_t now, const std::string& text) {
+  return h.add(now, ocrImageHash((const uint8_t*)text.data(), text.size()), text.data(), text.size());
+}
+
+static std::string textOf(const OcrHistory& h, uint32_t id) {
+  OcrHistory::Entry e;
+  const char* text;
+  uint16_t len;
+  if (!h.get(id, e, text, len)) return "<gone>";
+  return std::string(text, len);
+}
+
+static bool contains(const std::string& s, const char* part) {
+  return s.find(part) != std::string::npos;
+}
+
+// ===========================================
+// OcrHistory ring
+// ===========================================
+void test_history_off_without_buffer() {
+  OcrHistory h;
+  h.attach(nullptr, 0);
+  TEST_ASSERT_FALSE(h.enabled());
+  TEST_ASSERT_EQUAL_UINT32(0, addText(h, 1, "EXIT"));
+}
+
+void test_history_wraps_after_capacity() {
+  OcrHistory h;
+  h.attach(mem, sizeof(mem));
+  for (int i = 1; i <= 6; i++) {
+    TEST_ASSERT_EQUAL_UINT32(i, addText(h, i * 100, "sign " + std::to_string(i)));
+  }
+  // Four slots: ids 1 and 2 evicted
+  TEST_ASSERT_EQUAL_UINT32(3, h.firstId());
+  TEST_ASSERT_EQUAL_UINT32(7, h.nextId());
+  TEST_ASSERT_EQUAL_STRING("<gone>", textOf(h, 2).c_str());
+  TEST_ASSERT_EQUAL_STRING("sign 3", textOf(h, 3).c_str());
+  TEST_ASSERT_EQUAL_STRING("sign 6", textOf(h, 6).c_str());
+  TEST_ASSERT_EQUAL_STRING("<gone>", textOf(h, 7).c_str());
+}
+
+void test_history_evicts_by_log_bytes() {
+  OcrHistory h;
+  h.attach(mem, sizeof(mem));
+  size_t log = h.logBytes();
+  std::string a(300, 'a'), b(300, 'b'), c(300, 'c'), d(300, 'd');
+  addText(h, 1, a);
+  addText(h, 2, b);
+  addText(h, 3, c);
+  TEST_ASSERT_EQUAL_UINT32(3, h.count());
+
+  // No room at the end of the log: wraps over the oldest
+  TEST_ASSERT_TRUE(3 * 302 + 302 > log);
+  addText(h, 4, d);
+  TEST_ASSERT_EQUAL_UINT32(2, h.firstId());
+  TEST_ASSERT_EQUAL_STRING(b.c_str(), textOf(h, 2).c_str());
+  TEST_ASSERT_EQUAL_STRING(c.c_str(), textOf(h, 3).c_str());
+  TEST_ASSERT_EQUAL_STRING(d.c_str(), textOf(h, 4).c_str());
+}
+
+void test_history_cuts_text_longer_than_log() {
+  OcrHistory h;
+  h.attach(mem, sizeof(mem));
+  addText(h, 1, "short");
+  uint32_t id = addText(h, 2, std::string(2000, 'x'));
+  TEST_ASSERT_EQUAL_UINT32(1, h.count());   // took the whole log
+  TEST_ASSERT_EQUAL_UINT32(h.logBytes() - 2, textOf(h, id).size());
+}
+
+// ===========================================
+// Paged retrieval (/ocr/history)
+// ===========================================
+void test_history_pages_newest_first() {
+  OcrHistory h;
+  h.attach(mem, sizeof(mem));
+  for (int i = 1; i <= 6; i++) addText(h, 1000, "sign " + std::to_string(i));
+
+  std::string page = ocrHistoryJson(h, 0, 2, 1500);
+  TEST_ASSERT_TRUE(contains(page, "\"first\":3,\"next\":7"));
+  TEST_ASSERT_TRUE(contains(page, "{\"id\":6,\"ageMs\":500,"));
+  TEST_ASSERT_TRUE(contains(page, "\"id\":5"));
+  TEST_ASSERT_FALSE(contains(page, "\"id\":4"));
+  TEST_ASSERT_TRUE(contains(page, "\"more\":true"));
+
+  // Next page from the oldest id shown: ends at firstId()
+  page = ocrHistoryJson(h, 5, 2, 1500);
+  TEST_ASSERT_TRUE(contains(page, "\"id\":4"));
+  TEST_ASSERT_TRUE(contains(page, "\"id\":3"));
+  TEST_ASSERT_TRUE(contains(page, "\"more\":false"));
+}
+
+void test_history_page_boundaries() {
+  OcrHistory h;
+  h.attach(mem, sizeof(mem));
+  for (int i = 1; i <= 6; i++) addText(h, 1000, "sign " + std::to_string(i));
+
+  // Nothing older than the first id held
+  std::string page = ocrHistoryJson(h, 3, 5, 1500);
+  TEST_ASSERT_TRUE(contains(page, "\"entries\":[]"));
+  TEST_ASSERT_TRUE(contains(page, "\"more\":false"));
+
+  // A stale cursor past the newest starts over at the newest
+  page = ocrHistoryJson(h, 99, 1, 1500);
+  TEST_ASSERT_TRUE(contains(page, "\"id\":6"));
+  TEST_ASSERT_TRUE(contains(page, "\"more\":true"));
+}
+
+// ===========================================
+// Save / restore (NVS blob)
+// ===========================================
+void test_history_save_restore_round_trip() {
+  OcrHistory h;
+  h.attach(mem, sizeof(mem));
+  for (int i = 1; i <= 6; i++) addText(h, 1000, "sign " + std::to_string(i));
+  uint8_t blob[512];
+  size_t len = h.save(blob, sizeof(blob));
+  TEST_ASSERT_TRUE(len > 2);
+
+  static uint8_t other[sizeof(mem)];
+  OcrHistory restored;
+  restored.attach(other, sizeof(other));
+  TEST_ASSERT_TRUE(restored.load(blob, len));
+  TEST_ASSERT_EQUAL_UINT32(4, restored.count());
+  TEST_ASSERT_EQUAL_STRING("sign 3", textOf(restored, 1).c_str());
+  TEST_ASSERT_EQUAL_STRING("sign 6", textOf(restored, 4).c_str());
+
+  OcrHistory::Entry e;
+  const char* text;
+  uint16_t n;
+  restored.get(4, e, text, n);
+  TEST_ASSERT_EQUAL_UINT32(0, e.ms);   // before this boot
+  TEST_ASSERT_EQUAL_UINT32(ocrImageHash((const uint8_t*)"sign 6", 6), e.imageHash);
+}
+
+void test_history_save_keeps_newest_that_fit() {
+  OcrHistory h;
+  h.attach(mem, sizeof(mem));
+  addText(h, 1, std::string(100, 'a'));
+  addText(h, 2, std::string(100, 'b'));
+  addText(h, 3, "newest");
+  // Header, then 4 + 2 + len per entry: room for "newest" and one more
+  uint8_t blob[2 + 12 + 106];
+  size_t len = h.save(blob, sizeof(blob));
+  TEST_ASSERT_EQUAL_UINT32(sizeof(blob), len);
+  TEST_ASSERT_EQUAL_UINT8(2, blob[1]);
+
+  static uint8_t other[sizeof(mem)];
+  OcrHistory restored;
+  restored.attach(other, sizeof(other));
+  TEST_ASSERT_TRUE(restored.load(blob, len));
+  TEST_ASSERT_EQUAL_STRING(std::string(100, 'b').c_str(), textOf(restored, 1).c_str());
+  TEST_ASSERT_EQUAL_STRING("newest", textOf(restored, 2).c_str());
+}
+
+void test_history_rejects_truncated_or_corrupt_blob() {
+  OcrHistory h;
+  h.attach(mem, sizeof(mem));
+  addText(h, 1, "PLATFORM 2");
+  addText(h, 2, "MIND THE GAP");
+  uint8_t blob[128];
+  size_t len = h.save(blob, sizeof(blob));
+
+  static uint8_t other[sizeof(mem)];
+  OcrHistory restored;
+  restored.attach(other, sizeof(other));
+
+  // Cut inside the last text: nothing restored, not the first entry alone
+  TEST_ASSERT_FALSE(restored.load(blob, len - 3));
+  TEST_ASSERT_EQUAL_UINT32(0, restored.count());
+  TEST_ASSERT_FALSE(restored.load(blob, 1));
+
+  uint8_t bad[128];
+  memcpy(bad, blob, len);
+  bad[0] ^= 0xFF;   // unknown version
+  TEST_ASSERT_FALSE(restored.load(bad, len));
+  memcpy(bad, blob, len);
+  bad[1] = 3;       // claims an entry that is not there
+  TEST_ASSERT_FALSE(restored.load(bad, len));
+  memcpy(bad, blob, len);
+  bad[2 + 4] = 0xFF;   // first text length runs past the end
+  TEST_ASSERT_FALSE(restored.load(bad, len));
+  TEST_ASSERT_EQUAL_UINT32(0, restored.count());
+
+  TEST_ASSERT_TRUE(restored.load(blob, len));
+  TEST_ASSERT_EQUAL_STRING("MIND THE GAP", textOf(restored, 2).c_str());
+}
+
+// ===========================================
+// OcrChunks
+// ===========================================
+void test_chunker_cuts_at_sentence_end() {
+  SentenceChunker c;
+  c.reset();
+  const char* text = "Exit. Stairs";
+  size_t cut = 0;
+  for (const char* p = text; *p && !cut; p++) cut = c.push(*p);
+  TEST_ASSERT_EQUAL_UINT32(6, cut);   // "Exit. "
+  TEST_ASSERT_EQUAL_UINT32(0, c.pending());
+}
+
+void test_chunk_log_pages_by_sequence() {
+  OcrChunkLog log;
+  log.begin(7);
+  log.add("Platform 2", 10);
+  log.add("Mind the gap", 12);
+  log.finish();
+  TEST_ASSERT_EQUAL_UINT8(2, log.count());
+
+  std::string out;
+  log.appendJson(out, 1);
+  TEST_ASSERT_TRUE(contains(out, "\"run\":7,\"done\":true,\"next\":2"));
+  TEST_ASSERT_FALSE(contains(out, "\"seq\":0"));
+  TEST_ASSERT_TRUE(contains(out, "{\"seq\":1,\"text\":\"Mind the gap\"}"));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_history_off_without_buffer);
+  RUN_TEST(test_history_wraps_after_capacity);
+  RUN_TEST(test_history_evicts_by_log_bytes);
+  RUN_TEST(test_history_cuts_text_longer_than_log);
+  RUN_TEST(test_history_pages_newest_first);
+  RUN_TEST(test_history_page_boundaries);
+  RUN_TEST(test_history_save_restore_round_trip);
+  RUN_TEST(test_history_save_keeps_newest_that_fit);
+  RUN_TEST(test_history_rejects_truncated_or_corrupt_blob);
+  RUN_TEST(test_chunker_cuts_at_sentence_end);
+  RUN_TEST(test_chunk_log_pages_by_sequence);
+  return UNITY_END();
+}
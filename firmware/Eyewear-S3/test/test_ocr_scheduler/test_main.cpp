@@ -0,0 +1,196 @@
+/*
+ * ============================================
+ * VisionAssist - OCR scheduler tests
+ * ============================================
+ *
+ *   pio test -e native
+ * ============================================
+ */
+
+#include <unity.h>
+#include <HalHost.h>
+#include <OcrScheduler.h>
+
+void setUp() {}
+void tearDown() {}
+
+// ===========================================
+// Latest wins
+// ===========================================
+void test_submit_replaces_running_request() {
+  hal::VirtualClock clock;
+  OcrScheduler s(clock);
+  OcrRequest first = s.submit(0, 15000);
+  s.begin(first);
+  OcrTicket ticket(s, first);
+  TEST_ASSERT_TRUE(s.busy());
+  TEST_ASSERT_FALSE(ticket.cancelled());
+
+  clock.delay(500);
+  OcrRequest second = s.submit(1, 15000);
+  TEST_ASSERT_TRUE(second.id > first.id);
+  TEST_ASSERT_TRUE(ticket.cancelled());
+  TEST_ASSERT_TRUE(s.isCurrent(second.id));
+  TEST_ASSERT_FALSE(s.isCurrent(first.id));
+  TEST_ASSERT_EQUAL_INT(OCR_CANCELLED, s.abandonedOutcome(first));
+  // The run that lost cannot abandon the newer request
+  TEST_ASSERT_FALSE(s.abandon(first.id));
+
+  s.finish(OCR_CANCELLED);
+  TEST_ASSERT_FALSE(s.busy());
+  TEST_ASSERT_EQUAL_UINT32(1, s.outcomes(OCR_CANCELLED));
+}
+
+void test_requests_replaced_in_queue_are_counted() {
+  hal::VirtualClock clock;
+  OcrScheduler s(clock);
+  OcrRequest first = s.submit(0, 15000);
+  s.begin(first);
+  s.finish(OCR_COMPLETED);
+  s.submit(0, 15000);
+  s.submit(0, 15000);
+  OcrRequest last = s.submit(0, 15000);
+  s.begin(last);   // the two before it never ran
+  s.finish(OCR_COMPLETED);
+  TEST_ASSERT_EQUAL_UINT32(2, s.outcomes(OCR_CANCELLED));
+  TEST_ASSERT_EQUAL_UINT32(2, s.outcomes(OCR_COMPLETED));
+}
+
+// ===========================================
+// Deadlines
+// ===========================================
+void test_abandon_late_fires_at_deadline() {
+  hal::VirtualClock clock;
+  clock.set(1000);
+  OcrScheduler s(clock);
+  OcrRequest req = s.submit(0, 15000);
+  TEST_ASSERT_FALSE(s.abandonLate());   // not running yet
+  s.begin(req);
+  OcrTicket ticket(s, req);
+
+  clock.set(15999);
+  TEST_ASSERT_EQUAL_UINT32(1, s.remaining(req));
+  TEST_ASSERT_FALSE(s.abandonLate());
+  TEST_ASSERT_FALSE(ticket.cancelled());
+
+  clock.set(16000);
+  TEST_ASSERT_TRUE(s.abandonLate());
+  TEST_ASSERT_FALSE(s.abandonLate());   // once only
+  TEST_ASSERT_TRUE(ticket.cancelled());
+  TEST_ASSERT_EQUAL_UINT32(0, s.remaining(req));
+  TEST_ASSERT_EQUAL_INT(OCR_DEADLINE_MISSED, s.abandonedOutcome(req));
+}
+
+void test_abandon_running_is_user_stop() {
+  hal::VirtualClock clock;
+  OcrScheduler s(clock);
+  TEST_ASSERT_FALSE(s.abandonRunning());
+  OcrRequest req = s.submit(0, 15000);
+  s.begin(req);
+  TEST_ASSERT_TRUE(s.abandonRunning());
+  TEST_ASSERT_FALSE(s.isCurrent(req.id));
+  TEST_ASSERT_EQUAL_INT(OCR_CANCELLED, s.abandonedOutcome(req));
+}
+
+// ===========================================
+// Retries
+// ===========================================
+void test_transient_codes() {
+  TEST_ASSERT_TRUE(OcrScheduler::transient(-1));
+  TEST_ASSERT_TRUE(OcrScheduler::transient(408));
+  TEST_ASSERT_TRUE(OcrScheduler::transient(429));
+  TEST_ASSERT_TRUE(OcrScheduler::transient(503));
+  TEST_ASSERT_FALSE(OcrScheduler::transient(200));
+  TEST_ASSERT_FALSE(OcrScheduler::transient(400));
+  TEST_ASSERT_FALSE(OcrScheduler::transient(403));
+}
+
+void test_retry_backoff_and_attempt_limit() {
+  hal::VirtualClock clock;
+  OcrScheduler s(clock);
+  OcrRequest req = s.submit(0, 15000);
+  uint32_t waitMs = 0;
+
+  // 300 ms, then 600 ms, each +-25%
+  TEST_ASSERT_TRUE(s.retryAfter(req, 503, 0, waitMs));
+  TEST_ASSERT_TRUE(waitMs >= 225 && waitMs <= 375);
+  TEST_ASSERT_TRUE(s.retryAfter(req, -1, 1, waitMs));
+  TEST_ASSERT_TRUE(waitMs >= 450 && waitMs <= 750);
+  TEST_ASSERT_FALSE(s.retryAfter(req, 503, OCR_MAX_ATTEMPTS - 1, waitMs));
+  TEST_ASSERT_FALSE(s.retryAfter(req, 400, 0, waitMs));
+  TEST_ASSERT_EQUAL_UINT32(2, s.retries());
+}
+
+void test_retry_refused_near_deadline() {
+  hal::VirtualClock clock;
+  OcrScheduler s(clock);
+  OcrRequest req = s.submit(0, 15000);
+  uint32_t waitMs = 0;
+
+  // Less than the longest first wait + OCR_MIN_ATTEMPT_MS left
+  clock.set(15000 - OCR_MIN_ATTEMPT_MS - 200);
+  TEST_ASSERT_FALSE(s.retryAfter(req, 503, 0, waitMs));
+
+  // Enough for the longest wait and a whole attempt
+  clock.set(15000 - OCR_MIN_ATTEMPT_MS - 400);
+  TEST_ASSERT_TRUE(s.retryAfter(req, 503, 0, waitMs));
+  TEST_ASSERT_EQUAL_UINT32(1, s.retries());
+}
+
+void test_no_retry_once_replaced() {
+  hal::VirtualClock clock;
+  OcrScheduler s(clock);
+  OcrRequest req = s.submit(0, 15000);
+  s.submit(0, 15000);
+  uint32_t waitMs = 0;
+  TEST_ASSERT_FALSE(s.retryAfter(req, 503, 0, waitMs));
+  TEST_ASSERT_EQUAL_UINT32(0, s.retries());
+}
+
+// ===========================================
+// OcrTicket::wait
+// ===========================================
+void test_ticket_wait_runs_full_time() {
+  hal::VirtualClock clock;
+  OcrScheduler s(clock);
+  OcrRequest req = s.submit(0, 15000);
+  OcrTicket ticket(s, req);
+  TEST_ASSERT_TRUE(ticket.wait(clock, 350));
+  TEST_ASSERT_EQUAL_UINT32(350, clock.millis());
+}
+
+void test_ticket_wait_after_cancellation() {
+  hal::VirtualClock clock;
+  OcrScheduler s(clock);
+  OcrRequest req = s.submit(0, 15000);
+  OcrTicket ticket(s, req);
+  s.submit(0, 15000);
+  TEST_ASSERT_FALSE(ticket.wait(clock, 300));
+  TEST_ASSERT_EQUAL_UINT32(0, clock.millis());   // returns without sleeping
+}
+
+void test_ticket_wait_stops_at_deadline() {
+  hal::VirtualClock clock;
+  OcrScheduler s(clock);
+  OcrRequest req = s.submit(0, 100);
+  OcrTicket ticket(s, req);
+  TEST_ASSERT_FALSE(ticket.wait(clock, 600));
+  // Woken within one 20 ms poll of the deadline
+  TEST_ASSERT_TRUE(clock.millis() >= 100 && clock.millis() <= 120);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_submit_replaces_running_request);
+  RUN_TEST(test_requests_replaced_in_queue_are_counted);
+  RUN_TEST(test_abandon_late_fires_at_deadline);
+  RUN_TEST(test_abandon_running_is_user_stop);
+  RUN_TEST(test_transient_codes);
+  RUN_TEST(test_retry_backoff_and_attempt_limit);
+  RUN_TEST(test_retry_refused_near_deadline);
+  RUN_TEST(test_no_retry_once_replaced);
+  RUN_TEST(test_ticket_wait_runs_full_time);
+  RUN_TEST(test_ticket_wait_after_cancellation);
+  RUN_TEST(test_ticket_wait_stops_at_deadline);
+  return UNITY_END();
+}
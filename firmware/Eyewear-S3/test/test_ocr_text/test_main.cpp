@@ -0,0 +1,140 @@
+/*
+ * ============================================
+ * VisionAssist - OCR request / response tests
+ * ============================================
+ *
+ *   pio test -e native
+ * ============================================
+ */
+
+#include <unity.h>
+#include <HalHost.h>
+#include <OcrText.h>
+
+#include <string>
+
+void setUp() {}
+void tearDown() {}
+
+static std::string encode(const char* text) {
+  std::string out;
+  base64Encode((const uint8_t*)text, strlen(text), out);
+  return out;
+}
+
+// ===========================================
+// base64Encode
+// ===========================================
+void test_base64_rfc4648_vectors() {
+  TEST_ASSERT_EQUAL_STRING("", encode("").c_str());
+  TEST_ASSERT_EQUAL_STRING("Zg==", encode("f").c_str());
+  TEST_ASSERT_EQUAL_STRING("Zm8=", encode("fo").c_str());
+  TEST_ASSERT_EQUAL_STRING("Zm9v", encode("foo").c_str());
+  TEST_ASSERT_EQUAL_STRING("Zm9vYg==", encode("foob").c_str());
+  TEST_ASSERT_EQUAL_STRING("Zm9vYmE=", encode("fooba").c_str());
+  TEST_ASSERT_EQUAL_STRING("Zm9vYmFy", encode("foobar").c_str());
+}
+
+void test_base64_binary_and_append() {
+  const uint8_t bytes[] = { 0xFF, 0xD8, 0xFF, 0x00, 0xFE };
+  std::string out = "x";
+  base64Encode(bytes, sizeof(bytes), out);
+  TEST_ASSERT_EQUAL_STRING("x/9j/AP4=", out.c_str());
+}
+
+// ===========================================
+// Vision request bodies
+// ===========================================
+void test_vision_body_size_is_exact() {
+  const uint8_t jpeg[] = { 0xFF, 0xD8, 0xFF, 0xE0, 0x00, 0x10, 0x4A };
+  std::string one = buildVisionRequest(jpeg, sizeof(jpeg), FEATURE_TEXT);
+  TEST_ASSERT_EQUAL_UINT32(one.size(), visionBatchBytes(sizeof(jpeg), 1, FEATURE_TEXT));
+  std::string doc = buildVisionRequest(jpeg, sizeof(jpeg), FEATURE_DOCUMENT);
+  TEST_ASSERT_EQUAL_UINT32(doc.size(), visionBatchBytes(sizeof(jpeg), 1, FEATURE_DOCUMENT));
+
+  static uint8_t buf[4096];
+  Arena arena(buf, sizeof(buf));
+  ArenaString batch{ ArenaAllocator<char>(arena) };
+  beginVisionBatch(batch, visionBatchBytes(sizeof(jpeg), 3, FEATURE_TEXT));
+  for (int i = 0; i < 3; i++) addVisionBatchImage(jpeg, sizeof(jpeg), FEATURE_TEXT, batch);
+  endVisionBatch(batch);
+  TEST_ASSERT_EQUAL_UINT32(batch.size(), visionBatchBytes(sizeof(jpeg), 3, FEATURE_TEXT));
+}
+
+// ===========================================
+// extractTextFromResponse
+// ===========================================
+static std::string extract(const std::string& json) {
+  hal::MemoryStream stream(json);
+  return extractTextFromResponse(stream);
+}
+
+void test_extract_masked_text() {
+  std::string text = extract("{\"responses\":[{\"fullTextAnnotation\":{\"text\":\"EXIT\\nPlatform 2\\n\"}}]}");
+  TEST_ASSERT_EQUAL_STRING("EXIT\nPlatform 2\n", text.c_str());
+}
+
+void test_extract_first_description() {
+  std::string text = extract(
+      "{\"responses\":[{\"textAnnotations\":["
+      "{\"locale\":\"en\",\"description\":\"Say \\\"hi\\\" {now}\"},"
+      "{\"description\":\"Say\"}]}]}");
+  TEST_ASSERT_EQUAL_STRING("Say \"hi\" {now}", text.c_str());
+}
+
+void test_extract_after_long_prefix() {
+  // Text late in a long response (the old parser only searched past 1000 bytes)
+  std::string json = "{\"responses\":[{\"pages\":[\"" + std::string(3000, 'x') + "\"],";
+  json += "\"fullTextAnnotation\":{\"text\":\"late\"}}]}";
+  TEST_ASSERT_EQUAL_STRING("late", extract(json).c_str());
+  TEST_ASSERT_EQUAL_STRING("short", extract("{\"text\":\"short\"}").c_str());
+}
+
+void test_extract_no_text() {
+  TEST_ASSERT_EQUAL_STRING("", extract("{\"responses\":[{}]}").c_str());
+  TEST_ASSERT_EQUAL_STRING("", extract("").c_str());
+}
+
+// ===========================================
+// extractBatchTexts
+// ===========================================
+void test_batch_texts_in_order() {
+  hal::MemoryStream stream(
+      "{\"responses\":["
+      "{\"fullTextAnnotation\":{\"text\":\"first\"}},"
+      "{\"error\":{\"code\":3,\"message\":\"Bad image {data}\"}},"
+      "{\"textAnnotations\":[{\"description\":\"third\"},{\"description\":\"not this\"}]}"
+      "]}");
+  std::string texts[3];
+  TEST_ASSERT_EQUAL_UINT8(3, extractBatchTexts(stream, texts, 3));
+  TEST_ASSERT_EQUAL_STRING("first", texts[0].c_str());
+  TEST_ASSERT_EQUAL_STRING("", texts[1].c_str());
+  TEST_ASSERT_EQUAL_STRING("third", texts[2].c_str());
+}
+
+void test_batch_texts_bounds() {
+  hal::MemoryStream more("{\"responses\":[{\"text\":\"a\"},{\"text\":\"b\"},{\"text\":\"c\"}]}");
+  std::string two[2];
+  TEST_ASSERT_EQUAL_UINT8(2, extractBatchTexts(more, two, 2));
+  TEST_ASSERT_EQUAL_STRING("a", two[0].c_str());
+  TEST_ASSERT_EQUAL_STRING("b", two[1].c_str());
+
+  hal::MemoryStream fewer("{\"responses\":[{},{}]}");
+  std::string three[3];
+  TEST_ASSERT_EQUAL_UINT8(2, extractBatchTexts(fewer, three, 3));
+  TEST_ASSERT_EQUAL_STRING("", three[0].c_str());
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_base64_rfc4648_vectors);
+  RUN_TEST(test_base64_binary_and_append);
+  RUN_TEST(test_vision_body_size_is_exact);
+  RUN_TEST(test_extract_masked_text);
+  RUN_TEST(test_extract_first_description);
+  RUN_TEST(test_extract_after_long_prefix);
+  RUN_TEST(test_extract_no_text);
+  RUN_TEST(test_batch_texts_in_order);
+  RUN_TEST(test_batch_texts_bounds);
+  return UNITY_END();
+}
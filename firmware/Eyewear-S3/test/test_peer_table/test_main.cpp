@@ -0,0 +1,245 @@
+/*
+ * ============================================
+ * VisionAssist - ZoneMap / PeerTable tests
+ * ============================================
+ *
+ *   pio test -e native
+ * ============================================
+ */
+
+#include <unity.h>
+#include <HalHost.h>
+#include <DistanceTracker.h>
+#include <PeerTable.h>
+#include <StateFrames.h>
+#include <ZoneMap.h>
+
+void setUp() {}
+void tearDown() {}
+
+static const uint8_t MAC_A[6] = { 0x02, 0, 0, 0, 0, 0xa };
+static const uint8_t MAC_B[6] = { 0x02, 0, 0, 0, 0, 0xb };
+
+// One reading of `zone` at `ms`, as the tracker's poll would take it
+static void feed(hal::VirtualClock& clock, hal::ScriptedTof& tof, ZoneMap& map,
+                 uint32_t ms, uint8_t zone, int mm) {
+  clock.set(ms);
+  tof.push(mm, zone);
+  map.distance();
+}
+
+// ===========================================
+// ZoneMap::roleFrame
+// ===========================================
+void test_single_zone_passes_nearest_frame() {
+  hal::VirtualClock clock;
+  hal::ScriptedTof tof(1);
+  ZoneMap map(tof, clock);
+  ZoneClassifier zones;
+  feed(clock, tof, map, 100, 0, 1200);
+  StateFrame nearest = makeStateFrame(3, PATTERN_CRITICAL, 1200, 250);
+  StateFrame f = map.roleFrame(nearest, ROLE_LEFT, zones);
+  TEST_ASSERT_EQUAL_INT(PATTERN_CRITICAL, f.pattern);
+  TEST_ASSERT_EQUAL_INT(1200, f.distance);
+  TEST_ASSERT_EQUAL_INT(250, f.closingSpeed);
+}
+
+void test_side_of_nearest_obstacle_gets_nearest_frame() {
+  hal::VirtualClock clock;
+  hal::ScriptedTof tof(3);
+  ZoneMap map(tof, clock);
+  ZoneClassifier zones;
+  feed(clock, tof, map, 100, 0, 1000);
+  feed(clock, tof, map, 120, 1, 3000);
+  feed(clock, tof, map, 140, 2, 3500);
+  StateFrame nearest = makeStateFrame(1, PATTERN_CRITICAL, 1000, 400);
+
+  StateFrame left = map.roleFrame(nearest, ROLE_LEFT, zones);
+  TEST_ASSERT_EQUAL_INT(1000, left.distance);
+  TEST_ASSERT_EQUAL_INT(400, left.closingSpeed);
+  StateFrame all = map.roleFrame(nearest, ROLE_ALL, zones);
+  TEST_ASSERT_EQUAL_INT(1000, all.distance);
+
+  StateFrame pause = makePauseFrame(1);
+  TEST_ASSERT_EQUAL_INT(FLAG_PAUSE, map.roleFrame(pause, ROLE_RIGHT, zones).flags);
+}
+
+void test_other_side_gets_own_zone_and_closing_speed() {
+  hal::VirtualClock clock;
+  hal::ScriptedTof tof(3);
+  ZoneMap map(tof, clock);
+  ZoneClassifier zones;
+  // Left obstacle standing at 1000 mm, right one approaching at 500 mm/s
+  for (int i = 0; i < 30; i++) {
+    uint32_t ms = 100 + i * 100;
+    feed(clock, tof, map, ms, 0, 1000);
+    feed(clock, tof, map, ms + 20, 1, 3800);
+    feed(clock, tof, map, ms + 40, 2, 3000 - i * 50);
+  }
+  TEST_ASSERT_FLOAT_WITHIN(5.0f, 0.0f, map.zoneSpeed(0));
+  TEST_ASSERT_FLOAT_WITHIN(5.0f, 500.0f, map.zoneSpeed(2));
+
+  StateFrame nearest = makeStateFrame(1, PATTERN_CRITICAL, 1000, 0);
+  StateFrame right = map.roleFrame(nearest, ROLE_RIGHT, zones);
+  TEST_ASSERT_EQUAL_INT(1550, right.distance);
+  TEST_ASSERT_EQUAL_INT(PATTERN_WARNING, right.pattern);
+  TEST_ASSERT_INT_WITHIN(5, 500, right.closingSpeed);
+}
+
+void test_other_side_never_more_urgent_than_nearest() {
+  hal::VirtualClock clock;
+  hal::ScriptedTof tof(3);
+  ZoneMap map(tof, clock);
+  ZoneClassifier zones;
+  feed(clock, tof, map, 100, 0, 900);
+  feed(clock, tof, map, 120, 1, 3800);
+  feed(clock, tof, map, 140, 2, 1500);
+  // The debounced nearest pattern still lags at CAUTION
+  StateFrame nearest = makeStateFrame(1, PATTERN_CAUTION, 900, 0);
+  StateFrame right = map.roleFrame(nearest, ROLE_RIGHT, zones);
+  TEST_ASSERT_EQUAL_INT(PATTERN_CAUTION, right.pattern);
+  TEST_ASSERT_EQUAL_INT(1500, right.distance);
+}
+
+void test_side_without_reading_is_clear() {
+  hal::VirtualClock clock;
+  hal::ScriptedTof tof(3);
+  ZoneMap map(tof, clock);
+  ZoneClassifier zones;
+  feed(clock, tof, map, 100, 0, 1000);
+  feed(clock, tof, map, 120, 1, 0);   // bad reading
+  feed(clock, tof, map, 140, 2, 3000);
+  StateFrame nearest = makeStateFrame(1, PATTERN_CRITICAL, 1000, 300);
+  StateFrame centre = map.roleFrame(nearest, ROLE_CENTER, zones);
+  TEST_ASSERT_EQUAL_INT(PATTERN_CLEAR, centre.pattern);
+  TEST_ASSERT_EQUAL_INT(DistanceTracker::NO_OBSTACLE, centre.distance);
+  TEST_ASSERT_EQUAL_INT(0, centre.closingSpeed);
+}
+
+// ===========================================
+// PeerTable
+// ===========================================
+void test_pair_only_while_window_open() {
+  PeerTable peers;
+  bool added = true;
+  TEST_ASSERT_EQUAL_INT(-1, peers.pair(0, MAC_A, ROLE_LEFT, added));
+  TEST_ASSERT_FALSE(added);
+
+  peers.openPairing(1000, 5000);
+  TEST_ASSERT_EQUAL_INT(0, peers.pair(2000, MAC_A, ROLE_LEFT, added));
+  TEST_ASSERT_TRUE(added);
+  TEST_ASSERT_EQUAL_INT(ROLE_LEFT, peers.role(0));
+  TEST_ASSERT_TRUE(peers.directional());
+
+  // Window over: known bands are still acknowledged, new ones are not
+  TEST_ASSERT_FALSE(peers.pairingOpen(6000));
+  TEST_ASSERT_EQUAL_INT(0, peers.pair(6000, MAC_A, ROLE_LEFT, added));
+  TEST_ASSERT_FALSE(added);
+  TEST_ASSERT_EQUAL_INT(-1, peers.pair(6000, MAC_B, ROLE_RIGHT, added));
+  TEST_ASSERT_EQUAL_UINT8(1, peers.count());
+}
+
+void test_pair_table_full() {
+  PeerTable peers;
+  peers.openPairing(0);
+  bool added;
+  for (uint8_t i = 0; i < PeerTable::MAX_PEERS; i++) {
+    uint8_t mac[6] = { 0x02, 0, 0, 0, 1, i };
+    TEST_ASSERT_EQUAL_INT(i, peers.pair(0, mac, ROLE_ALL, added));
+  }
+  TEST_ASSERT_EQUAL_INT(-1, peers.pair(0, MAC_A, ROLE_ALL, added));
+  TEST_ASSERT_FALSE(peers.directional());
+}
+
+void test_plan_one_frame_per_band() {
+  hal::VirtualClock clock;
+  hal::ScriptedTof tof(3);
+  ZoneMap map(tof, clock);
+  ZoneClassifier zones;
+  feed(clock, tof, map, 100, 0, 1000);
+  feed(clock, tof, map, 120, 1, 3000);
+  feed(clock, tof, map, 140, 2, 3500);
+
+  PeerTable peers;
+  peers.openPairing(0);
+  bool added;
+  peers.pair(0, MAC_A, ROLE_LEFT, added);
+  peers.pair(0, MAC_B, ROLE_RIGHT, added);
+
+  PeerTable::Send out[PeerTable::MAX_PEERS];
+  StateFrame nearest = makeStateFrame(1, PATTERN_CRITICAL, 1000, 0);
+  TEST_ASSERT_EQUAL_UINT8(2, peers.plan(200, nearest, map, zones, out));
+  TEST_ASSERT_EQUAL_MEMORY(MAC_A, out[0].mac, 6);
+  TEST_ASSERT_EQUAL_INT(1000, out[0].frame.distance);
+  TEST_ASSERT_EQUAL_MEMORY(MAC_B, out[1].mac, 6);
+  TEST_ASSERT_EQUAL_INT(3000, out[1].frame.distance);
+}
+
+void test_unreachable_band_is_throttled() {
+  hal::VirtualClock clock;
+  hal::ScriptedTof tof(1);
+  ZoneMap map(tof, clock);
+  ZoneClassifier zones;
+  PeerTable peers;
+  peers.openPairing(0);
+  bool added;
+  peers.pair(0, MAC_A, ROLE_ALL, added);
+  peers.pair(0, MAC_B, ROLE_ALL, added);
+
+  PeerTable::Send out[PeerTable::MAX_PEERS];
+  StateFrame nearest = makeStateFrame(1, PATTERN_CLEAR, 3000, 0);
+  uint32_t now = 100;
+  for (uint16_t i = 0; i < PeerTable::UNREACHABLE_AFTER; i++) {
+    TEST_ASSERT_TRUE(peers.reachable(0));
+    peers.plan(now, nearest, map, zones, out);
+    peers.onDelivery(now, MAC_A, false);
+    peers.onDelivery(now, MAC_B, true);
+    now += 50;
+  }
+  TEST_ASSERT_FALSE(peers.reachable(0));
+  TEST_ASSERT_EQUAL_UINT32(PeerTable::UNREACHABLE_AFTER, peers.stats(0).failed);
+
+  // Band A last planned at now - 50: skipped until UNREACHABLE_INTERVAL passes
+  uint32_t last = now - 50;
+  TEST_ASSERT_EQUAL_UINT8(1, peers.plan(now, nearest, map, zones, out));
+  TEST_ASSERT_EQUAL_MEMORY(MAC_B, out[0].mac, 6);
+  TEST_ASSERT_EQUAL_UINT8(1, peers.plan(last + PeerTable::UNREACHABLE_INTERVAL - 1,
+                                        nearest, map, zones, out));
+  TEST_ASSERT_EQUAL_UINT8(2, peers.plan(last + PeerTable::UNREACHABLE_INTERVAL,
+                                        nearest, map, zones, out));
+
+  // One acknowledgement makes it reachable again
+  peers.onDelivery(now, MAC_A, true);
+  TEST_ASSERT_TRUE(peers.reachable(0));
+  TEST_ASSERT_EQUAL_UINT16(0, peers.stats(0).failStreak);
+}
+
+void test_awaiting_ack_until_heard_or_unreachable() {
+  PeerTable peers;
+  TEST_ASSERT_FALSE(peers.awaitingAck());
+  peers.openPairing(0);
+  bool added;
+  peers.pair(0, MAC_A, ROLE_ALL, added);
+  peers.pair(0, MAC_B, ROLE_ALL, added);
+  TEST_ASSERT_TRUE(peers.awaitingAck());
+
+  peers.onDelivery(100, MAC_A, true);
+  TEST_ASSERT_TRUE(peers.awaitingAck());   // B not heard yet
+  for (uint16_t i = 0; i < PeerTable::UNREACHABLE_AFTER; i++) peers.onDelivery(100, MAC_B, false);
+  TEST_ASSERT_FALSE(peers.awaitingAck());  // B is off: stop waiting for it
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_single_zone_passes_nearest_frame);
+  RUN_TEST(test_side_of_nearest_obstacle_gets_nearest_frame);
+  RUN_TEST(test_other_side_gets_own_zone_and_closing_speed);
+  RUN_TEST(test_other_side_never_more_urgent_than_nearest);
+  RUN_TEST(test_side_without_reading_is_clear);
+  RUN_TEST(test_pair_only_while_window_open);
+  RUN_TEST(test_pair_table_full);
+  RUN_TEST(test_plan_one_frame_per_band);
+  RUN_TEST(test_unreachable_band_is_throttled);
+  RUN_TEST(test_awaiting_ack_until_heard_or_unreachable);
+  return UNITY_END();
+}
@@ -0,0 +1,147 @@
+/*
+ * ============================================
+ * VisionAssist - PowerManager tests
+ * ============================================
+ *
+ *   pio test -e native
+ * ============================================
+ */
+
+#include <unity.h>
+#include <HalHost.h>
+#include <PowerManager.h>
+
+void setUp() {}
+void tearDown() {}
+
+static PowerManager started(uint32_t now) {
+  PowerManager p;
+  p.begin(now, PowerManager::Config());
+  return p;
+}
+
+// ===========================================
+// Camera: idle -> standby -> wake
+// ===========================================
+void test_camera_idles_to_standby() {
+  PowerManager p = started(1000);
+  TEST_ASSERT_TRUE(p.on(POWER_CAMERA));
+  TEST_ASSERT_EQUAL_UINT8(0, p.update(5999) & PowerManager::CAMERA_STANDBY);
+  TEST_ASSERT_EQUAL_UINT8(PowerManager::CAMERA_STANDBY, p.update(6000) & PowerManager::CAMERA_STANDBY);
+  TEST_ASSERT_FALSE(p.on(POWER_CAMERA));
+  TEST_ASSERT_EQUAL_UINT8(0, p.update(7000) & PowerManager::CAMERA_STANDBY);   // once
+
+  TEST_ASSERT_TRUE(p.acquireCamera(8000));   // caller wakes it
+  TEST_ASSERT_TRUE(p.on(POWER_CAMERA));
+  TEST_ASSERT_EQUAL_UINT32(1, p.wakes(POWER_CAMERA));
+  TEST_ASSERT_EQUAL_UINT32(5000, (uint32_t)p.onMs(POWER_CAMERA, 8000));
+}
+
+void test_camera_stays_on_while_in_use() {
+  PowerManager p = started(0);
+  TEST_ASSERT_FALSE(p.acquireCamera(100));   // already on
+  TEST_ASSERT_EQUAL_UINT8(0, p.update(60000) & PowerManager::CAMERA_STANDBY);
+  p.releaseCamera(60000);
+  TEST_ASSERT_EQUAL_UINT8(0, p.update(64999) & PowerManager::CAMERA_STANDBY);
+  TEST_ASSERT_TRUE(p.update(65000) & PowerManager::CAMERA_STANDBY);
+}
+
+// Camera streamed until 6000, then idled to standby; woken at 9000
+static uint32_t standbyAndWake(hal::VirtualClock& clock, hal::ScriptedCamera& camera,
+                               PowerManager& p) {
+  hal::Frame f;
+  clock.set(5960);
+  camera.capture(f);
+  camera.release(f);
+  TEST_ASSERT_TRUE(p.update(clock.millis()) & PowerManager::CAMERA_STANDBY);
+  camera.setStandby(true);
+  TEST_ASSERT_FALSE(camera.capture(f));
+
+  clock.set(9000);
+  TEST_ASSERT_TRUE(p.acquireCamera(clock.millis()));
+  TEST_ASSERT_TRUE(camera.setStandby(false));
+  return clock.millis();
+}
+
+void test_first_frame_after_wake_is_stale() {
+  hal::VirtualClock clock;
+  hal::ScriptedCamera camera(clock, 40);
+  PowerManager p = started(0);
+  uint32_t wokeAt = standbyAndWake(clock, camera, p);
+  hal::Frame first;
+  TEST_ASSERT_TRUE(camera.capture(first));
+  TEST_ASSERT_EQUAL_UINT32(6000, first.ms);   // from before standby
+  TEST_ASSERT_TRUE(first.ms < wokeAt);
+}
+
+void test_wake_skips_stale_frame() {
+  hal::VirtualClock clock;
+  hal::ScriptedCamera camera(clock, 40);
+  PowerManager p = started(0);
+  uint32_t wokeAt = standbyAndWake(clock, camera, p);
+  uint32_t before = camera.captures;
+  // Drops the held frame, times the wake to the next one
+  TEST_ASSERT_EQUAL_INT(40, awaitFreshFrame(camera, clock, wokeAt, 4));
+  TEST_ASSERT_EQUAL_UINT32(2, camera.captures - before);
+}
+
+void test_wake_gives_up_without_fresh_frame() {
+  hal::VirtualClock clock;
+  hal::ScriptedCamera camera(clock, 40);
+  camera.setStandby(true);
+  TEST_ASSERT_EQUAL_INT(-1, awaitFreshFrame(camera, clock, 0, 4));
+}
+
+// ===========================================
+// Radio
+// ===========================================
+void test_radio_idles_to_modem_sleep() {
+  PowerManager p = started(0);
+  TEST_ASSERT_FALSE(p.webActivity(1000));
+  TEST_ASSERT_EQUAL_UINT8(0, p.update(3999) & PowerManager::RADIO_SLEEP);
+  TEST_ASSERT_TRUE(p.update(4000) & PowerManager::RADIO_SLEEP);
+  TEST_ASSERT_FALSE(p.on(POWER_RADIO));
+  TEST_ASSERT_TRUE(p.webActivity(5000));   // caller wakes it
+  TEST_ASSERT_EQUAL_UINT32(1, p.wakes(POWER_RADIO));
+}
+
+void test_hold_keeps_radio_awake() {
+  PowerManager p = started(0);
+  // Held every tick (pairing open): never sleeps
+  for (uint32_t t = 0; t <= 20000; t += 100) {
+    TEST_ASSERT_FALSE(p.holdRadio(t));
+    TEST_ASSERT_EQUAL_UINT8(0, p.update(t) & PowerManager::RADIO_SLEEP);
+  }
+  // Released: sleeps radioIdleMs after the last hold
+  TEST_ASSERT_EQUAL_UINT8(0, p.update(22999) & PowerManager::RADIO_SLEEP);
+  TEST_ASSERT_TRUE(p.update(23000) & PowerManager::RADIO_SLEEP);
+  TEST_ASSERT_TRUE(p.holdRadio(24000));
+  TEST_ASSERT_TRUE(p.on(POWER_RADIO));
+}
+
+// ===========================================
+// Duty and current estimate
+// ===========================================
+void test_duty_over_full_window() {
+  PowerManager p = started(0);
+  p.update(5000);   // camera off after 5 s
+  p.update(PowerManager::WINDOW_MS);
+  TEST_ASSERT_EQUAL_UINT16(83, p.dutyPermille(POWER_CAMERA, PowerManager::WINDOW_MS));
+  PowerManager::Config c;
+  uint32_t ma = p.estimatedMa(PowerManager::WINDOW_MS);
+  TEST_ASSERT_TRUE(ma > (uint32_t)c.baseMa + c.offMa[POWER_CAMERA] + c.offMa[POWER_RADIO]);
+  TEST_ASSERT_TRUE(ma < (uint32_t)c.baseMa + c.onMa[POWER_CAMERA] + c.onMa[POWER_RADIO]);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_camera_idles_to_standby);
+  RUN_TEST(test_camera_stays_on_while_in_use);
+  RUN_TEST(test_first_frame_after_wake_is_stale);
+  RUN_TEST(test_wake_skips_stale_frame);
+  RUN_TEST(test_wake_gives_up_without_fresh_frame);
+  RUN_TEST(test_radio_idles_to_modem_sleep);
+  RUN_TEST(test_hold_keeps_radio_awake);
+  RUN_TEST(test_duty_over_full_window);
+  return UNITY_END();
+}
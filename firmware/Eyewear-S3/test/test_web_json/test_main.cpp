@@ -0,0 +1,49 @@
+/*
+ * ============================================
+ * VisionAssist - Web API JSON tests
+ * ============================================
+ *
+ *   pio test -e native
+ * ============================================
+ */
+
+#include <unity.h>
+#include <VisionAssistProtocol.h>
+#include <WebJson.h>
+
+void setUp() {}
+void tearDown() {}
+
+void test_escape_plain_text_unchanged() {
+  TEST_ASSERT_EQUAL_STRING("", escapeJson("").c_str());
+  TEST_ASSERT_EQUAL_STRING("Platform 2 / Exit", escapeJson("Platform 2 / Exit").c_str());
+}
+
+void test_escape_quotes_and_backslashes() {
+  TEST_ASSERT_EQUAL_STRING("say \\\"hi\\\"", escapeJson("say \"hi\"").c_str());
+  TEST_ASSERT_EQUAL_STRING("C:\\\\path", escapeJson("C:\\path").c_str());
+}
+
+void test_escape_line_breaks_and_tabs() {
+  TEST_ASSERT_EQUAL_STRING("a\\nb\\r\\nc\\td", escapeJson("a\nb\r\nc\td").c_str());
+}
+
+void test_escape_keeps_utf8() {
+  TEST_ASSERT_EQUAL_STRING("caf\xC3\xA9", escapeJson("caf\xC3\xA9").c_str());
+}
+
+void test_distance_json_fields() {
+  std::string json = distanceJson(1234, PATTERN_WARNING, false);
+  TEST_ASSERT_TRUE(json.find("\"distance\":1234") != std::string::npos);
+  TEST_ASSERT_TRUE(json.find("WARNING") != std::string::npos);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_escape_plain_text_unchanged);
+  RUN_TEST(test_escape_quotes_and_backslashes);
+  RUN_TEST(test_escape_line_breaks_and_tabs);
+  RUN_TEST(test_escape_keeps_utf8);
+  RUN_TEST(test_distance_json_fields);
+  return UNITY_END();
+}
@@ -0,0 +1,69 @@
+#include "DeadReckoning.h"
+
+DeadReckoning::DeadReckoning() {}
+
+DeadReckoning::DeadReckoning(const Config& config) : cfg(config) {}
+
+void DeadReckoning::setThresholds(uint16_t critical, uint16_t warning, uint16_t caution) {
+  cfg.thresholds[0] = critical;
+  cfg.thresholds[1] = warning;
+  cfg.thresholds[2] = caution;
+}
+
+void DeadReckoning::onFrame(uint32_t now, int16_t distance, int16_t closingSpeed) {
+  haveFrame = true;
+  frameTime = now;
+  frameDistance = distance;
+
+  // Only approach is extrapolated - a receding obstacle holds the last zone
+  if (closingSpeed < 0) closingSpeed = 0;
+  if (closingSpeed > cfg.maxClosingSpeed) closingSpeed = cfg.maxClosingSpeed;
+  frameSpeed = closingSpeed;
+}
+
+void DeadReckoning::reset() {
+  haveFrame = false;
+}
+
+DeadReckoning::Mode DeadReckoning::mode(uint32_t now) const {
+  if (!haveFrame) return LINK_LOST;
+
+  uint32_t gap = now - frameTime;
+  if (gap < cfg.frameGapMs) return LINK_OK;
+  if (gap < cfg.windowMs) return EXTRAPOLATING;
+  if (gap < cfg.linkLostMs) return DEGRADED;
+  return LINK_LOST;
+}
+
+int DeadReckoning::estimatedDistance(uint32_t now) const {
+  if (!haveFrame) return frameDistance;
+
+  uint32_t dt = now - frameTime;
+  if (dt > cfg.windowMs) dt = cfg.windowMs;
+
+  int d = frameDistance - (int)((int32_t)frameSpeed * (int32_t)dt / 1000);
+  return d < 0 ? 0 : d;
+}
+
+uint8_t DeadReckoning::zoneFor(int distance) const {
+  if (distance < cfg.thresholds[0]) return PATTERN_CRITICAL;
+  if (distance < cfg.thresholds[1]) return PATTERN_WARNING;
+  if (distance < cfg.thresholds[2]) return PATTERN_CAUTION;
+  return PATTERN_CLEAR;
+}
+
+uint8_t DeadReckoning::extrapolatedZone(uint32_t now) const {
+  uint8_t last = zoneFor(frameDistance);
+  uint8_t est = zoneFor(estimatedDistance(now));
+  return severity(est) > severity(last) ? est : last;
+}
+
+// CLEAR < CAUTION < WARNING < CRITICAL
+uint8_t DeadReckoning::severity(uint8_t zone) {
+  switch (zone) {
+    case PATTERN_CRITICAL: return 3;
+    case PATTERN_WARNING: return 2;
+    case PATTERN_CAUTION: return 1;
+    default: return 0;
+  }
+}
@@ -0,0 +1,71 @@
+/*
+ * ============================================
+ * VisionAssist - Handband Dead Reckoning
+ * ============================================
+ *
+ * Keeps the haptic zone moving while ESP-NOW frames are lost.
+ * Each state frame carries range and closing speed; between
+ * frames the range is extrapolated for a bounded window, after
+ * which the link is reported as degraded and finally lost.
+ *
+ * Plain C++ (no Arduino dependency) so the same code runs in the
+ * host simulator under firmware/Host-Tools.
+ * ============================================
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <VisionAssistProtocol.h>
+
+class DeadReckoning {
+public:
+  enum Mode {
+    LINK_OK,        // frames arriving - use the received pattern
+    EXTRAPOLATING,  // short gap - zone from extrapolated range
+    DEGRADED,       // gap longer than the window - play degraded pattern
+    LINK_LOST       // no frames for a long time - motor off
+  };
+
+  struct Config {
+    uint16_t frameGapMs = 150;      // gap before extrapolation starts (3 missed frames)
+    uint16_t windowMs = 1000;       // how long an extrapolation is trusted
+    uint16_t linkLostMs = 5000;     // degraded -> lost
+    int16_t maxClosingSpeed = 3000; // mm/s, clamp for noisy speed estimates
+    uint16_t thresholds[3] = { CRITICAL_DISTANCE, WARNING_DISTANCE, CAUTION_DISTANCE };
+  };
+
+  DeadReckoning();
+  explicit DeadReckoning(const Config& config);
+
+  void setThresholds(uint16_t critical, uint16_t warning, uint16_t caution);
+  const Config& config() const { return cfg; }
+
+  // Record a received state frame
+  void onFrame(uint32_t now, int16_t distance, int16_t closingSpeed);
+
+  // Forget the last frame (reading mode or link lost)
+  void reset();
+
+  Mode mode(uint32_t now) const;
+
+  // Range estimate at `now`; never further than the last received range
+  int estimatedDistance(uint32_t now) const;
+
+  // Pattern id (0 CLEAR .. 1 CRITICAL) for a range
+  uint8_t zoneFor(int distance) const;
+
+  // Zone to play while extrapolating; never less severe than the last frame
+  uint8_t extrapolatedZone(uint32_t now) const;
+
+  bool hasFrame() const { return haveFrame; }
+
+private:
+  static uint8_t severity(uint8_t zone);
+
+  Config cfg;
+  bool haveFrame = false;
+  uint32_t frameTime = 0;
+  int16_t frameDistance = 0;
+  int16_t frameSpeed = 0;
+};
@@ -0,0 +1,15 @@
+#include "ChannelScanner.h"
+
+uint8_t ChannelScanner::start(uint8_t preferred, uint32_t now) {
+  current = (preferred >= FIRST_CHANNEL && preferred <= LAST_CHANNEL) ? preferred : FIRST_CHANNEL;
+  lastHop = now;
+  started = now;
+  return current;
+}
+
+bool ChannelScanner::hop(uint32_t now) {
+  if (now - lastHop < dwell) return false;
+  lastHop = now;
+  current = current >= LAST_CHANNEL ? FIRST_CHANNEL : current + 1;
+  return true;
+}
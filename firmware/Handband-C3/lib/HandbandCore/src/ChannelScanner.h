@@ -0,0 +1,37 @@
+/*
+ * ============================================
+ * VisionAssist - ESP-NOW Channel Scanner
+ * ============================================
+ *
+ * Steps through WiFi channels until the eyewear is heard.
+ * Starts on the preferred (last locked) channel.
+ * ============================================
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+class ChannelScanner {
+public:
+  static const uint8_t FIRST_CHANNEL = 1;
+  static const uint8_t LAST_CHANNEL = 13;
+
+  // dwellMs: time per channel - eyewear sends every 50 ms, beacons every 250 ms
+  explicit ChannelScanner(uint16_t dwellMs = 120) : dwell(dwellMs) {}
+
+  // Begin a scan; returns the channel to tune to
+  uint8_t start(uint8_t preferred, uint32_t now);
+
+  // Returns true when it is time to tune to channel()
+  bool hop(uint32_t now);
+
+  uint8_t channel() const { return current; }
+  uint32_t startedAt() const { return started; }
+
+private:
+  uint16_t dwell;
+  uint8_t current = FIRST_CHANNEL;
+  uint32_t lastHop = 0;
+  uint32_t started = 0;
+};
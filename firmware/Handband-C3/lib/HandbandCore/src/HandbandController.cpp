@@ -0,0 +1,100 @@
+#include "HandbandController.h"
+
+HandbandController::HandbandController(hal::Gpio& gpio, uint8_t motorPin, uint8_t ledPin)
+  : gpio(gpio), motorPin(motorPin), ledPin(ledPin) {}
+
+void HandbandController::setMotor(bool on) {
+  gpio.analogWrite(motorPin, on ? currentIntensity : 0);
+  gpio.digitalWrite(ledPin, on ? 1 : 0);
+  motorState = on;
+}
+
+uint8_t HandbandController::onStateFrame(uint32_t now, const StateFrame& frame) {
+  uint8_t events = EV_NONE;
+  lastReceived = now;
+  receiveCount++;
+
+  // Reading mode: motor off until a normal frame arrives
+  if (frame.flags & FLAG_PAUSE) {
+    dr.reset();
+    if (!isPaused) {
+      isPaused = true;
+      currentPattern = PATTERN_CLEAR;
+      setMotor(false);
+      events |= EV_PAUSED;
+    }
+    return events;
+  }
+
+  if (isPaused) {
+    isPaused = false;
+    events |= EV_RESUMED;
+  }
+
+  dr.onFrame(now, frame.distance, frame.closingSpeed);
+
+  currentIntensity = frame.intensity;
+  currentPattern = patterns.clampId(frame.pattern);
+
+  if (currentPattern != lastFramePattern) {
+    lastFramePattern = currentPattern;
+    patterns.select(currentPattern, now);
+    setMotor(patterns.motorOn());
+    events |= EV_PATTERN;
+  } else if (motorState) {
+    gpio.analogWrite(motorPin, currentIntensity);
+  }
+  return events;
+}
+
+uint8_t HandbandController::update(uint32_t now) {
+  uint8_t events = EV_NONE;
+
+  if (now - lastReceived > dr.config().linkLostMs) {
+    if (motorState || currentPattern != PATTERN_CLEAR || isPaused || dr.hasFrame()) {
+      setMotor(false);
+      currentPattern = PATTERN_CLEAR;
+      patterns.select(PATTERN_CLEAR, now);
+      lastFramePattern = -1;
+      isPaused = false;
+      dr.reset();
+      lastLinkMode = DeadReckoning::LINK_OK;
+      events |= EV_RESET;
+    }
+    return events | EV_LINK_LOST;
+  }
+
+  if (isPaused) {
+    setMotor(false);
+    return events;
+  }
+
+  // Frames missing: extrapolate the zone, then fall back to the degraded pattern
+  int pattern = currentPattern;
+  DeadReckoning::Mode mode = dr.mode(now);
+
+  if (mode == DeadReckoning::EXTRAPOLATING) {
+    pattern = dr.extrapolatedZone(now);
+  } else if (mode == DeadReckoning::DEGRADED) {
+    pattern = patterns.clampId(PATTERN_DEGRADED);
+  }
+
+  if (mode != lastLinkMode) {
+    lastLinkMode = mode;
+    events |= EV_LINK_MODE;
+  }
+
+  if (patterns.select(pattern, now)) {
+    setMotor(patterns.motorOn());
+  }
+
+  bool on = patterns.update(now);
+  if (on != motorState) setMotor(on);
+  return events;
+}
+
+uint32_t HandbandController::quietMs(uint32_t now) const {
+  if (motorState) return 0;
+  if (isPaused) return UINT32_MAX;
+  return dr.mode(now) == DeadReckoning::LINK_OK ? patterns.untilChange(now) : 0;
+}
@@ -0,0 +1,76 @@
+/*
+ * ============================================
+ * VisionAssist - Handband Alert Controller
+ * ============================================
+ *
+ * What the handband does with eyewear state frames:
+ * reading-mode pause, pattern selection, dead reckoning
+ * during frame gaps and the link-lost timeout. Drives the
+ * motor and LED through the HAL. Channel discovery and
+ * NVS stay in main.cpp.
+ * ============================================
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <Hal.h>
+#include <VisionAssistProtocol.h>
+#include <DeadReckoning.h>
+#include "PatternPlayer.h"
+
+class HandbandController {
+public:
+  // Bits returned by onStateFrame() / update() for logging
+  enum Event : uint8_t {
+    EV_NONE = 0,
+    EV_PAUSED = 0x01,
+    EV_RESUMED = 0x02,
+    EV_PATTERN = 0x04,     // received pattern changed
+    EV_LINK_MODE = 0x08,   // linkMode() changed
+    EV_LINK_LOST = 0x10,   // no frame for linkLostMs - rescan
+    EV_RESET = 0x20        // link lost while something was active
+  };
+
+  HandbandController(hal::Gpio& gpio, uint8_t motorPin, uint8_t ledPin);
+
+  // A MSG_STATE frame from the eyewear
+  uint8_t onStateFrame(uint32_t now, const StateFrame& frame);
+
+  // One loop() pass while the channel is locked
+  uint8_t update(uint32_t now);
+
+  // Restart the link-lost timer (while scanning, nothing is expected)
+  void holdLink(uint32_t now) { lastReceived = now; }
+
+  // ms the band can go without update(): 0 while the motor is on or
+  // frames are missing, else until the pattern's next step
+  uint32_t quietMs(uint32_t now) const;
+
+  PatternPlayer& player() { return patterns; }
+  DeadReckoning& reckoner() { return dr; }
+
+  bool paused() const { return isPaused; }
+  bool motorOn() const { return motorState; }
+  int receivedPattern() const { return currentPattern; }
+  DeadReckoning::Mode linkMode() const { return lastLinkMode; }
+  uint32_t frames() const { return receiveCount; }
+
+private:
+  void setMotor(bool on);
+
+  hal::Gpio& gpio;
+  uint8_t motorPin;
+  uint8_t ledPin;
+  PatternPlayer patterns;
+  DeadReckoning dr;
+
+  volatile int currentPattern = PATTERN_CLEAR;
+  int lastFramePattern = -1;             // last pattern announced by EV_PATTERN
+  volatile uint8_t currentIntensity = 255;
+  volatile uint32_t lastReceived = 0;
+  volatile bool isPaused = false;
+  bool motorState = false;
+  DeadReckoning::Mode lastLinkMode = DeadReckoning::LINK_OK;
+  uint32_t receiveCount = 0;
+};
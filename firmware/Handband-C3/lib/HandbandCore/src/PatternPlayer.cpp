@@ -0,0 +1,70 @@
+#include "PatternPlayer.h"
+
+#include <string.h>
+
+PatternPlayer::PatternPlayer() {
+  load(DEFAULT_PATTERNS, PATTERN_COUNT, 0);
+}
+
+bool PatternPlayer::applyTable(const PatternTableFrame& table) {
+  if (table.count == 0 || table.count > MAX_PATTERNS) return false;
+  if (table.tableVersion == tableVersion) return false;
+
+  load(table.patterns, table.count, table.tableVersion);
+  return true;
+}
+
+void PatternPlayer::load(const PatternDesc* table, uint8_t count, uint8_t version) {
+  if (count > MAX_PATTERNS) count = MAX_PATTERNS;
+  memset(patterns, 0, sizeof(patterns));
+  memcpy(patterns, table, count * sizeof(PatternDesc));
+  patternCount = count;
+  tableVersion = version;
+  if (current >= patternCount) current = PATTERN_CLEAR;
+}
+
+uint8_t PatternPlayer::clampId(int id) const {
+  return (id >= 0 && id < patternCount) ? (uint8_t)id : PATTERN_CLEAR;
+}
+
+bool PatternPlayer::select(uint8_t id, uint32_t now) {
+  id = clampId(id);
+  if (id == current) return false;
+
+  current = id;
+  lastToggle = now;
+  motor = patterns[id].onMs > 0;
+  return true;
+}
+
+bool PatternPlayer::update(uint32_t now) {
+  const PatternDesc& p = patterns[current];
+
+  if (p.onMs == 0) {
+    // OFF
+    motor = false;
+  } else if (p.offMs == 0) {
+    // Continuous vibration
+    motor = true;
+  } else if (motor) {
+    if (now - lastToggle >= p.onMs) {
+      motor = false;
+      lastToggle = now;
+    }
+  } else {
+    if (now - lastToggle >= p.offMs) {
+      motor = true;
+      lastToggle = now;
+    }
+  }
+  return motor;
+}
+
+uint32_t PatternPlayer::untilChange(uint32_t now) const {
+  const PatternDesc& p = patterns[current];
+  if (p.onMs == 0 || p.offMs == 0) return UINT32_MAX;
+
+  uint32_t phase = motor ? p.onMs : p.offMs;
+  uint32_t since = now - lastToggle;
+  return since < phase ? phase - since : 0;
+}
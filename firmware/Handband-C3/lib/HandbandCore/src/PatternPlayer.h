@@ -0,0 +1,54 @@
+/*
+ * ============================================
+ * VisionAssist - Haptic Pattern Player
+ * ============================================
+ *
+ * Holds the pattern table sent by the eyewear (or the
+ * built-in defaults) and runs the ON/OFF cycle of the
+ * selected pattern. The caller drives the motor from
+ * motorOn().
+ * ============================================
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <VisionAssistProtocol.h>
+
+class PatternPlayer {
+public:
+  PatternPlayer();
+
+  // Replace the table from an eyewear frame; false if invalid or unchanged
+  bool applyTable(const PatternTableFrame& table);
+
+  // Replace the table from storage
+  void load(const PatternDesc* table, uint8_t count, uint8_t version);
+
+  uint8_t version() const { return tableVersion; }
+  uint8_t count() const { return patternCount; }
+  const PatternDesc* table() const { return patterns; }
+
+  // Ids outside the table play as CLEAR
+  uint8_t clampId(int id) const;
+
+  // Switch pattern; returns true if it changed (cycle restarts at ON)
+  bool select(uint8_t id, uint32_t now);
+
+  // Advance the ON/OFF cycle; returns the motor state
+  bool update(uint32_t now);
+
+  // ms until update() next switches the motor (UINT32_MAX = never)
+  uint32_t untilChange(uint32_t now) const;
+
+  uint8_t playing() const { return current; }
+  bool motorOn() const { return motor; }
+
+private:
+  PatternDesc patterns[MAX_PATTERNS];
+  uint8_t patternCount = 0;
+  uint8_t tableVersion = 0;   // 0 = built-in defaults
+  uint8_t current = PATTERN_CLEAR;
+  bool motor = false;
+  uint32_t lastToggle = 0;
+};
@@ -0,0 +1,28 @@
+#include "SleepPlanner.h"
+
+void SleepPlanner::configure(const Config& config, uint16_t frameGapMs) {
+  cfg = config;
+  // Half a period of margin: a frame sent late must not start extrapolation
+  uint32_t span = cfg.budgetMs;
+  uint32_t gapLimit = frameGapMs > cfg.framePeriodMs / 2 ? frameGapMs - cfg.framePeriodMs / 2 : 0;
+  if (span > gapLimit) span = gapLimit;
+  stride = cfg.framePeriodMs ? (uint16_t)(span / cfg.framePeriodMs) : 0;   // 0 = never sleep
+  synced = false;
+}
+
+void SleepPlanner::onFrame(uint32_t now) {
+  lastFrame = now;
+  synced = true;
+}
+
+uint32_t SleepPlanner::sleepMs(uint32_t now, uint32_t quietMs) const {
+  if (!synced || stride == 0) return 0;
+
+  uint32_t since = now - lastFrame;
+  uint32_t wake = (uint32_t)stride * cfg.framePeriodMs - cfg.guardMs;
+  if (since >= wake) return 0;   // listening for the next frame
+
+  uint32_t ms = wake - since;
+  if (ms > quietMs) ms = quietMs;
+  return ms >= cfg.minSleepMs ? ms : 0;
+}
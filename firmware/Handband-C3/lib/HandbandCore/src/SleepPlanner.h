@@ -0,0 +1,60 @@
+/*
+ * ============================================
+ * VisionAssist - Handband Sleep Planner
+ * ============================================
+ *
+ * Decides when the band may light-sleep with the radio
+ * off. The eyewear sends a state frame every framePeriodMs
+ * (and one at once on a zone change, which restarts that
+ * cadence), so the next frames' times are known from the
+ * last one heard.
+ *
+ * After each frame the band sleeps through frames until
+ * just before the last one that keeps a zone change
+ * within budgetMs, then listens. A change sent while it
+ * sleeps is heard at the latest budgetMs later. The gap it
+ * creates always stays short of dead reckoning's frame
+ * gap. No frame by the expected time: the band stays
+ * awake until the next one, as without power saving.
+ *
+ * The motor has to be off: sleep also ends at the next
+ * step of the playing pattern.
+ * ============================================
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+class SleepPlanner {
+public:
+  struct Config {
+    uint16_t framePeriodMs = 50;   // eyewear NavigationController::SEND_INTERVAL
+    uint16_t budgetMs = 150;       // worst-case alert latency added by sleeping
+    uint8_t guardMs = 5;           // wake this early (wake-up time, send jitter)
+    uint8_t minSleepMs = 8;        // shorter sleeps cost more than they save
+  };
+
+  // `frameGapMs`: dead reckoning's gap before extrapolation starts
+  void configure(const Config& config, uint16_t frameGapMs);
+  const Config& config() const { return cfg; }
+
+  // A state frame was heard (radio callback)
+  void onFrame(uint32_t now);
+  // No cadence to follow (channel scan, link lost)
+  void reset() { synced = false; }
+
+  // Frames between two the band listens for (1 = every frame,
+  // 0 = never sleeps: the budget is under one frame period)
+  uint16_t frameStride() const { return stride; }
+
+  // How long to sleep from `now`, at most `quietMs` (until the motor
+  // must change); 0 = stay awake and listen
+  uint32_t sleepMs(uint32_t now, uint32_t quietMs) const;
+
+private:
+  Config cfg;
+  uint16_t stride = 0;
+  volatile uint32_t lastFrame = 0;
+  volatile bool synced = false;
+};
@@ -0,0 +1,74 @@
+/*
+ * ============================================
+ * VisionAssist - Handband host runner
+ * ============================================
+ *
+ * Plays received state frames through the handband alert
+ * controller on a PC with a virtual clock.
+ *
+ * Input  (stdin):  "ms,pattern,intensity,distance,closingSpeed,flags"
+ *                  per received frame (eyewear runner output)
+ * Output (stdout): "ms,motor" on every motor transition
+ * ============================================
+ */
+
+#include <stdio.h>
+
+#include <HalHost.h>
+#include <VisionAssistProtocol.h>
+#include <HandbandController.h>
+
+static const uint32_t LOOP_INTERVAL = 10;   // matches the firmware loop() delay
+static const uint8_t MOTOR_PIN = 4;
+
+struct Rx {
+  unsigned long ms;
+  int pattern, intensity, distance, speed, flags;
+};
+
+static bool readFrame(Rx& rx) {
+  return scanf("%lu,%d,%d,%d,%d,%d", &rx.ms, &rx.pattern, &rx.intensity,
+               &rx.distance, &rx.speed, &rx.flags) == 6;
+}
+
+int main() {
+  hal::VirtualClock clock;
+  hal::RecordingGpio gpio;
+  HandbandController controller(gpio, MOTOR_PIN, 8);
+
+  Rx rx;
+  bool haveFrame = readFrame(rx);
+  int motor = -1;
+  bool lost = false;
+
+  while (!lost) {
+    uint32_t now = clock.millis();
+
+    while (haveFrame && rx.ms <= now) {
+      StateFrame f = {};
+      f.type = MSG_STATE;
+      f.pattern = (uint8_t)rx.pattern;
+      f.intensity = (uint8_t)rx.intensity;
+      f.flags = (uint8_t)rx.flags;
+      f.distance = (int16_t)rx.distance;
+      f.closingSpeed = (int16_t)rx.speed;
+      controller.onStateFrame(now, f);
+      haveFrame = readFrame(rx);
+    }
+
+    if (controller.update(now) & HandbandController::EV_LINK_LOST) {
+      // The firmware rescans here; stop once the trace is exhausted
+      lost = !haveFrame;
+      controller.holdLink(now);
+    }
+
+    int on = controller.motorOn() ? 1 : 0;
+    if (on != motor) {
+      printf("%u,%d\n", now, on);
+      motor = on;
+    }
+
+    clock.delay(controller.paused() ? 50 : LOOP_INTERVAL);
+  }
+  return 0;
+}
@@ -9,6 +9,12 @@
  *   - Status LED
  *   - ESP-NOW receiver
  *   - Reading mode support (pause vibration)
+ *   - Vibration patterns downloaded from eyewear (cached in NVS)
+ *   - Dead reckoning of the obstacle zone during packet loss
+ *   - Channel discovery (no WiFi AP needed)
+ *   - Pairing with the eyewear (left / right / centre / all role)
+ *   - Deferred binary trace (decode with Host-Tools/trace_decode)
+ *   - Light sleep between expected frames and pattern steps
  * 
  * License: MIT
  * ============================================
@@ -17,6 +23,16 @@
 #include <Arduino.h>
 #include <esp_now.h>
 #include <WiFi.h>
+#include <esp_wifi.h>
+#include <esp_sleep.h>
+#include <driver/gpio.h>
+#include <Preferences.h>
+#include <VisionAssistProtocol.h>
+#include <HalArduino.h>
+#include <HandbandController.h>
+#include <ChannelScanner.h>
+#include <SleepPlanner.h>
+#include <Trace.h>
 
 #if ARDUINO_USB_CDC_ON_BOOT
 #define HWSerial Serial
@@ -25,11 +41,11 @@
 #endif
 
 // ===========================================
-// WiFi Credentials - CHANGE THESE!
-// Must match the eyewear unit
+// Trace Drain
 // ===========================================
-const char* ssid = "YOUR_WIFI_SSID";
-const char* password = "YOUR_WIFI_PASSWORD";
+#define TRACE_PRIORITY 1
+#define TRACE_STACK 2048
+#define TRACE_DRAIN_MS 20
 
 // ===========================================
 // Pin Definitions
@@ -38,78 +54,331 @@ const char* password = "YOUR_WIFI_PASSWORD";
 #define LED_PIN 8
 
 // ===========================================
-// Message Structure (must match S3)
+// Hardware
 // ===========================================
-typedef struct {
-  char command[32];
-  int distance;
-  int pattern;
-} Message;
+hal::ArduinoClock sysClock;
+hal::ArduinoGpio gpio;
+hal::EspNowRadio radio;
 
-Message incomingData;
+// ===========================================
+// Alert Path (pause, patterns, dead reckoning)
+// ===========================================
+HandbandController controller(gpio, MOTOR_PIN, LED_PIN);
+PatternPlayer& player = controller.player();
+DeadReckoning& reckoner = controller.reckoner();
+
+// ===========================================
+// Pattern Table (defaults until eyewear sends one)
+// ===========================================
+volatile bool tableDirty = false;  // save to NVS from loop()
+unsigned long lastTableRequest = 0;
+#define TABLE_REQUEST_INTERVAL 1000
+
+Preferences prefs;
+
+// ===========================================
+// Pairing - SET THE ROLE FOR THIS BAND
+// ===========================================
+// ROLE_ALL for a single band or a belt, ROLE_LEFT / ROLE_RIGHT for
+// a pair of bands. Only used the first time the eyewear pairs this
+// band; later changes are made from the eyewear web UI.
+#define BAND_ROLE ROLE_ALL
+#define PAIR_REQUEST_INTERVAL 1000
+
+volatile bool paired = false;  // cleared on link loss, re-sent until acknowledged
+unsigned long lastPairRequest = 0;
+
+// ===========================================
+// Channel Discovery
+// ===========================================
+ChannelScanner scanner;
+volatile bool channelLocked = false;
+volatile bool channelDirty = false;  // save to NVS from loop()
+uint8_t savedChannel = 0;
+bool firstVibrationLogged = false;
+
+// ===========================================
+// Power Saving
+// ===========================================
+// Light sleep with the radio off between the state frames the band
+// listens for and between pattern steps (see SleepPlanner). The USB
+// serial stops while asleep: set POWER_SAVE 0 to read the trace.
+#define POWER_SAVE 1
+#define ALERT_LATENCY_BUDGET_MS 150   // worst-case delay of a zone change
+#define FRAME_PERIOD_MS 50            // eyewear state frame interval
+#define POWER_REPORT_INTERVAL 10000
+
+SleepPlanner sleeper;
+uint32_t sleptMs = 0;          // since the last report
+uint16_t sleepCount = 0;
+unsigned long lastPowerReport = 0;
 
 // ===========================================
-// State Variables
+// Receive Mailbox
 // ===========================================
-volatile int currentPattern = 0;
-unsigned long lastToggle = 0;
-unsigned long lastReceived = 0;
-bool motorState = false;
-int lastPrintedPattern = -1;
-int receiveCount = 0;
-bool isPaused = false;
+// The receive callback runs on the WiFi task: it only leaves the
+// latest state frame, pattern table and beacon sender here, loop()
+// applies them, so the controller is only ever touched (and peers
+// added and pair requests sent) from one task
+portMUX_TYPE mailboxMux = portMUX_INITIALIZER_UNLOCKED;
+StateFrame mailFrame;
+uint32_t mailFrameAt = 0;     // receive time, for the sleep planner
+uint8_t mailMac[6];
+bool mailFramePending = false;
+PatternTableFrame mailTable;
+bool mailTablePending = false;
+uint8_t mailBeaconMac[6];
+bool mailBeaconPending = false;
+
+// ===========================================
+// Motor Output
+// ===========================================
+void checkFirstVibration() {
+  if (controller.motorOn() && !firstVibrationLogged) {
+    firstVibrationLogged = true;
+    HWSerial.printf("⏱ Boot to first vibration: %lu ms\n", millis());
+  }
+}
+
+// ===========================================
+// Channel Discovery
+// ===========================================
+void setChannel(uint8_t channel) {
+  esp_wifi_set_channel(channel, WIFI_SECOND_CHAN_NONE);
+}
+
+void startChannelScan() {
+  channelLocked = false;
+  sleeper.reset();
+  setChannel(scanner.start(savedChannel, sysClock.millis()));
+  TRACE(TR_HB_CHANNEL_SCAN, scanner.channel(), 0);
+}
+
+// Called from the receive callback on the first frame heard
+void lockChannel() {
+  channelLocked = true;
+  if (scanner.channel() != savedChannel) {
+    savedChannel = scanner.channel();
+    channelDirty = true;
+  }
+  TRACE(TR_HB_CHANNEL_LOCK, scanner.channel(), sysClock.millis() - scanner.startedAt());
+}
+
+// ===========================================
+// Pattern Table Storage
+// ===========================================
+void loadPatternTable() {
+  prefs.begin("haptics", true);
+  uint8_t ver = prefs.getUChar("ver", 0);
+  uint8_t count = prefs.getUChar("count", 0);
+  PatternDesc patterns[MAX_PATTERNS];
+  if (ver != 0 && count > 0 && count <= MAX_PATTERNS &&
+      prefs.getBytesLength("table") == sizeof(patterns)) {
+    prefs.getBytes("table", patterns, sizeof(patterns));
+    player.load(patterns, count, ver);
+    
+    uint16_t thresholds[3];
+    if (prefs.getBytes("thresh", thresholds, sizeof(thresholds)) == sizeof(thresholds)) {
+      reckoner.setThresholds(thresholds[0], thresholds[1], thresholds[2]);
+    }
+  }
+  savedChannel = prefs.getUChar("chan", 0);
+  prefs.end();
+  
+  HWSerial.print("✓ Pattern table v");
+  HWSerial.print(player.version());
+  HWSerial.println(player.version() == 0 ? " (built-in)" : " (cached)");
+}
+
+void savePatternTable() {
+  prefs.begin("haptics", false);
+  prefs.putBytes("table", player.table(), MAX_PATTERNS * sizeof(PatternDesc));
+  prefs.putBytes("thresh", reckoner.config().thresholds, sizeof(reckoner.config().thresholds));
+  prefs.putUChar("count", player.count());
+  prefs.putUChar("ver", player.version());
+  prefs.end();
+}
+
+void addEyewearPeer(const uint8_t *mac) {
+  if (esp_now_is_peer_exist(mac)) return;
+  esp_now_peer_info_t peer = {};
+  memcpy(peer.peer_addr, mac, 6);
+  peer.channel = 0;
+  peer.encrypt = false;
+  esp_now_add_peer(&peer);
+}
+
+void requestPatternTable(const uint8_t *mac) {
+  unsigned long now = sysClock.millis();
+  if (now - lastTableRequest < TABLE_REQUEST_INTERVAL) return;
+  lastTableRequest = now;
+  TRACE(TR_HB_TABLE_REQUEST, player.version(), 0);
+  
+  addEyewearPeer(mac);
+  
+  TableRequestFrame req;
+  req.type = MSG_TABLE_REQUEST;
+  req.haveVersion = player.version();
+  radio.send(mac, (uint8_t*)&req, sizeof(req));
+}
+
+// Beacons come from the eyewear: ask to be driven by it
+void requestPairing(const uint8_t *mac) {
+  unsigned long now = sysClock.millis();
+  if (paired || now - lastPairRequest < PAIR_REQUEST_INTERVAL) return;
+  lastPairRequest = now;
+  
+  addEyewearPeer(mac);
+  
+  PairRequestFrame req;
+  req.type = MSG_PAIR_REQUEST;
+  req.role = BAND_ROLE;
+  radio.send(mac, (uint8_t*)&req, sizeof(req));
+}
+
+void onPatternTable(const PatternTableFrame *table) {
+  if (!player.applyTable(*table)) return;
+  reckoner.setThresholds(table->thresholds[0], table->thresholds[1], table->thresholds[2]);
+  tableDirty = true;
+}
 
 // ===========================================
 // ESP-NOW Receive Callback
 // ===========================================
 void OnDataRecv(const uint8_t *mac, const uint8_t *data, int len) {
-  memcpy(&incomingData, data, sizeof(incomingData));
+  if (len < 1) return;
+  
+  // Any eyewear frame tells us we are on its channel
+  bool fromEyewear = data[0] >= MSG_STATE && data[0] <= MSG_PAIR_ACK &&
+                     data[0] != MSG_TABLE_REQUEST && data[0] != MSG_PAIR_REQUEST;
+  if (!channelLocked && fromEyewear) {
+    lockChannel();
+  }
+  if (data[0] == MSG_BEACON) {
+    if (paired) return;
+    portENTER_CRITICAL(&mailboxMux);
+    memcpy(mailBeaconMac, mac, 6);
+    mailBeaconPending = true;
+    portEXIT_CRITICAL(&mailboxMux);
+    return;
+  }
   
-  lastReceived = millis();
-  receiveCount++;
+  if (data[0] == MSG_PAIR_ACK && len >= (int)sizeof(PairAckFrame)) {
+    const PairAckFrame *ack = (const PairAckFrame*)data;
+    if (!paired) TRACE(TR_HB_PAIRED, ack->role, ack->slot);
+    paired = true;
+    return;
+  }
   
-  // Check for PAUSE command (reading mode)
-  if (strcmp(incomingData.command, "PAUSE") == 0) {
-    if (!isPaused) {
-      isPaused = true;
-      currentPattern = 0;
-      digitalWrite(MOTOR_PIN, LOW);
-      digitalWrite(LED_PIN, LOW);
-      motorState = false;
-      HWSerial.println("📖 READING MODE - Motor OFF");
-    }
+  if (data[0] == MSG_PATTERN_TABLE && len >= (int)sizeof(PatternTableFrame)) {
+    portENTER_CRITICAL(&mailboxMux);
+    memcpy(&mailTable, data, sizeof(mailTable));
+    mailTablePending = true;
+    portEXIT_CRITICAL(&mailboxMux);
     return;
   }
   
-  // Normal mode
-  if (isPaused) {
-    isPaused = false;
-    HWSerial.println("📍 NAVIGATION MODE - Motor Active");
+  if (data[0] != MSG_STATE || len < (int)sizeof(StateFrame)) return;
+  
+  // A newer frame replaces one loop() has not taken yet
+  uint32_t now = sysClock.millis();
+  portENTER_CRITICAL(&mailboxMux);
+  memcpy(&mailFrame, data, sizeof(mailFrame));
+  memcpy(mailMac, mac, 6);
+  mailFrameAt = now;
+  mailFramePending = true;
+  portEXIT_CRITICAL(&mailboxMux);
+}
+
+// ===========================================
+// Frame Handling (loop task)
+// ===========================================
+void applyMailbox() {
+  static PatternTableFrame table;   // off the loop stack
+  StateFrame frame;
+  uint32_t frameAt = 0;
+  uint8_t mac[6];
+  uint8_t beaconMac[6];
+  
+  portENTER_CRITICAL(&mailboxMux);
+  bool haveFrame = mailFramePending;
+  bool haveTable = mailTablePending;
+  bool haveBeacon = mailBeaconPending;
+  if (haveFrame) {
+    memcpy(&frame, &mailFrame, sizeof(frame));
+    memcpy(mac, mailMac, 6);
+    frameAt = mailFrameAt;
   }
+  if (haveTable) memcpy(&table, &mailTable, sizeof(table));
+  if (haveBeacon) memcpy(beaconMac, mailBeaconMac, 6);
+  mailFramePending = mailTablePending = mailBeaconPending = false;
+  portEXIT_CRITICAL(&mailboxMux);
   
-  currentPattern = incomingData.pattern;
+  if (haveBeacon) requestPairing(beaconMac);
+  if (haveTable) onPatternTable(&table);
+  if (!haveFrame) return;
   
-  if (incomingData.pattern != lastPrintedPattern) {
-    lastPrintedPattern = currentPattern;
-    
-    HWSerial.print("📩 ");
-    HWSerial.print(incomingData.command);
-    HWSerial.print(" @ ");
-    HWSerial.print(incomingData.distance);
-    HWSerial.print("mm (");
-    HWSerial.print(receiveCount);
-    HWSerial.println(" msgs)");
-    
-    lastToggle = millis();
-    if (currentPattern >= 1) {
-      digitalWrite(MOTOR_PIN, HIGH);
-      digitalWrite(LED_PIN, HIGH);
-      motorState = true;
-    } else {
-      digitalWrite(MOTOR_PIN, LOW);
-      digitalWrite(LED_PIN, LOW);
-      motorState = false;
+  if (frame.tableVersion != player.version()) {
+    requestPatternTable(mac);
+  }
+  
+  sleeper.onFrame(frameAt);
+  uint8_t events = controller.onStateFrame(sysClock.millis(), frame);
+  
+  if (events & HandbandController::EV_PAUSED) TRACE(TR_HB_PAUSED, 0, 0);
+  if (events & HandbandController::EV_RESUMED) TRACE(TR_HB_RESUMED, 0, 0);
+  if (events & HandbandController::EV_PATTERN) {
+    TRACE(TR_HB_PATTERN, controller.receivedPattern(), frame.distance);
+  }
+  checkFirstVibration();
+}
+
+// ===========================================
+// Power Saving
+// ===========================================
+// Light sleep until the next frame worth hearing or pattern step, else
+// the usual loop delay. The motor pin is held low while asleep.
+void idle(uint32_t now, uint32_t loopMs) {
+#if POWER_SAVE
+  uint32_t ms = sleeper.sleepMs(now, controller.quietMs(now));
+  if (ms > 0 && !tableDirty && !channelDirty) {
+    gpio_hold_en((gpio_num_t)MOTOR_PIN);
+    esp_sleep_enable_timer_wakeup(ms * 1000ULL);
+    esp_light_sleep_start();
+    gpio_hold_dis((gpio_num_t)MOTOR_PIN);
+    sleptMs += sysClock.millis() - now;
+    sleepCount++;
+    return;
+  }
+#endif
+  sysClock.delay(loopMs);
+}
+
+void reportPower(uint32_t now) {
+  uint32_t elapsed = now - lastPowerReport;
+  if (elapsed < POWER_REPORT_INTERVAL) return;
+  TRACE(TR_HB_POWER, (int32_t)((uint64_t)sleptMs * 1000 / elapsed), sleepCount);
+  lastPowerReport = now;
+  sleptMs = 0;
+  sleepCount = 0;
+}
+
+// ===========================================
+// Trace Drain Task
+// ===========================================
+// Only this task writes trace records to serial, so the receive
+// callback and loop() never wait on the UART
+void traceTask(void* param) {
+  static uint8_t frame[5 + TRACE_FRAME_MAX_RECORDS * sizeof(TraceRecord)];
+  for (;;) {
+    size_t len;
+    while ((len = traceDrain(frame, sizeof(frame))) > 0) {
+      HWSerial.write(frame, len);
     }
+    // Reported once the ring has room again
+    uint32_t lost = traceTakeDropped();
+    if (lost) TRACE(TR_DROPPED, lost, 0);
+    vTaskDelay(pdMS_TO_TICKS(TRACE_DRAIN_MS));
   }
 }
 
@@ -121,46 +390,34 @@ void setup() {
   pinMode(LED_PIN, OUTPUT);
   
   HWSerial.begin(115200);
-  delay(2000);
   
   HWSerial.println("\n================================");
   HWSerial.println("  VISIONASSIST - HANDBAND UNIT");
   HWSerial.println("  Vibration Feedback Controller");
   HWSerial.println("================================\n");
   
-  // Hardware test
+  traceBegin(sysClock, 'H');
+  uint32_t traceCost = traceMeasureCostNs(2000);
+  TRACE(TR_COST, traceCost, 2000);
+  HWSerial.printf("✓ Trace level %d, %u ns/event\n", TRACE_LEVEL, traceCost);
+  xTaskCreate(traceTask, "trace", TRACE_STACK, NULL, TRACE_PRIORITY, NULL);
+  
+  // Hardware test - short pulse, a long one only delays boot
   HWSerial.println("Testing motor & LED...");
   digitalWrite(MOTOR_PIN, HIGH);
   digitalWrite(LED_PIN, HIGH);
-  delay(1000);
+  delay(100);
   digitalWrite(MOTOR_PIN, LOW);
   digitalWrite(LED_PIN, LOW);
   HWSerial.println("✓ Hardware OK\n");
   
-  // WiFi connection
-  HWSerial.print("Connecting to WiFi: ");
-  HWSerial.println(ssid);
+  loadPatternTable();
   
+  // Radio only - no AP association, the channel is discovered from eyewear frames
   WiFi.mode(WIFI_STA);
-  WiFi.begin(ssid, password);
-  
-  int attempts = 0;
-  while (WiFi.status() != WL_CONNECTED && attempts++ < 30) {
-    delay(500);
-    HWSerial.print(".");
-    digitalWrite(LED_PIN, !digitalRead(LED_PIN));
-  }
-  digitalWrite(LED_PIN, LOW);
-  
-  if (WiFi.status() == WL_CONNECTED) {
-    HWSerial.println("\n✓ WiFi Connected");
-    HWSerial.print("  Channel: ");
-    HWSerial.println(WiFi.channel());
-    HWSerial.print("  MAC: ");
-    HWSerial.println(WiFi.macAddress());
-  } else {
-    HWSerial.println("\n✗ WiFi FAILED");
-  }
+  WiFi.disconnect();
+  HWSerial.print("  MAC: ");
+  HWSerial.println(WiFi.macAddress());
   
   // ESP-NOW init
   if (esp_now_init() != ESP_OK) {
@@ -176,93 +433,79 @@ void setup() {
   HWSerial.println("✓ ESP-NOW OK");
   esp_now_register_recv_cb(OnDataRecv);
   
+  SleepPlanner::Config sleepConfig;
+  sleepConfig.framePeriodMs = FRAME_PERIOD_MS;
+  sleepConfig.budgetMs = ALERT_LATENCY_BUDGET_MS;
+  sleeper.configure(sleepConfig, reckoner.config().frameGapMs);
+#if POWER_SAVE
+  HWSerial.printf("✓ Light sleep on, listening every %u frames (%u ms budget)\n",
+                  sleeper.frameStride(), ALERT_LATENCY_BUDGET_MS);
+#endif
+  
+  startChannelScan();
+  
   HWSerial.println("\n================================");
-  HWSerial.println("  Ready! Waiting for S3...");
+  HWSerial.printf("  Ready at boot +%lu ms\n", millis());
+  HWSerial.println("  Waiting for S3...");
   HWSerial.println("================================\n");
   
-  lastReceived = millis();
+  controller.holdLink(millis());
 }
 
 // ===========================================
 // Loop
 // ===========================================
 void loop() {
-  unsigned long now = millis();
+  // Frames first, so none is newer than the loop's clock
+  applyMailbox();
+  unsigned long now = sysClock.millis();
   
-  // Connection timeout
-  if (now - lastReceived > 1500) {
-    if (motorState || currentPattern != 0 || isPaused) {
-      digitalWrite(MOTOR_PIN, LOW);
-      digitalWrite(LED_PIN, LOW);
-      motorState = false;
-      currentPattern = 0;
-      lastPrintedPattern = -1;
-      isPaused = false;
-      HWSerial.println("⚠️ Connection lost");
+  // Persist a freshly downloaded pattern table (NVS writes stay out of the callback)
+  if (tableDirty) {
+    tableDirty = false;
+    savePatternTable();
+    TRACE(TR_HB_TABLE_SAVED, player.version(), 0);
+  }
+  
+  if (channelDirty) {
+    channelDirty = false;
+    prefs.begin("haptics", false);
+    prefs.putUChar("chan", savedChannel);
+    prefs.end();
+  }
+  
+  // Channel discovery - motor stays off until the eyewear is heard
+  if (!channelLocked) {
+    if (scanner.hop(now)) setChannel(scanner.channel());
+    gpio.digitalWrite(LED_PIN, (now / 250) % 2);
+    controller.holdLink(now);
+    sysClock.delay(10);
+    return;
+  }
+  
+  uint8_t events = controller.update(now);
+  checkFirstVibration();
+  reportPower(now);
+  
+  if (events & HandbandController::EV_LINK_LOST) {
+    if (events & HandbandController::EV_RESET) {
+      TRACE(TR_HB_LINK_LOST, controller.frames(), 0);
     }
-    delay(100);
+    paired = false;  // a rebooted eyewear may have lost us
+    // Eyewear may have moved to another channel (e.g. joined its AP)
+    startChannelScan();
     return;
   }
   
-  // If paused (reading mode), keep motor off
-  if (isPaused) {
-    digitalWrite(MOTOR_PIN, LOW);
-    digitalWrite(LED_PIN, LOW);
-    delay(50);
+  // If paused (reading mode), the motor stays off
+  if (controller.paused()) {
+    idle(now, 50);
     return;
   }
   
-  // Handle vibration patterns
-  switch(currentPattern) {
-    
-    case 1:  // CRITICAL - Continuous vibration
-      digitalWrite(MOTOR_PIN, HIGH);
-      digitalWrite(LED_PIN, HIGH);
-      break;
-      
-    case 2:  // WARNING - Fast pulses
-      if (motorState) {
-        if (now - lastToggle >= 400) {
-          digitalWrite(MOTOR_PIN, LOW);
-          digitalWrite(LED_PIN, LOW);
-          motorState = false;
-          lastToggle = now;
-        }
-      } else {
-        if (now - lastToggle >= 150) {
-          digitalWrite(MOTOR_PIN, HIGH);
-          digitalWrite(LED_PIN, HIGH);
-          motorState = true;
-          lastToggle = now;
-        }
-      }
-      break;
-      
-    case 3:  // CAUTION - Slow pulses
-      if (motorState) {
-        if (now - lastToggle >= 300) {
-          digitalWrite(MOTOR_PIN, LOW);
-          digitalWrite(LED_PIN, LOW);
-          motorState = false;
-          lastToggle = now;
-        }
-      } else {
-        if (now - lastToggle >= 600) {
-          digitalWrite(MOTOR_PIN, HIGH);
-          digitalWrite(LED_PIN, HIGH);
-          motorState = true;
-          lastToggle = now;
-        }
-      }
-      break;
-      
-    case 0:  // CLEAR - OFF
-    default:
-      digitalWrite(MOTOR_PIN, LOW);
-      digitalWrite(LED_PIN, LOW);
-      motorState = false;
-      break;
+  if (events & HandbandController::EV_LINK_MODE) {
+    TRACE(TR_HB_LINK_MODE, controller.linkMode(), 0);
   }
   
-  delay(10);
-}
\ No newline at end of file
+  idle(now, 10);
+}
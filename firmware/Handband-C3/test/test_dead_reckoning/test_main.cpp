@@ -0,0 +1,81 @@
+/*
+ * ============================================
+ * VisionAssist - DeadReckoning tests
+ * ============================================
+ *
+ *   pio test -e native
+ * ============================================
+ */
+
+#include <unity.h>
+#include <DeadReckoning.h>
+
+void setUp() {}
+void tearDown() {}
+
+void test_modes_follow_the_gap() {
+  DeadReckoning dr;   // 150 ms gap, 1000 ms window, 5000 ms to lost
+  TEST_ASSERT_EQUAL_INT(DeadReckoning::LINK_LOST, dr.mode(0));
+  dr.onFrame(1000, 2500, 0);
+  TEST_ASSERT_EQUAL_INT(DeadReckoning::LINK_OK, dr.mode(1149));
+  TEST_ASSERT_EQUAL_INT(DeadReckoning::EXTRAPOLATING, dr.mode(1150));
+  TEST_ASSERT_EQUAL_INT(DeadReckoning::EXTRAPOLATING, dr.mode(1999));
+  TEST_ASSERT_EQUAL_INT(DeadReckoning::DEGRADED, dr.mode(2000));
+  TEST_ASSERT_EQUAL_INT(DeadReckoning::DEGRADED, dr.mode(5999));
+  TEST_ASSERT_EQUAL_INT(DeadReckoning::LINK_LOST, dr.mode(6000));
+
+  dr.onFrame(6000, 2500, 0);
+  TEST_ASSERT_EQUAL_INT(DeadReckoning::LINK_OK, dr.mode(6010));
+  dr.reset();
+  TEST_ASSERT_EQUAL_INT(DeadReckoning::LINK_LOST, dr.mode(6010));
+}
+
+void test_zone_thresholds() {
+  DeadReckoning dr;
+  TEST_ASSERT_EQUAL_UINT8(PATTERN_CRITICAL, dr.zoneFor(CRITICAL_DISTANCE - 1));
+  TEST_ASSERT_EQUAL_UINT8(PATTERN_WARNING, dr.zoneFor(CRITICAL_DISTANCE));
+  TEST_ASSERT_EQUAL_UINT8(PATTERN_CAUTION, dr.zoneFor(WARNING_DISTANCE));
+  TEST_ASSERT_EQUAL_UINT8(PATTERN_CLEAR, dr.zoneFor(CAUTION_DISTANCE));
+
+  dr.setThresholds(500, 800, 1000);
+  TEST_ASSERT_EQUAL_UINT8(PATTERN_CRITICAL, dr.zoneFor(499));
+  TEST_ASSERT_EQUAL_UINT8(PATTERN_CAUTION, dr.zoneFor(800));
+  TEST_ASSERT_EQUAL_UINT8(PATTERN_CLEAR, dr.zoneFor(1000));
+}
+
+void test_extrapolates_approach_within_window() {
+  DeadReckoning dr;
+  dr.onFrame(0, 2100, 1000);   // 1 m/s closing
+  TEST_ASSERT_EQUAL_INT(2100, dr.estimatedDistance(0));
+  TEST_ASSERT_EQUAL_INT(1800, dr.estimatedDistance(300));
+  TEST_ASSERT_EQUAL_UINT8(PATTERN_CAUTION, dr.extrapolatedZone(300));
+  TEST_ASSERT_EQUAL_UINT8(PATTERN_WARNING, dr.extrapolatedZone(600));
+  // Held at the window's end
+  TEST_ASSERT_EQUAL_INT(1100, dr.estimatedDistance(1000));
+  TEST_ASSERT_EQUAL_INT(1100, dr.estimatedDistance(4000));
+  TEST_ASSERT_EQUAL_UINT8(PATTERN_CRITICAL, dr.extrapolatedZone(1000));
+}
+
+void test_receding_holds_last_zone() {
+  DeadReckoning dr;
+  dr.onFrame(0, 1500, -2000);
+  TEST_ASSERT_EQUAL_INT(1500, dr.estimatedDistance(800));
+  TEST_ASSERT_EQUAL_UINT8(PATTERN_WARNING, dr.extrapolatedZone(800));
+}
+
+void test_speed_clamped_and_range_floored() {
+  DeadReckoning dr;
+  dr.onFrame(0, 2000, 30000);   // noisy estimate, clamped to 3000 mm/s
+  TEST_ASSERT_EQUAL_INT(1700, dr.estimatedDistance(100));
+  TEST_ASSERT_EQUAL_INT(0, dr.estimatedDistance(1000));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_modes_follow_the_gap);
+  RUN_TEST(test_zone_thresholds);
+  RUN_TEST(test_extrapolates_approach_within_window);
+  RUN_TEST(test_receding_holds_last_zone);
+  RUN_TEST(test_speed_clamped_and_range_floored);
+  return UNITY_END();
+}
@@ -0,0 +1,111 @@
+/*
+ * ============================================
+ * VisionAssist - PatternPlayer tests
+ * ============================================
+ *
+ *   pio test -e native
+ * ============================================
+ */
+
+#include <unity.h>
+#include <PatternPlayer.h>
+
+#include <string.h>
+
+void setUp() {}
+void tearDown() {}
+
+void test_starts_on_default_table() {
+  PatternPlayer p;
+  TEST_ASSERT_EQUAL_UINT8(0, p.version());
+  TEST_ASSERT_EQUAL_UINT8(PATTERN_COUNT, p.count());
+  TEST_ASSERT_EQUAL_UINT8(PATTERN_CLEAR, p.playing());
+  TEST_ASSERT_FALSE(p.update(0));
+}
+
+void test_warning_on_off_timing() {
+  // WARNING: 400 ms on, 150 ms off
+  PatternPlayer p;
+  TEST_ASSERT_TRUE(p.select(PATTERN_WARNING, 1000));
+  TEST_ASSERT_TRUE(p.motorOn());
+  TEST_ASSERT_TRUE(p.update(1399));
+  TEST_ASSERT_EQUAL_UINT32(1, p.untilChange(1399));
+  TEST_ASSERT_FALSE(p.update(1400));
+  TEST_ASSERT_EQUAL_UINT32(150, p.untilChange(1400));
+  TEST_ASSERT_FALSE(p.update(1549));
+  TEST_ASSERT_TRUE(p.update(1550));
+  TEST_ASSERT_FALSE(p.update(1950));
+}
+
+void test_continuous_and_off_never_change() {
+  PatternPlayer p;
+  p.select(PATTERN_CRITICAL, 0);
+  TEST_ASSERT_TRUE(p.update(100000));
+  TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, p.untilChange(100000));
+  p.select(PATTERN_CLEAR, 100000);
+  TEST_ASSERT_FALSE(p.update(200000));
+  TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, p.untilChange(200000));
+}
+
+void test_reselect_keeps_cycle() {
+  PatternPlayer p;
+  p.select(PATTERN_CAUTION, 0);
+  TEST_ASSERT_FALSE(p.select(PATTERN_CAUTION, 200));   // same pattern: no restart
+  TEST_ASSERT_FALSE(p.update(300));                     // 300 ms on ended at 300
+}
+
+void test_unknown_id_plays_clear() {
+  PatternPlayer p;
+  p.select(PATTERN_CRITICAL, 0);
+  TEST_ASSERT_TRUE(p.select(MAX_PATTERNS + 3, 10));
+  TEST_ASSERT_EQUAL_UINT8(PATTERN_CLEAR, p.playing());
+  TEST_ASSERT_EQUAL_UINT8(PATTERN_CLEAR, p.clampId(-1));
+}
+
+void test_apply_table() {
+  PatternPlayer p;
+  PatternTableFrame frame;
+  memset(&frame, 0, sizeof(frame));
+  frame.type = MSG_PATTERN_TABLE;
+  frame.tableVersion = 7;
+  frame.count = 3;
+  frame.patterns[2].onMs = 100;
+  frame.patterns[2].offMs = 100;
+
+  TEST_ASSERT_TRUE(p.applyTable(frame));
+  TEST_ASSERT_EQUAL_UINT8(7, p.version());
+  TEST_ASSERT_EQUAL_UINT8(3, p.count());
+  TEST_ASSERT_FALSE(p.applyTable(frame));   // same version
+
+  p.select(2, 0);
+  TEST_ASSERT_TRUE(p.update(99));
+  TEST_ASSERT_FALSE(p.update(100));
+  // Ids past the new table play as CLEAR
+  TEST_ASSERT_EQUAL_UINT8(PATTERN_CLEAR, p.clampId(3));
+
+  frame.tableVersion = 8;
+  frame.count = 0;
+  TEST_ASSERT_FALSE(p.applyTable(frame));
+  frame.count = MAX_PATTERNS + 1;
+  TEST_ASSERT_FALSE(p.applyTable(frame));
+  TEST_ASSERT_EQUAL_UINT8(7, p.version());
+}
+
+void test_playing_pattern_dropped_by_smaller_table() {
+  PatternPlayer p;
+  p.select(PATTERN_DEGRADED, 0);
+  p.load(DEFAULT_PATTERNS, 2, 9);
+  TEST_ASSERT_EQUAL_UINT8(PATTERN_CLEAR, p.playing());
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_starts_on_default_table);
+  RUN_TEST(test_warning_on_off_timing);
+  RUN_TEST(test_continuous_and_off_never_change);
+  RUN_TEST(test_reselect_keeps_cycle);
+  RUN_TEST(test_unknown_id_plays_clear);
+  RUN_TEST(test_apply_table);
+  RUN_TEST(test_playing_pattern_dropped_by_smaller_table);
+  return UNITY_END();
+}
@@ -0,0 +1,182 @@
+/*
+ * ============================================
+ * VisionAssist - SleepPlanner tests
+ * ============================================
+ *
+ *   pio test -e native
+ * ============================================
+ */
+
+#include <unity.h>
+#include <HalHost.h>
+#include <HandbandController.h>
+#include <SleepPlanner.h>
+
+void setUp() {}
+void tearDown() {}
+
+static const uint8_t MOTOR_PIN = 2;
+static const uint8_t LED_PIN = 8;
+
+static StateFrame stateFrame(uint8_t pattern, uint8_t flags = 0) {
+  StateFrame f;
+  f.type = MSG_STATE;
+  f.tableVersion = 0;
+  f.pattern = pattern;
+  f.intensity = 200;
+  f.flags = flags;
+  f.distance = pattern == PATTERN_CLEAR ? 3000 : 1800;
+  f.closingSpeed = 0;
+  return f;
+}
+
+// Planner as main.cpp configures it, from dead reckoning's frame gap
+static SleepPlanner defaultPlanner() {
+  SleepPlanner s;
+  s.configure(SleepPlanner::Config(), DeadReckoning::Config().frameGapMs);
+  return s;
+}
+
+// ===========================================
+// Stride
+// ===========================================
+void test_default_stride_is_two() {
+  // min(150 budget, 150 gap - 25) / 50 = 2
+  TEST_ASSERT_EQUAL_UINT16(2, defaultPlanner().frameStride());
+}
+
+void test_stride_limits() {
+  SleepPlanner s;
+  SleepPlanner::Config c;
+  c.budgetMs = 300;
+  s.configure(c, 400);
+  TEST_ASSERT_EQUAL_UINT16(6, s.frameStride());   // budget bound
+  s.configure(c, 200);
+  TEST_ASSERT_EQUAL_UINT16(3, s.frameStride());   // frame gap bound: 175 / 50
+  c.budgetMs = 40;
+  s.configure(c, 400);
+  TEST_ASSERT_EQUAL_UINT16(0, s.frameStride());   // under one period: never sleeps
+  c.budgetMs = 150;
+  s.configure(c, 20);
+  TEST_ASSERT_EQUAL_UINT16(0, s.frameStride());
+}
+
+// ===========================================
+// sleepMs
+// ===========================================
+void test_sleep_follows_frame_cadence() {
+  SleepPlanner s = defaultPlanner();
+  TEST_ASSERT_EQUAL_UINT32(0, s.sleepMs(1000, UINT32_MAX));   // no frame heard yet
+  s.onFrame(1000);
+  // Sleeps through one frame, wakes 5 ms before the second
+  TEST_ASSERT_EQUAL_UINT32(95, s.sleepMs(1000, UINT32_MAX));
+  TEST_ASSERT_EQUAL_UINT32(45, s.sleepMs(1050, UINT32_MAX));
+  TEST_ASSERT_EQUAL_UINT32(0, s.sleepMs(1088, UINT32_MAX));   // under minSleepMs
+  TEST_ASSERT_EQUAL_UINT32(0, s.sleepMs(1095, UINT32_MAX));   // listening
+  TEST_ASSERT_EQUAL_UINT32(0, s.sleepMs(1200, UINT32_MAX));   // frame missed: stay awake
+  s.reset();
+  TEST_ASSERT_EQUAL_UINT32(0, s.sleepMs(1000, UINT32_MAX));
+}
+
+void test_sleep_paused() {
+  hal::RecordingGpio gpio;
+  HandbandController hb(gpio, MOTOR_PIN, LED_PIN);
+  SleepPlanner s = defaultPlanner();
+  hb.onStateFrame(1000, stateFrame(PATTERN_CLEAR, FLAG_PAUSE));
+  s.onFrame(1000);
+  hb.update(1000);
+  TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, hb.quietMs(1000));
+  TEST_ASSERT_EQUAL_UINT32(95, s.sleepMs(1000, hb.quietMs(1000)));
+}
+
+void test_sleep_motor_on() {
+  hal::RecordingGpio gpio;
+  HandbandController hb(gpio, MOTOR_PIN, LED_PIN);
+  SleepPlanner s = defaultPlanner();
+  hb.onStateFrame(1000, stateFrame(PATTERN_CAUTION));   // 300 ms on, 600 off
+  s.onFrame(1000);
+  hb.update(1010);
+  TEST_ASSERT_TRUE(hb.motorOn());
+  TEST_ASSERT_EQUAL_UINT32(0, s.sleepMs(1010, hb.quietMs(1010)));
+}
+
+void test_sleep_link_ok_bounded_by_quiet_ms() {
+  hal::RecordingGpio gpio;
+  HandbandController hb(gpio, MOTOR_PIN, LED_PIN);
+  SleepPlanner s = defaultPlanner();
+  hb.onStateFrame(1000, stateFrame(PATTERN_CAUTION));
+  hb.update(1300);   // off phase until 1900
+  TEST_ASSERT_FALSE(hb.motorOn());
+
+  // Frame at 1850 keeps the link OK; the pulse at 1900 ends sleep early
+  hb.onStateFrame(1850, stateFrame(PATTERN_CAUTION));
+  s.onFrame(1850);
+  hb.update(1880);
+  TEST_ASSERT_EQUAL_INT(DeadReckoning::LINK_OK, hb.linkMode());
+  TEST_ASSERT_EQUAL_UINT32(20, hb.quietMs(1880));
+  TEST_ASSERT_EQUAL_UINT32(20, s.sleepMs(1880, hb.quietMs(1880)));
+
+  // Clear: nothing to play, only the frame cadence bounds sleep
+  hb.onStateFrame(2000, stateFrame(PATTERN_CLEAR));
+  s.onFrame(2000);
+  hb.update(2000);
+  TEST_ASSERT_EQUAL_UINT32(95, s.sleepMs(2000, hb.quietMs(2000)));
+}
+
+// ===========================================
+// Frame gap bound
+// ===========================================
+void test_sleep_never_reaches_frame_gap() {
+  SleepPlanner::Config c;
+  for (uint16_t period = 20; period <= 100; period += 10) {
+    for (uint16_t budget = 0; budget <= 1000; budget += 25) {
+      for (uint16_t gap = 50; gap <= 1000; gap += 50) {
+        c.framePeriodMs = period;
+        c.budgetMs = budget;
+        SleepPlanner s;
+        s.configure(c, gap);
+        // The frame listened for leaves half a period for send jitter
+        TEST_ASSERT_TRUE(s.frameStride() * period <= gap - period / 2 || s.frameStride() == 0);
+        s.onFrame(10000);
+        for (uint32_t since = 0; since < gap; since++) {
+          uint32_t ms = s.sleepMs(10000 + since, UINT32_MAX);
+          if (ms) TEST_ASSERT_TRUE(since + ms < gap);
+        }
+      }
+    }
+  }
+}
+
+void test_sleeping_band_never_degrades() {
+  // Eyewear sends every 50 ms; the band hears only the frames it is awake for
+  hal::RecordingGpio gpio;
+  HandbandController hb(gpio, MOTOR_PIN, LED_PIN);
+  SleepPlanner s = defaultPlanner();
+  uint32_t awakeAt = 0;
+  uint32_t heard = 0;
+  for (uint32_t t = 1000; t < 6000; t++) {
+    if (t < awakeAt) continue;
+    if (t % 50 == 0) {
+      hb.onStateFrame(t, stateFrame(PATTERN_CLEAR));
+      s.onFrame(t);
+      heard++;
+    }
+    hb.update(t);
+    TEST_ASSERT_EQUAL_INT(DeadReckoning::LINK_OK, hb.linkMode());
+    awakeAt = t + s.sleepMs(t, hb.quietMs(t));
+  }
+  TEST_ASSERT_EQUAL_UINT32(50, heard);   // every second frame of 100
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_default_stride_is_two);
+  RUN_TEST(test_stride_limits);
+  RUN_TEST(test_sleep_follows_frame_cadence);
+  RUN_TEST(test_sleep_paused);
+  RUN_TEST(test_sleep_motor_on);
+  RUN_TEST(test_sleep_link_ok_bounded_by_quiet_ms);
+  RUN_TEST(test_sleep_never_reaches_frame_gap);
+  RUN_TEST(test_sleeping_band_never_degrades);
+  return UNITY_END();
+}
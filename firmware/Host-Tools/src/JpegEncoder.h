@@ -0,0 +1,211 @@
+/*
+ * ============================================
+ * VisionAssist - Baseline JPEG Encoder (host)
+ * ============================================
+ *
+ * Grey frames to baseline JPEGs laid out like the OV2640's
+ * stream (4:2:2, one scan, no restart markers), for the
+ * Host-Tools that feed generated scenes to the eyewear's
+ * JPEG parsers. Standard (Annex K) luma tables; chroma
+ * blocks are flat grey and share them.
+ * ============================================
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+static const uint8_t ZIGZAG[64] = {
+   0,  1,  8, 16,  9,  2,  3, 10, 17, 24, 32, 25, 18, 11,  4,  5,
+  12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13,  6,  7, 14, 21, 28,
+  35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51,
+  58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63 };
+
+static const uint8_t STD_QUANT[64] = {
+  16, 11, 10, 16,  24,  40,  51,  61,  12, 12, 14, 19,  26,  58,  60,  55,
+  14, 13, 16, 24,  40,  57,  69,  56,  14, 17, 22, 29,  51,  87,  80,  62,
+  18, 22, 37, 56,  68, 109, 103,  77,  24, 35, 55, 64,  81, 104, 113,  92,
+  49, 64, 78, 87, 103, 121, 120, 101,  72, 92, 95, 98, 112, 100, 103,  99 };
+
+static const uint8_t DC_BITS[16] = { 0, 1, 5, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0 };
+static const uint8_t DC_VALS[12] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11 };
+static const uint8_t AC_BITS[16] = { 0, 2, 1, 3, 3, 2, 4, 3, 5, 5, 4, 4, 0, 0, 1, 0x7D };
+static const uint8_t AC_VALS[162] = {
+  0x01, 0x02, 0x03, 0x00, 0x04, 0x11, 0x05, 0x12, 0x21, 0x31, 0x41, 0x06, 0x13, 0x51, 0x61, 0x07,
+  0x22, 0x71, 0x14, 0x32, 0x81, 0x91, 0xA1, 0x08, 0x23, 0x42, 0xB1, 0xC1, 0x15, 0x52, 0xD1, 0xF0,
+  0x24, 0x33, 0x62, 0x72, 0x82, 0x09, 0x0A, 0x16, 0x17, 0x18, 0x19, 0x1A, 0x25, 0x26, 0x27, 0x28,
+  0x29, 0x2A, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49,
+  0x4A, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5A, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69,
+  0x6A, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7A, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89,
+  0x8A, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9A, 0xA2, 0xA3, 0xA4, 0xA5, 0xA6, 0xA7,
+  0xA8, 0xA9, 0xAA, 0xB2, 0xB3, 0xB4, 0xB5, 0xB6, 0xB7, 0xB8, 0xB9, 0xBA, 0xC2, 0xC3, 0xC4, 0xC5,
+  0xC6, 0xC7, 0xC8, 0xC9, 0xCA, 0xD2, 0xD3, 0xD4, 0xD5, 0xD6, 0xD7, 0xD8, 0xD9, 0xDA, 0xE1, 0xE2,
+  0xE3, 0xE4, 0xE5, 0xE6, 0xE7, 0xE8, 0xE9, 0xEA, 0xF1, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7, 0xF8,
+  0xF9, 0xFA };
+
+class JpegEncoder {
+public:
+  explicit JpegEncoder(int quality = 75) {
+    int scale = quality < 50 ? 5000 / quality : 200 - 2 * quality;
+    for (int i = 0; i < 64; i++) {
+      int q = (STD_QUANT[i] * scale + 50) / 100;
+      quant[i] = (uint8_t)std::min(255, std::max(1, q));
+    }
+    buildCodes(DC_BITS, DC_VALS, dcCode, dcLen);
+    buildCodes(AC_BITS, AC_VALS, acCode, acLen);
+    for (int u = 0; u < 8; u++) {
+      for (int x = 0; x < 8; x++) {
+        cosTable[u][x] = (u == 0 ? sqrtf(0.5f) : 1.0f) * 0.5f * cosf((2 * x + 1) * u * (float)M_PI / 16);
+      }
+    }
+  }
+
+  void encode(const std::vector<uint8_t>& img, int w, int h, std::string& out) {
+    out.clear();
+    static const uint8_t SOI[] = { 0xFF, 0xD8 };
+    out.append((const char*)SOI, 2);
+
+    marker(out, 0xDB, 67);
+    out += (char)0x00;
+    for (int k = 0; k < 64; k++) out += (char)quant[ZIGZAG[k]];
+
+    marker(out, 0xC0, 17);
+    out += (char)8;
+    out += (char)(h >> 8); out += (char)h;
+    out += (char)(w >> 8); out += (char)w;
+    out += (char)3;
+    const uint8_t comps[3][3] = { { 1, 0x21, 0 }, { 2, 0x11, 0 }, { 3, 0x11, 0 } };
+    for (auto& c : comps) out.append((const char*)c, 3);
+
+    marker(out, 0xC4, 2 + 17 + 12 + 17 + 162);
+    out += (char)0x00;
+    out.append((const char*)DC_BITS, 16);
+    out.append((const char*)DC_VALS, 12);
+    out += (char)0x10;
+    out.append((const char*)AC_BITS, 16);
+    out.append((const char*)AC_VALS, 162);
+
+    marker(out, 0xDA, 12);
+    out += (char)3;
+    for (int c = 1; c <= 3; c++) { out += (char)c; out += (char)0x00; }
+    out += (char)0; out += (char)63; out += (char)0;
+
+    acc = 0;
+    nbits = 0;
+    int dcPred = 0;
+    for (int my = 0; my < (h + 7) / 8; my++) {
+      for (int mx = 0; mx < (w + 15) / 16; mx++) {
+        block(img, w, h, mx * 16, my * 8, dcPred, out);
+        block(img, w, h, mx * 16 + 8, my * 8, dcPred, out);
+        for (int c = 0; c < 2; c++) {   // flat chroma: no DC change, end of block
+          put(out, dcCode[0], dcLen[0]);
+          put(out, acCode[0x00], acLen[0x00]);
+        }
+      }
+    }
+    if (nbits) put(out, 0x7F, 8 - nbits);   // pad with ones
+    out += (char)0xFF;
+    out += (char)0xD9;
+  }
+
+private:
+  static void buildCodes(const uint8_t* bits, const uint8_t* vals, uint16_t* codes, uint8_t* lens) {
+    int code = 0, k = 0;
+    for (int len = 1; len <= 16; len++) {
+      for (int i = 0; i < bits[len - 1]; i++, k++) {
+        codes[vals[k]] = code++;
+        lens[vals[k]] = len;
+      }
+      code <<= 1;
+    }
+  }
+
+  static void marker(std::string& out, uint8_t id, int len) {
+    out += (char)0xFF;
+    out += (char)id;
+    out += (char)(len >> 8);
+    out += (char)len;
+  }
+
+  void put(std::string& out, uint32_t code, int len) {
+    acc = (acc << len) | (code & ((1u << len) - 1));
+    nbits += len;
+    while (nbits >= 8) {
+      uint8_t byte = (uint8_t)(acc >> (nbits - 8));
+      out += (char)byte;
+      if (byte == 0xFF) out += (char)0x00;
+      nbits -= 8;
+    }
+    acc &= (1u << nbits) - 1;
+  }
+
+  void putValue(std::string& out, int v, int size) {
+    if (size) put(out, v > 0 ? v : v + (1 << size) - 1, size);
+  }
+
+  static int category(int v) {
+    int a = abs(v), s = 0;
+    while (a) { s++; a >>= 1; }
+    return s;
+  }
+
+  void block(const std::vector<uint8_t>& img, int w, int h, int x0, int y0, int& dcPred, std::string& out) {
+    float f[8][8];
+    for (int y = 0; y < 8; y++) {
+      for (int x = 0; x < 8; x++) {
+        int px = std::min(x0 + x, w - 1), py = std::min(y0 + y, h - 1);
+        f[y][x] = img[py * w + px] - 128.0f;
+      }
+    }
+    float rows[8][8];
+    for (int y = 0; y < 8; y++) {
+      for (int u = 0; u < 8; u++) {
+        float s = 0;
+        for (int x = 0; x < 8; x++) s += cosTable[u][x] * f[y][x];
+        rows[y][u] = s;
+      }
+    }
+    int coef[64];
+    for (int v = 0; v < 8; v++) {
+      for (int u = 0; u < 8; u++) {
+        float s = 0;
+        for (int y = 0; y < 8; y++) s += cosTable[v][y] * rows[y][u];
+        coef[v * 8 + u] = (int)lrintf(s / quant[v * 8 + u]);
+      }
+    }
+
+    int diff = coef[0] - dcPred;
+    dcPred = coef[0];
+    int size = category(diff);
+    put(out, dcCode[size], dcLen[size]);
+    putValue(out, diff, size);
+
+    int run = 0;
+    for (int k = 1; k < 64; k++) {
+      int c = coef[ZIGZAG[k]];
+      if (c == 0) { run++; continue; }
+      while (run > 15) {
+        put(out, acCode[0xF0], acLen[0xF0]);
+        run -= 16;
+      }
+      size = category(c);
+      int rs = (run << 4) | size;
+      put(out, acCode[rs], acLen[rs]);
+      putValue(out, c, size);
+      run = 0;
+    }
+    if (run) put(out, acCode[0x00], acLen[0x00]);
+  }
+
+  uint8_t quant[64];
+  uint16_t dcCode[256] = {}, acCode[256] = {};
+  uint8_t dcLen[256] = {}, acLen[256] = {};
+  float cosTable[8][8];
+  uint32_t acc = 0;
+  int nbits = 0;
+};
@@ -0,0 +1,440 @@
+/*
+ * ============================================
+ * VisionAssist - Hot Path Micro-Benchmarks
+ * ============================================
+ *
+ * Times the code that runs per frame or per poll on the
+ * eyewear, on the host, over recorded-style inputs:
+ *   - base64 / request building for a camera JPEG
+ *   - Vision response parsing (full and field-masked)
+ *   - JSON escaping and the /ocr_status, /distance payloads
+ *   - one navigation loop() pass (TOF smoothing + zones)
+ *   - the same over a 3-zone sweep with cues for four bands
+ *   - one TRACE() record
+ *   - one /metrics histogram update
+ *
+ * Reports ns/op, bytes allocated/op and allocations/op.
+ * Allocation numbers are exact and machine independent;
+ * ns/op is only comparable on the same machine, so times
+ * are compared as a ratio to the "reference" kernel (a
+ * plain hash over the JPEG) measured in the same run.
+ *
+ * Usage:
+ *   program [--data dir] [--jpeg file] [--baseline file]
+ *           [--save file] [--tolerance pct] [--gate-time]
+ *
+ * --baseline exits non-zero if any kernel allocates more
+ * than the baseline. Kernels slower than the baseline by
+ * more than --tolerance (default 25%), relative to the
+ * reference kernel, are flagged; they fail the run only
+ * with --gate-time, for a quiet machine. A baseline
+ * without a reference row only reports times. Refresh
+ * data/bench_baseline.txt with --save when a change is
+ * intended.
+ * ============================================
+ */
+
+#include <HalHost.h>
+#include <OcrText.h>
+#include <WebJson.h>
+#include <NavigationController.h>
+#include <ZoneMap.h>
+#include <PeerTable.h>
+#include <FlightRecorder.h>
+#include <Trace.h>
+#include <Metrics.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+
+// ===========================================
+// Allocation Counting
+// ===========================================
+static uint64_t allocCount = 0;
+static uint64_t allocBytes = 0;
+
+void* operator new(size_t size) {
+  allocCount++;
+  allocBytes += size;
+  void* p = malloc(size ? size : 1);
+  if (!p) throw std::bad_alloc();
+  return p;
+}
+void* operator new[](size_t size) { return operator new(size); }
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+
+// ===========================================
+// Harness
+// ===========================================
+struct Result {
+  std::string name;
+  double nsPerOp = 0;
+  double bytesPerOp = 0;
+  double allocsPerOp = 0;
+};
+
+static volatile size_t sink = 0;   // keeps results alive
+
+// Runs `op` for about `minSeconds` in TIME_ROUNDS rounds and keeps the
+// fastest, so a round slowed by another process does not count;
+// allocations are measured on a separate run so the counters do not
+// skew the timing
+static const int TIME_ROUNDS = 7;
+
+template <typename Op>
+static Result bench(const char* name, Op op, double minSeconds = 0.3) {
+  Result r;
+  r.name = name;
+
+  for (int i = 0; i < 3; i++) op();   // warm up
+
+  const int countedOps = 16;
+  uint64_t c0 = allocCount, b0 = allocBytes;
+  for (int i = 0; i < countedOps; i++) op();
+  r.allocsPerOp = (double)(allocCount - c0) / countedOps;
+  r.bytesPerOp = (double)(allocBytes - b0) / countedOps;
+
+  // Ops per round: doubled until a round takes its share of minSeconds
+  uint64_t batch = 1;
+  double best = 0;
+  for (;;) {
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < batch; i++) op();
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (elapsed >= minSeconds / TIME_ROUNDS) {
+      best = elapsed;
+      break;
+    }
+    batch *= 2;
+  }
+  for (int round = 1; round < TIME_ROUNDS; round++) {
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < batch; i++) op();
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (elapsed < best) best = elapsed;
+  }
+  r.nsPerOp = best * 1e9 / batch;
+  return r;
+}
+
+// ===========================================
+// Inputs
+// ===========================================
+static bool readFile(const std::string& path, std::string& out) {
+  FILE* f = fopen(path.c_str(), "rb");
+  if (!f) return false;
+  char buf[4096];
+  size_t n;
+  out.clear();
+  while ((n = fread(buf, 1, sizeof(buf), f)) > 0) out.append(buf, n);
+  fclose(f);
+  return true;
+}
+
+// Stand-in for a VGA JPEG at the eyewear's quality setting: base64
+// cost depends only on the length, so random bytes between markers do
+static std::string syntheticJpeg(size_t len) {
+  std::string jpeg(len, '\0');
+  uint32_t x = 2463534242u;
+  for (size_t i = 0; i < len; i++) {
+    x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+    jpeg[i] = (char)x;
+  }
+  jpeg[0] = (char)0xFF; jpeg[1] = (char)0xD8;
+  jpeg[len - 2] = (char)0xFF; jpeg[len - 1] = (char)0xD9;
+  return jpeg;
+}
+
+struct Sample {
+  uint32_t ms;
+  int mm;
+};
+
+static bool loadWalk(const std::string& path, std::vector<Sample>& walk) {
+  FILE* f = fopen(path.c_str(), "r");
+  if (!f) return false;
+  Sample s;
+  unsigned long ms;
+  while (fscanf(f, "%lu,%d", &ms, &s.mm) == 2) {
+    s.ms = (uint32_t)ms;
+    walk.push_back(s);
+  }
+  fclose(f);
+  return !walk.empty();
+}
+
+// ===========================================
+// Baseline
+// ===========================================
+static const char REFERENCE_KERNEL[] = "reference";
+
+static const Result* findResult(const std::vector<Result>& results, const std::string& name) {
+  for (const Result& r : results) if (r.name == name) return &r;
+  return nullptr;
+}
+
+static bool loadBaseline(const char* path, std::vector<Result>& out) {
+  FILE* f = fopen(path, "r");
+  if (!f) return false;
+  char line[256];
+  while (fgets(line, sizeof(line), f)) {
+    if (line[0] == '#' || line[0] == '\n') continue;
+    char name[128];
+    Result r;
+    if (sscanf(line, "%127s %lf %lf %lf", name, &r.nsPerOp, &r.bytesPerOp, &r.allocsPerOp) == 4) {
+      r.name = name;
+      out.push_back(r);
+    }
+  }
+  fclose(f);
+  return true;
+}
+
+static bool saveBaseline(const char* path, const std::vector<Result>& results) {
+  FILE* f = fopen(path, "w");
+  if (!f) return false;
+  fprintf(f, "# name ns/op bytes/op allocs/op\n");
+  for (const Result& r : results) {
+    fprintf(f, "%s %.1f %.1f %.2f\n", r.name.c_str(), r.nsPerOp, r.bytesPerOp, r.allocsPerOp);
+  }
+  fclose(f);
+  return true;
+}
+
+// ===========================================
+// Main
+// ===========================================
+int main(int argc, char** argv) {
+  std::string dataDir = "data";
+  const char* jpegPath = nullptr;
+  const char* baselinePath = nullptr;
+  const char* savePath = nullptr;
+  double tolerance = 25;
+  bool gateTime = false;
+
+  for (int i = 1; i < argc; i++) {
+    bool more = i + 1 < argc;
+    if (!strcmp(argv[i], "--gate-time")) gateTime = true;
+    else if (!strcmp(argv[i], "--data") && more) dataDir = argv[++i];
+    else if (!strcmp(argv[i], "--jpeg") && more) jpegPath = argv[++i];
+    else if (!strcmp(argv[i], "--baseline") && more) baselinePath = argv[++i];
+    else if (!strcmp(argv[i], "--save") && more) savePath = argv[++i];
+    else if (!strcmp(argv[i], "--tolerance") && more) tolerance = atof(argv[++i]);
+  }
+
+  std::string jpeg;
+  if (jpegPath) {
+    if (!readFile(jpegPath, jpeg)) { fprintf(stderr, "cannot read %s\n", jpegPath); return 2; }
+  } else {
+    jpeg = syntheticJpeg(24 * 1024);
+  }
+
+  std::string response, masked;
+  std::vector<Sample> walk;
+  if (!readFile(dataDir + "/vision_response.json", response) ||
+      !readFile(dataDir + "/vision_response_masked.json", masked) ||
+      !loadWalk(dataDir + "/walk.csv", walk)) {
+    fprintf(stderr, "missing inputs in %s (run from firmware/Host-Tools or pass --data)\n",
+            dataDir.c_str());
+    return 2;
+  }
+
+  hal::MemoryStream stream(response);
+  std::string ocrText = extractTextFromResponse(stream);
+
+  std::vector<Result> results;
+  const uint8_t* jpegBytes = (const uint8_t*)jpeg.data();
+
+  // Scales the other kernels' times to this machine: no allocations,
+  // no firmware code, only loads and arithmetic like base64
+  results.push_back(bench(REFERENCE_KERNEL, [&] {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < jpeg.size(); i++) h = (h ^ jpegBytes[i]) * 16777619u;
+    sink += h;
+  }));
+
+  results.push_back(bench("base64Encode", [&] {
+    std::string out;
+    base64Encode(jpegBytes, jpeg.size(), out);
+    sink += out.size();
+  }));
+
+  results.push_back(bench("buildVisionRequest", [&] {
+    sink += buildVisionRequest(jpegBytes, jpeg.size()).size();
+  }));
+
+  results.push_back(bench("extractTextFromResponse", [&] {
+    stream.assign(response);
+    sink += extractTextFromResponse(stream).size();
+  }));
+
+  // Same text through the `fields` mask the firmware now requests
+  hal::MemoryStream maskedStream(masked);
+  results.push_back(bench("extractTextMasked", [&] {
+    maskedStream.assign(masked);
+    sink += extractTextFromResponse(maskedStream).size();
+  }));
+
+  results.push_back(bench("escapeJson", [&] {
+    sink += escapeJson(ocrText).size();
+  }));
+
+  results.push_back(bench("ocrStatusJson", [&] {
+    sink += ocrStatusJson(true, false, ocrText).size();
+  }));
+
+  results.push_back(bench("distanceJson", [&] {
+    sink += distanceJson(1234, PATTERN_WARNING, false).size();
+  }));
+
+  // One eyewear loop() pass (5 ms apart) replaying the walk
+  hal::ScriptedTof tof;
+  NavigationController nav;
+  size_t next = 0;
+  uint32_t now = 0;
+  nav.reset(0);
+  results.push_back(bench("navigationStep", [&] {
+    if (now >= walk[next].ms) {
+      tof.push(walk[next].mm);
+      if (++next == walk.size()) {
+        next = 0;
+        now = 0;
+        nav.reset(0);
+      }
+    }
+    StateFrame f;
+    sink += nav.step(now, &tof, false, 0, f);
+    now += 5;
+  }));
+
+  // Same walk seen by a 3-zone sensor (obstacle drifting across), plus
+  // the per-band frames for four bands, one of each role
+  hal::ScriptedTof zoneTof(3);
+  hal::VirtualClock zoneClock;
+  ZoneMap zoneMap(zoneTof, zoneClock);
+  NavigationController zoneNav;
+  PeerTable peers;
+  peers.openPairing(0);
+  for (uint8_t r = 0; r < ROLE_COUNT; r++) {
+    uint8_t mac[6] = { 0x02, 0, 0, 0, 0, r };
+    bool added;
+    peers.pair(0, mac, r, added);
+  }
+  size_t zoneNext = 0;
+  uint32_t zoneNow = 0;
+  uint8_t sweep = 0;
+  zoneNav.reset(0);
+  results.push_back(bench("peerFanout", [&] {
+    if (zoneNow >= walk[zoneNext].ms) {
+      int mm = walk[zoneNext].mm;
+      if (sweep != (zoneNext / 40) % 3) mm += 600;   // other zones see further
+      zoneTof.push(mm, sweep);
+      sweep = (sweep + 1) % 3;
+      if (++zoneNext == walk.size()) {
+        zoneNext = 0;
+        zoneNow = 0;
+        zoneNav.reset(0);
+      }
+    }
+    StateFrame f;
+    zoneClock.set(zoneNow);
+    if (zoneNav.step(zoneNow, &zoneMap, false, 0, f)) {
+      PeerTable::Send batch[PeerTable::MAX_PEERS];
+      sink += peers.plan(zoneNow, f, zoneMap, zoneNav.zones(), batch);
+    }
+    zoneNow += 5;
+  }));
+
+  // Host cost of the deferred trace call; the firmware prints its
+  // own figure at boot (traceMeasureCostNs)
+  hal::VirtualClock traceClock;
+  traceBegin(traceClock, 'B');
+  uint8_t frame[5 + TRACE_FRAME_MAX_RECORDS * sizeof(TraceRecord)];
+  int32_t traced = 0;
+  results.push_back(bench("traceEmit", [&] {
+    TRACE(TR_EYE_STATUS, traced, PATTERN_WARNING);
+    if ((++traced & 15) == 0) {
+      while (traceDrain(frame, sizeof(frame)) > 0) {}
+    }
+  }));
+
+  // Flight recorder entry, as the safety task and callbacks make them
+  hal::VirtualClock flightClock;
+  FlightRecorder flightRecorder;
+  static uint8_t flightRing[256 * 1024];
+  flightRecorder.begin(flightClock, flightRing, sizeof(flightRing));
+  int32_t recorded = 0;
+  results.push_back(bench("flightRecord", [&] {
+    flightRecorder.record(FR_TOF, recorded % 3, 1000 + (recorded & 1023));
+    if ((++recorded & 3) == 0) flightClock.delay(5);
+  }));
+
+  // Per-tick cost of the always-on loop timing histograms
+  static const uint32_t LOOP_BUCKETS_US[] = { 50, 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000 };
+  Histogram loopUs(LOOP_BUCKETS_US, 10);
+  uint32_t observed = 0;
+  results.push_back(bench("histogramObserve", [&] {
+    loopUs.observe((observed++ * 2654435761u) % 60000);
+    sink += loopUs.count();
+  }));
+
+  printf("jpeg %zu bytes%s, response %zu bytes (%zu masked), walk %zu samples\n\n",
+         jpeg.size(), jpegPath ? "" : " (synthetic)", response.size(), masked.size(), walk.size());
+  printf("%-26s %12s %12s %10s\n", "kernel", "ns/op", "bytes/op", "allocs/op");
+  for (const Result& r : results) {
+    printf("%-26s %12.1f %12.1f %10.2f\n", r.name.c_str(), r.nsPerOp, r.bytesPerOp, r.allocsPerOp);
+  }
+
+  if (savePath) {
+    if (!saveBaseline(savePath, results)) { fprintf(stderr, "cannot write %s\n", savePath); return 2; }
+    printf("\n✓ Baseline saved to %s\n", savePath);
+  }
+
+  if (!baselinePath) return 0;
+
+  std::vector<Result> baseline;
+  if (!loadBaseline(baselinePath, baseline)) {
+    fprintf(stderr, "cannot read %s\n", baselinePath);
+    return 2;
+  }
+
+  // Times relative to the reference kernel, so the baseline holds on
+  // other machines. Still noisy on a shared host: they only fail the
+  // run with --gate-time, allocations always do.
+  const Result* ref = findResult(results, REFERENCE_KERNEL);
+  const Result* baseRef = findResult(baseline, REFERENCE_KERNEL);
+  bool scaled = ref && baseRef && ref->nsPerOp > 0 && baseRef->nsPerOp > 0;
+  double scale = scaled ? ref->nsPerOp / baseRef->nsPerOp : 1.0;
+
+  int regressions = 0;
+  printf("\nvs %s (tolerance %.0f%%, %s)\n", baselinePath, tolerance,
+         !scaled ? "no reference row: time advisory"
+                 : gateTime ? "time relative to reference" : "time relative to reference, advisory");
+  for (const Result& r : results) {
+    if (r.name == REFERENCE_KERNEL) continue;
+    const Result* b = findResult(baseline, r.name);
+    if (!b) {
+      printf("  %-24s new\n", r.name.c_str());
+      continue;
+    }
+    double expected = b->nsPerOp * scale;
+    double dt = expected > 0 ? 100.0 * (r.nsPerOp - expected) / expected : 0;
+    bool slower = scaled && dt > tolerance;
+    bool moreAllocs = r.allocsPerOp > b->allocsPerOp + 0.01 || r.bytesPerOp > b->bytesPerOp + 0.5;
+    bool failed = moreAllocs || (slower && gateTime);
+    if (failed) regressions++;
+    printf("  %-24s %+6.1f%% time  %+8.1f bytes  %+6.2f allocs  %s\n", r.name.c_str(), dt,
+           r.bytesPerOp - b->bytesPerOp, r.allocsPerOp - b->allocsPerOp,
+           failed ? "✗ REGRESSION" : slower ? "~ slower" : "✓");
+  }
+  printf("%s\n", regressions ? "FAIL" : "PASS");
+  return regressions ? 1 : 0;
+}
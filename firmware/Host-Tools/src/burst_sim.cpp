@@ -0,0 +1,339 @@
+/*
+ * ============================================
+ * VisionAssist - OCR Burst Simulation
+ * ============================================
+ *
+ * Compares a one-frame read, retried by tapping again, with
+ * burst reads: two or three frames of the scene in one
+ * Vision request (firmware OCR setting "Frames"). Runs the
+ * firmware's own request building, VisionBackend, batch
+ * parser and consensus against a mock Vision endpoint on a
+ * virtual clock.
+ *
+ * Each scene has a readability; every frame of it reads
+ * correctly with that probability, otherwise it comes back
+ * empty or as a garbled fragment (blur, glare). A read that
+ * is wrong or empty is tapped again after --retap-ms (the
+ * firmware's NO_TEXT_RESUME_DELAY plus a reaction), up to
+ * --taps taps. A request costs a TLS handshake, the upload
+ * and Vision's time, plus a little per extra image.
+ *
+ * Reported per mode: reads right on the first tap and
+ * within --taps, touch-to-right-text time, wrong text
+ * spoken, and upload per tap. The model's figures are
+ * typical; pass measured ones (visionassist_ocr_stage_ms)
+ * for real numbers.
+ *
+ * Usage:
+ *   program [--scenes n] [--seed n] [--readable p]
+ *           [--spread p] [--jpeg-kb n] [--uplink-kbps n]
+ *           [--tls-ms n] [--server-ms n] [--per-image-ms n]
+ *           [--frame-ms n] [--retap-ms n] [--taps n] [--csv]
+ * ============================================
+ */
+
+#include <HalHost.h>
+#include <OcrText.h>
+#include <OcrBackend.h>
+#include <OcrConsensus.h>
+#include <WebJson.h>
+#include <Arena.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+struct Options {
+  int scenes = 2000;
+  uint32_t seed = 1;
+  double readable = 0.6;     // mean chance a frame reads right
+  double spread = 0.35;      // scene readability: readable ± spread
+  int jpegKb = 30;           // SVGA, quality 12
+  int uplinkKbps = 1500;     // TLS upload over the eyewear's WiFi
+  int tlsMs = 450;           // connect + handshake (new connection per request)
+  int serverMs = 650;        // Vision, one image
+  int perImageMs = 120;      // each further image in the same request
+  int frameMs = 60;          // SVGA frame interval, per extra burst frame
+  double encodeMsPerKb = 0.4;
+  int retapMs = 3300;        // NO_TEXT_RESUME_DELAY + reaction
+  int taps = 3;
+  bool csv = false;
+};
+
+static const char* const SCENES[] = {
+  "EXIT",
+  "PLATFORM 2\nTrains to Colombo Fort",
+  "Pharmacy open 8am to 10pm",
+  "CAUTION WET FLOOR",
+  "Room 214 Radiology",
+  "Take one tablet twice daily after meals. Do not exceed the stated dose.",
+  "The library will be closed on Monday for maintenance. Books may be returned through the drop box by the main entrance.",
+};
+
+// Words of at least CONSENSUS_MIN_WORD letters / digits, lower-cased
+static std::vector<std::string> words(const std::string& text) {
+  std::vector<std::string> out;
+  std::string w;
+  for (size_t i = 0; i <= text.size(); i++) {
+    char ch = i < text.size() ? text[i] : ' ';
+    if (isalnum((unsigned char)ch)) {
+      w += (char)tolower((unsigned char)ch);
+      continue;
+    }
+    if (w.size() >= CONSENSUS_MIN_WORD) out.push_back(w);
+    w.clear();
+  }
+  return out;
+}
+
+// Right = at least 80% of the scene's words, in any order
+static bool readRight(const std::string& text, const std::string& truth) {
+  std::vector<std::string> got = words(text), want = words(truth);
+  size_t found = 0;
+  for (const std::string& w : want) {
+    auto it = std::find(got.begin(), got.end(), w);
+    if (it != got.end()) {
+      found++;
+      got.erase(it);
+    }
+  }
+  return !want.empty() && found * 5 >= want.size() * 4;
+}
+
+// A frame's OCR: right, nothing, or a fragment
+static std::string frameText(const std::string& truth, bool good, std::mt19937& rng) {
+  std::uniform_real_distribution<double> u(0, 1);
+  std::string out;
+  if (good) return truth;
+  if (u(rng) < 0.5) return out;
+  // Blur / glare: words dropped, letters confused
+  std::vector<std::string> w = words(truth);
+  for (const std::string& word : w) {
+    if (u(rng) < 0.5) continue;
+    std::string x = word;
+    for (char& ch : x) {
+      if (u(rng) < 0.3) ch = "il1o0e"[rng() % 6];
+    }
+    if (!out.empty()) out += ' ';
+    out += x;
+  }
+  return out;
+}
+
+// ===========================================
+// Mock Vision
+// ===========================================
+// Replies to images:annotate with the texts queued for the request's
+// images, advancing the clock by the modelled request time
+class MockVision : public hal::Http {
+public:
+  MockVision(hal::VirtualClock& clock, const Options& opt, std::mt19937& rng)
+    : clock(clock), opt(opt), rng(rng) {}
+
+  std::vector<std::string> texts;   // per image of the next request
+  size_t uploaded = 0;
+
+  int post(const char* url, const char* contentType, const uint8_t* body, size_t len) override {
+    (void)url;
+    (void)contentType;
+    std::string request((const char*)body, len);
+    size_t images = 0;
+    for (size_t at = request.find("\"image\""); at != std::string::npos; at = request.find("\"image\"", at + 1)) {
+      images++;
+    }
+    uploaded += len;
+
+    std::uniform_real_distribution<double> jitter(0.8, 1.2);
+    double ms = opt.tlsMs + len * 8.0 / opt.uplinkKbps;
+    ms += (opt.serverMs + opt.perImageMs * (images ? images - 1 : 0)) * jitter(rng);
+    clock.advanceUs((uint64_t)(ms * 1000));
+
+    std::string reply = "{\"responses\":[";
+    for (size_t i = 0; i < images; i++) {
+      if (i) reply += ',';
+      const std::string& t = i < texts.size() ? texts[i] : std::string();
+      if (t.empty()) reply += "{}";
+      else reply += "{\"fullTextAnnotation\":{\"text\":\"" + escapeJson(t) + "\"}}";
+    }
+    reply += "]}";
+    stream.assign(reply);
+    return 200;
+  }
+  hal::ByteStream* responseStream() override { return &stream; }
+  void end() override {}
+
+private:
+  hal::VirtualClock& clock;
+  const Options& opt;
+  std::mt19937& rng;
+  hal::MemoryStream stream;
+};
+
+// ===========================================
+// Simulation
+// ===========================================
+struct ModeResult {
+  int frames = 0;
+  int firstRight = 0;
+  int right = 0;
+  int firstWrong = 0;   // wrong text spoken on the first tap
+  int taps = 0;
+  size_t uploaded = 0;
+  std::vector<uint32_t> msToRight;
+};
+
+// One tap: `frames` shots of the scene, one request, the text it speaks
+static std::string tap(int frames, const std::string& truth, double readability, const Options& opt,
+                       hal::VirtualClock& clock, MockVision& vision, VisionBackend& backend, Arena& arena,
+                       std::mt19937& rng) {
+  std::uniform_real_distribution<double> u(0, 1);
+  std::vector<uint8_t> jpeg((size_t)opt.jpegKb * 1024);
+  for (uint8_t& b : jpeg) b = (uint8_t)rng();
+  hal::Frame frame;
+  frame.buf = jpeg.data();
+  frame.len = jpeg.size();
+
+  vision.texts.clear();
+  for (int i = 0; i < frames; i++) vision.texts.push_back(frameText(truth, u(rng) < readability, rng));
+
+  // First shot exposed already; each further one a frame interval on
+  clock.advanceUs((uint64_t)((frames - 1) * opt.frameMs + frames * opt.jpegKb * opt.encodeMsPerKb) * 1000);
+
+  std::string spoken;
+  arena.reset();
+  ArenaAllocator<char> alloc(arena);
+  OcrTiming timing;
+  if (frames == 1) {
+    ArenaString text(alloc);
+    if (backend.recognize(frame, FEATURE_TEXT, text, nullptr, nullptr, timing) == 200) spoken = text.c_str();
+    return spoken;
+  }
+
+  ArenaString json(alloc);
+  beginVisionBatch(json, visionBatchBytes(frame.len, frames, FEATURE_TEXT));
+  for (int i = 0; i < frames; i++) addVisionBatchImage(frame.buf, frame.len, FEATURE_TEXT, json);
+  endVisionBatch(json);
+  std::vector<ArenaString> texts(frames, ArenaString(alloc));
+  if (backend.recognizeBatch(json, (uint8_t)frames, texts.data(), nullptr, timing) != 200) return spoken;
+
+  std::vector<OcrCandidate> candidates;
+  for (const ArenaString& t : texts) candidates.push_back({ t.data(), t.length() });
+  uint8_t pick = pickConsensusText(candidates.data(), (uint8_t)frames);
+  if (pick == frames) {
+    // As the firmware: the longest fragment when nothing is useful
+    pick = 0;
+    for (int i = 1; i < frames; i++) {
+      if (texts[i].length() > texts[pick].length()) pick = (uint8_t)i;
+    }
+  }
+  spoken = texts[pick].c_str();
+  return spoken;
+}
+
+static ModeResult run(int frames, const Options& opt) {
+  ModeResult r;
+  r.frames = frames;
+  std::mt19937 rng(opt.seed);       // same scenes for every mode
+  std::mt19937 frameRng(opt.seed * 7919 + frames);
+  std::uniform_real_distribution<double> u(-1, 1);
+  hal::VirtualClock clock;
+  MockVision vision(clock, opt, frameRng);
+  VisionBackend backend(clock, vision, "simulated-api-key");
+  std::vector<uint8_t> arenaMem(1024 * 1024);
+  Arena arena(arenaMem.data(), arenaMem.size());
+
+  const int sceneCount = sizeof(SCENES) / sizeof(SCENES[0]);
+  for (int s = 0; s < opt.scenes; s++) {
+    std::string truth = SCENES[rng() % sceneCount];
+    double readability = std::min(1.0, std::max(0.0, opt.readable + opt.spread * u(rng)));
+
+    uint32_t touched = clock.millis();
+    for (int t = 0; t < opt.taps; t++) {
+      if (t > 0) clock.advanceUs((uint64_t)opt.retapMs * 1000);
+      std::string spoken = tap(frames, truth, readability, opt, clock, vision, backend, arena, frameRng);
+      r.taps++;
+      bool right = readRight(spoken, truth);
+      if (t == 0 && right) r.firstRight++;
+      if (t == 0 && !right && isUsefulOcrText(spoken)) r.firstWrong++;
+      if (right) {
+        r.right++;
+        r.msToRight.push_back(clock.millis() - touched);
+        break;
+      }
+    }
+  }
+  r.uploaded = vision.uploaded;
+  std::sort(r.msToRight.begin(), r.msToRight.end());
+  return r;
+}
+
+static uint32_t percentile(const std::vector<uint32_t>& sorted, double p) {
+  if (sorted.empty()) return 0;
+  return sorted[std::min(sorted.size() - 1, (size_t)(p * sorted.size()))];
+}
+
+static void usage() {
+  fprintf(stderr, "usage: burst_sim [--scenes n] [--seed n] [--readable p] [--spread p] [--jpeg-kb n]\n"
+                  "                 [--uplink-kbps n] [--tls-ms n] [--server-ms n] [--per-image-ms n]\n"
+                  "                 [--frame-ms n] [--retap-ms n] [--taps n] [--csv]\n");
+}
+
+int main(int argc, char** argv) {
+  Options opt;
+  for (int i = 1; i < argc; i++) {
+    const char* a = argv[i];
+    bool more = i + 1 < argc;
+    if (!strcmp(a, "--scenes") && more) opt.scenes = atoi(argv[++i]);
+    else if (!strcmp(a, "--seed") && more) opt.seed = strtoul(argv[++i], nullptr, 0);
+    else if (!strcmp(a, "--readable") && more) opt.readable = atof(argv[++i]);
+    else if (!strcmp(a, "--spread") && more) opt.spread = atof(argv[++i]);
+    else if (!strcmp(a, "--jpeg-kb") && more) opt.jpegKb = atoi(argv[++i]);
+    else if (!strcmp(a, "--uplink-kbps") && more) opt.uplinkKbps = atoi(argv[++i]);
+    else if (!strcmp(a, "--tls-ms") && more) opt.tlsMs = atoi(argv[++i]);
+    else if (!strcmp(a, "--server-ms") && more) opt.serverMs = atoi(argv[++i]);
+    else if (!strcmp(a, "--per-image-ms") && more) opt.perImageMs = atoi(argv[++i]);
+    else if (!strcmp(a, "--frame-ms") && more) opt.frameMs = atoi(argv[++i]);
+    else if (!strcmp(a, "--retap-ms") && more) opt.retapMs = atoi(argv[++i]);
+    else if (!strcmp(a, "--taps") && more) opt.taps = atoi(argv[++i]);
+    else if (!strcmp(a, "--csv")) opt.csv = true;
+    else {
+      usage();
+      return 2;
+    }
+  }
+  if (opt.scenes < 1 || opt.taps < 1 || opt.jpegKb < 1 || opt.uplinkKbps < 1) {
+    usage();
+    return 2;
+  }
+
+  if (opt.csv) {
+    printf("frames,first_right_pct,right_pct,first_wrong_pct,median_ms,p90_ms,taps_per_scene,kb_per_tap\n");
+  } else {
+    printf("%d scenes, seed %u, frames read right %.0f%% +/- %.0f%%, %d KB JPEG, %d kbit/s up, up to %d taps\n\n",
+           opt.scenes, opt.seed, opt.readable * 100, opt.spread * 100, opt.jpegKb, opt.uplinkKbps, opt.taps);
+    printf("mode              1st tap right  right  1st tap wrong  to right p50 / p90  taps/scene  KB/tap\n");
+  }
+
+  for (int frames = 1; frames <= 3; frames++) {
+    ModeResult r = run(frames, opt);
+    double n = opt.scenes;
+    double kbPerTap = r.uploaded / 1024.0 / r.taps;
+    if (opt.csv) {
+      printf("%d,%.1f,%.1f,%.1f,%u,%u,%.2f,%.0f\n", frames, 100 * r.firstRight / n, 100 * r.right / n,
+             100 * r.firstWrong / n, percentile(r.msToRight, 0.5), percentile(r.msToRight, 0.9), r.taps / n,
+             kbPerTap);
+      continue;
+    }
+    char mode[24];
+    if (frames == 1) snprintf(mode, sizeof(mode), "1 frame + retaps");
+    else snprintf(mode, sizeof(mode), "burst of %d", frames);
+    printf("%-16s  %12.1f%%  %4.1f%%  %12.1f%%  %7u / %5u ms  %10.2f  %6.0f\n", mode, 100 * r.firstRight / n,
+           100 * r.right / n, 100 * r.firstWrong / n, percentile(r.msToRight, 0.5), percentile(r.msToRight, 0.9),
+           r.taps / n, kbPerTap);
+  }
+  return 0;
+}
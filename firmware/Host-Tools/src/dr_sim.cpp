@@ -0,0 +1,169 @@
+/*
+ * ============================================
+ * VisionAssist - Dead Reckoning Simulation
+ * ============================================
+ *
+ * Replays a user walking toward an obstacle through a lossy
+ * ESP-NOW link and compares two handband strategies:
+ *   - legacy: hold the last received pattern, silence after 1500 ms
+ *   - dead reckoning: lib/DeadReckoning as used by the firmware
+ *
+ * Usage:
+ *   program [--speed mm/s] [--loss p] [--burst-ms N] [--burst-every N]
+ *           [--runs N] [--seed N]
+ *
+ * Exit code is non-zero if dead reckoning under-warns more than legacy.
+ * ============================================
+ */
+
+#include <DeadReckoning.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+// Eyewear timing (matches Eyewear-S3 loop())
+static const uint32_t FRAME_INTERVAL = 50;
+static const uint32_t TICK = 10;
+static const uint32_t LEGACY_TIMEOUT = 1500;
+
+struct Options {
+  int speed = 1200;        // walking speed toward the obstacle, mm/s
+  double loss = 0.05;      // independent per-frame loss probability
+  uint32_t burstMs = 600;  // length of each loss burst
+  uint32_t burstEvery = 2500;
+  int runs = 200;
+  unsigned seed = 1;
+};
+
+struct Metrics {
+  uint64_t underWarnMs = 0;    // played zone less severe than the true zone
+  uint64_t silentInDanger = 0; // motor off while truly inside CRITICAL
+  int escalations = 0;
+  int missedEscalations = 0;   // true escalation not reflected within 300 ms
+  uint32_t worstDelay = 0;
+};
+
+static int severity(int zone) {
+  switch (zone) {
+    case 1: return 3;
+    case 2: return 2;
+    case 3: return 1;
+    default: return 0;
+  }
+}
+
+static void runScenario(const Options& opt, std::mt19937& rng, Metrics& legacy, Metrics& dr) {
+  std::uniform_real_distribution<double> uni(0.0, 1.0);
+  std::normal_distribution<double> noise(0.0, 15.0);
+
+  DeadReckoning reckoner;
+  const int startDistance = 3500;
+  const int stopDistance = 300;
+  const uint32_t walkMs = (uint32_t)((startDistance - stopDistance) * 1000 / opt.speed);
+  const uint32_t duration = walkMs + 1500;
+  const uint32_t burstPhase = (uint32_t)(uni(rng) * opt.burstEvery);
+
+  int legacyPattern = 0;
+  uint32_t lastReceived = 0;
+  int lastRxPattern = 0;
+
+  int lastTrueZone = 0;
+  uint32_t escalationAt = 0;
+  bool pendingLegacy = false, pendingDr = false;
+
+  for (uint32_t t = 0; t <= duration; t += TICK) {
+    int truth = t < walkMs ? startDistance - (int)((uint64_t)t * opt.speed / 1000) : stopDistance;
+    int trueZone = reckoner.zoneFor(truth);
+
+    // Eyewear sends a frame every FRAME_INTERVAL
+    if (t % FRAME_INTERVAL == 0) {
+      bool inBurst = ((t + burstPhase) % opt.burstEvery) < opt.burstMs;
+      bool lost = inBurst || uni(rng) < opt.loss;
+      if (!lost) {
+        int measured = truth + (int)noise(rng);
+        int speed = t < walkMs ? opt.speed + (int)noise(rng) : 0;
+        lastRxPattern = reckoner.zoneFor(measured);
+        lastReceived = t;
+        reckoner.onFrame(t, (int16_t)measured, (int16_t)speed);
+      }
+    }
+
+    // Legacy handband
+    legacyPattern = (t - lastReceived > LEGACY_TIMEOUT) ? 0 : lastRxPattern;
+
+    // Dead reckoning handband
+    int drPattern = lastRxPattern;
+    switch (reckoner.mode(t)) {
+      case DeadReckoning::EXTRAPOLATING: drPattern = reckoner.extrapolatedZone(t); break;
+      case DeadReckoning::DEGRADED: drPattern = -1; break;  // distinct, but not a zone
+      case DeadReckoning::LINK_LOST: drPattern = 0; break;
+      default: break;
+    }
+
+    // Escalation tracking
+    if (severity(trueZone) > severity(lastTrueZone)) {
+      legacy.escalations++;
+      dr.escalations++;
+      escalationAt = t;
+      pendingLegacy = pendingDr = true;
+    }
+    lastTrueZone = trueZone;
+
+    auto check = [&](int played, Metrics& m, bool& pending) {
+      bool degraded = played < 0;
+      int sev = degraded ? 0 : severity(played);
+      if (sev < severity(trueZone)) m.underWarnMs += TICK;
+      if (trueZone == 1 && played == 0) m.silentInDanger += TICK;
+      if (pending) {
+        uint32_t delay = t - escalationAt;
+        if (sev >= severity(trueZone) || degraded) {
+          pending = false;
+          if (delay > m.worstDelay) m.worstDelay = delay;
+        } else if (delay > 300) {
+          pending = false;
+          m.missedEscalations++;
+        }
+      }
+    };
+    check(legacyPattern, legacy, pendingLegacy);
+    check(drPattern, dr, pendingDr);
+  }
+}
+
+static void printMetrics(const char* name, const Metrics& m, uint64_t totalMs) {
+  printf("%-16s under-warn %6.2f%%  silent-in-critical %7llu ms  missed escalations %3d/%-4d  worst delay %4u ms\n",
+         name, 100.0 * m.underWarnMs / totalMs, (unsigned long long)m.silentInDanger,
+         m.missedEscalations, m.escalations, m.worstDelay);
+}
+
+int main(int argc, char** argv) {
+  Options opt;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    if (!strcmp(argv[i], "--speed")) opt.speed = atoi(argv[i + 1]);
+    else if (!strcmp(argv[i], "--loss")) opt.loss = atof(argv[i + 1]);
+    else if (!strcmp(argv[i], "--burst-ms")) opt.burstMs = (uint32_t)atoi(argv[i + 1]);
+    else if (!strcmp(argv[i], "--burst-every")) opt.burstEvery = (uint32_t)atoi(argv[i + 1]);
+    else if (!strcmp(argv[i], "--runs")) opt.runs = atoi(argv[i + 1]);
+    else if (!strcmp(argv[i], "--seed")) opt.seed = (unsigned)atoi(argv[i + 1]);
+  }
+  if (opt.speed <= 0 || opt.burstEvery == 0) {
+    fprintf(stderr, "invalid options\n");
+    return 2;
+  }
+
+  std::mt19937 rng(opt.seed);
+  Metrics legacy, dr;
+  for (int r = 0; r < opt.runs; r++) runScenario(opt, rng, legacy, dr);
+
+  uint64_t totalMs = (uint64_t)opt.runs * ((3500 - 300) * 1000 / opt.speed + 1500);
+  printf("speed %d mm/s, loss %.2f, bursts %u ms every %u ms, %d runs\n",
+         opt.speed, opt.loss, opt.burstMs, opt.burstEvery, opt.runs);
+  printMetrics("legacy", legacy, totalMs);
+  printMetrics("dead-reckoning", dr, totalMs);
+
+  bool pass = dr.underWarnMs <= legacy.underWarnMs && dr.missedEscalations <= legacy.missedEscalations;
+  printf("%s\n", pass ? "PASS" : "FAIL");
+  return pass ? 0 : 1;
+}
@@ -0,0 +1,327 @@
+/*
+ * ============================================
+ * VisionAssist - Handband Energy Model
+ * ============================================
+ *
+ * Estimates the handband's average current and battery
+ * life per power mode from a recorded activity timeline.
+ * The state frames of the timeline are played through the
+ * handband's HandbandController and SleepPlanner as the
+ * firmware loop() runs them: frames that arrive while the
+ * band sleeps are lost, so the added alert latency is
+ * measured along with the time spent in each state.
+ *
+ * Usage:
+ *   program [--slot N] [--budget ms] [--battery mAh]
+ *           [--rx-ma mA] [--sleep-ma mA] [--motor-ma mA]
+ *           [--base-ma mA] [--csv] [file]   (default: stdin)
+ *
+ * The timeline is any of:
+ *   - an eyewear /flight dump (frames queued to band --slot,
+ *     reading-mode pauses included)
+ *   - "ms,pattern,intensity,distance,closingSpeed,flags"
+ *     frames (eyewear host runner output)
+ *   - "ms,mm" TOF samples (data/walk.csv), run through the
+ *     eyewear NavigationController first
+ *
+ * Modes: always awake (radio listening), light sleep
+ * between every frame (50 ms budget), and the firmware's
+ * default 150 ms budget; --budget adds one. Currents are
+ * typical ESP32-C3 and coin-motor figures at 3.3 V;
+ * measure the real band and pass them for real numbers.
+ * ============================================
+ */
+
+#include <HalHost.h>
+#include <VisionAssistProtocol.h>
+#include <NavigationController.h>
+#include <StateFrames.h>
+#include <FlightRecorder.h>
+#include <HandbandController.h>
+#include <SleepPlanner.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+static const uint8_t MOTOR_PIN = 4;
+static const uint8_t LED_PIN = 8;
+static const uint32_t HAND_LOOP = 10;        // handband loop() delay
+static const uint32_t HAND_LOOP_PAUSED = 50;
+static const uint32_t EYE_LOOP = 5;          // eyewear safety task period
+static const uint32_t FIRMWARE_BUDGET = 150; // ALERT_LATENCY_BUDGET_MS
+
+struct Options {
+  const char* path = nullptr;
+  int slot = 0;
+  int budget = -1;
+  double batteryMah = 150;
+  double rxMa = 82;       // radio listening, CPU mostly idle
+  double sleepMa = 0.13;  // light sleep, radio off
+  double motorMa = 75;    // at full duty
+  double ledMa = 3;       // status LED, on with the motor
+  double baseMa = 0;      // regulator, power LED
+  double wakeMs = 1.0;    // awake time per light sleep (wake-up, RF restart)
+  bool csv = false;
+};
+
+struct TimedFrame {
+  uint32_t ms;
+  StateFrame frame;
+};
+
+struct Result {
+  uint32_t budget = 0;     // 0 = always awake
+  uint16_t stride = 0;
+  double awakeMs = 0;
+  double asleepMs = 0;
+  double chargeMaMs = 0;
+  uint32_t sleeps = 0;
+  uint32_t heard = 0;
+  uint32_t missed = 0;
+  uint32_t changes = 0;     // pattern / pause changes heard
+  uint32_t maxLatency = 0;
+  double sumLatency = 0;
+};
+
+// ===========================================
+// Timeline input
+// ===========================================
+static void readAll(FILE* in, std::vector<uint8_t>& data) {
+  uint8_t chunk[4096];
+  size_t n;
+  while ((n = fread(chunk, 1, sizeof(chunk), in)) > 0) data.insert(data.end(), chunk, chunk + n);
+}
+
+// Frames queued to `slot`, pause frames while reading mode was on
+static bool framesFromFlight(const std::vector<uint8_t>& data, int slot, std::vector<TimedFrame>& out) {
+  FlightReader reader;
+  if (!reader.open(data.data(), data.size())) return false;
+
+  FlightEvent e;
+  bool paused = false;
+  int distance = DistanceTracker::NO_OBSTACLE;
+  while (reader.next(e)) {
+    if (e.kind == FR_DISTANCE) distance = e.value;
+    if (e.kind == FR_PAUSE) paused = true;
+    if (e.kind == FR_RESUME) paused = false;
+    if (e.kind != FR_SEND || e.arg != slot || !(e.value >> 8)) continue;
+
+    int pattern = e.value & 0xFF;
+    TimedFrame f;
+    f.ms = e.ms;
+    if (pattern == FLIGHT_OTHER_FRAME) {
+      if (!paused) continue;   // pattern table
+      f.frame = makePauseFrame(0);
+    } else {
+      f.frame = makeStateFrame(0, (uint8_t)pattern, distance, 0);
+    }
+    out.push_back(f);
+  }
+  return true;
+}
+
+// "ms,mm" samples through the eyewear's navigation path
+static void framesFromTof(const std::vector<uint32_t>& ms, const std::vector<int>& mm,
+                          std::vector<TimedFrame>& out) {
+  hal::ScriptedTof tof;
+  NavigationController nav;
+  nav.reset(ms[0]);
+  size_t next = 0;
+  for (uint32_t t = ms[0]; t <= ms.back(); t += EYE_LOOP) {
+    while (next < ms.size() && ms[next] <= t) tof.push(mm[next++]);
+    TimedFrame f;
+    if (nav.step(t, &tof, false, 0, f.frame)) {
+      f.ms = t;
+      out.push_back(f);
+    }
+  }
+}
+
+static bool loadTimeline(const Options& opt, std::vector<TimedFrame>& out) {
+  FILE* in = opt.path ? fopen(opt.path, "rb") : stdin;
+  if (!in) return false;
+  std::vector<uint8_t> data;
+  readAll(in, data);
+  if (opt.path) fclose(in);
+
+  if (framesFromFlight(data, opt.slot, out)) return !out.empty();
+
+  data.push_back(0);
+  const char* p = (const char*)data.data();
+  std::vector<uint32_t> tofMs;
+  std::vector<int> tofMm;
+  while (*p) {
+    const char* eol = strchr(p, '\n');
+    unsigned long t;
+    int v[5];
+    int fields = sscanf(p, "%lu,%d,%d,%d,%d,%d", &t, &v[0], &v[1], &v[2], &v[3], &v[4]);
+    if (fields == 6) {
+      TimedFrame f;
+      f.ms = (uint32_t)t;
+      f.frame = StateFrame();
+      f.frame.type = MSG_STATE;
+      f.frame.pattern = (uint8_t)v[0];
+      f.frame.intensity = (uint8_t)v[1];
+      f.frame.distance = (int16_t)v[2];
+      f.frame.closingSpeed = (int16_t)v[3];
+      f.frame.flags = (uint8_t)v[4];
+      out.push_back(f);
+    } else if (fields == 2) {
+      tofMs.push_back((uint32_t)t);
+      tofMm.push_back(v[0]);
+    }
+    if (!eol) break;
+    p = eol + 1;
+  }
+  if (out.empty() && tofMs.size() >= 2) framesFromTof(tofMs, tofMm, out);
+  return !out.empty();
+}
+
+// ===========================================
+// Handband loop() with light sleep
+// ===========================================
+static Result run(const std::vector<TimedFrame>& frames, uint32_t budget, const Options& opt) {
+  hal::RecordingGpio gpio;
+  HandbandController band(gpio, MOTOR_PIN, LED_PIN);
+  SleepPlanner sleeper;
+  SleepPlanner::Config cfg;
+  cfg.budgetMs = budget;
+  sleeper.configure(cfg, band.reckoner().config().frameGapMs);
+
+  Result r;
+  r.budget = budget;
+  r.stride = budget ? sleeper.frameStride() : 0;
+
+  uint32_t start = frames.front().ms;
+  uint32_t end = frames.back().ms + HAND_LOOP;
+  band.holdLink(start);
+  uint32_t sleepUntil = start, nextLoop = start;
+  size_t next = 0;
+  int sent = -1;           // pattern of the last frame sent, -2 = pause
+  uint32_t sentAt = 0;
+  bool waiting = false;
+
+  for (uint32_t t = start; t < end; t++) {
+    bool asleep = t < sleepUntil;
+    while (next < frames.size() && frames[next].ms <= t) {
+      const TimedFrame& f = frames[next++];
+      int pattern = f.frame.flags & FLAG_PAUSE ? -2 : f.frame.pattern;
+      if (pattern != sent) {
+        sent = pattern;
+        sentAt = f.ms;
+        waiting = true;
+      }
+      if (asleep) {
+        r.missed++;
+        continue;
+      }
+      sleeper.onFrame(t);
+      band.onStateFrame(t, f.frame);
+      r.heard++;
+      if (waiting) {
+        uint32_t latency = t - sentAt;
+        if (latency > r.maxLatency) r.maxLatency = latency;
+        r.sumLatency += latency;
+        r.changes++;
+        waiting = false;
+      }
+    }
+
+    if (!asleep && t >= nextLoop) {
+      if (band.update(t) & HandbandController::EV_LINK_LOST) band.holdLink(t);
+      uint32_t ms = budget ? sleeper.sleepMs(t, band.quietMs(t)) : 0;
+      if (ms > 0) {
+        sleepUntil = nextLoop = t + ms;
+        r.sleeps++;
+      } else {
+        nextLoop = t + (band.paused() ? HAND_LOOP_PAUSED : HAND_LOOP);
+      }
+    }
+
+    double ma = opt.baseMa;
+    if (t < sleepUntil) {
+      r.asleepMs++;
+      ma += opt.sleepMa;
+    } else {
+      r.awakeMs++;
+      ma += opt.rxMa;
+    }
+    int duty = gpio.level(MOTOR_PIN);
+    if (duty > 0) ma += opt.motorMa * duty / 255.0 + opt.ledMa;
+    r.chargeMaMs += ma;
+  }
+  r.chargeMaMs += r.sleeps * opt.wakeMs * (opt.rxMa - opt.sleepMa);
+  return r;
+}
+
+// ===========================================
+// Main
+// ===========================================
+static void usage() {
+  fprintf(stderr, "usage: energy_model [--slot N] [--budget ms] [--battery mAh] [--rx-ma mA] [--sleep-ma mA]\n"
+                  "                    [--motor-ma mA] [--base-ma mA] [--csv] [file]\n");
+}
+
+int main(int argc, char** argv) {
+  Options opt;
+  for (int i = 1; i < argc; i++) {
+    const char* a = argv[i];
+    bool more = i + 1 < argc;
+    if (!strcmp(a, "--slot") && more) opt.slot = atoi(argv[++i]);
+    else if (!strcmp(a, "--budget") && more) opt.budget = atoi(argv[++i]);
+    else if (!strcmp(a, "--battery") && more) opt.batteryMah = atof(argv[++i]);
+    else if (!strcmp(a, "--rx-ma") && more) opt.rxMa = atof(argv[++i]);
+    else if (!strcmp(a, "--sleep-ma") && more) opt.sleepMa = atof(argv[++i]);
+    else if (!strcmp(a, "--motor-ma") && more) opt.motorMa = atof(argv[++i]);
+    else if (!strcmp(a, "--base-ma") && more) opt.baseMa = atof(argv[++i]);
+    else if (!strcmp(a, "--csv")) opt.csv = true;
+    else if (a[0] == '-') {
+      usage();
+      return 2;
+    } else {
+      opt.path = a;
+    }
+  }
+
+  std::vector<TimedFrame> frames;
+  if (!loadTimeline(opt, frames)) {
+    fprintf(stderr, "no state frames in %s\n", opt.path ? opt.path : "stdin");
+    return 2;
+  }
+
+  std::vector<uint32_t> budgets = { 0, NavigationController::SEND_INTERVAL, FIRMWARE_BUDGET };
+  if (opt.budget >= 0) budgets.push_back((uint32_t)opt.budget);
+
+  double seconds = (frames.back().ms - frames.front().ms) / 1000.0;
+  if (opt.csv) {
+    printf("budget_ms,stride,asleep_pct,avg_ma,hours,sleeps,missed,max_latency_ms,mean_latency_ms\n");
+  } else {
+    printf("%zu frames over %.1f s, %.0f mAh battery\n\n", frames.size(), seconds, opt.batteryMah);
+    printf("mode              stride  asleep   avg mA   hours   sleeps  missed  latency max/mean\n");
+  }
+
+  for (uint32_t budget : budgets) {
+    Result r = run(frames, budget, opt);
+    double total = r.awakeMs + r.asleepMs;
+    double avg = r.chargeMaMs / total;
+    double hours = opt.batteryMah / avg;
+    double asleep = 100.0 * r.asleepMs / total;
+    double mean = r.changes ? r.sumLatency / r.changes : 0;
+    if (opt.csv) {
+      printf("%u,%u,%.1f,%.2f,%.1f,%u,%u,%u,%.1f\n", budget, r.stride, asleep, avg, hours, r.sleeps, r.missed,
+             r.maxLatency, mean);
+      continue;
+    }
+    char mode[24];
+    if (budget) snprintf(mode, sizeof(mode), "sleep %u ms", budget);
+    else snprintf(mode, sizeof(mode), "awake");
+    char stride[8];
+    if (budget) snprintf(stride, sizeof(stride), "%u", r.stride);
+    else snprintf(stride, sizeof(stride), "-");
+    printf("%-16s  %6s  %5.1f%%  %7.2f  %6.1f  %6u  %6u  %5u / %.1f ms\n", mode, stride, asleep, avg, hours,
+           r.sleeps, r.missed, r.maxLatency, mean);
+  }
+  return 0;
+}
@@ -0,0 +1,428 @@
+/*
+ * ============================================
+ * VisionAssist - OCR Exposure Simulation
+ * ============================================
+ *
+ * Replays a set of generated reading scenes through a
+ * model of the OV2640 and compares two ways of exposing
+ * the OCR shot:
+ *   auto  - the sensor's own AEC: whole-frame average
+ *           brought to mid grey, long exposure first,
+ *           gain capped at 8x
+ *   ocr   - ExposureController on the JPEG DC statistics
+ *           (JpegLuma), exactly as the eyewear runs it,
+ *           warm-started from the previous read
+ *
+ * Scene kinds: indoor page, sign against a bright sky,
+ * page under a lamp, light text on a dark panel, outdoor
+ * sign. Every frame of the ocr path is encoded as a 4:2:2
+ * baseline JPEG and measured from that, so the DC parser
+ * is exercised end to end.
+ *
+ * "Readable" stands in for OCR success: in every text
+ * line, ink and background medians differ by at least
+ * MIN_CONTRAST levels and by 4x the background noise.
+ * Convergence time counts the frames measured plus the
+ * frames dropped after each exposure change.
+ *
+ * Usage:
+ *   program [--scenes n] [--seed n] [--frame-ms n]
+ *           [--settle n] [--jpeg file ...]
+ *
+ * --jpeg only parses the given captures and prints their
+ * block statistics (a check of JpegLuma on real frames).
+ * Exits non-zero if a JPEG cannot be parsed.
+ * ============================================
+ */
+
+#include <ExposureController.h>
+#include <JpegLuma.h>
+
+#include "JpegEncoder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+static const int WIDTH = 800;    // FRAMESIZE_SVGA, as initCamera() sets it
+static const int HEIGHT = 600;
+static const int MIN_CONTRAST = 40;
+
+// ===========================================
+// Scenes
+// ===========================================
+enum Kind { KIND_INDOOR, KIND_BACKLIT, KIND_GLARE, KIND_DARK_SIGN, KIND_OUTDOOR, KINDS };
+static const char* const KIND_NAMES[KINDS] = { "indoor", "backlit", "glare", "dark_sign", "outdoor" };
+
+enum { PX_OTHER = 0, PX_BACKGROUND = 1, PX_INK = 2 };
+
+struct Scene {
+  Kind kind;
+  std::vector<float> radiance;     // linear, 1.0 is mid grey at 800 lines
+  std::vector<uint8_t> mask;       // PX_* inside text lines
+  std::vector<int> lineTop;        // text line boxes
+  int lineX0 = 0, lineX1 = 0, lineH = 0;
+};
+
+static void fillRect(Scene& s, int x0, int y0, int x1, int y1, float r) {
+  for (int y = std::max(0, y0); y < std::min(HEIGHT, y1); y++) {
+    for (int x = std::max(0, x0); x < std::min(WIDTH, x1); x++) s.radiance[y * WIDTH + x] = r;
+  }
+}
+
+// Glyph-like strokes (3 px, 24 px line height) on a board of radiance `board`
+static void drawText(Scene& s, std::mt19937& rng, int x0, int y0, int x1, int y1, float board, float ink) {
+  const int lineH = 24, gap = 14, glyphW = 14, stroke = 3;
+  std::uniform_int_distribution<int> bits(0, 15);
+  s.lineX0 = x0 + 16;
+  s.lineX1 = x1 - 16;
+  s.lineH = lineH;
+  for (int top = y0 + 16; top + lineH <= y1 - 16; top += lineH + gap) {
+    s.lineTop.push_back(top);
+    for (int y = top; y < top + lineH; y++) {
+      for (int x = s.lineX0; x < s.lineX1; x++) s.mask[y * WIDTH + x] = PX_BACKGROUND;
+    }
+    for (int gx = s.lineX0; gx + glyphW <= s.lineX1; gx += glyphW + 6) {
+      int shape = bits(rng);
+      auto bar = [&](int bx0, int by0, int bx1, int by1) {
+        for (int y = by0; y < by1; y++) {
+          for (int x = bx0; x < bx1; x++) {
+            s.radiance[y * WIDTH + x] = ink;
+            s.mask[y * WIDTH + x] = PX_INK;
+          }
+        }
+      };
+      bar(gx, top, gx + stroke, top + lineH);                                   // stem
+      if (shape & 1) bar(gx, top, gx + glyphW, top + stroke);                     // top
+      if (shape & 2) bar(gx, top + lineH / 2 - 1, gx + glyphW, top + lineH / 2 + 2);
+      if (shape & 4) bar(gx, top + lineH - stroke, gx + glyphW, top + lineH);     // bottom
+      if (shape & 8) bar(gx + glyphW - stroke, top, gx + glyphW, top + lineH);    // right stem
+    }
+  }
+  (void)board;
+}
+
+static Scene makeScene(Kind kind, std::mt19937& rng) {
+  std::uniform_real_distribution<float> u(0.0f, 1.0f);
+  auto range = [&](float lo, float hi) { return lo + (hi - lo) * u(rng); };
+
+  Scene s;
+  s.kind = kind;
+  s.radiance.assign(WIDTH * HEIGHT, 0.0f);
+  s.mask.assign(WIDTH * HEIGHT, PX_OTHER);
+
+  // Board (page / sign) around the centre, where the wearer looks
+  int bw = (int)(WIDTH * range(0.45f, 0.6f)), bh = (int)(HEIGHT * range(0.3f, 0.45f));
+  int bx = (WIDTH - bw) / 2 + (int)range(-40, 40), by = (HEIGHT - bh) / 2 + (int)range(-30, 30);
+  float surround, board, ink;
+
+  switch (kind) {
+    case KIND_INDOOR:
+      surround = range(0.05f, 0.15f);
+      board = range(0.25f, 0.5f);
+      ink = board * 0.1f;
+      fillRect(s, 0, 0, WIDTH, HEIGHT, surround);
+      fillRect(s, 0, 0, WIDTH / 4, HEIGHT / 3, range(2.0f, 4.0f));   // window or lamp in a corner
+      break;
+    case KIND_BACKLIT:
+      surround = range(4.0f, 8.0f);
+      board = range(0.3f, 0.8f);
+      ink = board * 0.1f;
+      fillRect(s, 0, 0, WIDTH, HEIGHT, surround);
+      fillRect(s, 0, HEIGHT * 3 / 4, WIDTH, HEIGHT, surround * 0.2f);   // ground
+      fillRect(s, bx + bw / 2 - 6, by + bh, bx + bw / 2 + 6, HEIGHT, board * 0.5f);   // post
+      break;
+    case KIND_GLARE:
+      surround = range(0.1f, 0.3f);
+      board = range(2.5f, 5.0f);
+      ink = board * 0.12f;
+      fillRect(s, 0, 0, WIDTH, HEIGHT, surround);
+      bw = WIDTH * 7 / 10;
+      bh = HEIGHT * 7 / 10;
+      bx = (WIDTH - bw) / 2;
+      by = (HEIGHT - bh) / 2;
+      break;
+    case KIND_DARK_SIGN:
+      surround = range(0.02f, 0.06f);
+      board = 0.05f;
+      ink = range(1.0f, 3.0f);   // lit letters
+      fillRect(s, 0, 0, WIDTH, HEIGHT, surround);
+      break;
+    default:
+      surround = range(1.5f, 3.0f);
+      board = range(1.0f, 2.0f);
+      ink = board * 0.1f;
+      fillRect(s, 0, 0, WIDTH, HEIGHT, surround);
+      break;
+  }
+  fillRect(s, bx, by, bx + bw, by + bh, board);
+  drawText(s, rng, bx, by, bx + bw, by + bh, board, ink);
+  return s;
+}
+
+// ===========================================
+// Sensor Model
+// ===========================================
+// Linear signal rad * total / SCALE, shot noise (fewer photons at high
+// gain), read noise amplified by gain, then gamma 2.2 and 8 bits.
+// Beyond 800 lines head movement smears the image sideways.
+static const float SCALE = 3000.0f;
+
+static void expose(const Scene& s, const Exposure& e, std::mt19937& rng, std::vector<uint8_t>& out) {
+  std::normal_distribution<float> noise(0.0f, 1.0f);
+  float total = (float)ExposureController::total(e);
+  float gain = e.gain + 1.0f;
+  int blur = e.lines > 800 ? 1 + (e.lines - 800) / 100 : 1;
+
+  out.resize(WIDTH * HEIGHT);
+  std::vector<float> row(WIDTH);
+  for (int y = 0; y < HEIGHT; y++) {
+    const float* r = &s.radiance[y * WIDTH];
+    for (int x = 0; x < WIDTH; x++) {
+      float sum = 0;
+      int n = 0;
+      for (int k = 0; k < blur && x + k < WIDTH; k++, n++) sum += r[x + k];
+      row[x] = sum / n;
+    }
+    for (int x = 0; x < WIDTH; x++) {
+      float sig = row[x] * total / SCALE;
+      float sigma = sqrtf(std::max(sig, 0.0f) * gain / 4000.0f) + 0.0015f * gain;
+      sig += sigma * noise(rng);
+      sig = std::min(1.0f, std::max(0.0f, sig));
+      out[y * WIDTH + x] = (uint8_t)(255.0f * powf(sig, 1.0f / 2.2f) + 0.5f);
+    }
+  }
+}
+
+// Frame average the AEC sees (sampled, noise free)
+static float meanLevel(const Scene& s, float total) {
+  double sum = 0;
+  int n = 0;
+  for (size_t i = 0; i < s.radiance.size(); i += 7, n++) {
+    float sig = std::min(1.0f, s.radiance[i] * total / SCALE);
+    sum += 255.0f * powf(sig, 1.0f / 2.2f);
+  }
+  return (float)(sum / n);
+}
+
+// OV2640 AEC: whole-frame average to ~110, up to 1200 lines then gain
+// (8x ceiling). Runs continuously, so it has settled by the OCR shot.
+static Exposure autoExposure(const Scene& s, std::mt19937& rng, std::vector<uint8_t>& img) {
+  auto split = [](float t) {
+    Exposure e;
+    if (t <= 1200) {
+      e.lines = (uint16_t)std::max(4.0f, t);
+      e.gain = 0;
+    } else {
+      e.gain = (uint8_t)std::min(7.0f, ceilf(t / 1200) - 1);
+      e.lines = (uint16_t)std::min(1200.0f, t / (e.gain + 1));
+    }
+    return e;
+  };
+  float lo = 4, hi = 1200 * 8;
+  for (int i = 0; i < 18; i++) {
+    float mid = sqrtf(lo * hi);
+    if (meanLevel(s, (float)ExposureController::total(split(mid))) < 110) lo = mid;
+    else hi = mid;
+  }
+  Exposure e = split(sqrtf(lo * hi));
+  expose(s, e, rng, img);
+  return e;
+}
+
+// ===========================================
+// Readability (stand-in for OCR success)
+// ===========================================
+static bool readable(const Scene& s, const std::vector<uint8_t>& img) {
+  if (s.lineTop.empty()) return false;
+  std::vector<uint8_t> ink, bg;
+  for (int top : s.lineTop) {
+    ink.clear();
+    bg.clear();
+    for (int y = top; y < top + s.lineH; y++) {
+      for (int x = s.lineX0; x < s.lineX1; x++) {
+        uint8_t m = s.mask[y * WIDTH + x];
+        if (m == PX_INK) ink.push_back(img[y * WIDTH + x]);
+        else if (m == PX_BACKGROUND) bg.push_back(img[y * WIDTH + x]);
+      }
+    }
+    if (ink.empty() || bg.empty()) return false;
+    std::nth_element(ink.begin(), ink.begin() + ink.size() / 2, ink.end());
+    std::nth_element(bg.begin(), bg.begin() + bg.size() / 2, bg.end());
+    int contrast = abs((int)ink[ink.size() / 2] - (int)bg[bg.size() / 2]);
+
+    double mean = 0, var = 0;
+    for (uint8_t v : bg) mean += v;
+    mean /= bg.size();
+    for (uint8_t v : bg) var += (v - mean) * (v - mean);
+    double sigma = sqrt(var / bg.size());
+    if (contrast < MIN_CONTRAST || contrast < 4 * sigma) return false;
+  }
+  return true;
+}
+
+// ===========================================
+// Real Captures (--jpeg)
+// ===========================================
+static bool readFile(const char* path, std::string& out) {
+  FILE* f = fopen(path, "rb");
+  if (!f) return false;
+  char buf[4096];
+  size_t n;
+  out.clear();
+  while ((n = fread(buf, 1, sizeof(buf), f)) > 0) out.append(buf, n);
+  fclose(f);
+  return true;
+}
+
+static int checkCaptures(const std::vector<const char*>& paths) {
+  int failed = 0;
+  ExposureController ctl;
+  LumaStats stats;
+  printf("%-32s %7s %6s %5s %5s %5s %7s  %s\n", "file", "blocks", "mean", "p50", "p97", "clip", "step", "result");
+  for (const char* path : paths) {
+    std::string jpeg;
+    if (!readFile(path, jpeg) || !jpegLumaStats((const uint8_t*)jpeg.data(), jpeg.size(), stats)) {
+      printf("%-32s unreadable or unsupported JPEG\n", path);
+      failed++;
+      continue;
+    }
+    ctl.begin();
+    uint32_t before = ExposureController::total(ctl.exposure());
+    ExposureController::Result r = ctl.update(stats);
+    uint32_t after = ExposureController::total(ctl.exposure());
+    printf("%-32s %7u %6u %5u %5u %4u%% %6.2fx  %s\n", path, stats.count, stats.mean(), stats.percentile(50),
+           stats.percentile(ExposureController::TARGET_PCT), stats.permilleAbove(ExposureController::CLIPPED) / 10,
+           (double)after / before, exposureResultName(r));
+  }
+  return failed ? 1 : 0;
+}
+
+// ===========================================
+// Main
+// ===========================================
+struct KindStats {
+  int scenes = 0;
+  int autoOk = 0;
+  int ocrOk = 0;
+  int steps = 0;
+  int maxSteps = 0;
+  uint32_t ms = 0;
+  uint32_t maxMs = 0;
+  int results[ExposureController::EXPOSURE_RESULTS] = {};
+};
+
+int main(int argc, char** argv) {
+  int scenes = 50;
+  uint32_t seed = 1;
+  uint32_t frameMs = 40;
+  int settle = 2;
+  std::vector<const char*> captures;
+
+  for (int i = 1; i < argc; i++) {
+    if (i + 1 >= argc) break;
+    if (!strcmp(argv[i], "--scenes")) scenes = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "--seed")) seed = strtoul(argv[++i], nullptr, 0);
+    else if (!strcmp(argv[i], "--frame-ms")) frameMs = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "--settle")) settle = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "--jpeg")) {
+      while (i + 1 < argc && strncmp(argv[i + 1], "--", 2) != 0) captures.push_back(argv[++i]);
+    }
+  }
+  if (!captures.empty()) return checkCaptures(captures);
+
+  std::mt19937 rng(seed);
+  JpegEncoder encoder;
+  ExposureController ctl;
+  LumaStats stats;
+  std::vector<uint8_t> img;
+  std::string jpeg;
+  KindStats kinds[KINDS];
+  int worstDcError = 0;
+
+  for (int n = 0; n < scenes; n++) {
+    Kind kind = (Kind)(rng() % KINDS);
+    Scene scene = makeScene(kind, rng);
+    KindStats& k = kinds[kind];
+    k.scenes++;
+
+    autoExposure(scene, rng, img);
+    k.autoOk += readable(scene, img);
+
+    ctl.begin();
+    ExposureController::Result r;
+    for (;;) {
+      expose(scene, ctl.exposure(), rng, img);
+      encoder.encode(img, WIDTH, HEIGHT, jpeg);
+      if (!jpegLumaStats((const uint8_t*)jpeg.data(), jpeg.size(), stats)) {
+        fprintf(stderr, "scene %d: JpegLuma rejected the encoded frame\n", n);
+        return 1;
+      }
+      // Same percentile straight from the pixels, as a check on the parser
+      if (n == 0 && ctl.steps() == 0) {
+        LumaStats truth;
+        truth.clear();
+        int mx = WIDTH * 20 / 100, my = HEIGHT * 20 / 100;
+        for (int by = 0; by < HEIGHT / 8; by++) {
+          for (int bx = 0; bx < WIDTH / 8; bx++) {
+            int cx = bx * 8 + 4, cy = by * 8 + 4;
+            if (cx < mx || cx >= WIDTH - mx || cy < my || cy >= HEIGHT - my) continue;
+            int sum = 0;
+            for (int y = 0; y < 8; y++) {
+              for (int x = 0; x < 8; x++) sum += img[(by * 8 + y) * WIDTH + bx * 8 + x];
+            }
+            truth.add((uint8_t)((sum + 32) / 64));
+          }
+        }
+        for (uint8_t pct : { 5, 50, 97 }) {
+          worstDcError = std::max(worstDcError, abs((int)truth.percentile(pct) - (int)stats.percentile(pct)));
+        }
+        if (truth.count != stats.count) worstDcError = 255;
+      }
+      r = ctl.update(stats);
+      if (r != ExposureController::EXPOSURE_ADJUST) break;
+    }
+    k.ocrOk += readable(scene, img);
+    k.results[r]++;
+    k.steps += ctl.steps();
+    k.maxSteps = std::max(k.maxSteps, (int)ctl.steps());
+    // Every frame measured, plus the frames dropped after each change
+    uint32_t ms = (ctl.steps() + (uint32_t)settle * ctl.steps()) * frameMs;
+    k.ms += ms;
+    k.maxMs = std::max(k.maxMs, ms);
+  }
+
+  printf("%d scenes, seed %u, %u ms/frame, %d settle frames; JPEG DC vs pixel percentiles: %d levels apart\n\n",
+         scenes, seed, frameMs, settle, worstDcError);
+  printf("%-10s %6s %9s %9s %11s %13s %10s %6s %10s\n", "scene", "count", "auto ok", "ocr ok", "frames avg",
+         "ms avg / max", "converged", "limit", "unsettled");
+  KindStats all;
+  for (int i = 0; i < KINDS; i++) {
+    const KindStats& k = kinds[i];
+    if (!k.scenes) continue;
+    printf("%-10s %6d %8.0f%% %8.0f%% %6.1f / %d %6u / %4u %10d %6d %10d\n", KIND_NAMES[i], k.scenes,
+           100.0 * k.autoOk / k.scenes, 100.0 * k.ocrOk / k.scenes, (double)k.steps / k.scenes, k.maxSteps,
+           k.ms / k.scenes, k.maxMs, k.results[ExposureController::EXPOSURE_CONVERGED],
+           k.results[ExposureController::EXPOSURE_LIMIT], k.results[ExposureController::EXPOSURE_UNSETTLED]);
+    all.scenes += k.scenes;
+    all.autoOk += k.autoOk;
+    all.ocrOk += k.ocrOk;
+    all.steps += k.steps;
+    all.ms += k.ms;
+    all.maxMs = std::max(all.maxMs, k.maxMs);
+    all.maxSteps = std::max(all.maxSteps, k.maxSteps);
+    for (int r = 0; r < ExposureController::EXPOSURE_RESULTS; r++) all.results[r] += k.results[r];
+  }
+  if (all.scenes) {
+    printf("%-10s %6d %8.0f%% %8.0f%% %6.1f / %d %6u / %4u %10d %6d %10d\n", "all", all.scenes,
+           100.0 * all.autoOk / all.scenes, 100.0 * all.ocrOk / all.scenes, (double)all.steps / all.scenes,
+           all.maxSteps, all.ms / all.scenes, all.maxMs, all.results[ExposureController::EXPOSURE_CONVERGED],
+           all.results[ExposureController::EXPOSURE_LIMIT], all.results[ExposureController::EXPOSURE_UNSETTLED]);
+  }
+  return worstDcError > 4 ? 1 : 0;
+}
@@ -0,0 +1,165 @@
+/*
+ * ============================================
+ * VisionAssist - Flight Recorder Decoder
+ * ============================================
+ *
+ * Reads a dump from the eyewear's /flight endpoint and
+ * prints what the alert path did: raw TOF samples per
+ * zone, smoothed distance, zone changes, frames queued
+ * per band with their delivery results, and reading-mode
+ * pauses. A per-band summary goes to stderr.
+ *
+ * Usage:
+ *   program [--csv | --tof] [--from ms] [--to ms] [file]   (default: stdin)
+ *
+ *   curl -s http://<ip>/flight > flight.bin
+ *   program flight.bin
+ *   program --tof flight.bin | system_sim --trace /dev/stdin
+ *
+ * Times are device millis(); the last column of the log
+ * is seconds before the dump was taken.
+ * --csv prints "ms,kind,arg,value" for timelines.
+ * --tof prints "ms,mm" (nearest zone) - the input of the
+ * eyewear host runner and system_sim --trace.
+ * ============================================
+ */
+
+#include <FlightRecorder.h>
+#include <VisionAssistProtocol.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+static const char* const PATTERN_NAMES[PATTERN_COUNT] = { "CLEAR", "CRITICAL", "WARNING", "CAUTION", "DEGRADED" };
+// main.cpp ResumeReason
+static const char* const RESUME_NAMES[] = { "tts_done", "auto", "timeout", "capture_failed", "abandoned" };
+
+static const char* patternName(int pattern) {
+  if (pattern == FLIGHT_OTHER_FRAME) return "pause/table";
+  return pattern >= 0 && pattern < PATTERN_COUNT ? PATTERN_NAMES[pattern] : "?";
+}
+
+struct BandStats {
+  uint32_t sent = 0;
+  uint32_t notQueued = 0;
+  uint32_t delivered = 0;
+  uint32_t failed = 0;
+  uint32_t lastAck = 0;
+};
+
+int main(int argc, char** argv) {
+  const char* path = nullptr;
+  bool csv = false, tofOnly = false;
+  uint32_t from = 0, to = 0xFFFFFFFF;
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--csv")) csv = true;
+    else if (!strcmp(argv[i], "--tof")) tofOnly = true;
+    else if (!strcmp(argv[i], "--from") && i + 1 < argc) from = strtoul(argv[++i], nullptr, 0);
+    else if (!strcmp(argv[i], "--to") && i + 1 < argc) to = strtoul(argv[++i], nullptr, 0);
+    else path = argv[i];
+  }
+
+  FILE* in = path ? fopen(path, "rb") : stdin;
+  if (!in) {
+    fprintf(stderr, "cannot open %s\n", path);
+    return 2;
+  }
+  std::vector<uint8_t> data;
+  uint8_t chunk[4096];
+  size_t n;
+  while ((n = fread(chunk, 1, sizeof(chunk), in)) > 0) data.insert(data.end(), chunk, chunk + n);
+  if (path) fclose(in);
+
+  FlightReader reader;
+  if (!reader.open(data.data(), data.size())) {
+    fprintf(stderr, "not a flight recorder dump (version %d expected)\n", FLIGHT_VERSION);
+    return 2;
+  }
+  const FlightHeader& h = reader.header();
+
+  if (tofOnly) {
+    uint32_t ms;
+    int mm;
+    while (reader.nextTof(ms, mm)) {
+      if (ms >= from && ms <= to) printf("%u,%d\n", ms, mm);
+    }
+    return 0;
+  }
+
+  if (csv) printf("ms,kind,arg,value\n");
+  FlightEvent e;
+  BandStats bands[16];
+  uint32_t events = 0, tofSamples = 0, tofErrors = 0, pauses = 0;
+  uint32_t first = 0, last = 0;
+  while (reader.next(e)) {
+    if (e.ms < from || e.ms > to) continue;
+    if (events++ == 0) first = e.ms;
+    last = e.ms;
+
+    if (csv) {
+      printf("%u,%s,%u,%d\n", e.ms, flightKindName(e.kind), e.arg, e.value);
+    } else {
+      printf("%10u  %-8s  ", e.ms, flightKindName(e.kind));
+      switch (e.kind) {
+        case FR_TOF:
+          printf("zone %u  %d mm%s", e.arg, e.value, e.value <= 0 ? " (error)" : "");
+          break;
+        case FR_DISTANCE:
+          printf("%d mm", e.value);
+          break;
+        case FR_ZONE:
+          printf("%s at %d mm", patternName(e.arg), e.value);
+          break;
+        case FR_SEND:
+          printf("band %u  %s  %s", e.arg, patternName(e.value & 0xFF), e.value >> 8 ? "queued" : "NOT QUEUED");
+          break;
+        case FR_ACK:
+          printf("band %u  %s", e.arg, e.value ? "delivered" : "FAILED");
+          break;
+        case FR_RESUME:
+          printf("%s", e.arg < sizeof(RESUME_NAMES) / sizeof(RESUME_NAMES[0]) ? RESUME_NAMES[e.arg] : "?");
+          break;
+        default:
+          break;
+      }
+      printf("  (-%.1f s)\n", (int32_t)(h.dumpMs - e.ms) / 1000.0);
+    }
+
+    BandStats& b = bands[e.arg & 0x0F];
+    switch (e.kind) {
+      case FR_TOF:
+        tofSamples++;
+        if (e.value <= 0) tofErrors++;
+        break;
+      case FR_SEND:
+        b.sent++;
+        if (!(e.value >> 8)) b.notQueued++;
+        break;
+      case FR_ACK:
+        if (e.value) b.delivered++;
+        else b.failed++;
+        b.lastAck = e.ms;
+        break;
+      case FR_PAUSE:
+        pauses++;
+        break;
+      default:
+        break;
+    }
+  }
+
+  fprintf(stderr, "%u events over %.1f s (dump at %u ms, %u records overwritten before), %u TOF zones\n", events,
+          (last - first) / 1000.0, h.dumpMs, h.overwritten, h.tofZones);
+  fprintf(stderr, "TOF: %u samples, %u errors; %u reading pauses\n", tofSamples, tofErrors, pauses);
+  for (int slot = 0; slot < 16; slot++) {
+    const BandStats& b = bands[slot];
+    if (!b.sent && !b.delivered && !b.failed) continue;
+    fprintf(stderr, "band %d: %u frames, %u not queued, %u delivered, %u failed", slot, b.sent, b.notQueued,
+            b.delivered, b.failed);
+    if (b.delivered + b.failed) fprintf(stderr, ", last ack %.1f s before the dump", (h.dumpMs - b.lastAck) / 1000.0);
+    fprintf(stderr, "\n");
+  }
+  return 0;
+}
@@ -0,0 +1,399 @@
+/*
+ * ============================================
+ * VisionAssist - Reference OCR Gateway
+ * ============================================
+ *
+ * Runs on a PC on the eyewear's network and stands in for
+ * the gateway behind the "gateway" OCR backend
+ * (EyewearCore/OcrBackend.h):
+ *   POST /ocr?feature=text|document   body: the raw JPEG
+ *   -> 200 text/plain; charset=utf-8, Content-Length set
+ * over HTTP/1.1 with keep-alive. GET /health answers "ok".
+ *
+ * The text comes from:
+ *   (default)     a canned sign, for tests
+ *   --text file   that file, for every request
+ *   --cmd "..."   a command run per request with the JPEG on
+ *                 stdin and OCR_FEATURE=text|document set;
+ *                 its stdout is the text. Local OCR, e.g.
+ *                 --cmd "tesseract stdin stdout", or a script
+ *                 that calls a cloud OCR API.
+ * --delay ms adds simulated OCR time, --save dir keeps the
+ * received frames.
+ *
+ * --probe drives a running gateway through the firmware's
+ * own GatewayBackend, once over one kept-alive connection
+ * and once with a new connection per request, and prints
+ * the latency spread next to the upload a direct Vision
+ * request would need for the same JPEG.
+ *
+ * Usage:
+ *   program [--port n] [--text file | --cmd command]
+ *           [--delay ms] [--save dir]
+ *   program --probe http://host:port/ocr [--jpeg file]
+ *           [--jpeg-kb n] [--runs n]
+ *
+ * POSIX sockets (Linux / macOS).
+ * ============================================
+ */
+
+#include <HalPosix.h>
+#include <OcrText.h>
+#include <OcrBackend.h>
+#include <Arena.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+static const size_t MAX_BODY = 4 * 1024 * 1024;
+static const int IDLE_TIMEOUT_S = 60;   // kept-alive connection with no request
+
+static const char CANNED_TEXT[] = "EXIT\nPush bar to open.\nAlarm will sound.";
+
+// ===========================================
+// Helpers
+// ===========================================
+static bool readFile(const std::string& path, std::string& out) {
+  FILE* f = fopen(path.c_str(), "rb");
+  if (!f) return false;
+  char buf[4096];
+  size_t n;
+  out.clear();
+  while ((n = fread(buf, 1, sizeof(buf), f)) > 0) out.append(buf, n);
+  fclose(f);
+  return true;
+}
+
+static double msSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// ===========================================
+// Gateway (server)
+// ===========================================
+struct GatewayOptions {
+  int port = 8088;
+  std::string text = CANNED_TEXT;
+  std::string cmd;
+  int delayMs = 0;
+  std::string saveDir;
+};
+
+static GatewayOptions gw;
+static std::mutex logMutex;
+static std::atomic<uint32_t> requestCount(0);
+static std::atomic<uint32_t> connectionCount(0);
+
+struct HttpRequest {
+  std::string method;
+  std::string path;
+  std::string query;
+  std::string body;
+  bool keepAlive = true;
+};
+
+// false: connection closed or unusable
+static bool readRequest(hal::SocketReader& in, HttpRequest& req, int& error) {
+  error = 0;
+  std::string line;
+  if (!in.readLine(line)) return false;
+  while (line.empty()) {   // stray CRLF between requests
+    if (!in.readLine(line)) return false;
+  }
+
+  char method[16], target[1024], version[16];
+  if (sscanf(line.c_str(), "%15s %1023s %15s", method, target, version) != 3) {
+    error = 400;
+    return false;
+  }
+  req.method = method;
+  req.path = target;
+  req.query.clear();
+  size_t q = req.path.find('?');
+  if (q != std::string::npos) {
+    req.query = req.path.substr(q + 1);
+    req.path.resize(q);
+  }
+  req.keepAlive = strcmp(version, "HTTP/1.0") != 0;
+
+  size_t length = 0;
+  for (;;) {
+    if (!in.readLine(line)) return false;
+    if (line.empty()) break;
+    if (hal::iequalsPrefix(line, "content-length:")) {
+      length = strtoul(line.c_str() + 15, nullptr, 10);
+    } else if (hal::iequalsPrefix(line, "connection:")) {
+      std::string value = line.substr(11);
+      for (char& ch : value) ch = (char)tolower((uint8_t)ch);
+      if (value.find("close") != std::string::npos) req.keepAlive = false;
+      else if (value.find("keep-alive") != std::string::npos) req.keepAlive = true;
+    }
+  }
+  if (length > MAX_BODY) {
+    error = 413;
+    return false;
+  }
+  return in.readExact(req.body, length);
+}
+
+static bool sendResponse(int fd, int code, const char* reason, const std::string& body, bool keepAlive) {
+  char head[256];
+  int n = snprintf(head, sizeof(head),
+                   "HTTP/1.1 %d %s\r\nContent-Type: text/plain; charset=utf-8\r\n"
+                   "Content-Length: %zu\r\nConnection: %s\r\n\r\n",
+                   code, reason, body.size(), keepAlive ? "keep-alive" : "close");
+  return hal::sendAll(fd, head, (size_t)n) && hal::sendAll(fd, body.data(), body.size());
+}
+
+// JPEG on stdin via a temp file; false if the command fails
+static bool runCommand(const std::string& jpeg, const char* feature, std::string& out) {
+  char path[] = "/tmp/ocr_gateway_XXXXXX";
+  int fd = mkstemp(path);
+  if (fd < 0) return false;
+  bool written = write(fd, jpeg.data(), jpeg.size()) == (ssize_t)jpeg.size();
+  close(fd);
+
+  bool ok = false;
+  if (written) {
+    std::string command = "export OCR_FEATURE=";
+    command += feature;
+    command += "; (" + gw.cmd + ") < " + path;
+    FILE* p = popen(command.c_str(), "r");
+    if (p) {
+      char buf[4096];
+      size_t n;
+      out.clear();
+      while ((n = fread(buf, 1, sizeof(buf), p)) > 0) out.append(buf, n);
+      ok = pclose(p) == 0;
+    }
+  }
+  unlink(path);
+  return ok;
+}
+
+static void serveConnection(int fd, uint32_t conn) {
+  hal::setSocketTimeouts(fd, IDLE_TIMEOUT_S);
+  hal::SocketReader in(fd);
+  uint32_t served = 0;
+
+  for (;;) {
+    HttpRequest req;
+    int error;
+    if (!readRequest(in, req, error)) {
+      if (error == 413) sendResponse(fd, 413, "Payload Too Large", "Image too large", false);
+      else if (error) sendResponse(fd, error, "Bad Request", "Bad request", false);
+      break;
+    }
+    served++;
+    auto started = std::chrono::steady_clock::now();
+
+    if (req.method == "GET" && req.path == "/health") {
+      if (!sendResponse(fd, 200, "OK", "ok", req.keepAlive) || !req.keepAlive) break;
+      continue;
+    }
+    if (req.method != "POST" || req.path != "/ocr") {
+      if (!sendResponse(fd, 404, "Not Found", "Not found", req.keepAlive) || !req.keepAlive) break;
+      continue;
+    }
+    if (req.body.empty()) {
+      if (!sendResponse(fd, 400, "Bad Request", "No image", req.keepAlive) || !req.keepAlive) break;
+      continue;
+    }
+
+    uint32_t id = ++requestCount;
+    const char* feature = req.query.find("feature=text") != std::string::npos ? "text" : "document";
+    if (!gw.saveDir.empty()) {
+      char name[64];
+      snprintf(name, sizeof(name), "/frame_%05u.jpg", id);
+      FILE* f = fopen((gw.saveDir + name).c_str(), "wb");
+      if (f) {
+        fwrite(req.body.data(), 1, req.body.size(), f);
+        fclose(f);
+      }
+    }
+
+    auto ocrStarted = std::chrono::steady_clock::now();
+    if (gw.delayMs > 0) std::this_thread::sleep_for(std::chrono::milliseconds(gw.delayMs));
+    std::string text = gw.text;
+    bool ok = gw.cmd.empty() || runCommand(req.body, feature, text);
+    double ocrMs = msSince(ocrStarted);
+
+    bool sent = ok ? sendResponse(fd, 200, "OK", text, req.keepAlive)
+                   : sendResponse(fd, 502, "Bad Gateway", "OCR command failed", req.keepAlive);
+    {
+      std::lock_guard<std::mutex> lock(logMutex);
+      printf("#%-5u conn %-3u req %-3u %7zu B  %-8s  ocr %7.1f ms  total %7.1f ms  -> %s%zu chars\n", id,
+             conn, served, req.body.size(), feature, ocrMs, msSince(started), ok ? "" : "FAILED ",
+             text.size());
+      fflush(stdout);
+    }
+    if (!sent || !req.keepAlive) break;
+  }
+  close(fd);
+}
+
+static int runGateway() {
+  int server = socket(AF_INET, SOCK_STREAM, 0);
+  if (server < 0) {
+    perror("socket");
+    return 2;
+  }
+  int one = 1;
+  setsockopt(server, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+  sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  addr.sin_port = htons((uint16_t)gw.port);
+  if (bind(server, (sockaddr*)&addr, sizeof(addr)) < 0 || listen(server, 8) < 0) {
+    perror("bind");
+    return 2;
+  }
+
+  printf("OCR gateway on port %d: POST /ocr (%s%s)\n", gw.port,
+         gw.cmd.empty() ? "fixed text" : gw.cmd.c_str(), gw.delayMs ? ", delayed" : "");
+  fflush(stdout);
+
+  for (;;) {
+    int fd = accept(server, nullptr, nullptr);
+    if (fd < 0) continue;
+    // The eyewear keeps one connection open; the thread lets a probe
+    // or a second unit in meanwhile
+    std::thread(serveConnection, fd, ++connectionCount).detach();
+  }
+}
+
+// ===========================================
+// Probe (client)
+// ===========================================
+struct ProbeResult {
+  const char* mode;
+  int failed = 0;
+  uint32_t connects = 0;
+  std::vector<double> ms;
+  std::string text;
+};
+
+static ProbeResult probe(const char* mode, bool keepAlive, const std::string& url, const std::string& jpeg,
+                         int runs) {
+  ProbeResult r;
+  r.mode = mode;
+  hal::SteadyClock clock;
+  hal::PosixHttp http(keepAlive);
+  GatewayBackend backend(clock, http, url.c_str());
+  std::vector<uint8_t> arenaMem(256 * 1024);
+  Arena arena(arenaMem.data(), arenaMem.size());
+
+  hal::Frame frame;
+  frame.buf = (const uint8_t*)jpeg.data();
+  frame.len = jpeg.size();
+
+  for (int i = 0; i < runs; i++) {
+    auto started = std::chrono::steady_clock::now();
+    {
+      OcrTiming timing;
+      ArenaString text{ ArenaAllocator<char>(arena) };
+      int code = backend.recognize(frame, FEATURE_DOCUMENT, text, nullptr, nullptr, timing);
+      if (code == 200) r.text.assign(text.data(), text.size());
+      else r.failed++;
+    }
+    r.ms.push_back(msSince(started));
+    arena.reset();
+  }
+  r.connects = http.connects();
+  std::sort(r.ms.begin(), r.ms.end());
+  return r;
+}
+
+static double percentile(const std::vector<double>& sorted, double p) {
+  if (sorted.empty()) return 0;
+  size_t i = (size_t)(p * (sorted.size() - 1) + 0.5);
+  return sorted[i];
+}
+
+static int runProbe(const std::string& url, const std::string& jpeg, int runs) {
+  hal::SteadyClock clock;
+  hal::PosixHttp http(true);
+  GatewayBackend check(clock, http, url.c_str());
+  if (!check.configured()) {
+    fprintf(stderr, "probe URL must be http://host[:port]/path\n");
+    return 2;
+  }
+
+  size_t visionBytes = buildVisionRequest((const uint8_t*)jpeg.data(), jpeg.size()).size();
+  printf("%s, JPEG %zu bytes, %d runs\n", url.c_str(), jpeg.size(), runs);
+  printf("upload: gateway %zu bytes, direct Vision JSON %zu bytes (+%.0f%%)\n\n", jpeg.size(), visionBytes,
+         100.0 * visionBytes / jpeg.size() - 100.0);
+
+  ProbeResult results[2] = {
+    probe("keep-alive", true, url, jpeg, runs),
+    probe("new conn", false, url, jpeg, runs),
+  };
+
+  printf("%-11s %6s %8s %9s %9s %9s %9s  (ms, post to text)\n", "mode", "failed", "connects", "min",
+         "median", "p95", "max");
+  for (const ProbeResult& r : results) {
+    printf("%-11s %6d %8u %9.2f %9.2f %9.2f %9.2f\n", r.mode, r.failed, r.connects, percentile(r.ms, 0),
+           percentile(r.ms, 0.5), percentile(r.ms, 0.95), percentile(r.ms, 1));
+  }
+  if (!results[0].text.empty()) printf("\ntext: %s\n", results[0].text.c_str());
+  return results[0].failed || results[1].failed ? 1 : 0;
+}
+
+// ===========================================
+// Main
+// ===========================================
+int main(int argc, char** argv) {
+  std::string probeUrl;
+  std::string jpegPath;
+  size_t jpegKb = 40;
+  int runs = 20;
+
+  for (int i = 1; i + 1 < argc; i++) {
+    if (!strcmp(argv[i], "--port")) gw.port = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "--cmd")) gw.cmd = argv[++i];
+    else if (!strcmp(argv[i], "--delay")) gw.delayMs = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "--save")) gw.saveDir = argv[++i];
+    else if (!strcmp(argv[i], "--probe")) probeUrl = argv[++i];
+    else if (!strcmp(argv[i], "--jpeg")) jpegPath = argv[++i];
+    else if (!strcmp(argv[i], "--jpeg-kb")) jpegKb = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "--runs")) runs = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "--text")) {
+      if (!readFile(argv[++i], gw.text)) {
+        fprintf(stderr, "can't read %s\n", argv[i]);
+        return 2;
+      }
+    }
+  }
+  signal(SIGPIPE, SIG_IGN);
+
+  if (probeUrl.empty()) return runGateway();
+
+  std::string jpeg;
+  if (!jpegPath.empty()) {
+    if (!readFile(jpegPath, jpeg) || jpeg.empty()) {
+      fprintf(stderr, "can't read %s\n", jpegPath.c_str());
+      return 2;
+    }
+  } else {
+    // The stand-in gateway ignores the content; only the size matters
+    jpeg.assign(jpegKb * 1024, '\x5a');
+  }
+  return runProbe(probeUrl, jpeg, runs < 1 ? 1 : runs);
+}
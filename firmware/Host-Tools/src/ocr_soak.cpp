@@ -0,0 +1,351 @@
+/*
+ * ============================================
+ * VisionAssist - OCR Heap Soak
+ * ============================================
+ *
+ * Runs thousands of simulated OCR cycles through the real
+ * request / response code against a model of the eyewear's
+ * internal heap, and tracks the largest free block. Each
+ * run is done twice from the same seed:
+ *   heap   - request JSON and response text on the heap
+ *            (the allocation pattern before the arena)
+ *   arena  - both taken from a PSRAM-sized Arena, reset
+ *            after every cycle (what performOCR() does)
+ *
+ * Between cycles the web handlers keep allocating: status
+ * and distance payloads while the request is in flight,
+ * longer-lived buffers that outlast it, and lastOcrText,
+ * which is replaced every cycle.
+ *
+ * The heap model is first-fit with coalescing, a stand-in
+ * for the ESP-IDF allocator: absolute numbers differ from
+ * the device, the trend between the two modes is the point.
+ *
+ * Usage:
+ *   program [--cycles n] [--heap-kb n] [--arena-kb n]
+ *           [--jpeg-kb min max] [--seed n] [--csv]
+ *           [--data dir]
+ *
+ * Exits non-zero if any arena cycle fails or overflows.
+ * ============================================
+ */
+
+#include <Hal.h>
+#include <OcrText.h>
+#include <WebJson.h>
+#include <Arena.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+
+// ===========================================
+// Heap Model
+// ===========================================
+// Blocks are laid out back to back; each starts with a header
+class HeapModel {
+public:
+  struct Stats {
+    size_t freeBytes;
+    size_t largestFree;
+    size_t blocks;
+  };
+
+  void begin(size_t bytes) {
+    mem.assign(bytes, 0);
+    Header* h = at(0);
+    h->size = bytes;
+    h->used = false;
+  }
+
+  bool owns(const void* p) const {
+    return !mem.empty() && p >= mem.data() && p < mem.data() + mem.size();
+  }
+
+  void* alloc(size_t size) {
+    size_t need = align(size + sizeof(Header));
+    for (size_t off = 0; off < mem.size(); off += at(off)->size) {
+      Header* h = at(off);
+      if (h->used) continue;
+      coalesce(off);
+      if (h->size < need) continue;
+      if (h->size - need >= MIN_SPLIT) {
+        Header* rest = at(off + need);
+        rest->size = h->size - need;
+        rest->used = false;
+        h->size = need;
+      }
+      h->used = true;
+      return (uint8_t*)h + sizeof(Header);
+    }
+    return nullptr;
+  }
+
+  void release(void* p) {
+    Header* h = (Header*)((uint8_t*)p - sizeof(Header));
+    h->used = false;
+  }
+
+  Stats stats() {
+    Stats s = { 0, 0, 0 };
+    for (size_t off = 0; off < mem.size(); off += at(off)->size) {
+      Header* h = at(off);
+      s.blocks++;
+      if (h->used) continue;
+      coalesce(off);
+      size_t avail = h->size - sizeof(Header);
+      s.freeBytes += avail;
+      if (avail > s.largestFree) s.largestFree = avail;
+    }
+    return s;
+  }
+
+private:
+  struct Header {
+    size_t size;   // including this header
+    bool used;
+  };
+  static const size_t ALIGN = 16;
+  static const size_t MIN_SPLIT = 64;
+
+  static size_t align(size_t n) { return (n + ALIGN - 1) & ~(ALIGN - 1); }
+  Header* at(size_t off) { return (Header*)(mem.data() + off); }
+
+  // Merge the free blocks that follow `off` into it
+  void coalesce(size_t off) {
+    Header* h = at(off);
+    while (off + h->size < mem.size() && !at(off + h->size)->used) {
+      h->size += at(off + h->size)->size;
+    }
+  }
+
+  std::vector<uint8_t> mem;
+};
+
+static HeapModel internalHeap;
+static bool heapActive = false;   // route operator new to the model
+static uint32_t heapFailures = 0;
+
+void* operator new(size_t size) {
+  if (heapActive) {
+    void* p = internalHeap.alloc(size);
+    if (!p) {
+      heapFailures++;
+      throw std::bad_alloc();
+    }
+    return p;
+  }
+  void* p = malloc(size ? size : 1);
+  if (!p) throw std::bad_alloc();
+  return p;
+}
+void* operator new[](size_t size) { return operator new(size); }
+void operator delete(void* p) noexcept {
+  if (internalHeap.owns(p)) internalHeap.release(p);
+  else free(p);
+}
+void operator delete[](void* p) noexcept { operator delete(p); }
+void operator delete(void* p, size_t) noexcept { operator delete(p); }
+void operator delete[](void* p, size_t) noexcept { operator delete(p); }
+
+// ===========================================
+// Inputs
+// ===========================================
+// Reads a response without copying it (a copy would land on the model heap)
+class SpanStream : public hal::ByteStream {
+public:
+  SpanStream(const std::string& data) : data(data) {}
+  void rewind() { pos = 0; }
+  int available() override { return (int)(data.size() - pos); }
+  int read() override { return pos < data.size() ? (uint8_t)data[pos++] : -1; }
+
+private:
+  const std::string& data;
+  size_t pos = 0;
+};
+
+static bool readFile(const std::string& path, std::string& out) {
+  FILE* f = fopen(path.c_str(), "rb");
+  if (!f) return false;
+  char buf[4096];
+  size_t n;
+  out.clear();
+  while ((n = fread(buf, 1, sizeof(buf), f)) > 0) out.append(buf, n);
+  fclose(f);
+  return true;
+}
+
+struct Rng {
+  uint32_t x;
+  uint32_t next() {
+    x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+    return x;
+  }
+  uint32_t range(uint32_t lo, uint32_t hi) { return lo + next() % (hi - lo + 1); }
+};
+
+// ===========================================
+// Soak
+// ===========================================
+struct Options {
+  int cycles = 5000;
+  size_t heapKb = 200;      // internal heap free once WiFi + camera are up
+  size_t arenaKb = 256;     // OCR_ARENA_BYTES
+  size_t jpegMinKb = 20;
+  size_t jpegMaxKb = 90;
+  uint32_t seed = 1;
+  bool csv = false;
+};
+
+struct Summary {
+  const char* mode;
+  int failed = 0;
+  size_t largestStart = 0;
+  size_t largestMin = (size_t)-1;
+  size_t largestEnd = 0;
+  size_t freeEnd = 0;
+  size_t blocksEnd = 0;
+  size_t arenaPeak = 0;
+  uint32_t overflows = 0;
+};
+
+// Web handler buffers that outlive a request (client buffers,
+// Strings kept by handlers); replaced at random
+static const int LONG_LIVED_SLOTS = 12;
+
+static Summary soak(const char* mode, bool useArena, const Options& opt,
+                    const std::string& response, const std::string& jpeg) {
+  Summary sum;
+  sum.mode = mode;
+
+  std::vector<uint8_t> psram(opt.arenaKb * 1024);
+  Arena arena(psram.data(), psram.size());
+  SpanStream stream(response);
+  Rng rng = { opt.seed };
+
+  internalHeap.begin(opt.heapKb * 1024);
+  heapFailures = 0;
+  heapActive = true;
+  sum.largestStart = internalHeap.stats().largestFree;
+
+  {
+    std::string lastOcrText = "No text detected yet";
+    std::vector<std::string> longLived(LONG_LIVED_SLOTS);
+
+    for (int cycle = 0; cycle < opt.cycles; cycle++) {
+      size_t jpegLen = rng.range(opt.jpegMinKb, opt.jpegMaxKb) * 1024;
+      uint32_t polls = rng.range(2, 10);
+      int replaced = (int)rng.range(0, LONG_LIVED_SLOTS - 1);
+      size_t replacedLen = rng.range(64, 4096);
+      bool failed = false;
+
+      try {
+        stream.rewind();
+        const uint8_t* jpegBytes = (const uint8_t*)jpeg.data();
+        if (useArena) {
+          ArenaString json{ ArenaAllocator<char>(arena) };
+          buildVisionRequest(jpegBytes, jpegLen, json);
+
+          // Web task keeps serving while the request is in flight
+          for (uint32_t i = 0; i < polls; i++) {
+            std::string status = ocrStatusJson(false, true, lastOcrText);
+            std::string dist = distanceJson(800 + i, 2, true);
+          }
+          longLived[replaced] = std::string(replacedLen, 'x');
+
+          ArenaString text{ ArenaAllocator<char>(arena) };
+          extractTextFromResponse(stream, text);
+          lastOcrText.assign(text.data(), text.size());
+        } else {
+          std::string json = buildVisionRequest(jpegBytes, jpegLen);
+
+          for (uint32_t i = 0; i < polls; i++) {
+            std::string status = ocrStatusJson(false, true, lastOcrText);
+            std::string dist = distanceJson(800 + i, 2, true);
+          }
+          longLived[replaced] = std::string(replacedLen, 'x');
+
+          std::string text = extractTextFromResponse(stream);
+          lastOcrText = text;
+        }
+      } catch (const std::bad_alloc&) {
+        failed = true;
+      }
+      arena.reset();
+
+      HeapModel::Stats s = internalHeap.stats();
+      if (failed) sum.failed++;
+      if (s.largestFree < sum.largestMin) sum.largestMin = s.largestFree;
+      if (opt.csv && (cycle % 10 == 0 || failed)) {
+        printf("%s,%d,%zu,%zu,%zu,%d\n", mode, cycle, s.freeBytes, s.largestFree, s.blocks, failed);
+      }
+    }
+
+    HeapModel::Stats s = internalHeap.stats();
+    sum.largestEnd = s.largestFree;
+    sum.freeEnd = s.freeBytes;
+    sum.blocksEnd = s.blocks;
+  }
+
+  heapActive = false;
+  sum.arenaPeak = arena.highWater();
+  sum.overflows = arena.overflows();
+  return sum;
+}
+
+// ===========================================
+// Main
+// ===========================================
+int main(int argc, char** argv) {
+  Options opt;
+  std::string dataDir = "data";
+
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--csv")) opt.csv = true;
+    else if (i + 1 >= argc) break;
+    else if (!strcmp(argv[i], "--cycles")) opt.cycles = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "--heap-kb")) opt.heapKb = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "--arena-kb")) opt.arenaKb = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "--seed")) opt.seed = strtoul(argv[++i], nullptr, 0);
+    else if (!strcmp(argv[i], "--data")) dataDir = argv[++i];
+    else if (!strcmp(argv[i], "--jpeg-kb") && i + 2 < argc) {
+      opt.jpegMinKb = atoi(argv[++i]);
+      opt.jpegMaxKb = atoi(argv[++i]);
+    }
+  }
+  if (opt.seed == 0) opt.seed = 1;
+  if (opt.jpegMaxKb < opt.jpegMinKb) opt.jpegMaxKb = opt.jpegMinKb;
+
+  std::string response;
+  if (!readFile(dataDir + "/vision_response.json", response)) {
+    fprintf(stderr, "missing %s/vision_response.json (run from firmware/Host-Tools or pass --data)\n",
+            dataDir.c_str());
+    return 2;
+  }
+  // Only the length matters to the allocation pattern; lives in "PSRAM"
+  std::string jpeg(opt.jpegMaxKb * 1024, '\x5a');
+
+  if (opt.csv) printf("mode,cycle,free,largest_free,blocks,failed\n");
+  Summary results[2] = {
+    soak("heap", false, opt, response, jpeg),
+    soak("arena", true, opt, response, jpeg),
+  };
+  if (opt.csv) return 0;
+
+  printf("%d cycles, %zu KB heap, %zu KB arena, JPEG %zu-%zu KB, seed %u\n\n", opt.cycles,
+         opt.heapKb, opt.arenaKb, opt.jpegMinKb, opt.jpegMaxKb, opt.seed);
+  printf("%-6s %7s %14s %14s %14s %10s %7s %11s %9s\n", "mode", "failed", "largest start",
+         "largest min", "largest end", "free end", "blocks", "arena peak", "overflow");
+  for (const Summary& r : results) {
+    printf("%-6s %7d %14zu %14zu %14zu %10zu %7zu %11zu %9u\n", r.mode, r.failed, r.largestStart,
+           r.largestMin, r.largestEnd, r.freeEnd, r.blocksEnd, r.arenaPeak, r.overflows);
+  }
+
+  const Summary& arena = results[1];
+  bool ok = arena.failed == 0 && arena.overflows == 0;
+  printf("\n%s\n", ok ? "PASS" : "FAIL");
+  return ok ? 0 : 1;
+}
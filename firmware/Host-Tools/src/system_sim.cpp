@@ -0,0 +1,443 @@
+/*
+ * ============================================
+ * VisionAssist - Whole-System Simulator
+ * ============================================
+ *
+ * Discrete-event simulation of the alert path on a PC:
+ *
+ *   distance trace -> TOF -> eyewear NavigationController
+ *     -> ESP-NOW link (latency, jitter, loss, bursts)
+ *     -> HandbandController -> motor timeline
+ *
+ * Both controllers are the libraries the firmware runs, so
+ * a change to the alert path can be checked here before it
+ * is walked with the hardware.
+ *
+ * Usage:
+ *   program [--scenario approach|passby|stopgo|mixed] [--trace file]
+ *           [--runs N] [--seed N] [--speed mm/s]
+ *           [--latency ms] [--jitter ms] [--loss p]
+ *           [--burst-ms N] [--burst-every N]
+ *           [--deadline ms] [--flicker-ms ms]
+ *           [--timeline] [--csv]
+ *
+ * --trace replays a recorded "ms,mm" file (the eyewear host
+ * runner input format) or an eyewear /flight dump instead of
+ * a generated walk.
+ * --timeline prints "ms,motor,pattern" for the first run.
+ * --csv prints one result row, for sweeps from a shell loop.
+ * ============================================
+ */
+
+#include <HalHost.h>
+#include <VisionAssistProtocol.h>
+#include <NavigationController.h>
+#include <HandbandController.h>
+#include <FlightRecorder.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <queue>
+#include <random>
+#include <string>
+#include <vector>
+
+// Firmware timing
+static const uint32_t EYE_LOOP = 5;        // eyewear loop() pass
+static const uint32_t TOF_PERIOD = 20;     // VL53L1X ranging period
+static const uint32_t HAND_LOOP = 10;      // handband loop() delay
+static const uint32_t HAND_LOOP_PAUSED = 50;
+static const uint8_t MOTOR_PIN = 4;
+static const uint8_t LED_PIN = 8;
+
+struct Options {
+  std::string scenario = "mixed";
+  std::string tracePath;
+  int runs = 1000;
+  unsigned seed = 1;
+  int speed = 1200;            // walking speed, mm/s
+  uint32_t latency = 3;        // ESP-NOW one-way latency, ms
+  uint32_t jitter = 4;         // added uniformly 0..jitter, ms
+  double loss = 0.02;          // independent per-frame loss
+  uint32_t burstMs = 0;        // loss bursts (0 = none)
+  uint32_t burstEvery = 3000;
+  uint32_t deadline = 500;     // escalation not felt within this = missed
+  uint32_t flickerMs = 200;    // played pattern shorter than this = flicker
+  bool timeline = false;
+  bool csv = false;
+};
+
+// ===========================================
+// Distance Traces
+// ===========================================
+struct Trace {
+  std::vector<uint32_t> ms;
+  std::vector<int> mm;
+
+  void add(uint32_t t, int d) { ms.push_back(t); mm.push_back(d); }
+  uint32_t duration() const { return ms.empty() ? 0 : ms.back(); }
+
+  // Linear interpolation between points
+  int at(uint32_t t) const {
+    if (ms.empty()) return DistanceTracker::NO_OBSTACLE;
+    if (t <= ms.front()) return mm.front();
+    if (t >= ms.back()) return mm.back();
+    size_t i = std::upper_bound(ms.begin(), ms.end(), t) - ms.begin();
+    uint32_t t0 = ms[i - 1], t1 = ms[i];
+    return mm[i - 1] + (int)((int64_t)(mm[i] - mm[i - 1]) * (t - t0) / (t1 - t0));
+  }
+};
+
+static bool loadTrace(const char* path, Trace& trace) {
+  FILE* f = fopen(path, "rb");
+  if (!f) return false;
+  std::vector<uint8_t> data;
+  uint8_t chunk[4096];
+  size_t n;
+  while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) data.insert(data.end(), chunk, chunk + n);
+  fclose(f);
+
+  // Flight recorder dump: its TOF samples from 0 ms, sensor errors
+  // dropped and "nothing in range" as NO_OBSTACLE
+  FlightReader flight;
+  if (flight.open(data.data(), data.size())) {
+    uint32_t t, start = 0;
+    int d;
+    while (flight.nextTof(t, d)) {
+      if (d <= 0) continue;
+      if (d >= DistanceTracker::MAX_RANGE) d = DistanceTracker::NO_OBSTACLE;
+      if (trace.ms.empty()) start = t;
+      else if (t - start <= trace.ms.back()) continue;
+      trace.add(t - start, d);
+    }
+    return trace.ms.size() >= 2;
+  }
+
+  data.push_back(0);
+  const char* p = (const char*)data.data();
+  unsigned long t;
+  int d, used;
+  while (sscanf(p, "%lu,%d%n", &t, &d, &used) == 2) {
+    trace.add((uint32_t)t, d);
+    p += used;
+  }
+  return trace.ms.size() >= 2;
+}
+
+static void makeTrace(const std::string& kind, int speed, std::mt19937& rng, Trace& trace) {
+  std::uniform_int_distribution<int> pick(0, 2);
+  std::uniform_int_distribution<int> start(3000, 3900);
+  std::uniform_int_distribution<int> closest(250, 1000);
+  std::uniform_int_distribution<int> hold(300, 1500);
+
+  int type = kind == "approach" ? 0 : kind == "passby" ? 1 : kind == "stopgo" ? 2 : pick(rng);
+  int d0 = start(rng);
+  int d1 = closest(rng);
+  uint32_t walk = (uint32_t)((d0 - d1) * 1000 / speed);
+
+  trace.add(0, d0);
+  switch (type) {
+    case 0:  // walk up to the obstacle and stand there
+      trace.add(walk, d1);
+      trace.add(walk + 1500, d1);
+      break;
+    case 1:  // walk past: closest approach, then it falls away
+      trace.add(walk, d1);
+      trace.add(walk + 200, d1);
+      trace.add(walk + 400, DistanceTracker::NO_OBSTACLE);
+      trace.add(walk + 1500, DistanceTracker::NO_OBSTACLE);
+      break;
+    default: {  // stop and go, pausing inside each zone
+      uint32_t t = 0;
+      int d = d0;
+      const int stops[] = { CAUTION_DISTANCE - 150, WARNING_DISTANCE - 150, d1 };
+      for (int s : stops) {
+        if (s >= d) continue;
+        t += (uint32_t)((d - s) * 1000 / speed);
+        trace.add(t, s);
+        t += (uint32_t)hold(rng);
+        trace.add(t, s);
+        d = s;
+      }
+      trace.add(t + 1000, d);
+      break;
+    }
+  }
+}
+
+// ===========================================
+// Metrics
+// ===========================================
+struct Metrics {
+  uint64_t simMs = 0;
+  uint64_t underWarnMs = 0;          // played zone less severe than the true zone
+  uint64_t silentInCriticalMs = 0;   // motor pattern CLEAR inside CRITICAL
+  int escalations = 0;
+  int missedEscalations = 0;
+  int flickers = 0;
+  uint64_t motorToggles = 0;
+  std::vector<uint32_t> latencies;   // escalation -> matching pattern playing
+
+  void merge(const Metrics& m) {
+    simMs += m.simMs;
+    underWarnMs += m.underWarnMs;
+    silentInCriticalMs += m.silentInCriticalMs;
+    escalations += m.escalations;
+    missedEscalations += m.missedEscalations;
+    flickers += m.flickers;
+    motorToggles += m.motorToggles;
+    latencies.insert(latencies.end(), m.latencies.begin(), m.latencies.end());
+  }
+};
+
+static int severity(int pattern) {
+  switch (pattern) {
+    case PATTERN_CRITICAL: return 3;
+    case PATTERN_WARNING: return 2;
+    case PATTERN_CAUTION: return 1;
+    default: return 0;
+  }
+}
+
+// ===========================================
+// Event Queue
+// ===========================================
+enum EventType : uint8_t { EV_TOF, EV_EYE_LOOP, EV_RX, EV_HAND_LOOP };
+
+struct Event {
+  uint32_t at;
+  uint32_t seq;        // FIFO among events at the same ms
+  EventType type;
+  StateFrame frame;
+  bool operator>(const Event& o) const { return at != o.at ? at > o.at : seq > o.seq; }
+};
+
+class EventQueue {
+public:
+  void push(uint32_t at, EventType type, const StateFrame* frame = nullptr) {
+    Event e;
+    e.at = at;
+    e.seq = seq++;
+    e.type = type;
+    if (frame) e.frame = *frame;
+    q.push(e);
+  }
+  bool empty() const { return q.empty(); }
+  Event pop() { Event e = q.top(); q.pop(); return e; }
+
+private:
+  std::priority_queue<Event, std::vector<Event>, std::greater<Event>> q;
+  uint32_t seq = 0;
+};
+
+// ===========================================
+// One Scenario
+// ===========================================
+static void runScenario(const Options& opt, const Trace& trace, std::mt19937& rng,
+                        Metrics& m, bool printTimeline) {
+  std::uniform_real_distribution<double> uni(0.0, 1.0);
+  std::normal_distribution<double> noise(0.0, 15.0);
+
+  hal::ScriptedTof tof;
+  hal::RecordingGpio gpio;
+  NavigationController nav;
+  HandbandController hand(gpio, MOTOR_PIN, LED_PIN);
+  const ZoneClassifier& zones = nav.zones();
+
+  const uint32_t end = trace.duration();
+  const uint32_t burstPhase = opt.burstMs ? (uint32_t)(uni(rng) * opt.burstEvery) : 0;
+  // Handband loop is not in phase with the eyewear
+  const uint32_t handPhase = (uint32_t)(uni(rng) * HAND_LOOP);
+
+  EventQueue events;
+  events.push(0, EV_TOF);
+  events.push(0, EV_EYE_LOOP);
+  events.push(handPhase, EV_HAND_LOOP);
+  nav.reset(0);
+  hand.holdLink(0);
+
+  int lastTrueSev = 0;
+  uint32_t escalationAt = 0;
+  bool pending = false;
+  int played = PATTERN_CLEAR;
+  uint32_t playedSince = 0;
+  bool motor = false;
+  uint32_t lastSample = 0;
+
+  while (!events.empty()) {
+    Event e = events.pop();
+    uint32_t now = e.at;
+    if (now > end) break;
+
+    switch (e.type) {
+      case EV_TOF: {
+        tof.push(trace.at(now) + (int)noise(rng));
+        events.push(now + TOF_PERIOD, EV_TOF);
+        break;
+      }
+      case EV_EYE_LOOP: {
+        StateFrame f;
+        if (nav.step(now, &tof, false, 0, f)) {
+          bool inBurst = opt.burstMs && ((now + burstPhase) % opt.burstEvery) < opt.burstMs;
+          if (!inBurst && uni(rng) >= opt.loss) {
+            uint32_t delay = opt.latency + (opt.jitter ? (uint32_t)(uni(rng) * (opt.jitter + 1)) : 0);
+            events.push(now + delay, EV_RX, &f);
+          }
+        }
+        events.push(now + EYE_LOOP, EV_EYE_LOOP);
+        break;
+      }
+      case EV_RX:
+        hand.onStateFrame(now, e.frame);
+        break;
+      case EV_HAND_LOOP: {
+        // The firmware rescans after link loss; here the link comes straight back
+        if (hand.update(now) & HandbandController::EV_LINK_LOST) hand.holdLink(now);
+        events.push(now + (hand.paused() ? HAND_LOOP_PAUSED : HAND_LOOP), EV_HAND_LOOP);
+        break;
+      }
+    }
+
+    // Sample the outputs after every event that can change them
+    if (e.type != EV_RX && e.type != EV_HAND_LOOP) continue;
+
+    int trueSev = severity(zones.classify(trace.at(now)));
+    int nowPlaying = hand.player().playing();
+    bool degraded = nowPlaying == PATTERN_DEGRADED;
+    int playedSev = degraded ? 0 : severity(nowPlaying);
+
+    uint32_t dt = now - lastSample;
+    lastSample = now;
+    if (playedSev < trueSev && !degraded) m.underWarnMs += dt;
+    if (trueSev == 3 && nowPlaying == PATTERN_CLEAR) m.silentInCriticalMs += dt;
+
+    if (trueSev > lastTrueSev) {
+      m.escalations++;
+      escalationAt = now;
+      pending = true;
+    }
+    lastTrueSev = trueSev;
+
+    if (pending) {
+      uint32_t delay = now - escalationAt;
+      if (playedSev >= trueSev || degraded) {
+        pending = false;
+        m.latencies.push_back(delay);
+        if (delay > opt.deadline) m.missedEscalations++;
+      } else if (delay > opt.deadline) {
+        pending = false;
+        m.missedEscalations++;
+      }
+    }
+
+    if (nowPlaying != played) {
+      if (now - playedSince < opt.flickerMs && played != PATTERN_CLEAR) m.flickers++;
+      played = nowPlaying;
+      playedSince = now;
+    }
+
+    if (hand.motorOn() != motor) {
+      motor = hand.motorOn();
+      m.motorToggles++;
+      if (printTimeline) printf("%u,%d,%d\n", now, motor ? 1 : 0, nowPlaying);
+    }
+  }
+  m.simMs += end;
+}
+
+// ===========================================
+// Main
+// ===========================================
+static uint32_t percentile(std::vector<uint32_t>& v, double p) {
+  if (v.empty()) return 0;
+  size_t i = (size_t)(p * (v.size() - 1));
+  std::nth_element(v.begin(), v.begin() + i, v.end());
+  return v[i];
+}
+
+int main(int argc, char** argv) {
+  Options opt;
+  for (int i = 1; i < argc; i++) {
+    const char* a = argv[i];
+    const char* v = i + 1 < argc ? argv[i + 1] : nullptr;
+    if (!strcmp(a, "--timeline")) opt.timeline = true;
+    else if (!strcmp(a, "--csv")) opt.csv = true;
+    else if (!v) { fprintf(stderr, "missing value for %s\n", a); return 2; }
+    else {
+      i++;
+      if (!strcmp(a, "--scenario")) opt.scenario = v;
+      else if (!strcmp(a, "--trace")) opt.tracePath = v;
+      else if (!strcmp(a, "--runs")) opt.runs = atoi(v);
+      else if (!strcmp(a, "--seed")) opt.seed = (unsigned)atoi(v);
+      else if (!strcmp(a, "--speed")) opt.speed = atoi(v);
+      else if (!strcmp(a, "--latency")) opt.latency = (uint32_t)atoi(v);
+      else if (!strcmp(a, "--jitter")) opt.jitter = (uint32_t)atoi(v);
+      else if (!strcmp(a, "--loss")) opt.loss = atof(v);
+      else if (!strcmp(a, "--burst-ms")) opt.burstMs = (uint32_t)atoi(v);
+      else if (!strcmp(a, "--burst-every")) opt.burstEvery = (uint32_t)atoi(v);
+      else if (!strcmp(a, "--deadline")) opt.deadline = (uint32_t)atoi(v);
+      else if (!strcmp(a, "--flicker-ms")) opt.flickerMs = (uint32_t)atoi(v);
+      else { fprintf(stderr, "unknown option %s\n", a); return 2; }
+    }
+  }
+  if (opt.runs <= 0 || opt.speed <= 0 || opt.burstEvery == 0) {
+    fprintf(stderr, "invalid options\n");
+    return 2;
+  }
+
+  Trace recorded;
+  if (!opt.tracePath.empty() && !loadTrace(opt.tracePath.c_str(), recorded)) {
+    fprintf(stderr, "cannot read trace %s\n", opt.tracePath.c_str());
+    return 2;
+  }
+
+  std::mt19937 rng(opt.seed);
+  Metrics total;
+  auto started = std::chrono::steady_clock::now();
+
+  for (int r = 0; r < opt.runs; r++) {
+    Trace generated;
+    if (recorded.ms.empty()) makeTrace(opt.scenario, opt.speed, rng, generated);
+    Metrics m;
+    runScenario(opt, recorded.ms.empty() ? generated : recorded, rng, m, opt.timeline && r == 0);
+    total.merge(m);
+  }
+
+  double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+  double minutes = total.simMs / 60000.0;
+  size_t n = total.latencies.size();
+  double mean = 0;
+  for (uint32_t l : total.latencies) mean += l;
+  if (n) mean /= n;
+  uint32_t p50 = percentile(total.latencies, 0.50);
+  uint32_t p95 = percentile(total.latencies, 0.95);
+  uint32_t worst = n ? *std::max_element(total.latencies.begin(), total.latencies.end()) : 0;
+
+  if (opt.csv) {
+    // latency,jitter,loss,burst_ms,escalations,missed,lat_mean,lat_p50,lat_p95,lat_max,flicker_per_min,under_warn_pct
+    printf("%u,%u,%.3f,%u,%d,%d,%.1f,%u,%u,%u,%.2f,%.2f\n",
+           opt.latency, opt.jitter, opt.loss, opt.burstMs, total.escalations,
+           total.missedEscalations, mean, p50, p95, worst,
+           minutes > 0 ? total.flickers / minutes : 0.0,
+           total.simMs ? 100.0 * total.underWarnMs / total.simMs : 0.0);
+  } else if (!opt.timeline) {
+    printf("%d runs (%s), link %u+0..%u ms, loss %.2f, bursts %u ms every %u ms\n",
+           opt.runs, opt.tracePath.empty() ? opt.scenario.c_str() : opt.tracePath.c_str(),
+           opt.latency, opt.jitter, opt.loss, opt.burstMs, opt.burstEvery);
+    printf("  alert latency      mean %.1f ms  p50 %u ms  p95 %u ms  max %u ms\n", mean, p50, p95, worst);
+    printf("  missed escalations %d/%d (deadline %u ms)\n",
+           total.missedEscalations, total.escalations, opt.deadline);
+    printf("  flicker            %.2f /min (patterns < %u ms)\n",
+           minutes > 0 ? total.flickers / minutes : 0.0, opt.flickerMs);
+    printf("  under-warn         %.2f%%  silent in critical %llu ms\n",
+           total.simMs ? 100.0 * total.underWarnMs / total.simMs : 0.0,
+           (unsigned long long)total.silentInCriticalMs);
+    printf("  motor toggles      %.1f /min\n", minutes > 0 ? total.motorToggles / minutes : 0.0);
+    printf("  %.1f s simulated in %.2f s wall (%.0f scenarios/s)\n",
+           total.simMs / 1000.0, wall, wall > 0 ? opt.runs / wall : 0.0);
+  }
+  return 0;
+}
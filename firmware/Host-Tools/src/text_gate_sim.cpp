@@ -0,0 +1,511 @@
+/*
+ * ============================================
+ * VisionAssist - Text Presence Gate Evaluation
+ * ============================================
+ *
+ * Runs TextPresenceDetector, exactly as the eyewear runs
+ * it on the OCR shot, over a labelled set of frames and
+ * reports how well "no text" is called:
+ *   skip precision - skipped frames that had no text
+ *   skip recall    - no-text frames skipped
+ *   text lost      - text frames skipped (read as "No
+ *                    text detected": the costly mistake)
+ * and the time saved per touch, given the share of
+ * touches aimed at no text and the Vision round trip a
+ * skip avoids. Navigation also comes back sooner after a
+ * skip: NO_TEXT_LOCAL_RESUME_DELAY instead of
+ * NO_TEXT_RESUME_DELAY (main.cpp).
+ *
+ * Generated corpus (default): 800x600 grey frames with
+ * sensor noise, encoded as 4:2:2 baseline JPEGs.
+ *   text:    page, sign, far sign (small letters), single
+ *            word, low-contrast page, blurred page
+ *   no text: wall, dark, door, room (furniture edges),
+ *            sky, blinds (stripes), tiles, foliage
+ * Letters are stroke glyphs: stems, bars, bowls and
+ * diagonals at random sizes.
+ *
+ * --corpus reads real captures instead, one per line:
+ *   text captures/menu.jpg
+ *   none captures/wall.jpg
+ *
+ * Usage:
+ *   program [--frames n] [--seed n] [--quality n]
+ *           [--corpus labels.txt] [--no-text-share f]
+ *           [--vision-ms n] [--stroke-detail n]
+ *           [--min-run n] [--min-line-blocks n] [--csv]
+ *
+ * Exits 1 if any text frame is skipped.
+ * ============================================
+ */
+
+#include <TextPresence.h>
+
+#include "JpegEncoder.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+static const int WIDTH = 800;    // FRAMESIZE_SVGA, as initCamera() sets it
+static const int HEIGHT = 600;
+
+// ===========================================
+// Scenes
+// ===========================================
+enum Kind {
+  KIND_PAGE, KIND_SIGN, KIND_FAR_SIGN, KIND_WORD, KIND_LOW_CONTRAST, KIND_BLURRED,
+  KIND_WALL, KIND_DARK, KIND_DOOR, KIND_ROOM, KIND_SKY, KIND_BLINDS, KIND_TILES, KIND_FOLIAGE,
+  KINDS
+};
+static const int TEXT_KINDS = KIND_WALL;   // kinds before this one have text
+static const char* const KIND_NAMES[KINDS] = {
+  "page", "sign", "far_sign", "word", "low_contrast", "blurred",
+  "wall", "dark", "door", "room", "sky", "blinds", "tiles", "foliage"
+};
+
+struct Image {
+  std::vector<float> px;   // levels, clamped when encoded
+
+  Image() : px(WIDTH * HEIGHT, 0.0f) {}
+  float& at(int x, int y) { return px[y * WIDTH + x]; }
+};
+
+class Painter {
+public:
+  Painter(Image& img, std::mt19937& rng) : img(img), rng(rng) {}
+
+  float range(float lo, float hi) { return std::uniform_real_distribution<float>(lo, hi)(rng); }
+  int irange(int lo, int hi) { return std::uniform_int_distribution<int>(lo, hi)(rng); }
+
+  void rect(int x0, int y0, int x1, int y1, float level) {
+    for (int y = std::max(0, y0); y < std::min(HEIGHT, y1); y++) {
+      for (int x = std::max(0, x0); x < std::min(WIDTH, x1); x++) img.at(x, y) = level;
+    }
+  }
+
+  // Smooth shading: a gradient in a random direction
+  void gradient(float base, float span) {
+    float a = range(0, 6.2832f), cx = cosf(a), cy = sinf(a);
+    for (int y = 0; y < HEIGHT; y++) {
+      for (int x = 0; x < WIDTH; x++) {
+        img.at(x, y) = base + span * ((x - WIDTH / 2) * cx + (y - HEIGHT / 2) * cy) / WIDTH;
+      }
+    }
+  }
+
+  void line(float x0, float y0, float x1, float y1, float width, float level) {
+    float len = std::max(1.0f, hypotf(x1 - x0, y1 - y0));
+    for (float t = 0; t <= len; t += 0.5f) {
+      float x = x0 + (x1 - x0) * t / len, y = y0 + (y1 - y0) * t / len;
+      rect((int)(x - width / 2), (int)(y - width / 2), (int)(x + width / 2 + 0.5f), (int)(y + width / 2 + 0.5f),
+           level);
+    }
+  }
+
+  void ring(float cx, float cy, float rx, float ry, float width, float level) {
+    for (float a = 0; a < 6.2832f; a += 0.5f / std::max(rx, ry)) {
+      float x = cx + rx * cosf(a), y = cy + ry * sinf(a);
+      rect((int)(x - width / 2), (int)(y - width / 2), (int)(x + width / 2 + 0.5f), (int)(y + width / 2 + 0.5f),
+           level);
+    }
+  }
+
+  // One letter-like glyph in a w x h box: stems, bars, a bowl or diagonals
+  void glyph(float x, float y, float w, float h, float stroke, float ink) {
+    int shape = irange(0, 7);
+    switch (shape) {
+      case 0:   // E / F
+        line(x, y, x, y + h, stroke, ink);
+        line(x, y, x + w, y, stroke, ink);
+        line(x, y + h / 2, x + w * 0.8f, y + h / 2, stroke, ink);
+        if (irange(0, 1)) line(x, y + h, x + w, y + h, stroke, ink);
+        break;
+      case 1:   // H / N
+        line(x, y, x, y + h, stroke, ink);
+        line(x + w, y, x + w, y + h, stroke, ink);
+        if (irange(0, 1)) line(x, y + h / 2, x + w, y + h / 2, stroke, ink);
+        else line(x, y, x + w, y + h, stroke, ink);
+        break;
+      case 2:   // O / C
+        ring(x + w / 2, y + h / 2, w / 2, h / 2, stroke, ink);
+        break;
+      case 3:   // A / V
+        line(x, y + h, x + w / 2, y, stroke, ink);
+        line(x + w / 2, y, x + w, y + h, stroke, ink);
+        line(x + w / 4, y + h * 0.6f, x + w * 0.75f, y + h * 0.6f, stroke, ink);
+        break;
+      case 4:   // T / L
+        if (irange(0, 1)) {
+          line(x, y, x + w, y, stroke, ink);
+          line(x + w / 2, y, x + w / 2, y + h, stroke, ink);
+        } else {
+          line(x, y, x, y + h, stroke, ink);
+          line(x, y + h, x + w, y + h, stroke, ink);
+        }
+        break;
+      case 5:   // P / B / R
+        line(x, y, x, y + h, stroke, ink);
+        ring(x + w / 3, y + h / 4, w * 0.6f, h / 4, stroke, ink);
+        if (irange(0, 1)) line(x + w / 3, y + h / 2, x + w, y + h, stroke, ink);
+        break;
+      case 6:   // S / Z
+        line(x, y, x + w, y, stroke, ink);
+        line(x + w, y, x, y + h, stroke, ink);
+        line(x, y + h, x + w, y + h, stroke, ink);
+        break;
+      default:  // lower case: x-height bowl and a stem
+        ring(x + w / 2, y + h * 0.7f, w / 2, h * 0.3f, stroke, ink);
+        line(x + w, y + h * 0.2f, x + w, y + h, stroke, ink);
+        break;
+    }
+  }
+
+  // Lines of words over a box; letters h px high
+  void text(int x0, int y0, int x1, int y1, float h, float ink, int maxLines = 100) {
+    float w = h * 0.6f, stroke = std::max(1.0f, h * range(0.08f, 0.14f));
+    for (float top = y0; top + h <= y1 && maxLines > 0; top += h * range(1.4f, 1.8f), maxLines--) {
+      float x = x0;
+      while (x + w <= x1) {
+        int letters = irange(2, 8);
+        for (int i = 0; i < letters && x + w <= x1; i++, x += w * 1.3f) glyph(x, top, w, h, stroke, ink);
+        x += w * 1.2f;   // word space
+      }
+    }
+  }
+
+  // Multi-scale blobs: leaves, gravel, carpet
+  void foliage(float base, float contrast) {
+    gradient(base, 20);
+    int blobs = irange(1500, 4000);
+    for (int i = 0; i < blobs; i++) {
+      float r = range(2, 14);
+      float cx = range(0, WIDTH), cy = range(0, HEIGHT), level = base + range(-contrast, contrast);
+      for (int y = (int)(cy - r); y <= (int)(cy + r); y++) {
+        for (int x = (int)(cx - r); x <= (int)(cx + r); x++) {
+          if (x >= 0 && y >= 0 && x < WIDTH && y < HEIGHT && hypotf(x - cx, y - cy) <= r) img.at(x, y) = level;
+        }
+      }
+    }
+  }
+
+  void boxBlur(int radius) {
+    std::vector<float> tmp(img.px.size());
+    for (int y = 0; y < HEIGHT; y++) {
+      for (int x = 0; x < WIDTH; x++) {
+        float sum = 0;
+        int n = 0;
+        for (int k = -radius; k <= radius; k++) {
+          int xx = std::min(WIDTH - 1, std::max(0, x + k));
+          sum += img.at(xx, y);
+          n++;
+        }
+        tmp[y * WIDTH + x] = sum / n;
+      }
+    }
+    for (int y = 0; y < HEIGHT; y++) {
+      for (int x = 0; x < WIDTH; x++) {
+        float sum = 0;
+        int n = 0;
+        for (int k = -radius; k <= radius; k++) {
+          int yy = std::min(HEIGHT - 1, std::max(0, y + k));
+          sum += tmp[yy * WIDTH + x];
+          n++;
+        }
+        img.at(x, y) = sum / n;
+      }
+    }
+  }
+
+  void noise(float sigma) {
+    std::normal_distribution<float> n(0.0f, sigma);
+    for (float& v : img.px) v += n(rng);
+  }
+
+private:
+  Image& img;
+  std::mt19937& rng;
+};
+
+static void makeScene(Kind kind, std::mt19937& rng, Image& img) {
+  Painter p(img, rng);
+  float paper = p.range(150, 220), surround = p.range(40, 120);
+
+  switch (kind) {
+    case KIND_PAGE:
+    case KIND_LOW_CONTRAST:
+    case KIND_BLURRED: {
+      p.gradient(surround, 40);
+      int bw = (int)(WIDTH * p.range(0.5f, 0.9f)), bh = (int)(HEIGHT * p.range(0.4f, 0.9f));
+      int bx = (WIDTH - bw) / 2 + p.irange(-40, 40), by = (HEIGHT - bh) / 2 + p.irange(-30, 30);
+      float ink = kind == KIND_LOW_CONTRAST ? paper - p.range(35, 60) : paper - p.range(90, 150);
+      p.rect(bx, by, bx + bw, by + bh, paper);
+      p.text(bx + 20, by + 20, bx + bw - 20, by + bh - 20, p.range(10, 28), ink);
+      if (kind == KIND_BLURRED) p.boxBlur(1);
+      break;
+    }
+    case KIND_SIGN: {
+      p.gradient(surround, 60);
+      int bw = (int)(WIDTH * p.range(0.3f, 0.6f)), bh = (int)(HEIGHT * p.range(0.2f, 0.35f));
+      int bx = p.irange(40, WIDTH - bw - 40), by = p.irange(40, HEIGHT - bh - 40);
+      bool light = p.irange(0, 1);
+      float board = light ? paper : p.range(20, 70), ink = light ? p.range(10, 60) : p.range(190, 250);
+      p.rect(bx, by, bx + bw, by + bh, board);
+      p.text(bx + 16, by + 16, bx + bw - 16, by + bh - 16, p.range(30, 60), ink, 3);
+      break;
+    }
+    case KIND_FAR_SIGN: {
+      p.gradient(surround, 60);
+      int bw = p.irange(90, 200), bh = p.irange(30, 60);
+      int bx = p.irange(40, WIDTH - bw - 40), by = p.irange(40, HEIGHT - bh - 40);
+      p.rect(bx, by, bx + bw, by + bh, paper);
+      p.text(bx + 6, by + 6, bx + bw - 6, by + bh - 6, p.range(8, 12), paper - p.range(100, 150), 2);
+      break;
+    }
+    case KIND_WORD: {
+      p.gradient(surround, 40);
+      float h = p.range(50, 110), w = h * 0.6f;
+      int letters = p.irange(3, 5);
+      float span = letters * w * 1.3f;
+      float x = p.range(20, WIDTH - span - 20), y = p.range(20, HEIGHT - h - 20);
+      p.rect((int)x - 20, (int)y - 20, (int)(x + span + 20), (int)(y + h + 20), paper);
+      for (int i = 0; i < letters; i++) p.glyph(x + i * w * 1.3f, y, w, h, h * p.range(0.1f, 0.15f), p.range(10, 60));
+      break;
+    }
+    case KIND_WALL:
+      p.gradient(p.range(60, 200), p.range(10, 80));
+      break;
+    case KIND_DARK:
+      p.gradient(p.range(4, 20), 6);
+      break;
+    case KIND_DOOR: {
+      float wall = p.range(100, 200);
+      p.gradient(wall, 40);
+      int dx = p.irange(150, 400), dw = p.irange(180, 300);
+      p.rect(dx - 12, 0, dx + dw + 12, HEIGHT, wall - p.range(30, 60));   // frame
+      p.rect(dx, 0, dx + dw, HEIGHT, p.range(60, 140));
+      p.ring(dx + dw - 30, HEIGHT * 0.55f, 8, 8, 4, p.range(180, 240));  // handle
+      break;
+    }
+    case KIND_ROOM: {
+      p.gradient(p.range(80, 160), 50);
+      p.rect(0, (int)(HEIGHT * p.range(0.55f, 0.75f)), WIDTH, HEIGHT, p.range(40, 100));   // floor
+      int things = p.irange(2, 5);
+      for (int i = 0; i < things; i++) {
+        int w = p.irange(80, 300), h = p.irange(60, 250), x = p.irange(0, WIDTH - w), y = p.irange(100, HEIGHT - h);
+        p.rect(x, y, x + w, y + h, p.range(20, 220));
+      }
+      break;
+    }
+    case KIND_SKY: {
+      p.gradient(p.range(170, 230), 30);
+      int horizon = p.irange(HEIGHT / 3, HEIGHT * 2 / 3);
+      p.rect(0, horizon, WIDTH, HEIGHT, p.range(50, 110));
+      float pole = p.range(100, 700);
+      p.line(pole, p.range(50, 200), pole, HEIGHT, p.range(6, 14), p.range(20, 60));
+      break;
+    }
+    case KIND_BLINDS: {
+      p.gradient(p.range(120, 200), 30);
+      int pitch = p.irange(12, 30);
+      float dark = p.range(30, 90);
+      for (int y = 0; y < HEIGHT; y += pitch) p.rect(0, y, WIDTH, y + pitch / 3, dark);
+      break;
+    }
+    case KIND_TILES: {
+      float tile = p.range(120, 210);
+      p.gradient(tile, 30);
+      int pitch = p.irange(50, 100);
+      float grout = tile - p.range(40, 80);
+      for (int y = 0; y < HEIGHT; y += pitch) p.rect(0, y, WIDTH, y + 3, grout);
+      for (int x = 0; x < WIDTH; x += pitch) p.rect(x, 0, x + 3, HEIGHT, grout);
+      break;
+    }
+    default:
+      p.foliage(p.range(60, 140), p.range(20, 60));
+      break;
+  }
+  p.noise(p.range(1.5f, 4.0f));
+}
+
+static void toGrey(const Image& img, std::vector<uint8_t>& out) {
+  out.resize(img.px.size());
+  for (size_t i = 0; i < out.size(); i++) {
+    out[i] = (uint8_t)std::min(255.0f, std::max(0.0f, img.px[i] + 0.5f));
+  }
+}
+
+// ===========================================
+// Evaluation
+// ===========================================
+struct KindStats {
+  int frames = 0;
+  int skipped = 0;
+  int unparsed = 0;
+  double lineBlocks = 0;
+  double us = 0;
+};
+
+struct Options {
+  int frames = 700;
+  uint32_t seed = 1;
+  int quality = 75;
+  const char* corpus = nullptr;
+  float noTextShare = 0.3f;
+  int visionMs = 1300;   // capture to text on Vision, p50 (visionassist_ocr_backend_ms)
+  int resumeMs = 2500;        // NO_TEXT_RESUME_DELAY
+  int skipResumeMs = 1000;    // NO_TEXT_LOCAL_RESUME_DELAY
+  bool csv = false;
+};
+
+static bool readFile(const char* path, std::string& out) {
+  FILE* f = fopen(path, "rb");
+  if (!f) return false;
+  char buf[4096];
+  size_t n;
+  out.clear();
+  while ((n = fread(buf, 1, sizeof(buf), f)) > 0) out.append(buf, n);
+  fclose(f);
+  return true;
+}
+
+// Runs the detector on one frame; true if it was skipped
+static bool judge(TextPresenceDetector& detector, const std::string& jpeg, const char* name, bool hasText,
+                  KindStats& k, const Options& opt) {
+  TextPresence r;
+  auto t0 = std::chrono::steady_clock::now();
+  bool parsed = detector.detect((const uint8_t*)jpeg.data(), jpeg.size(), r);
+  double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count();
+  k.frames++;
+  k.us += us;
+  k.lineBlocks += r.lineBlocks;
+  if (!parsed) k.unparsed++;
+  if (r.noText) k.skipped++;
+  if (opt.csv) {
+    printf("%s,%d,%d,%u,%u,%u,%u,%d,%.0f\n", name, hasText, parsed, r.blocks, r.strokeBlocks, r.lineBlocks,
+           r.lineRows, r.noText, us);
+  }
+  return r.noText;
+}
+
+int main(int argc, char** argv) {
+  Options opt;
+  TextPresenceConfig cfg;
+  for (int i = 1; i < argc; i++) {
+    const char* a = argv[i];
+    bool more = i + 1 < argc;
+    if (!strcmp(a, "--frames") && more) opt.frames = atoi(argv[++i]);
+    else if (!strcmp(a, "--seed") && more) opt.seed = strtoul(argv[++i], nullptr, 0);
+    else if (!strcmp(a, "--quality") && more) opt.quality = atoi(argv[++i]);
+    else if (!strcmp(a, "--corpus") && more) opt.corpus = argv[++i];
+    else if (!strcmp(a, "--no-text-share") && more) opt.noTextShare = (float)atof(argv[++i]);
+    else if (!strcmp(a, "--vision-ms") && more) opt.visionMs = atoi(argv[++i]);
+    else if (!strcmp(a, "--stroke-detail") && more) cfg.strokeDetail = (uint16_t)atoi(argv[++i]);
+    else if (!strcmp(a, "--min-run") && more) cfg.minRun = (uint8_t)atoi(argv[++i]);
+    else if (!strcmp(a, "--min-line-blocks") && more) cfg.minLineBlocks = (uint16_t)atoi(argv[++i]);
+    else if (!strcmp(a, "--csv")) opt.csv = true;
+    else {
+      fprintf(stderr, "usage: text_gate_sim [--frames n] [--seed n] [--quality n] [--corpus labels.txt]\n"
+                      "                     [--no-text-share f] [--vision-ms n] [--stroke-detail n]\n"
+                      "                     [--min-run n] [--min-line-blocks n] [--csv]\n");
+      return 2;
+    }
+  }
+
+  static TextPresenceDetector detector(cfg);   // 4 KB map
+  std::string jpeg;
+  // Generated: one stats row per kind. Corpus: text and none.
+  std::vector<KindStats> kinds(opt.corpus ? 2 : KINDS);
+  std::vector<std::string> names;
+  std::vector<bool> hasText;
+  if (opt.csv) printf("frame,has_text,parsed,blocks,stroke_blocks,line_blocks,line_rows,skipped,us\n");
+
+  if (opt.corpus) {
+    names = { "text", "none" };
+    hasText = { true, false };
+    FILE* f = fopen(opt.corpus, "r");
+    if (!f) {
+      perror(opt.corpus);
+      return 2;
+    }
+    char line[1024];
+    while (fgets(line, sizeof(line), f)) {
+      char label[16], path[1000];
+      if (line[0] == '#' || sscanf(line, "%15s %999[^\r\n]", label, path) != 2) continue;
+      bool text = !strcmp(label, "text");
+      if (!text && strcmp(label, "none") != 0) {
+        fprintf(stderr, "%s: label must be text or none\n", path);
+        return 2;
+      }
+      if (!readFile(path, jpeg)) {
+        fprintf(stderr, "can't read %s\n", path);
+        return 2;
+      }
+      judge(detector, jpeg, path, text, kinds[text ? 0 : 1], opt);
+    }
+    fclose(f);
+  } else {
+    for (int i = 0; i < KINDS; i++) {
+      names.push_back(KIND_NAMES[i]);
+      hasText.push_back(i < TEXT_KINDS);
+    }
+    std::mt19937 rng(opt.seed);
+    JpegEncoder encoder(opt.quality);
+    std::vector<uint8_t> grey;
+    for (int n = 0; n < opt.frames; n++) {
+      Kind kind = (Kind)(n % KINDS);
+      Image img;
+      makeScene(kind, rng, img);
+      toGrey(img, grey);
+      encoder.encode(grey, WIDTH, HEIGHT, jpeg);
+      judge(detector, jpeg, KIND_NAMES[kind], kind < TEXT_KINDS, kinds[kind], opt);
+    }
+  }
+  if (opt.csv) return 0;
+
+  printf("stroke detail %u, run %u, line blocks %u", cfg.strokeDetail, cfg.minRun, cfg.minLineBlocks);
+  if (!opt.corpus) printf("; %d frames, seed %u, JPEG quality %d", opt.frames, opt.seed, opt.quality);
+  printf("\n\n%-13s %5s %7s %8s %9s %11s %8s\n", "frames", "text", "count", "skipped", "unparsed", "line blocks",
+         "us avg");
+  int textFrames = 0, textSkipped = 0, noneFrames = 0, noneSkipped = 0;
+  double us = 0;
+  int frames = 0;
+  for (size_t i = 0; i < kinds.size(); i++) {
+    const KindStats& k = kinds[i];
+    if (!k.frames) continue;
+    printf("%-13s %5s %7d %7.0f%% %9d %11.1f %8.0f\n", names[i].c_str(), hasText[i] ? "yes" : "no", k.frames,
+           100.0 * k.skipped / k.frames, k.unparsed, k.lineBlocks / k.frames, k.us / k.frames);
+    if (hasText[i]) {
+      textFrames += k.frames;
+      textSkipped += k.skipped;
+    } else {
+      noneFrames += k.frames;
+      noneSkipped += k.skipped;
+    }
+    us += k.us;
+    frames += k.frames;
+  }
+
+  int skipped = textSkipped + noneSkipped;
+  double precision = skipped ? (double)noneSkipped / skipped : 1.0;
+  double recall = noneFrames ? (double)noneSkipped / noneFrames : 0.0;
+  double lost = textFrames ? (double)textSkipped / textFrames : 0.0;
+  printf("\nskip precision %.1f%%, skip recall %.1f%%, text lost %.2f%% (%d of %d text frames)\n", 100 * precision,
+         100 * recall, 100 * lost, textSkipped, textFrames);
+  // Per touch: skips save the Vision round trip; every touch pays the check
+  double savedMs = opt.noTextShare * recall * opt.visionMs;
+  printf("with %.0f%% of touches at no text and %d ms to Vision: %.0f ms saved per touch on average, "
+         "%d ms on each skipped one; check %.0f us/frame here\n",
+         100 * opt.noTextShare, opt.visionMs, savedMs, opt.visionMs, frames ? us / frames : 0.0);
+  // Reading mode ends the resume delay after the answer, shorter for a skip
+  int pauseSavedMs = opt.visionMs + opt.resumeMs - opt.skipResumeMs;
+  printf("navigation paused %.0f ms less per touch on average, %d ms less on each skipped one\n",
+         opt.noTextShare * recall * pauseSavedMs, pauseSavedMs);
+  return textSkipped ? 1 : 0;
+}
@@ -0,0 +1,633 @@
+/*
+ * ============================================
+ * VisionAssist - Touch-to-Speech Benchmark
+ * ============================================
+ *
+ * Measures the reading-mode number users feel: touch to
+ * the first spoken word. Runs the eyewear's OCR path on
+ * the PC in real time, with real sockets, against local
+ * stand-ins:
+ *   eyewear  - loop() polling the touch pin every 10 ms,
+ *              OcrScheduler, the OCR task with its camera
+ *              frames (exposure frames, burst frames),
+ *              VisionBackend with the chunk publisher, and
+ *              OcrChunkLog behind ocrStatusJson()
+ *   Vision   - a mock images:annotate server on localhost
+ *              with a TLS handshake stand-in, upload and
+ *              download rates, think time and response size
+ *   phone    - a headless client following index_html:
+ *              /ocr_status every 100 ms while reading (400
+ *              ms otherwise), each poll one round trip; the
+ *              first chunk of a run starts speech, which
+ *              begins --tts-ms later
+ *
+ * Each run waits a random while, touches, and waits for
+ * the first word. Per stage and end to end it prints the
+ * latency spread; --csv prints every run instead. The
+ * defaults are typical figures: take measured ones from
+ * /metrics (visionassist_ocr_stage_ms) to model a unit.
+ *
+ * Usage:
+ *   program [--runs n] [--seed n] [--jpeg file | --jpeg-kb n]
+ *           [--burst n] [--frame-ms n] [--exposure-frames n]
+ *           [--handshake-ms n] [--server-ms n] [--jitter-ms n]
+ *           [--uplink-kbps n] [--downlink-kbps n]
+ *           [--text file | --chars n] [--response-kb n]
+ *           [--rtt-ms n] [--tts-ms n] [--csv]
+ *
+ * POSIX sockets (Linux / macOS).
+ * ============================================
+ */
+
+#include <HalPosix.h>
+#include <OcrText.h>
+#include <OcrChunks.h>
+#include <OcrBackend.h>
+#include <OcrConsensus.h>
+#include <OcrScheduler.h>
+#include <WebJson.h>
+#include <Arena.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <signal.h>
+
+// Firmware figures (Eyewear-S3/src/main.cpp)
+static const uint32_t LOOP_MS = 10;              // loop() period, polls the touch pin
+static const uint32_t OCR_TOUCH_DEADLINE = 15000;
+static const uint8_t OCR_TOUCH = 0;
+static const uint32_t POLL_READING_MS = 100;     // index_html pollOcr()
+static const uint32_t POLL_IDLE_MS = 400;
+
+static const char CANNED_TEXT[] =
+  "PLATFORM 2\nTrains to Colombo Fort.\nPlease stand behind the yellow line. "
+  "The next train departs at 10:45.";
+
+struct Options {
+  int runs = 50;
+  uint32_t seed = 1;
+  std::string jpeg;
+  int jpegKb = 30;
+  int burst = 1;
+  int frameMs = 50;          // SVGA frame interval
+  int exposureFrames = 3;    // ExposureController: a measured frame + 2 settling
+  int handshakeMs = 350;     // TLS to Vision, a new connection per request
+  int serverMs = 600;
+  int jitterMs = 150;
+  int uplinkKbps = 2000;
+  int downlinkKbps = 0;      // 0 = unthrottled
+  std::string text = CANNED_TEXT;
+  int responseKb = 0;        // read through before the text (unmasked geometry)
+  int rttMs = 20;            // phone <-> eyewear, per poll
+  int ttsMs = 150;           // speechSynthesis.speak() to onstart
+  bool csv = false;
+};
+
+static Options opt;
+static const std::chrono::steady_clock::time_point origin = std::chrono::steady_clock::now();
+
+static double nowMs() {
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - origin).count();
+}
+
+static void sleepMs(double ms) {
+  if (ms > 0) std::this_thread::sleep_for(std::chrono::microseconds((int64_t)(ms * 1000)));
+}
+
+static bool readFile(const std::string& path, std::string& out) {
+  FILE* f = fopen(path.c_str(), "rb");
+  if (!f) return false;
+  char buf[4096];
+  size_t n;
+  out.clear();
+  while ((n = fread(buf, 1, sizeof(buf), f)) > 0) out.append(buf, n);
+  fclose(f);
+  return true;
+}
+
+// ===========================================
+// Mock Vision
+// ===========================================
+// images:annotate: one response per image in the request, each with
+// --text; Connection: close like the real endpoint as the firmware uses it
+static std::atomic<uint32_t> visionRequests(0);
+
+static void serveVision(int fd, uint32_t seed) {
+  hal::setSocketTimeouts(fd, 30);
+  hal::SocketReader in(fd);
+  std::mt19937 rng(seed);
+  sleepMs(opt.handshakeMs);
+
+  std::string line;
+  size_t length = 0;
+  if (!in.readLine(line)) {
+    close(fd);
+    return;
+  }
+  for (;;) {
+    if (!in.readLine(line)) {
+      close(fd);
+      return;
+    }
+    if (line.empty()) break;
+    if (hal::iequalsPrefix(line, "content-length:")) length = strtoul(line.c_str() + 15, nullptr, 10);
+  }
+  std::string body;
+  if (!in.readExact(body, length)) {
+    close(fd);
+    return;
+  }
+  visionRequests++;
+  // The upload took this long on the eyewear's link
+  if (opt.uplinkKbps > 0) sleepMs(length * 8.0 / opt.uplinkKbps);
+
+  size_t images = 0;
+  for (size_t at = body.find("\"image\""); at != std::string::npos; at = body.find("\"image\"", at + 1)) images++;
+  std::uniform_int_distribution<int> jitter(-opt.jitterMs, opt.jitterMs);
+  sleepMs(opt.serverMs + jitter(rng));
+
+  std::string reply = "{\"responses\":[";
+  std::string text = escapeJson(opt.text);
+  for (size_t i = 0; i < images; i++) {
+    if (i) reply += ',';
+    reply += "{";
+    if (opt.responseKb > 0) reply += "\"pages\":[\"" + std::string((size_t)opt.responseKb * 1024, 'x') + "\"],";
+    reply += "\"fullTextAnnotation\":{\"text\":\"" + text + "\"}}";
+  }
+  reply += "]}";
+
+  char head[192];
+  int n = snprintf(head, sizeof(head),
+                   "HTTP/1.1 200 OK\r\nContent-Type: application/json; charset=UTF-8\r\n"
+                   "Content-Length: %zu\r\nConnection: close\r\n\r\n",
+                   reply.size());
+  hal::sendAll(fd, head, (size_t)n);
+  const size_t SEGMENT = 1460;
+  for (size_t at = 0; at < reply.size(); at += SEGMENT) {
+    size_t take = std::min(SEGMENT, reply.size() - at);
+    if (!hal::sendAll(fd, reply.data() + at, take)) break;
+    if (opt.downlinkKbps > 0) sleepMs(take * 8.0 / opt.downlinkKbps);
+  }
+  close(fd);
+}
+
+// Listens on a free localhost port; returns it (0 on failure)
+static int startVision() {
+  int server = socket(AF_INET, SOCK_STREAM, 0);
+  if (server < 0) return 0;
+  sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port = 0;
+  socklen_t len = sizeof(addr);
+  if (bind(server, (sockaddr*)&addr, sizeof(addr)) < 0 || listen(server, 8) < 0 ||
+      getsockname(server, (sockaddr*)&addr, &len) < 0) {
+    close(server);
+    return 0;
+  }
+  std::thread([server]() {
+    for (uint32_t conn = 0;; conn++) {
+      int fd = accept(server, nullptr, nullptr);
+      if (fd < 0) continue;
+      std::thread(serveVision, fd, opt.seed + conn).detach();
+    }
+  }).detach();
+  return ntohs(addr.sin_port);
+}
+
+// ===========================================
+// Eyewear
+// ===========================================
+// ms since the touch, per run; -1 = not reached
+struct RunTimes {
+  double touch = 0;        // absolute
+  double detected = -1;
+  double ocrStart = -1;
+  double captured = -1;
+  double encodeMs = 0;
+  double httpMs = 0;
+  double downloadMs = 0;
+  double firstChunk = -1;
+  double clientChunk = -1;
+  double firstWord = -1;
+  double done = -1;
+  int code = 0;
+  size_t chars = 0;
+};
+
+static hal::SteadyClock sysClock;
+static OcrScheduler scheduler(sysClock);
+
+// What handleOcrStatus() reads, under ocrTextMutex on the eyewear
+static std::mutex ocrTextMutex;
+static OcrChunkLog ocrChunks;
+static std::string ocrText;
+static bool newOcrAvailable = false;
+static std::atomic<bool> readingMode(false);
+static std::atomic<uint32_t> ocrRun(0);
+
+static std::mutex runMutex;
+static std::vector<RunTimes> runs;   // index = run - 1
+
+static RunTimes& current(uint32_t run) {
+  return runs[run - 1];
+}
+
+static std::atomic<bool> touchPending(false);
+static std::mutex queueMutex;
+static std::condition_variable queueReady;
+static bool queued = false;
+static OcrRequest queuedRequest;
+
+class ChunkPublisher : public OcrTextSink {
+public:
+  void onChunk(const char* text, size_t len) override {
+    std::lock_guard<std::mutex> lock(ocrTextMutex);
+    bool first = ocrChunks.count() == 0;
+    ocrChunks.add(text, len);
+    if (first && ocrChunks.count() > 0) {
+      std::lock_guard<std::mutex> r(runMutex);
+      RunTimes& t = current(ocrChunks.run());
+      t.firstChunk = nowMs() - t.touch;
+    }
+  }
+};
+
+// loop(): the touch pin edge queues a request
+static void loopTask() {
+  for (;;) {
+    if (touchPending.exchange(false)) {
+      {
+        std::lock_guard<std::mutex> r(runMutex);
+        RunTimes& t = runs.back();
+        t.detected = nowMs() - t.touch;
+      }
+      OcrRequest req = scheduler.submit(OCR_TOUCH, OCR_TOUCH_DEADLINE);
+      {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        queuedRequest = req;
+        queued = true;
+      }
+      queueReady.notify_one();
+    }
+    sleepMs(LOOP_MS);
+  }
+}
+
+// Waits for the next frame boundary, as esp_camera_fb_get() does
+static void nextFrame() {
+  double now = nowMs();
+  double next = ((int64_t)(now / opt.frameMs) + 1) * (double)opt.frameMs;
+  sleepMs(next - now);
+}
+
+// runOCR() for a touch: capture, recognize, publish chunks
+static void ocrTask(int port) {
+  hal::PosixHttp http(false);
+  char endpoint[64];
+  snprintf(endpoint, sizeof(endpoint), "http://127.0.0.1:%d/v1/images:annotate", port);
+  VisionBackend vision(sysClock, http, "host-benchmark-key", endpoint);
+  ChunkPublisher publisher;
+  std::vector<uint8_t> arenaMem(1024 * 1024);
+  Arena arena(arenaMem.data(), arenaMem.size());
+
+  std::string jpeg = opt.jpeg;
+  if (jpeg.empty()) {
+    std::mt19937 rng(opt.seed);
+    jpeg.resize((size_t)opt.jpegKb * 1024);
+    for (char& c : jpeg) c = (char)rng();
+  }
+  hal::Frame frame;
+  frame.buf = (const uint8_t*)jpeg.data();
+  frame.len = jpeg.size();
+  frame.width = 800;
+  frame.height = 600;
+
+  for (;;) {
+    OcrRequest req;
+    {
+      std::unique_lock<std::mutex> lock(queueMutex);
+      queueReady.wait(lock, [] { return queued; });
+      queued = false;
+      req = queuedRequest;
+    }
+    scheduler.begin(req);
+    OcrTicket ticket(scheduler, req);
+    readingMode = true;
+    uint32_t run;
+    {
+      std::lock_guard<std::mutex> lock(ocrTextMutex);
+      run = ++ocrRun;
+      ocrChunks.begin(run);
+    }
+    double touch;
+    {
+      std::lock_guard<std::mutex> r(runMutex);
+      touch = current(run).touch;
+      current(run).ocrStart = nowMs() - touch;
+    }
+
+    for (int i = 0; i < 1 + opt.exposureFrames; i++) nextFrame();
+    double captured = nowMs() - touch;
+
+    arena.reset();
+    ArenaAllocator<char> alloc(arena);
+    OcrTiming timing;
+    std::string text;
+    int code;
+    double encodeMs;
+    if (opt.burst <= 1) {
+      ArenaString out(alloc);
+      vision.setTimeout(scheduler.remaining(req));
+      code = vision.recognize(frame, chooseOcrFeature(OCR_MODE_AUTO, frame.len, frame.width, frame.height, 0),
+                              out, &publisher, &ticket, timing);
+      text.assign(out.data(), out.size());
+      encodeMs = timing.encodeMs;
+    } else {
+      // performBurstOCR(): each further frame encoded as it arrives
+      double started = nowMs();
+      OcrFeature feature = chooseOcrFeature(OCR_MODE_AUTO, frame.len, frame.width, frame.height, 0);
+      ArenaString json(alloc);
+      beginVisionBatch(json, visionBatchBytes(frame.len + frame.len / 2, opt.burst, feature));
+      for (int i = 0; i < opt.burst; i++) {
+        if (i) nextFrame();
+        addVisionBatchImage(frame.buf, frame.len, feature, json);
+      }
+      endVisionBatch(json);
+      encodeMs = nowMs() - started;
+
+      std::vector<ArenaString> texts(opt.burst, ArenaString(alloc));
+      vision.setTimeout(scheduler.remaining(req));
+      code = vision.recognizeBatch(json, (uint8_t)opt.burst, texts.data(), &ticket, timing);
+      std::vector<OcrCandidate> candidates;
+      for (const ArenaString& t : texts) candidates.push_back({ t.data(), t.length() });
+      uint8_t pick = pickConsensusText(candidates.data(), (uint8_t)opt.burst);
+      if (code == 200 && pick < opt.burst) {
+        text.assign(texts[pick].data(), texts[pick].size());
+        sendTextChunks(text.data(), text.size(), &publisher);
+      }
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(ocrTextMutex);
+      ocrChunks.finish();
+      ocrText = code == 200 ? text : "API Error: " + std::to_string(code);
+      newOcrAvailable = true;
+    }
+    scheduler.finish(code == 200 ? OCR_COMPLETED : OCR_FAILED);
+    {
+      std::lock_guard<std::mutex> r(runMutex);
+      RunTimes& t = current(run);
+      t.captured = captured;
+      t.encodeMs = encodeMs;
+      t.httpMs = timing.httpMs;
+      t.downloadMs = timing.downloadMs;
+      t.done = nowMs() - t.touch;
+      t.code = code;
+      t.chars = text.size();
+    }
+  }
+}
+
+// ===========================================
+// Headless Client
+// ===========================================
+static bool jsonInt(const std::string& json, const char* key, long& value) {
+  size_t at = json.find(key);
+  if (at == std::string::npos) return false;
+  value = strtol(json.c_str() + at + strlen(key), nullptr, 10);
+  return true;
+}
+
+static bool jsonTrue(const std::string& json, const char* key) {
+  size_t at = json.find(key);
+  return at != std::string::npos && json.compare(at + strlen(key), 4, "true") == 0;
+}
+
+// checkForNewOcr() / speakChunk(): follows chunk runs, speaks each in order
+static void clientTask() {
+  long chunkRun = -1;
+  long nextSeq = 0;
+  for (;;) {
+    sleepMs(opt.rttMs / 2.0);
+    std::string json;
+    {
+      // handleOcrStatus()
+      std::lock_guard<std::mutex> lock(ocrTextMutex);
+      long since = (uint32_t)chunkRun == ocrChunks.run() ? nextSeq : 0;
+      json = ocrStatusJson(newOcrAvailable, readingMode, ocrText, ocrChunks, (uint8_t)std::min(since, 255L));
+    }
+    sleepMs(opt.rttMs / 2.0);
+    double arrived = nowMs();
+
+    long run = 0;
+    jsonInt(json, "\"run\":", run);
+    bool reading = jsonTrue(json, "\"reading\":");
+    if (chunkRun < 0) {
+      // Page just loaded: don't replay an earlier read
+      chunkRun = run;
+      jsonInt(json, "\"next\":", nextSeq);
+    } else {
+      if (run != chunkRun) {
+        chunkRun = run;
+        nextSeq = 0;
+      }
+      for (size_t at = json.find("\"seq\":"); at != std::string::npos; at = json.find("\"seq\":", at + 1)) {
+        long seq = strtol(json.c_str() + at + 6, nullptr, 10);
+        if (seq != nextSeq) continue;
+        if (seq == 0 && run > 0) {
+          std::lock_guard<std::mutex> r(runMutex);
+          if ((size_t)run <= runs.size()) {
+            RunTimes& t = current((uint32_t)run);
+            t.clientChunk = arrived - t.touch;
+            t.firstWord = t.clientChunk + opt.ttsMs;   // utterance.onstart
+          }
+        }
+        nextSeq++;
+      }
+    }
+    sleepMs(reading ? POLL_READING_MS : POLL_IDLE_MS);
+  }
+}
+
+// ===========================================
+// Report
+// ===========================================
+struct Stage {
+  const char* name;
+  std::vector<double> ms;
+};
+
+static double percentile(const std::vector<double>& sorted, double p) {
+  if (sorted.empty()) return 0;
+  return sorted[std::min(sorted.size() - 1, (size_t)(p * (sorted.size() - 1) + 0.5))];
+}
+
+static void report(const std::vector<RunTimes>& done) {
+  Stage stages[] = {
+    { "touch detected (loop poll)", {} },
+    { "queued to OCR task", {} },
+    { "capture", {} },
+    { "encode", {} },
+    { "http (to headers)", {} },
+    { "download", {} },
+    { "first chunk, from touch", {} },
+    { "poll wait (chunk to phone)", {} },
+    { "speech start", {} },
+    { "FIRST WORD, from touch", {} },
+    { "text complete, from touch", {} },
+  };
+  int failed = 0;
+  for (const RunTimes& t : done) {
+    if (t.code != 200 || t.firstWord < 0) {
+      failed++;
+      continue;
+    }
+    double v[] = { t.detected,   t.ocrStart - t.detected, t.captured - t.ocrStart,
+                   t.encodeMs,   t.httpMs,                t.downloadMs,
+                   t.firstChunk, t.clientChunk - t.firstChunk,
+                   (double)opt.ttsMs, t.firstWord, t.done };
+    for (size_t i = 0; i < sizeof(v) / sizeof(v[0]); i++) stages[i].ms.push_back(v[i]);
+  }
+
+  printf("%d runs (%d failed), %zu KB JPEG, burst %d, Vision %d +- %d ms after a %d ms handshake, "
+         "%d chars\n\n",
+         (int)done.size(), failed, opt.jpeg.empty() ? (size_t)opt.jpegKb : opt.jpeg.size() / 1024, opt.burst,
+         opt.serverMs, opt.jitterMs, opt.handshakeMs, (int)opt.text.size());
+  printf("%-28s %8s %8s %8s %8s %8s  (ms)\n", "stage", "mean", "p50", "p90", "p99", "max");
+  for (Stage& s : stages) {
+    std::sort(s.ms.begin(), s.ms.end());
+    double sum = 0;
+    for (double v : s.ms) sum += v;
+    printf("%-28s %8.1f %8.1f %8.1f %8.1f %8.1f\n", s.name, s.ms.empty() ? 0 : sum / s.ms.size(),
+           percentile(s.ms, 0.5), percentile(s.ms, 0.9), percentile(s.ms, 0.99), percentile(s.ms, 1));
+  }
+}
+
+static void usage() {
+  fprintf(stderr, "usage: touch_bench [--runs n] [--seed n] [--jpeg file | --jpeg-kb n] [--burst n]\n"
+                  "                   [--frame-ms n] [--exposure-frames n] [--handshake-ms n]\n"
+                  "                   [--server-ms n] [--jitter-ms n] [--uplink-kbps n] [--downlink-kbps n]\n"
+                  "                   [--text file | --chars n] [--response-kb n] [--rtt-ms n] [--tts-ms n]\n"
+                  "                   [--csv]\n");
+}
+
+int main(int argc, char** argv) {
+  for (int i = 1; i < argc; i++) {
+    const char* a = argv[i];
+    bool more = i + 1 < argc;
+    if (!strcmp(a, "--runs") && more) opt.runs = atoi(argv[++i]);
+    else if (!strcmp(a, "--seed") && more) opt.seed = strtoul(argv[++i], nullptr, 0);
+    else if (!strcmp(a, "--jpeg-kb") && more) opt.jpegKb = atoi(argv[++i]);
+    else if (!strcmp(a, "--burst") && more) opt.burst = atoi(argv[++i]);
+    else if (!strcmp(a, "--frame-ms") && more) opt.frameMs = atoi(argv[++i]);
+    else if (!strcmp(a, "--exposure-frames") && more) opt.exposureFrames = atoi(argv[++i]);
+    else if (!strcmp(a, "--handshake-ms") && more) opt.handshakeMs = atoi(argv[++i]);
+    else if (!strcmp(a, "--server-ms") && more) opt.serverMs = atoi(argv[++i]);
+    else if (!strcmp(a, "--jitter-ms") && more) opt.jitterMs = atoi(argv[++i]);
+    else if (!strcmp(a, "--uplink-kbps") && more) opt.uplinkKbps = atoi(argv[++i]);
+    else if (!strcmp(a, "--downlink-kbps") && more) opt.downlinkKbps = atoi(argv[++i]);
+    else if (!strcmp(a, "--response-kb") && more) opt.responseKb = atoi(argv[++i]);
+    else if (!strcmp(a, "--rtt-ms") && more) opt.rttMs = atoi(argv[++i]);
+    else if (!strcmp(a, "--tts-ms") && more) opt.ttsMs = atoi(argv[++i]);
+    else if (!strcmp(a, "--csv")) opt.csv = true;
+    else if (!strcmp(a, "--chars") && more) {
+      // The canned text repeated to length: longer pages
+      size_t n = strtoul(argv[++i], nullptr, 10);
+      std::string base = CANNED_TEXT;
+      opt.text.clear();
+      while (opt.text.size() < n) opt.text += base + "\n";
+      opt.text.resize(n);
+    } else if ((!strcmp(a, "--jpeg") || !strcmp(a, "--text")) && more) {
+      std::string& out = a[2] == 'j' ? opt.jpeg : opt.text;
+      if (!readFile(argv[++i], out) || out.empty()) {
+        fprintf(stderr, "can't read %s\n", argv[i]);
+        return 2;
+      }
+    } else {
+      usage();
+      return 2;
+    }
+  }
+  if (opt.runs < 1 || opt.frameMs < 1 || opt.burst < 1 || opt.burst > 3) {
+    usage();
+    return 2;
+  }
+  signal(SIGPIPE, SIG_IGN);
+
+  int port = startVision();
+  if (!port) {
+    perror("mock Vision");
+    return 2;
+  }
+  runs.reserve(opt.runs);
+  std::thread(loopTask).detach();
+  std::thread(ocrTask, port).detach();
+  std::thread(clientTask).detach();
+  sleepMs(POLL_IDLE_MS * 2);   // the page has loaded
+
+  std::mt19937 rng(opt.seed);
+  std::uniform_real_distribution<double> idle(300, 1300);
+  if (opt.csv) {
+    printf("run,detected,ocr_start,captured,encode,http,download,first_chunk,client_chunk,first_word,done,code,"
+           "chars\n");
+  }
+  for (int i = 0; i < opt.runs; i++) {
+    sleepMs(idle(rng));
+    {
+      std::lock_guard<std::mutex> r(runMutex);
+      runs.push_back(RunTimes());
+      runs.back().touch = nowMs();
+    }
+    touchPending = true;
+
+    // Until the first word and the end of the run, or the deadline
+    for (;;) {
+      sleepMs(5);
+      std::lock_guard<std::mutex> r(runMutex);
+      const RunTimes& t = runs.back();
+      bool finished = t.done >= 0 && (t.firstWord >= 0 || t.code != 200 || t.chars == 0);
+      if (finished || nowMs() - t.touch > OCR_TOUCH_DEADLINE + 1000) break;
+    }
+    readingMode = false;   // /tts_done
+    {
+      std::lock_guard<std::mutex> lock(ocrTextMutex);
+      newOcrAvailable = false;   // /ocr_ack
+    }
+
+    if (opt.csv) {
+      std::lock_guard<std::mutex> r(runMutex);
+      const RunTimes& t = runs.back();
+      printf("%d,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%d,%zu\n", i + 1, t.detected, t.ocrStart,
+             t.captured, t.encodeMs, t.httpMs, t.downloadMs, t.firstChunk, t.clientChunk, t.firstWord, t.done,
+             t.code, t.chars);
+      fflush(stdout);
+    }
+  }
+
+  std::vector<RunTimes> done;
+  {
+    std::lock_guard<std::mutex> r(runMutex);
+    done = runs;
+  }
+  if (!opt.csv) report(done);
+  int failed = 0;
+  for (const RunTimes& t : done) {
+    if (t.code != 200 || t.firstWord < 0) failed++;
+  }
+  // Threads are detached and blocked; leave without joining them
+  fflush(stdout);
+  _exit(failed ? 1 : 0);
+}
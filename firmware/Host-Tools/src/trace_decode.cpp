@@ -0,0 +1,175 @@
+/*
+ * ============================================
+ * VisionAssist - Trace Decoder
+ * ============================================
+ *
+ * Turns the binary trace frames written by either unit's
+ * trace drain task back into log lines or a CSV timeline.
+ * Plain text printed on the same serial port (boot log,
+ * OCR text) is passed through unchanged.
+ *
+ * Usage:
+ *   program [--csv] [--no-text] [file]      (default: stdin)
+ *
+ * Capture with e.g.
+ *   pio device monitor --raw > capture.bin
+ *   stty -F /dev/ttyACM0 115200 raw && cat /dev/ttyACM0 | program
+ *
+ * --csv prints "unit,us,event,name,a,b" for timelines.
+ * Sequence gaps (ring overflow, corrupted frames) are
+ * reported as lost records.
+ * ============================================
+ */
+
+#include <Trace.h>
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+struct EventInfo {
+  uint16_t id;
+  int level;
+  const char* name;
+  const char* format;
+};
+
+#define TRACE_EVENT_INFO(name, id, level, fmt) { id, level, #name, fmt },
+static const EventInfo EVENTS[] = { TRACE_EVENTS(TRACE_EVENT_INFO) };
+#undef TRACE_EVENT_INFO
+
+static const EventInfo* lookup(uint16_t id) {
+  for (const EventInfo& e : EVENTS) if (e.id == id) return &e;
+  return nullptr;
+}
+
+struct UnitState {
+  bool seen = false;
+  uint16_t nextSeq = 0;
+  uint32_t lastUs = 0;
+  uint64_t wraps = 0;     // micros() wraps every ~71 minutes
+  uint64_t lost = 0;
+  uint64_t records = 0;
+};
+
+static bool csv = false;
+static bool showText = true;
+static UnitState units[256];
+
+static void printRecord(char unit, const TraceRecord& r) {
+  UnitState& u = units[(uint8_t)unit];
+  if (u.seen && r.seq != u.nextSeq) {
+    uint16_t gap = (uint16_t)(r.seq - u.nextSeq);
+    u.lost += gap;
+    if (!csv) printf("[%c] ⚠️ %u trace records lost\n", unit, gap);
+  }
+  if (u.seen && r.us < u.lastUs) u.wraps++;
+  u.seen = true;
+  u.nextSeq = r.seq + 1;
+  u.lastUs = r.us;
+  u.records++;
+
+  uint64_t us = (u.wraps << 32) + r.us;
+  const EventInfo* e = lookup(r.event);
+
+  if (csv) {
+    printf("%c,%llu,%u,%s,%d,%d\n", unit, (unsigned long long)us, r.event,
+           e ? e->name : "UNKNOWN", r.a, r.b);
+    return;
+  }
+
+  static const char LEVELS[] = "?EWID";
+  char text[160];
+  if (e) {
+    snprintf(text, sizeof(text), e->format, r.a, r.b);
+  } else {
+    snprintf(text, sizeof(text), "event 0x%04x (%d, %d)", r.event, r.a, r.b);
+  }
+  printf("[%c %6llu.%06llu] %c %s\n", unit, (unsigned long long)(us / 1000000),
+         (unsigned long long)(us % 1000000), e ? LEVELS[e->level] : '?', text);
+}
+
+// Returns bytes consumed from `p` (0 = need more input)
+static size_t parse(const uint8_t* p, size_t len, bool final) {
+  size_t i = 0;
+  std::string text;
+
+  while (i < len) {
+    if (p[i] != TRACE_FRAME_MAGIC0) {
+      text += (char)p[i++];
+      continue;
+    }
+    if (len - i < 4) {
+      if (!final) break;
+      text += (char)p[i++];
+      continue;
+    }
+    uint8_t count = p[i + 3];
+    if (p[i + 1] != TRACE_FRAME_MAGIC1 || count == 0 || count > TRACE_FRAME_MAX_RECORDS) {
+      text += (char)p[i++];
+      continue;
+    }
+    size_t frameLen = 4 + count * sizeof(TraceRecord) + 1;
+    if (len - i < frameLen) {
+      if (!final) break;
+      text += (char)p[i++];
+      continue;
+    }
+    uint8_t check = 0;
+    for (size_t k = i + 4; k < i + frameLen - 1; k++) check ^= p[k];
+    if (check != p[i + frameLen - 1]) {
+      text += (char)p[i++];
+      continue;
+    }
+
+    if (showText && !text.empty() && !csv) fputs(text.c_str(), stdout);
+    text.clear();
+
+    char unit = (char)p[i + 2];
+    for (uint8_t n = 0; n < count; n++) {
+      TraceRecord r;
+      memcpy(&r, p + i + 4 + n * sizeof(TraceRecord), sizeof(r));
+      printRecord(unit, r);
+    }
+    i += frameLen;
+  }
+
+  if (showText && !text.empty() && !csv) fputs(text.c_str(), stdout);
+  return i;
+}
+
+int main(int argc, char** argv) {
+  const char* path = nullptr;
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--csv")) csv = true;
+    else if (!strcmp(argv[i], "--no-text")) showText = false;
+    else path = argv[i];
+  }
+
+  FILE* in = path ? fopen(path, "rb") : stdin;
+  if (!in) {
+    fprintf(stderr, "cannot open %s\n", path);
+    return 2;
+  }
+  if (csv) printf("unit,us,event,name,a,b\n");
+
+  std::vector<uint8_t> buf;
+  uint8_t chunk[4096];
+  size_t n;
+  while ((n = fread(chunk, 1, sizeof(chunk), in)) > 0) {
+    buf.insert(buf.end(), chunk, chunk + n);
+    size_t used = parse(buf.data(), buf.size(), false);
+    buf.erase(buf.begin(), buf.begin() + used);
+    fflush(stdout);
+  }
+  parse(buf.data(), buf.size(), true);
+  if (path) fclose(in);
+
+  for (int u = 0; u < 256; u++) {
+    if (units[u].records == 0) continue;
+    fprintf(stderr, "[%c] %llu records, %llu lost\n", u,
+            (unsigned long long)units[u].records, (unsigned long long)units[u].lost);
+  }
+  return 0;
+}
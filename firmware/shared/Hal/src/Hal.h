@@ -0,0 +1,131 @@
+/*
+ * ============================================
+ * VisionAssist - Hardware Abstraction Layer
+ * ============================================
+ *
+ * Thin interfaces over the hardware the core logic touches.
+ * The firmware binds them to Arduino / ESP-IDF (HalArduino.h
+ * and each unit's src/), host builds bind them to fakes
+ * (HalHost.h) so the same logic runs on Linux.
+ * ============================================
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace hal {
+
+class Clock {
+public:
+  virtual ~Clock() {}
+  virtual uint32_t millis() = 0;
+  virtual uint32_t micros() = 0;
+  virtual void delay(uint32_t ms) = 0;
+};
+
+class Gpio {
+public:
+  virtual ~Gpio() {}
+  virtual int digitalRead(uint8_t pin) = 0;
+  virtual void digitalWrite(uint8_t pin, int level) = 0;
+  virtual void analogWrite(uint8_t pin, uint8_t duty) = 0;
+};
+
+// Distance sensor, modelled on the VL53L1X polling API
+class Tof {
+public:
+  virtual ~Tof() {}
+  virtual bool dataReady() = 0;
+  virtual int distance() = 0;      // mm, <= 0 on error
+  virtual void clearInterrupt() = 0;
+
+  // Multi-zone sensors range one zone at a time: zone() is the
+  // zone of the last distance(), clearInterrupt() moves on to
+  // the next one. Zones run left to right as the wearer sees them.
+  virtual uint8_t zoneCount() const { return 1; }
+  virtual uint8_t zone() const { return 0; }
+};
+
+struct Frame {
+  const uint8_t* buf = nullptr;
+  size_t len = 0;
+  uint16_t width = 0;              // pixels, 0 if unknown
+  uint16_t height = 0;
+  uint32_t ms = 0;                 // millis() when the frame ended, 0 if unknown
+  void* handle = nullptr;          // backend specific (camera_fb_t* on ESP32)
+};
+
+class Camera {
+public:
+  virtual ~Camera() {}
+  virtual bool capture(Frame& frame) = 0;
+  virtual void release(Frame& frame) = 0;
+
+  // Manual exposure (sensor rows) and gain step for the next frames;
+  // false where the sensor does not support it
+  virtual bool setExposure(uint16_t lines, uint8_t gain) {
+    (void)lines;
+    (void)gain;
+    return false;
+  }
+  // Back to the sensor's own AEC/AGC
+  virtual void autoExposure() {}
+
+  // Sensor standby (no frames, settings kept); false where unsupported
+  virtual bool setStandby(bool standby) {
+    (void)standby;
+    return false;
+  }
+};
+
+class Radio {
+public:
+  virtual ~Radio() {}
+  virtual bool send(const uint8_t* mac, const uint8_t* data, size_t len) = 0;
+};
+
+// Byte-at-a-time reader (WiFiClient on ESP32)
+class ByteStream {
+public:
+  virtual ~ByteStream() {}
+  virtual int available() = 0;
+  virtual int read() = 0;          // -1 when nothing is available
+};
+
+// Counts the bytes read through another stream
+class CountingStream : public ByteStream {
+public:
+  explicit CountingStream(ByteStream& inner) : inner(inner) {}
+  int available() override { return inner.available(); }
+  int read() override {
+    int c = inner.read();
+    if (c >= 0) count++;
+    return c;
+  }
+  size_t bytes() const { return count; }
+
+private:
+  ByteStream& inner;
+  size_t count = 0;
+};
+
+class Http {
+public:
+  virtual ~Http() {}
+  // Returns the HTTP status code, or a negative transport error
+  virtual int post(const char* url, const char* contentType,
+                   const uint8_t* body, size_t len) = 0;
+  // Response body of the last successful post(), valid until end()
+  virtual ByteStream* responseStream() = 0;
+  // Content-Length of that response, -1 if not sent
+  virtual int responseSize() { return -1; }
+  // Applies to the next post()
+  virtual void setTimeout(uint32_t ms) { (void)ms; }
+  virtual void end() = 0;
+  // end() that never keeps the connection (body not read to the end)
+  virtual void abort() { end(); }
+};
+
+}  // namespace hal
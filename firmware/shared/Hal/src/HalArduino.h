@@ -0,0 +1,40 @@
+/*
+ * ============================================
+ * VisionAssist - HAL bindings shared by both units
+ * ============================================
+ */
+
+#pragma once
+
+#ifdef ARDUINO
+
+#include <Arduino.h>
+#include <esp_now.h>
+#include "Hal.h"
+
+namespace hal {
+
+class ArduinoClock : public Clock {
+public:
+  uint32_t millis() override { return ::millis(); }
+  uint32_t micros() override { return ::micros(); }
+  void delay(uint32_t ms) override { ::delay(ms); }
+};
+
+class ArduinoGpio : public Gpio {
+public:
+  int digitalRead(uint8_t pin) override { return ::digitalRead(pin); }
+  void digitalWrite(uint8_t pin, int level) override { ::digitalWrite(pin, level); }
+  void analogWrite(uint8_t pin, uint8_t duty) override { ::analogWrite(pin, duty); }
+};
+
+class EspNowRadio : public Radio {
+public:
+  bool send(const uint8_t* mac, const uint8_t* data, size_t len) override {
+    return esp_now_send(mac, data, len) == ESP_OK;
+  }
+};
+
+}  // namespace hal
+
+#endif  // ARDUINO
@@ -0,0 +1,147 @@
+/*
+ * ============================================
+ * VisionAssist - HAL fakes for host builds
+ * ============================================
+ *
+ * Virtual clock, recording GPIO, scripted TOF and camera and
+ * in-memory streams used by the native envs and
+ * firmware/Host-Tools.
+ * ============================================
+ */
+
+#pragma once
+
+#ifndef ARDUINO
+
+#include <string.h>
+#include <string>
+#include <vector>
+#include "Hal.h"
+
+namespace hal {
+
+class VirtualClock : public Clock {
+public:
+  uint32_t millis() override { return (uint32_t)(nowUs / 1000); }
+  uint32_t micros() override { return (uint32_t)nowUs; }
+  void delay(uint32_t ms) override { nowUs += (uint64_t)ms * 1000; }
+
+  void set(uint32_t ms) { nowUs = (uint64_t)ms * 1000; }
+  void advanceUs(uint64_t us) { nowUs += us; }
+
+private:
+  uint64_t nowUs = 0;
+};
+
+// Remembers the last level written to each pin
+class RecordingGpio : public Gpio {
+public:
+  int digitalRead(uint8_t pin) override { return levels[pin]; }
+  void digitalWrite(uint8_t pin, int level) override { levels[pin] = level ? 255 : 0; }
+  void analogWrite(uint8_t pin, uint8_t duty) override { levels[pin] = duty; }
+
+  void setInput(uint8_t pin, int level) { levels[pin] = level; }
+  int level(uint8_t pin) const { return levels[pin]; }
+
+private:
+  int levels[64] = {};
+};
+
+// Returns whatever distance the test harness last set
+class ScriptedTof : public Tof {
+public:
+  explicit ScriptedTof(uint8_t zones = 1) : zones(zones) {}
+
+  bool dataReady() override { return ready; }
+  int distance() override { return value; }
+  void clearInterrupt() override { ready = false; }
+  uint8_t zoneCount() const override { return zones; }
+  uint8_t zone() const override { return current; }
+
+  void push(int mm, uint8_t zone = 0) { value = mm; current = zone; ready = true; }
+
+private:
+  uint8_t zones;
+  uint8_t current = 0;
+  bool ready = false;
+  int value = 0;
+};
+
+// Streams a frame every periodMs of the virtual clock. Like the
+// OV2640 driver, it keeps its last frame through standby and hands
+// that one out first after waking.
+class ScriptedCamera : public Camera {
+public:
+  explicit ScriptedCamera(VirtualClock& clock, uint32_t periodMs = 40)
+    : clock(clock), periodMs(periodMs) {}
+
+  bool capture(Frame& frame) override {
+    if (standby) return false;
+    if (held) {
+      held = false;
+    } else {
+      clock.delay(periodMs);
+      lastMs = clock.millis();
+    }
+    frame.buf = jpeg;
+    frame.len = sizeof(jpeg);
+    frame.ms = lastMs;
+    captures++;
+    return true;
+  }
+  void release(Frame& frame) override { frame.buf = nullptr; }
+
+  bool setStandby(bool on) override {
+    if (on && !standby) held = lastMs != 0;
+    standby = on;
+    return true;
+  }
+
+  bool inStandby() const { return standby; }
+  uint32_t captures = 0;
+
+private:
+  VirtualClock& clock;
+  uint32_t periodMs;
+  uint32_t lastMs = 0;
+  bool held = false;
+  bool standby = false;
+  uint8_t jpeg[4] = { 0xFF, 0xD8, 0xFF, 0xD9 };
+};
+
+class MemoryStream : public ByteStream {
+public:
+  MemoryStream() {}
+  explicit MemoryStream(const std::string& data) : bytes(data) {}
+
+  void assign(const std::string& data) { bytes = data; pos = 0; }
+  int available() override { return (int)(bytes.size() - pos); }
+  int read() override { return pos < bytes.size() ? (uint8_t)bytes[pos++] : -1; }
+
+private:
+  std::string bytes;
+  size_t pos = 0;
+};
+
+// Collects every frame sent
+class RecordingRadio : public Radio {
+public:
+  struct Sent {
+    uint8_t mac[6];
+    std::vector<uint8_t> data;
+  };
+
+  bool send(const uint8_t* mac, const uint8_t* data, size_t len) override {
+    Sent s;
+    memcpy(s.mac, mac, 6);
+    s.data.assign(data, data + len);
+    sent.push_back(s);
+    return true;
+  }
+
+  std::vector<Sent> sent;
+};
+
+}  // namespace hal
+
+#endif  // !ARDUINO
@@ -0,0 +1,266 @@
+/*
+ * ============================================
+ * VisionAssist - POSIX HAL for host tools
+ * ============================================
+ *
+ * Real time and real sockets for the Host-Tools that talk
+ * to servers: a steady clock, and plain-HTTP hal::Http
+ * (the host counterpart of ArduinoHttp) with the socket
+ * helpers it is built on. Linux / macOS.
+ * ============================================
+ */
+
+#pragma once
+
+#ifndef ARDUINO
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "Hal.h"
+
+namespace hal {
+
+// Buffered reader over a blocking socket
+class SocketReader {
+public:
+  explicit SocketReader(int fd) : fd(fd) {}
+
+  int get() {
+    if (pos == len && fill() <= 0) return -1;
+    return (uint8_t)buf[pos++];
+  }
+
+  // Buffered bytes, or waits for the next segment; 0 once closed
+  int fill() {
+    if (pos < len) return (int)(len - pos);
+    ssize_t n = recv(fd, buf, sizeof(buf), 0);
+    if (n <= 0) return 0;
+    pos = 0;
+    len = (size_t)n;
+    return (int)n;
+  }
+
+  // One header line without its CRLF; false on EOF or an overlong line
+  bool readLine(std::string& line) {
+    line.clear();
+    for (;;) {
+      int c = get();
+      if (c < 0) return false;
+      if (c == '\n') break;
+      if (c != '\r') line += (char)c;
+      if (line.size() > 8192) return false;
+    }
+    return true;
+  }
+
+  bool readExact(std::string& out, size_t n) {
+    out.clear();
+    out.reserve(n);
+    while (out.size() < n) {
+      if (fill() <= 0) return false;
+      size_t take = std::min(len - pos, n - out.size());
+      out.append(buf + pos, take);
+      pos += take;
+    }
+    return true;
+  }
+
+private:
+  int fd;
+  char buf[4096];
+  size_t pos = 0;
+  size_t len = 0;
+};
+
+inline bool sendAll(int fd, const void* data, size_t len) {
+  const char* p = (const char*)data;
+  while (len > 0) {
+    ssize_t n = send(fd, p, len, MSG_NOSIGNAL);
+    if (n <= 0) return false;
+    p += n;
+    len -= (size_t)n;
+  }
+  return true;
+}
+
+inline void setSocketTimeouts(int fd, int seconds) {
+  timeval tv = { seconds, 0 };
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+  setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+  int one = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+}
+
+inline bool iequalsPrefix(const std::string& s, const char* prefix) {
+  size_t n = strlen(prefix);
+  if (s.size() < n) return false;
+  for (size_t i = 0; i < n; i++) {
+    if (tolower((uint8_t)s[i]) != tolower((uint8_t)prefix[i])) return false;
+  }
+  return true;
+}
+
+// Real time, for tools that talk to real servers
+class SteadyClock : public Clock {
+public:
+  uint32_t millis() override { return (uint32_t)(micros() / 1000); }
+  uint32_t micros() override {
+    return (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+  void delay(uint32_t ms) override { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); }
+};
+
+// Plain-HTTP hal::Http, the host counterpart of ArduinoHttp
+class PosixHttp : public Http {
+public:
+  explicit PosixHttp(bool keepAlive) : keepAlive(keepAlive) {}
+  ~PosixHttp() override { disconnect(); }
+
+  int post(const char* url, const char* contentType, const uint8_t* body, size_t len) override {
+    std::string host, port, path;
+    if (!parseUrl(url, host, port, path)) return -1;
+    if (fd >= 0 && (host != connHost || port != connPort)) disconnect();
+
+    std::string head = "POST " + path + " HTTP/1.1\r\nHost: " + host + "\r\nContent-Type: " + contentType +
+                       "\r\nContent-Length: " + std::to_string(len) + "\r\nConnection: " +
+                       (keepAlive ? "keep-alive" : "close") + "\r\n\r\n";
+
+    // A kept-alive connection the server has dropped fails here: retry once
+    for (int attempt = 0; attempt < 2; attempt++) {
+      bool reused = fd >= 0;
+      if (!reused && !connect(host, port)) return -1;
+      if (sendAll(fd, head.data(), head.size()) && sendAll(fd, body, len)) {
+        int code = readHead();
+        if (code > 0) return code;
+      }
+      disconnect();
+      if (!reused) break;
+    }
+    return -1;
+  }
+
+  ByteStream* responseStream() override { return &stream; }
+  int responseSize() override { return contentLength; }
+
+  void end() override {
+    // Unread body or a server that closes: the connection can't be reused
+    if (!keepAlive || closeAfter || stream.remaining() != 0) disconnect();
+  }
+
+  uint32_t connects() const { return connectCount; }
+
+private:
+  class BodyStream : public ByteStream {
+  public:
+    void attach(SocketReader* r, int length) {
+      reader = r;
+      left = length;
+    }
+    int remaining() const { return left; }   // -1 = until close
+    int available() override {
+      if (!reader || left == 0) return 0;
+      int n = reader->fill();
+      return left > 0 ? std::min(n, left) : n;
+    }
+    int read() override {
+      if (!reader || left == 0) return -1;
+      int c = reader->get();
+      if (c >= 0 && left > 0) left--;
+      return c;
+    }
+
+  private:
+    SocketReader* reader = nullptr;
+    int left = 0;
+  };
+
+  static bool parseUrl(const char* url, std::string& host, std::string& port, std::string& path) {
+    if (strncmp(url, "http://", 7) != 0) return false;
+    std::string rest = url + 7;
+    size_t slash = rest.find('/');
+    std::string authority = rest.substr(0, slash);
+    path = slash == std::string::npos ? "/" : rest.substr(slash);
+    size_t colon = authority.find(':');
+    host = authority.substr(0, colon);
+    port = colon == std::string::npos ? "80" : authority.substr(colon + 1);
+    return !host.empty();
+  }
+
+  bool connect(const std::string& host, const std::string& port) {
+    addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* res = nullptr;
+    if (getaddrinfo(host.c_str(), port.c_str(), &hints, &res) != 0) return false;
+    for (addrinfo* a = res; a && fd < 0; a = a->ai_next) {
+      fd = socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+      if (fd >= 0 && ::connect(fd, a->ai_addr, a->ai_addrlen) < 0) {
+        close(fd);
+        fd = -1;
+      }
+    }
+    freeaddrinfo(res);
+    if (fd < 0) return false;
+    setSocketTimeouts(fd, 15);
+    reader.reset(new SocketReader(fd));
+    connHost = host;
+    connPort = port;
+    connectCount++;
+    return true;
+  }
+
+  void disconnect() {
+    stream.attach(nullptr, 0);
+    if (fd >= 0) close(fd);
+    fd = -1;
+    reader.reset();
+  }
+
+  int readHead() {
+    std::string line;
+    if (!reader->readLine(line)) return -1;
+    int code = 0;
+    if (sscanf(line.c_str(), "HTTP/%*s %d", &code) != 1) return -1;
+    contentLength = -1;
+    closeAfter = false;
+    for (;;) {
+      if (!reader->readLine(line)) return -1;
+      if (line.empty()) break;
+      if (iequalsPrefix(line, "content-length:")) contentLength = atoi(line.c_str() + 15);
+      else if (iequalsPrefix(line, "connection:") && line.find("close") != std::string::npos) closeAfter = true;
+    }
+    if (contentLength < 0) closeAfter = true;
+    stream.attach(reader.get(), contentLength);
+    return code;
+  }
+
+  bool keepAlive;
+  int fd = -1;
+  std::unique_ptr<SocketReader> reader;
+  BodyStream stream;
+  std::string connHost;
+  std::string connPort;
+  int contentLength = -1;
+  bool closeAfter = false;
+  uint32_t connectCount = 0;
+};
+
+}  // namespace hal
+
+#endif  // !ARDUINO
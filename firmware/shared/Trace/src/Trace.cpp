@@ -0,0 +1,113 @@
+#include "Trace.h"
+
+#include <string.h>
+
+#ifdef ARDUINO
+#include <freertos/FreeRTOS.h>
+static portMUX_TYPE traceMux = portMUX_INITIALIZER_UNLOCKED;
+#define TRACE_LOCK() portENTER_CRITICAL(&traceMux)
+#define TRACE_UNLOCK() portEXIT_CRITICAL(&traceMux)
+#else
+// Host tools are single threaded
+#define TRACE_LOCK()
+#define TRACE_UNLOCK()
+#endif
+
+static_assert((TRACE_RING_RECORDS & (TRACE_RING_RECORDS - 1)) == 0, "TRACE_RING_RECORDS must be a power of two");
+static_assert(sizeof(TraceRecord) == 16, "trace records are 16 bytes on the wire");
+
+static TraceRecord ring[TRACE_RING_RECORDS];
+static uint32_t head = 0;        // next write
+static uint32_t tail = 0;        // next read
+static uint16_t seq = 0;
+static uint32_t dropped = 0;
+static hal::Clock* traceClock = nullptr;
+static char unitTag = '?';
+
+void traceBegin(hal::Clock& clock, char unit) {
+  traceClock = &clock;
+  unitTag = unit;
+}
+
+void traceEmit(uint16_t event, int32_t a, int32_t b) {
+  uint32_t us = traceClock ? traceClock->micros() : 0;
+  TRACE_LOCK();
+  if (head - tail >= TRACE_RING_RECORDS) {
+    dropped++;
+    seq++;
+  } else {
+    TraceRecord& r = ring[head & (TRACE_RING_RECORDS - 1)];
+    r.us = us;
+    r.event = event;
+    r.seq = seq++;
+    r.a = a;
+    r.b = b;
+    head++;
+  }
+  TRACE_UNLOCK();
+}
+
+size_t traceDrain(uint8_t* out, size_t cap) {
+  if (cap < 5 + sizeof(TraceRecord)) return 0;
+  size_t room = (cap - 5) / sizeof(TraceRecord);
+  if (room > TRACE_FRAME_MAX_RECORDS) room = TRACE_FRAME_MAX_RECORDS;
+
+  uint8_t* p = out + 4;
+  uint8_t count = 0;
+  uint8_t check = 0;
+
+  TRACE_LOCK();
+  while (tail != head && count < room) {
+    memcpy(p, &ring[tail & (TRACE_RING_RECORDS - 1)], sizeof(TraceRecord));
+    tail++;
+    count++;
+    p += sizeof(TraceRecord);
+  }
+  TRACE_UNLOCK();
+
+  if (count == 0) return 0;
+  for (uint8_t* q = out + 4; q < p; q++) check ^= *q;
+  out[0] = TRACE_FRAME_MAGIC0;
+  out[1] = TRACE_FRAME_MAGIC1;
+  out[2] = (uint8_t)unitTag;
+  out[3] = count;
+  *p++ = check;
+  return p - out;
+}
+
+uint32_t traceTakeDropped() {
+  TRACE_LOCK();
+  uint32_t n = dropped;
+  dropped = 0;
+  TRACE_UNLOCK();
+  return n;
+}
+
+uint32_t traceMeasureCostNs(int samples) {
+  if (!traceClock || samples <= 0) return 0;
+
+  TRACE_LOCK();
+  uint32_t savedHead = head, savedDropped = dropped;
+  uint16_t savedSeq = seq;
+  TRACE_UNLOCK();
+
+  uint32_t start = traceClock->micros();
+  for (int i = 0; i < samples; i++) {
+    traceEmit(TR_COST, i, 0);
+    // Keep the ring from filling so the stored path is what gets timed
+    if ((i & (TRACE_RING_RECORDS / 2 - 1)) == TRACE_RING_RECORDS / 2 - 1) {
+      TRACE_LOCK();
+      head = savedHead;
+      TRACE_UNLOCK();
+    }
+  }
+  uint32_t elapsed = traceClock->micros() - start;
+
+  TRACE_LOCK();
+  head = savedHead;
+  seq = savedSeq;
+  dropped = savedDropped;
+  TRACE_UNLOCK();
+
+  return (uint32_t)((uint64_t)elapsed * 1000 / samples);
+}
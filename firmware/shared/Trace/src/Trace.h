@@ -0,0 +1,73 @@
+/*
+ * ============================================
+ * VisionAssist - Deferred Binary Trace
+ * ============================================
+ *
+ * TRACE(event, a, b) stores a 16-byte record (time, event
+ * id, sequence, two int args) in a RAM ring and returns;
+ * nothing is formatted or printed on the caller's path.
+ * A low-priority task calls traceDrain() and writes the
+ * framed records to serial, where Host-Tools/trace_decode
+ * turns them back into log lines and timelines.
+ *
+ * Events above TRACE_LEVEL (build flag, default INFO) are
+ * compiled out. A full ring drops new records and counts
+ * them; producers never block.
+ *
+ * Frame on the wire:
+ *   0xA5 'T' unit count record[count] checksum
+ * checksum = XOR of the record bytes. Text printed on the
+ * same port between frames is passed through by the decoder.
+ * ============================================
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <Hal.h>
+#include "TraceEvents.h"
+
+#ifndef TRACE_LEVEL
+#define TRACE_LEVEL TRACE_LEVEL_INFO
+#endif
+
+#ifndef TRACE_RING_RECORDS
+#define TRACE_RING_RECORDS 256     // 4 KB, power of two
+#endif
+
+#define TRACE_FRAME_MAGIC0 0xA5
+#define TRACE_FRAME_MAGIC1 'T'
+#define TRACE_FRAME_MAX_RECORDS 32
+
+struct __attribute__((packed)) TraceRecord {
+  uint32_t us;      // hal::Clock::micros()
+  uint16_t event;
+  uint16_t seq;     // gaps = dropped records
+  int32_t a;
+  int32_t b;
+};
+
+// Time source and unit tag ('E' eyewear, 'H' handband)
+void traceBegin(hal::Clock& clock, char unit);
+
+// Store one record; safe from any task
+void traceEmit(uint16_t event, int32_t a, int32_t b);
+
+// Encode up to one frame of pending records into `out`
+// (needs 5 + 16 * TRACE_FRAME_MAX_RECORDS bytes);
+// returns the frame length, 0 if nothing is pending
+size_t traceDrain(uint8_t* out, size_t cap);
+
+// Records dropped since the last call
+uint32_t traceTakeDropped();
+
+// Average cost of traceEmit() in ns over `samples` calls; the
+// measurement records are discarded again. Call at boot, before
+// other tasks start tracing.
+uint32_t traceMeasureCostNs(int samples);
+
+#define TRACE(ev, a, b) \
+  do { \
+    if (ev##_LEVEL <= TRACE_LEVEL) traceEmit(ev, (int32_t)(a), (int32_t)(b)); \
+  } while (0)
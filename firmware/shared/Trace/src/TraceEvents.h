@@ -0,0 +1,70 @@
+/*
+ * ============================================
+ * VisionAssist - Trace Event Table
+ * ============================================
+ *
+ * Every trace event, its id, level and the format the host
+ * decoder prints it with (two int args). Ids are part of
+ * the trace stream: append new events, never renumber.
+ *   0x00xx trace system, 0x01xx eyewear, 0x02xx handband
+ * ============================================
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#define TRACE_LEVEL_ERROR 1
+#define TRACE_LEVEL_WARN  2
+#define TRACE_LEVEL_INFO  3
+#define TRACE_LEVEL_DEBUG 4
+
+//      name                  id      level              format
+#define TRACE_EVENTS(X) \
+  X(TR_DROPPED,           0x0001, TRACE_LEVEL_WARN,  "%d trace records dropped") \
+  X(TR_COST,              0x0002, TRACE_LEVEL_INFO,  "trace cost %d ns/event (%d samples)") \
+  X(TR_EYE_STATUS,        0x0100, TRACE_LEVEL_INFO,  "D:%dmm P:%d") \
+  X(TR_EYE_STATUS_READ,   0x0101, TRACE_LEVEL_INFO,  "READ | D:%dmm P:%d") \
+  X(TR_EYE_TOUCH,         0x0102, TRACE_LEVEL_INFO,  "touch detected") \
+  X(TR_EYE_READING_ON,    0x0103, TRACE_LEVEL_INFO,  "reading mode - vibration paused (source %d)") \
+  X(TR_EYE_READING_OFF,   0x0104, TRACE_LEVEL_INFO,  "navigation mode (reason %d: 0 tts done, 1 auto, 2 timeout, 3 capture failed, 4 OCR abandoned)") \
+  X(TR_EYE_OCR_IMAGE,     0x0110, TRACE_LEVEL_DEBUG, "OCR image %d bytes, request %d bytes") \
+  X(TR_EYE_OCR_HTTP,      0x0111, TRACE_LEVEL_INFO,  "OCR HTTP %d after %d ms") \
+  X(TR_EYE_OCR_DONE,      0x0112, TRACE_LEVEL_INFO,  "OCR done: %d chars, useful %d") \
+  X(TR_EYE_CAPTURE_FAIL,  0x0113, TRACE_LEVEL_ERROR, "camera capture failed (ready %d)") \
+  X(TR_EYE_OCR_CHUNK,     0x0114, TRACE_LEVEL_INFO,  "OCR run %d first chunk after %d ms") \
+  X(TR_EYE_TTS_START,     0x0115, TRACE_LEVEL_INFO,  "OCR run %d first word spoken after %d ms") \
+  X(TR_EYE_OCR_FEATURE,   0x0116, TRACE_LEVEL_DEBUG, "OCR feature %d (0 text, 1 document), mode %d (0 auto, 1 sign, 2 page)") \
+  X(TR_EYE_OCR_RESPONSE,  0x0117, TRACE_LEVEL_INFO,  "OCR response %d bytes in %d ms") \
+  X(TR_EYE_OCR_BACKEND,   0x0118, TRACE_LEVEL_INFO,  "OCR backend %d (0 vision, 1 gateway) total %d ms") \
+  X(TR_EYE_OCR_RETRY,     0x0119, TRACE_LEVEL_WARN,  "OCR attempt failed (code %d), retry in %d ms") \
+  X(TR_EYE_OCR_ABANDON,   0x011A, TRACE_LEVEL_WARN,  "OCR request %d abandoned (2 cancelled, 3 deadline missed: %d)") \
+  X(TR_EYE_EXPOSURE,      0x011B, TRACE_LEVEL_INFO,  "OCR exposure %d (1 converged, 2 limit, 3 unsettled) after %d frames") \
+  X(TR_EYE_CAMERA_POWER,  0x011C, TRACE_LEVEL_INFO,  "camera %d (0 awake, 1 standby), first fresh frame after %d ms") \
+  X(TR_EYE_OCR_BURST,     0x011D, TRACE_LEVEL_INFO,  "OCR burst of %d frames, frame %d read (= frames: none useful)") \
+  X(TR_EYE_TEXT_GATE,     0x011E, TRACE_LEVEL_INFO,  "OCR text check: %d blocks in text lines, %d ms") \
+  X(TR_EYE_TABLE_SENT,    0x0120, TRACE_LEVEL_INFO,  "pattern table v%d sent") \
+  X(TR_EYE_TABLE_SET,     0x0121, TRACE_LEVEL_INFO,  "pattern %d set, table v%d") \
+  X(TR_EYE_SEND_FAIL,     0x0122, TRACE_LEVEL_DEBUG, "ESP-NOW send failed (%d failed, %d ok)") \
+  X(TR_EYE_PEER_PAIRED,   0x0123, TRACE_LEVEL_INFO,  "band paired in slot %d, role %d") \
+  X(TR_EYE_PEER_LOST,     0x0124, TRACE_LEVEL_WARN,  "band %d unreachable after %d failed frames") \
+  X(TR_EYE_RADIO_POWER,   0x0125, TRACE_LEVEL_DEBUG, "radio %d (0 awake, 1 modem sleep)") \
+  X(TR_HB_PATTERN,        0x0200, TRACE_LEVEL_INFO,  "P%d @ %dmm") \
+  X(TR_HB_PAUSED,         0x0201, TRACE_LEVEL_INFO,  "reading mode - motor off") \
+  X(TR_HB_RESUMED,        0x0202, TRACE_LEVEL_INFO,  "navigation mode - motor active") \
+  X(TR_HB_LINK_MODE,      0x0203, TRACE_LEVEL_WARN,  "link mode %d (0 ok, 1 extrapolating, 2 degraded)") \
+  X(TR_HB_LINK_LOST,      0x0204, TRACE_LEVEL_WARN,  "connection lost after %d frames") \
+  X(TR_HB_TABLE_SAVED,    0x0205, TRACE_LEVEL_INFO,  "pattern table v%d saved") \
+  X(TR_HB_CHANNEL_LOCK,   0x0206, TRACE_LEVEL_INFO,  "locked on ch %d after %d ms") \
+  X(TR_HB_CHANNEL_SCAN,   0x0207, TRACE_LEVEL_INFO,  "scanning for eyewear from ch %d") \
+  X(TR_HB_TABLE_REQUEST,  0x0208, TRACE_LEVEL_DEBUG, "pattern table requested (have v%d)") \
+  X(TR_HB_PAIRED,         0x0209, TRACE_LEVEL_INFO,  "paired as role %d (slot %d)") \
+  X(TR_HB_POWER,          0x020A, TRACE_LEVEL_INFO,  "asleep %d permille, %d light sleeps")
+
+#define TRACE_EVENT_ID(name, id, level, fmt) name = id,
+enum TraceEvent : uint16_t { TRACE_EVENTS(TRACE_EVENT_ID) };
+#undef TRACE_EVENT_ID
+
+#define TRACE_EVENT_LEVEL(name, id, level, fmt) name##_LEVEL = level,
+enum TraceEventLevel { TRACE_EVENTS(TRACE_EVENT_LEVEL) };
+#undef TRACE_EVENT_LEVEL
@@ -0,0 +1,106 @@
+/*
+ * ============================================
+ * VisionAssist - ESP-NOW Protocol
+ * ============================================
+ *
+ * Frame layouts shared by the eyewear (sender) and the
+ * handband (receiver). All frames are packed and start
+ * with a one byte message type.
+ * ============================================
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#define MSG_STATE         1
+#define MSG_PATTERN_TABLE 2
+#define MSG_TABLE_REQUEST 3
+#define MSG_BEACON        4
+#define MSG_PAIR_REQUEST  5
+#define MSG_PAIR_ACK      6
+
+#define FLAG_PAUSE 0x01
+
+#define MAX_PATTERNS 8
+
+// Band roles: which part of the field of view a band reports
+#define ROLE_ALL    0   // nearest obstacle anywhere (single band, belt)
+#define ROLE_LEFT   1   // ahead and to the left
+#define ROLE_RIGHT  2   // ahead and to the right
+#define ROLE_CENTER 3   // straight ahead only
+#define ROLE_COUNT  4
+
+// Pattern ids
+#define PATTERN_CLEAR    0
+#define PATTERN_CRITICAL 1
+#define PATTERN_WARNING  2
+#define PATTERN_CAUTION  3
+#define PATTERN_DEGRADED 4
+#define PATTERN_COUNT    5
+
+// Default zone thresholds (mm)
+#define CRITICAL_DISTANCE 1300
+#define WARNING_DISTANCE 1600
+#define CAUTION_DISTANCE 2000
+
+// One vibration pattern: motor ON for onMs, then OFF for offMs.
+// onMs == 0 means always off, offMs == 0 means continuous.
+typedef struct __attribute__((packed)) {
+  uint16_t onMs;
+  uint16_t offMs;
+} PatternDesc;
+
+// Sent every frame - references a pattern by id only
+typedef struct __attribute__((packed)) {
+  uint8_t type;          // MSG_STATE
+  uint8_t tableVersion;  // version of the pattern table the id refers to
+  uint8_t pattern;       // index into the pattern table
+  uint8_t intensity;     // motor PWM duty (0-255)
+  uint8_t flags;         // FLAG_PAUSE
+  int16_t distance;      // mm
+  int16_t closingSpeed;  // mm/s, positive = approaching
+} StateFrame;
+
+// Sent once (and on request) - full pattern table
+typedef struct __attribute__((packed)) {
+  uint8_t type;          // MSG_PATTERN_TABLE
+  uint8_t tableVersion;  // 0 is reserved for the handband's built-in table
+  uint8_t count;
+  PatternDesc patterns[MAX_PATTERNS];
+  uint16_t thresholds[3]; // critical, warning, caution (mm)
+} PatternTableFrame;
+
+// Sent by the handband when its cached table is stale
+typedef struct __attribute__((packed)) {
+  uint8_t type;          // MSG_TABLE_REQUEST
+  uint8_t haveVersion;
+} TableRequestFrame;
+
+// Broadcast by the eyewear so bands can find its channel
+typedef struct __attribute__((packed)) {
+  uint8_t type;          // MSG_BEACON
+  uint8_t channel;
+} BeaconFrame;
+
+// Sent by a band until the eyewear acknowledges it
+typedef struct __attribute__((packed)) {
+  uint8_t type;          // MSG_PAIR_REQUEST
+  uint8_t role;          // role wanted on first pairing
+} PairRequestFrame;
+
+// Reply to a pair request from a registered band
+typedef struct __attribute__((packed)) {
+  uint8_t type;          // MSG_PAIR_ACK
+  uint8_t role;          // role the eyewear drives this band with
+  uint8_t slot;
+} PairAckFrame;
+
+// Built-in pattern table (handband default, eyewear initial table)
+static const PatternDesc DEFAULT_PATTERNS[PATTERN_COUNT] = {
+  {    0,   0 },  // 0: CLEAR    - OFF
+  { 1000,   0 },  // 1: CRITICAL - Continuous vibration
+  {  400, 150 },  // 2: WARNING  - Fast pulses
+  {  300, 600 },  // 3: CAUTION  - Slow pulses
+  {   60, 940 },  // 4: DEGRADED - Short blip, link lost but recently active
+};